@@ -2,6 +2,7 @@
 #include "../source/engine/helper.h"
 #include "../source/engine/Camera.h"
 #include "../source/engine/Debug.h"
+#include "../source/engine/VKtrace.h"
 #include "../source/struct.h"
 
 using namespace vkengine::helper;
@@ -25,15 +26,37 @@ namespace vkengine {
         VulkanEngine::prepare();
         this->init_sync_structures();
 
+        // 파이프라인을 먼저 요청해서 버퍼 업로드와 컴파일이 겹치도록 합니다.
+        this->createDescriptorSetLayout();
+        this->createGraphicsPipeline();
+
         this->createVertexbuffer();
         this->createIndexBuffer();
+        this->VKdevice->VKstagingRing->flush();
         this->createUniformBuffers();
+        this->createInstanceBuffer();
+
+        // GPU 컬링은 켤 때 만듭니다. -> 쓰지 않으면 컴퓨트 셰이더를 읽지 않습니다.
+        if (this->gpuCulling) {
+            this->createGpuCuller();
+        }
 
-        this->createDescriptorSetLayout();
         this->createDescriptorPool();
         this->createDescriptorSets();
 
-        this->createGraphicsPipeline();
+        // GPU 프로파일러 오버레이 -> 헤드리스 모드는 창이 없으므로 UI를 만들지 않습니다.
+        if (!this->headless) {
+            this->gui = new gui::vkGUI();
+            this->gui->init();
+        }
+
+        // 캐시 유무에 따른 시작 시 파이프라인 생성 시간
+        this->VKpipelineManager->waitIdle();
+        this->VKpipelineCache.report();
+
+#if SHADER_HOT_RELOAD
+        this->VKpipelineManager->watchShaders();
+#endif
 
         return true;
     }
@@ -42,23 +65,29 @@ namespace vkengine {
     {
         if (this->_isInitialized)
         {
+            // ImGui 백엔드가 만든 파이프라인, 폰트 이미지, 디스크립터 풀을 해제합니다.
+            delete this->gui;
+            this->gui = nullptr;
+
             this->cleanupSwapcChain();
 
-            vkDestroyPipeline(this->VKdevice->VKdevice, this->VKgraphicsPipeline, nullptr);
             vkDestroyPipelineLayout(this->VKdevice->VKdevice, this->VKpipelineLayout, nullptr);
             vkDestroyRenderPass(this->VKdevice->VKdevice, *this->VKrenderPass.get(), nullptr);
 
             // 추가적인 부분
             for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++)
             {
-                vkDestroyBuffer(this->VKdevice->VKdevice, this->VKuniformBuffer[i].buffer, nullptr);
-                vkFreeMemory(this->VKdevice->VKdevice, this->VKuniformBuffer[i].memory, nullptr);
+                this->VKuniformBuffer[i].cleanup(this->VKdevice->VKallocator.get());
+            }
+            this->VKinstanceBuffer->cleanup();
+            if (this->VKgpuCuller != nullptr) {
+                this->VKgpuCuller->cleanup();
             }
 
             vkDestroyDescriptorPool(this->VKdevice->VKdevice, this->VKdescriptorPool, nullptr);
             vkDestroyDescriptorSetLayout(this->VKdevice->VKdevice, this->VKdescriptorSetLayout, nullptr);
 
-            this->VKvertexBuffer.cleanup(this->VKdevice->VKdevice);
+            this->VKvertexBuffer.cleanup(this->VKdevice->VKallocator.get());
 
             for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++)
             {
@@ -67,7 +96,15 @@ namespace vkengine {
                 vkDestroyFence(this->VKdevice->VKdevice, this->VKframeData[i].VkinFlightFences, nullptr);
             }
 
-            vkDestroyPipelineCache(this->VKdevice->VKdevice, this->VKpipelineCache, nullptr);
+            this->VKgpuProfiler.cleanup();
+
+            // 컴파일 스레드를 멈추고 파이프라인을 해제한 뒤, 파이프라인 캐시를 파일로 저장하고 해제합니다.
+            this->VKpipelineManager->cleanup();
+            this->VKpipelineCache.cleanup();
+
+            // 스레드별 커맨드 풀을 해제하고 잡 시스템의 워커 스레드를 멈춥니다.
+            this->VKcommandRecorder->cleanup();
+            this->VKjobSystem->cleanup();
 
             this->VKdevice->cleanup();
 
@@ -75,28 +112,60 @@ namespace vkengine {
                 DestroyDebugUtilsMessengerEXT(this->VKinstance, this->VKdebugUtilsMessenger, nullptr);
             }
 
-            vkDestroySurfaceKHR(this->VKinstance, this->VKsurface, nullptr);
+            if (this->VKsurface != VK_NULL_HANDLE) {
+                vkDestroySurfaceKHR(this->VKinstance, this->VKsurface, nullptr);
+            }
             vkDestroyInstance(this->VKinstance, nullptr);
 
-            glfwDestroyWindow(this->VKwindow);
-            glfwTerminate();
+            if (!this->headless) {
+                glfwDestroyWindow(this->VKwindow);
+                glfwTerminate();
+            }
         }
 
     }
 
     void cameraEngine::drawFrame()
     {
+        VK_TRACE_SCOPE("drawFrame");
+
+        // 단계별 시간은 VKframeTimings에 남습니다. (벤치마크가 읽음)
+        auto phaseStart = std::chrono::high_resolution_clock::now();
+
         // 렌더링을 시작하기 전에 프레임을 렌더링할 준비가 되었는지 확인합니다.
         VK_CHECK_RESULT(vkWaitForFences(this->VKdevice->VKdevice, 1, &this->getCurrnetFrameData().VkinFlightFences, VK_TRUE, UINT64_MAX));
+        this->VKframeTimings.wait = lapMs(phaseStart);
+
+        // 펜스를 기다렸으므로 이 슬롯에 지난번 기록한 GPU 구간을 읽을 수 있습니다.
+        this->VKframeTimings.gpu = this->VKgpuProfiler.collect(static_cast<uint32_t>(this->currentFrame)) ? this->VKgpuProfiler.getFrameMs() : -1.0;
+
+        // 이 프레임의 GPU 작업이 끝났으므로 스레드별 커맨드 풀을 리셋합니다.
+        this->VKcommandRecorder->resetFrame(static_cast<uint32_t>(this->currentFrame));
+
+        // 바뀐 셰이더를 쓰는 파이프라인을 다시 컴파일하고, 교체된 파이프라인을 해제합니다.
+        this->VKpipelineManager->update();
 
         // 이미지를 가져오기 위해 스왑 체인에서 이미지 인덱스를 가져옵니다.
         // 주어진 스왑체인에서 다음 이미지를 획득하고, 
         // 선택적으로 세마포어와 펜스를 사용하여 동기화를 관리하는 Vulkan API의 함수입니다.
         uint32_t imageIndex = 0;
+        phaseStart = std::chrono::high_resolution_clock::now();
         VulkanEngine::prepareFame(&imageIndex);
-
-        // uniform 버퍼를 업데이트합니다.
-        this->updateUniformBuffer(static_cast<uint32_t>(this->currentFrame));
+        this->VKframeTimings.acquire = lapMs(phaseStart);
+
+        // 움직인 노드의 하위 트리만 월드 변환을 다시 계산하고, 바뀐 오브젝트를 인스턴스 버퍼와 컬링 경계에 반영합니다.
+        this->updateTransforms();
+
+        // uniform 버퍼와 인스턴스 버퍼 갱신을 잡으로 실행하고, 그동안 커맨드 버퍼를 기록합니다.
+        // 인스턴스 버퍼는 바뀐 뒤 이 슬롯에 아직 복사하지 않았을 때만 복사합니다. (일부만 바뀌었으면 그 오브젝트만)
+        const uint32_t frameIndex = static_cast<uint32_t>(this->currentFrame);
+        job::VKJob* uniformJob = this->VKjobSystem->createJob([this, frameIndex]() {
+            auto uniformStart = std::chrono::high_resolution_clock::now();
+            this->updateUniformBuffer(frameIndex);
+            this->VKinstanceBuffer->update(frameIndex, this->VKjobSystem.get());
+            this->VKframeTimings.uniform = lapMs(uniformStart);
+        });
+        this->VKjobSystem->run(uniformJob);
 
         // 플래그를 재설정합니다. -> 렌더링이 끝나면 플래그를 재설정합니다.
         vkResetFences(this->VKdevice->VKdevice, 1, &this->getCurrnetFrameData().VkinFlightFences);
@@ -108,13 +177,19 @@ namespace vkengine {
         // 렌더링을 시작하기 전에 커맨드 버퍼를 재설정합니다.
         this->recordCommandBuffer(&this->VKframeData[this->currentFrame], imageIndex);
 
+        // 제출 전에 uniform 버퍼 갱신이 끝나야 합니다.
+        this->VKjobSystem->wait(uniformJob);
+        this->VKframeTimings.record = lapMs(phaseStart);
+
         // VkSubmitInfo 구조체는 큐에 제출할 명령 버퍼를 지정합니다.
         VKsubmitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
 
         // 렌더링을 시작하기 전에 세마포어를 설정합니다.
+        // 헤드리스 모드는 스왑 체인 이미지를 기다리거나 프레젠트에 알릴 필요가 없으므로 세마포어를 쓰지 않습니다.
+        const uint32_t semaphoreCount = this->headless ? 0 : 1;
         VkSemaphore waitSemaphores[] = { this->VKframeData[this->currentFrame].VkimageavailableSemaphore };
         VkPipelineStageFlags waitStages[] = { VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT };
-        VKsubmitInfo.waitSemaphoreCount = 1;
+        VKsubmitInfo.waitSemaphoreCount = semaphoreCount;
         VKsubmitInfo.pWaitSemaphores = waitSemaphores;
         VKsubmitInfo.pWaitDstStageMask = waitStages;
 
@@ -124,17 +199,22 @@ namespace vkengine {
 
         // 렌더링을 시작하기 전에 세마포어를 설정합니다.
         VkSemaphore signalSemaphores[] = { this->VKframeData[this->currentFrame].VkrenderFinishedSemaphore };
-        VKsubmitInfo.signalSemaphoreCount = 1;
+        VKsubmitInfo.signalSemaphoreCount = semaphoreCount;
         VKsubmitInfo.pSignalSemaphores = signalSemaphores;
 
         // 플래그를 재설정합니다. -> 렌더링이 끝나면 플래그를 재설정합니다.
         vkResetFences(this->VKdevice->VKdevice, 1, &this->VKframeData[this->currentFrame].VkinFlightFences);
 
+        // 이번 프레임에 쌓인 업로드를 렌더링보다 먼저 같은 큐에 제출합니다. (기록된 것이 없으면 아무것도 하지 않음)
+        this->VKdevice->VKstagingRing->flush();
+
         // 렌더링을 시작합니다.
         VK_CHECK_RESULT(vkQueueSubmit(this->VKdevice->graphicsVKQueue, 1, &VKsubmitInfo, this->VKframeData[this->currentFrame].VkinFlightFences));
+        this->VKframeTimings.submit = lapMs(phaseStart);
 
         // 렌더링 종료 후, 프레젠트를 시작합니다.
         VulkanEngine::presentFrame(&imageIndex);
+        this->VKframeTimings.present = lapMs(phaseStart);
 
         this->currentFrame = (this->currentFrame + 1) % MAX_FRAMES_IN_FLIGHT;
     }
@@ -143,9 +223,7 @@ namespace vkengine {
     {
         static auto currentTime = std::chrono::high_resolution_clock::now();
         
-        while (!glfwWindowShouldClose(this->VKwindow)) {
-            glfwPollEvents();
-
+        while (this->nextFrame()) {
             auto newTime = std::chrono::high_resolution_clock::now();
             float frameTime = std::chrono::duration<float, std::chrono::seconds::period>(newTime - currentTime).count();
             currentTime = newTime;
@@ -217,11 +295,25 @@ namespace vkengine {
 
     void cameraEngine::recordCommandBuffer(FrameData* framedata, uint32_t imageIndex)
     {
+        VK_TRACE_SCOPE("recordCommandBuffer");
+
         // 커맨드 버퍼 기록을 시작합니다.
         VkCommandBufferBeginInfo beginInfo = framedata->commandBufferBeginInfo(VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
 
         VK_CHECK_RESULT(vkBeginCommandBuffer(framedata->mainCommandBuffer, &beginInfo));
 
+        // 프레임 전체 구간을 열고, 렌더 패스와 UI를 이름 붙은 구간으로 나눠 잽니다.
+        this->VKgpuProfiler.beginFrame(framedata->mainCommandBuffer, static_cast<uint32_t>(this->currentFrame));
+
+        // GPU 컬링은 렌더 패스 밖에서 디스패치합니다. -> 렌더 패스 안에서는 결과로 간접 draw 하나만 기록
+        const bool gpuCulled = this->isGpuCulling();
+        if (gpuCulled) {
+            VKGpuScopeGuard scope(this->VKgpuProfiler, framedata->mainCommandBuffer, "cull");
+            this->VKgpuCuller->record(framedata->mainCommandBuffer, static_cast<uint32_t>(this->currentFrame), this->camera->getFrustumPlanes());
+        }
+
+        const uint32_t renderPassScope = this->VKgpuProfiler.beginScope(framedata->mainCommandBuffer, "render pass");
+
         // 렌더 패스를 시작하기 위한 클리어 값 설정
         std::array<VkClearValue, 2> clearValues{};
         clearValues[0].color = { {0.2f, 0.2f, 0.2f, 1.0f} };
@@ -237,42 +329,100 @@ namespace vkengine {
         renderPassInfo.clearValueCount = static_cast<uint32_t>(clearValues.size());;
         renderPassInfo.pClearValues = clearValues.data();
 
-        // 렌더 패스를 시작합니다.
-        vkCmdBeginRenderPass(framedata->mainCommandBuffer, &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
+        // 렌더 패스를 시작합니다. -> 내용은 secondary 커맨드 버퍼로 기록합니다.
+        vkCmdBeginRenderPass(framedata->mainCommandBuffer, &renderPassInfo, VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS);
         {
-            // 그래픽 파이프라인을 바인딩합니다.
-            vkCmdBindPipeline(framedata->mainCommandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, this->VKgraphicsPipeline);
-
-            VkViewport viewport{};
-            viewport.x = 0.0f;
-            viewport.y = 0.0f;
-            viewport.width = static_cast<float>(this->VKswapChain->getSwapChainExtent().width);
-            viewport.height = static_cast<float>(this->VKswapChain->getSwapChainExtent().height);
-            viewport.minDepth = 0.0f;
-            viewport.maxDepth = 1.0f;
-            vkCmdSetViewport(framedata->mainCommandBuffer, 0, 1, &viewport);
-
-            VkRect2D scissor{};
-            scissor.offset = { 0, 0 };
-            scissor.extent = this->VKswapChain->getSwapChainExtent();
-            vkCmdSetScissor(framedata->mainCommandBuffer, 0, 1, &scissor);
-
-            // 버텍스 버퍼를 바인딩합니다.
-            VkBuffer vertexBuffers[] = { this->VKvertexBuffer.vertexBuffer };
-            VkDeviceSize offsets[] = { 0 };
-            vkCmdBindVertexBuffers(framedata->mainCommandBuffer, 0, 1, vertexBuffers, offsets);
-
-            // 인덱스 버퍼를 바인딩합니다.
-            vkCmdBindIndexBuffer(framedata->mainCommandBuffer, this->VKvertexBuffer.indexBuffer, 0, VK_INDEX_TYPE_UINT16);
+            VkCommandBufferInheritanceInfo inheritanceInfo{};
+            inheritanceInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
+            inheritanceInfo.renderPass = *this->VKrenderPass.get();
+            inheritanceInfo.subpass = 0;
+            inheritanceInfo.framebuffer = this->VKswapChainFramebuffers[imageIndex];
+
+            const VkExtent2D extent = this->VKswapChain->getSwapChainExtent();
+
+            // 오브젝트마다 그릴 때는 CPU 컬링으로 보이는 오브젝트만 남길 수 있습니다.
+            const bool cpuCulled = this->cpuCulling && !this->instancing && !gpuCulled;
+            if (cpuCulled) {
+                cullFrustum(this->VKcullBounds, this->camera->getFrustumPlanes(), VKCullVolume::Aabb, this->visibleObjects, this->VKjobSystem.get());
+            }
 
-            // 디스크립터 세트를 바인딩합니다.
-            vkCmdBindDescriptorSets(framedata->mainCommandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, this->VKpipelineLayout, 0, 1, &this->VKdescriptorSets[this->currentFrame], 0, nullptr);
-            // 렌더 패스를 종료합니다.
-            vkCmdDrawIndexed(framedata->mainCommandBuffer, static_cast<uint32_t>(cubeindices_.size()), 1, 0, 0, 0);
+            // 인스턴싱이나 GPU 컬링이면 draw는 하나뿐입니다.
+            const uint32_t recordCount = (this->instancing || gpuCulled) ? std::min(this->drawCount, 1u)
+                : (cpuCulled ? static_cast<uint32_t>(this->visibleObjects.size()) : this->drawCount);
+
+            // draw 목록을 스레드별로 나눠 기록합니다. (secondary 버퍼는 상태를 상속하지 않으므로 구간마다 바인딩)
+            this->VKcommandRecorder->record(
+                framedata->mainCommandBuffer,
+                static_cast<uint32_t>(this->currentFrame),
+                inheritanceInfo,
+                recordCount,
+                [this, extent, gpuCulled, cpuCulled](VkCommandBuffer commandBuffer, uint32_t first, uint32_t count) {
+                    // 파이프라인이 아직 컴파일 중이면 이 프레임은 그리지 않습니다.
+                    const VkPipeline pipeline = this->VKgraphicsPipeline.get();
+                    if (pipeline == VK_NULL_HANDLE) {
+                        return;
+                    }
+
+                    // 그래픽 파이프라인을 바인딩합니다.
+                    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline);
+
+                    VkViewport viewport{};
+                    viewport.x = 0.0f;
+                    viewport.y = 0.0f;
+                    viewport.width = static_cast<float>(extent.width);
+                    viewport.height = static_cast<float>(extent.height);
+                    viewport.minDepth = 0.0f;
+                    viewport.maxDepth = 1.0f;
+                    vkCmdSetViewport(commandBuffer, 0, 1, &viewport);
+
+                    VkRect2D scissor{};
+                    scissor.offset = { 0, 0 };
+                    scissor.extent = extent;
+                    vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
+
+                    // 버텍스 버퍼를 바인딩합니다.
+                    VkBuffer vertexBuffers[] = { this->VKvertexBuffer.vertexBuffer };
+                    VkDeviceSize offsets[] = { 0 };
+                    vkCmdBindVertexBuffers(commandBuffer, 0, 1, vertexBuffers, offsets);
+
+                    // 인덱스 버퍼를 바인딩합니다.
+                    vkCmdBindIndexBuffer(commandBuffer, this->VKvertexBuffer.indexBuffer, 0, VK_INDEX_TYPE_UINT16);
+
+                    // 디스크립터 세트를 바인딩합니다.
+                    vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, this->VKpipelineLayout, 0, 1, &this->VKdescriptorSets[this->currentFrame], 0, nullptr);
+
+                    // 보이는 오브젝트만 그립니다. -> 수는 GPU가 정하므로 CPU는 읽지 않습니다.
+                    if (gpuCulled) {
+                        this->VKgpuCuller->draw(commandBuffer, static_cast<uint32_t>(this->currentFrame));
+                        return;
+                    }
+
+                    const uint32_t indexCount = static_cast<uint32_t>(cubeindices_.size());
+
+                    // 모든 오브젝트를 한 번에 그립니다. -> 버텍스 셰이더가 gl_InstanceIndex로 변환을 읽습니다.
+                    if (this->instancing) {
+                        vkCmdDrawIndexed(commandBuffer, indexCount, this->drawCount, 0, 0, 0);
+                        return;
+                    }
+
+                    // 오브젝트마다 draw 하나 -> firstInstance가 gl_InstanceIndex가 되므로 같은 셰이더를 씁니다.
+                    for (uint32_t i = first; i < first + count; i++)
+                    {
+                        vkCmdDrawIndexed(commandBuffer, indexCount, 1, 0, 0, cpuCulled ? this->visibleObjects[i] : i);
+                    }
+                },
+                // UI는 메인 스레드에서 마지막 secondary 버퍼에 기록합니다. (헤드리스 모드는 UI 없음)
+                this->gui == nullptr ? std::function<void(VkCommandBuffer)>() : [this](VkCommandBuffer commandBuffer) {
+                    VKGpuScopeGuard scope(this->VKgpuProfiler, commandBuffer, "ui");
+                    this->gui->update(commandBuffer);
+                });
         }
 
         vkCmdEndRenderPass(framedata->mainCommandBuffer);
 
+        this->VKgpuProfiler.endScope(framedata->mainCommandBuffer, renderPassScope);
+        this->VKgpuProfiler.endFrame(framedata->mainCommandBuffer);
+
         // 커맨드 버퍼 기록을 종료합니다.
         VK_CHECK_RESULT(vkEndCommandBuffer(framedata->mainCommandBuffer));
     }
@@ -281,85 +431,31 @@ namespace vkengine {
     {
         VkDeviceSize buffersize = sizeof(cube[0]) * cube.size();
 
-        VkBuffer stagingBuffer;
-        VkDeviceMemory stagingBufferMemory;
-
         helper::createBuffer(
-            this->VKdevice->VKdevice,
-            this->VKdevice->VKphysicalDevice,
-            buffersize,
-            VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-            stagingBuffer,
-            stagingBufferMemory);
-
-        void* data;
-        vkMapMemory(this->VKdevice->VKdevice, stagingBufferMemory, 0, buffersize, 0, &data);
-        memcpy(data, cube.data(), (size_t)buffersize);
-        vkUnmapMemory(this->VKdevice->VKdevice, stagingBufferMemory);
-
-        helper::createBuffer(
-            this->VKdevice->VKdevice,
-            this->VKdevice->VKphysicalDevice,
+            this->VKdevice->VKallocator.get(),
             buffersize,
             VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
             VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
             this->VKvertexBuffer.vertexBuffer,
             this->VKvertexBuffer.vertexMemory);
 
-        helper::copyBuffer(
-            this->VKdevice->VKdevice,
-            this->VKdevice->VKcommandPool,
-            this->VKdevice->graphicsVKQueue,
-            stagingBuffer,
-            this->VKvertexBuffer.vertexBuffer,
-            buffersize);
-
-        // 버퍼 생성이 끝나면 스테이징 버퍼를 제거합니다.
-        vkDestroyBuffer(this->VKdevice->VKdevice, stagingBuffer, nullptr);
-        vkFreeMemory(this->VKdevice->VKdevice, stagingBufferMemory, nullptr);
+        // 스테이징 링에 복사 명령만 기록합니다. -> 제출은 flush()에서 한 번에 이루어집니다.
+        this->VKdevice->VKstagingRing->uploadBuffer(this->VKvertexBuffer.vertexBuffer, cube.data(), buffersize);
     }
 
     void cameraEngine::createIndexBuffer()
     {
         VkDeviceSize buffersize = sizeof(cubeindices_[0]) * cubeindices_.size();
-        VkBuffer stagingBuffer;
-        VkDeviceMemory stagingBufferMemory;
-
-        helper::createBuffer(
-            this->VKdevice->VKdevice,
-            this->VKdevice->VKphysicalDevice,
-            buffersize,
-            VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-            stagingBuffer,
-            stagingBufferMemory);
-
-        void* data;
-        vkMapMemory(this->VKdevice->VKdevice, stagingBufferMemory, 0, buffersize, 0, &data);
-        memcpy(data, cubeindices_.data(), (size_t)buffersize);
-        vkUnmapMemory(this->VKdevice->VKdevice, stagingBufferMemory);
-
         helper::createBuffer(
-            this->VKdevice->VKdevice,
-            this->VKdevice->VKphysicalDevice,
+            this->VKdevice->VKallocator.get(),
             buffersize,
             VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT,
             VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
             this->VKvertexBuffer.indexBuffer,
             this->VKvertexBuffer.indexmemory);
 
-        helper::copyBuffer(
-            this->VKdevice->VKdevice,
-            this->VKdevice->VKcommandPool,
-            this->VKdevice->graphicsVKQueue,
-            stagingBuffer,
-            this->VKvertexBuffer.indexBuffer,
-            buffersize);
-
-        // 버퍼 생성이 끝나면 스테이징 버퍼를 제거합니다.
-        vkDestroyBuffer(this->VKdevice->VKdevice, stagingBuffer, nullptr);
-        vkFreeMemory(this->VKdevice->VKdevice, stagingBufferMemory, nullptr);
+        // 스테이징 링에 복사 명령만 기록합니다. -> 제출은 flush()에서 한 번에 이루어집니다.
+        this->VKdevice->VKstagingRing->uploadBuffer(this->VKvertexBuffer.indexBuffer, cubeindices_.data(), buffersize);
     }
 
     void cameraEngine::createUniformBuffers()
@@ -371,34 +467,243 @@ namespace vkengine {
         for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++)
         {
             helper::createBuffer(
-                this->VKdevice->VKdevice,
-                this->VKdevice->VKphysicalDevice,
+                this->VKdevice->VKallocator.get(),
                 bufferSize,
                 VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
                 VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
                 this->VKuniformBuffer[i].buffer,
                 this->VKuniformBuffer[i].memory);
 
-            vkMapMemory(this->VKdevice->VKdevice, this->VKuniformBuffer[i].memory, 0, bufferSize, 0, &this->VKuniformBuffer[i].Mapped);
+            this->VKuniformBuffer[i].Mapped = this->VKuniformBuffer[i].memory.mapped;
+        }
+    }
+
+    void cameraEngine::createInstanceBuffer()
+    {
+        this->VKinstanceBuffer = std::make_unique<VKInstanceBuffer>(this->VKdevice->VKallocator.get(), this->drawCount);
+        this->layoutInstances();
+    }
+
+    void cameraEngine::createGpuCuller()
+    {
+        // 한 번 실패하면 다시 시도하지 않습니다.
+        this->gpuCullerUnavailable = true;
+
+        if (!VKGpuCuller::isSupported(this->VKdevice.get())) {
+            printf("GPU culling is not supported (%s, drawIndirectFirstInstance) -> CPU draw path\n", VK_KHR_DRAW_INDIRECT_COUNT_EXTENSION_NAME);
+            return;
+        }
+
+        VkShaderModule cullShader = VK_NULL_HANDLE;
+        try {
+            cullShader = this->VKpipelineManager->loadShaderModule(this->RootPath + "../../../../../../shader/compCull.spv");
+        }
+        catch (const std::exception& error) {
+            printf("GPU culling is disabled (compCull.spv: %s) -> CPU draw path\n", error.what());
+            return;
+        }
+
+        this->VKgpuCuller = std::make_unique<VKGpuCuller>(this->VKdevice.get(), cullShader, this->VKpipelineCache.getHandle(), this->drawCount);
+        this->VKgpuCuller->setCount(this->drawCount);
+        this->gpuCullerUnavailable = false;
+
+        VKCullObject* cullObjects = this->VKgpuCuller->getObjects();
+        const uint32_t indexCount = static_cast<uint32_t>(cubeindices_.size());
+        for (uint32_t i = 0; i < this->drawCount; i++)
+        {
+            cullObjects[i].indexCount = indexCount;
+            cullObjects[i].firstIndex = 0;
+            cullObjects[i].vertexOffset = 0;
+            cullObjects[i].instanceIndex = i;
+        }
+
+        // 장면 루트를 dirty로 표시해서 현재 변환 그대로 모든 오브젝트의 경계 구를 채웁니다. (배치는 다시 하지 않음)
+        this->VKtransforms.setLocal(this->sceneRoot, this->VKtransforms.getLocal(this->sceneRoot));
+        this->updateTransforms();
+        this->VKgpuCuller->markDirty();
+    }
+
+    void cameraEngine::setGpuCulling(bool enabled)
+    {
+        this->gpuCulling = enabled;
+
+        // prepare 전이면 prepare에서 만듭니다.
+        if (enabled && this->VKinstanceBuffer != nullptr && this->VKgpuCuller == nullptr && !this->gpuCullerUnavailable) {
+            this->createGpuCuller();
+        }
+    }
+
+    void cameraEngine::setDrawCount(uint32_t count)
+    {
+        this->drawCount = count;
+
+        // prepare 전이면 createInstanceBuffer에서 배치합니다.
+        if (this->VKinstanceBuffer != nullptr) {
+            this->layoutInstances();
+        }
+    }
+
+    void cameraEngine::layoutInstances()
+    {
+        VK_TRACE_SCOPE("layoutInstances");
+
+        // 용량이 모자라면 버퍼를 다시 만듭니다. -> GPU가 이전 버퍼를 다 쓸 때까지 기다립니다.
+        if (this->drawCount > this->VKinstanceBuffer->getCapacity()) {
+            vkDeviceWaitIdle(this->VKdevice->VKdevice);
+            this->VKinstanceBuffer->reserve(this->drawCount);
+
+            if (!this->VKdescriptorSets.empty()) {
+                this->writeInstanceDescriptors();
+            }
+        }
+
+        if (this->VKgpuCuller != nullptr && this->drawCount > this->VKgpuCuller->getCapacity()) {
+            vkDeviceWaitIdle(this->VKdevice->VKdevice);
+            this->VKgpuCuller->reserve(this->drawCount);
+        }
+
+        this->VKinstanceBuffer->setCount(this->drawCount);
+        this->VKcullBounds.resize(this->drawCount);
+        if (this->VKgpuCuller != nullptr) {
+            this->VKgpuCuller->setCount(this->drawCount);
+        }
+
+        // 원점 중심의 정육면체 격자 -> 색은 격자 안의 위치 (오브젝트가 하나면 흰색이라 기존 화면과 같음)
+        const uint32_t side = std::max(1u, static_cast<uint32_t>(std::ceil(std::cbrt(static_cast<double>(this->drawCount)))));
+        const float center = static_cast<float>(side - 1) * 0.5f;
+        const float colorScale = (side > 1) ? 1.0f / static_cast<float>(side - 1) : 0.0f;
+        auto cellOf = [side](uint32_t i) {
+            return glm::vec3(
+                static_cast<float>(i % side),
+                static_cast<float>((i / side) % side),
+                static_cast<float>(i / (side * side)));
+        };
+
+        // 장면 루트 아래에 오브젝트마다 격자 위치를 로컬 변환으로 가진 노드를 만듭니다.
+        this->VKtransforms.clear();
+        this->VKtransforms.reserve(this->drawCount + 1);
+        this->sceneRoot = this->VKtransforms.createNode();
+        this->instanceNodes.resize(this->drawCount);
+        this->nodeInstances.assign(static_cast<size_t>(this->drawCount) + 1, TRANSFORM_NONE);
+        for (uint32_t i = 0; i < this->drawCount; i++)
+        {
+            const glm::vec3 position = (cellOf(i) - center) * INSTANCE_GRID_SPACING;
+            this->instanceNodes[i] = this->VKtransforms.createNode(this->sceneRoot, glm::translate(glm::mat4(1.0f), position));
+            this->nodeInstances[this->instanceNodes[i]] = i;
+        }
+
+        if (this->drawCount == 0) {
+            this->VKtransforms.update();
+            return;
+        }
+
+        InstanceData* instances = this->VKinstanceBuffer->getInstances();
+        VKCullObject* cullObjects = (this->VKgpuCuller != nullptr) ? this->VKgpuCuller->getObjects() : nullptr;
+        const uint32_t indexCount = static_cast<uint32_t>(cubeindices_.size());
+
+        this->VKjobSystem->parallelFor(this->drawCount, INSTANCE_COPY_GRAIN, [=](uint32_t begin, uint32_t end) {
+            for (uint32_t i = begin; i < end; i++)
+            {
+                instances[i].color = (side > 1) ? glm::vec4(glm::vec3(0.4f) + cellOf(i) * (0.6f * colorScale), 1.0f) : glm::vec4(1.0f);
+
+                if (cullObjects != nullptr) {
+                    cullObjects[i].indexCount = indexCount;
+                    cullObjects[i].firstIndex = 0;
+                    cullObjects[i].vertexOffset = 0;
+                    cullObjects[i].instanceIndex = i;
+                }
+            }
+        });
+
+        // 새 노드는 모두 dirty이므로 모든 오브젝트의 변환 행렬과 경계를 채웁니다.
+        this->updateTransforms();
+
+        this->VKinstanceBuffer->markDirty();
+        if (this->VKgpuCuller != nullptr) {
+            this->VKgpuCuller->markDirty();
+        }
+    }
+
+    void cameraEngine::updateTransforms()
+    {
+        // 움직인 노드가 없으면 여기서 끝납니다.
+        if (this->VKtransforms.update(this->VKjobSystem.get()) == 0) {
+            return;
+        }
+
+        VK_TRACE_SCOPE("updateTransforms");
+
+        this->changedInstances.clear();
+        for (uint32_t node : this->VKtransforms.getChanged())
+        {
+            if (this->nodeInstances[node] != TRANSFORM_NONE) {
+                this->changedInstances.push_back(this->nodeInstances[node]);
+            }
+        }
+        if (this->changedInstances.empty()) {
+            return;
+        }
+
+        const VKTransformHierarchy* transforms = &this->VKtransforms;
+        const uint32_t* changed = this->changedInstances.data();
+        const uint32_t* nodes = this->instanceNodes.data();
+        InstanceData* instances = this->VKinstanceBuffer->getInstances();
+        VKCullObject* cullObjects = (this->VKgpuCuller != nullptr) ? this->VKgpuCuller->getObjects() : nullptr;
+        VKCullBounds* cullBounds = &this->VKcullBounds;
+        const float cubeRadius = std::sqrt(3.0f) * 0.5f;
+
+        this->VKjobSystem->parallelFor(static_cast<uint32_t>(this->changedInstances.size()), INSTANCE_COPY_GRAIN, [=](uint32_t begin, uint32_t end) {
+            for (uint32_t k = begin; k < end; k++)
+            {
+                const uint32_t i = changed[k];
+                const glm::mat4& world = transforms->getWorld(nodes[i]);
+                instances[i].model = world;
+
+                // 단위 큐브의 월드 AABB와 경계 구 (ubo.model은 단위 행렬이므로 월드 공간)
+                const glm::vec3 axisX(world[0]);
+                const glm::vec3 axisY(world[1]);
+                const glm::vec3 axisZ(world[2]);
+                const glm::vec3 position(world[3]);
+                const glm::vec3 halfExtent = (glm::abs(axisX) + glm::abs(axisY) + glm::abs(axisZ)) * 0.5f;
+                const float radius = cubeRadius * std::max(glm::length(axisX), std::max(glm::length(axisY), glm::length(axisZ)));
+
+                cullBounds->set(i, position, radius, halfExtent);
+                if (cullObjects != nullptr) {
+                    cullObjects[i].sphere = glm::vec4(position, radius);
+                }
+            }
+        });
+
+        // 인스턴스 버퍼는 바뀐 오브젝트만 각 프레임 슬롯에 복사합니다.
+        this->VKinstanceBuffer->markDirty(this->changedInstances.data(), static_cast<uint32_t>(this->changedInstances.size()));
+        if (this->VKgpuCuller != nullptr) {
+            this->VKgpuCuller->markDirty();
         }
     }
 
     void cameraEngine::createDescriptorSetLayout()
     {
         // Binding 0: Uniform buffer (Vertex shader)
-        VkDescriptorSetLayoutBinding uboLayoutBinding{};
-        uboLayoutBinding.binding = 0;
-        uboLayoutBinding.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-        uboLayoutBinding.descriptorCount = 1;
-        uboLayoutBinding.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
-        uboLayoutBinding.pImmutableSamplers = nullptr;
+        // Binding 1: Instance storage buffer (Vertex shader) -> instances[gl_InstanceIndex]
+        std::array<VkDescriptorSetLayoutBinding, 2> bindings{};
+        bindings[0].binding = 0;
+        bindings[0].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+        bindings[0].descriptorCount = 1;
+        bindings[0].stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+        bindings[0].pImmutableSamplers = nullptr;
+
+        bindings[1].binding = 1;
+        bindings[1].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        bindings[1].descriptorCount = 1;
+        bindings[1].stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+        bindings[1].pImmutableSamplers = nullptr;
 
         // Create the descriptor set layout
         VkDescriptorSetLayoutCreateInfo layoutInfo{};
         layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
         layoutInfo.pNext = nullptr;
-        layoutInfo.bindingCount = 1;
-        layoutInfo.pBindings = &uboLayoutBinding;
+        layoutInfo.bindingCount = static_cast<uint32_t>(bindings.size());
+        layoutInfo.pBindings = bindings.data();
 
         VK_CHECK_RESULT(vkCreateDescriptorSetLayout(this->VKdevice->VKdevice, &layoutInfo, nullptr, &this->VKdescriptorSetLayout));
     }
@@ -406,11 +711,11 @@ namespace vkengine {
     void cameraEngine::createDescriptorPool()
     {
         //// 디스크립터 풀 크기를 설정합니다.
-        std::array<VkDescriptorPoolSize, 1> poolSizes{};
+        std::array<VkDescriptorPoolSize, 2> poolSizes{};
         poolSizes[0].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
         poolSizes[0].descriptorCount = static_cast<uint32_t>(MAX_FRAMES_IN_FLIGHT);
-        //poolSizes[1].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-        //poolSizes[1].descriptorCount = static_cast<uint32_t>(MAX_FRAMES_IN_FLIGHT);
+        poolSizes[1].type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        poolSizes[1].descriptorCount = static_cast<uint32_t>(MAX_FRAMES_IN_FLIGHT);
 
         // 디스크립터 풀 생성 정보 구조체를 초기화합니다.
         VkDescriptorPoolCreateInfo poolInfo{};
@@ -463,135 +768,34 @@ namespace vkengine {
 
             vkUpdateDescriptorSets(this->VKdevice->VKdevice, static_cast<uint32_t>(descriptorWrites.size()), descriptorWrites.data(), 0, nullptr);
         }
+
+        this->writeInstanceDescriptors();
     }
 
-    void cameraEngine::createGraphicsPipeline()
+    void cameraEngine::writeInstanceDescriptors()
     {
-        VkShaderModule baseVertshaderModule = this->VKdevice->createShaderModule(this->RootPath + "../../../../../../shader/vertTrinagle00.spv");
-        VkShaderModule baseFragShaderModule = this->VKdevice->createShaderModule(this->RootPath + "../../../../../../shader/fragTrinagle00.spv");
-
-        VkPipelineShaderStageCreateInfo vertShaderStageInfo{};
-        vertShaderStageInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
-        vertShaderStageInfo.stage = VK_SHADER_STAGE_VERTEX_BIT;
-        vertShaderStageInfo.module = baseVertshaderModule;
-        vertShaderStageInfo.pName = "main";
-
-        VkPipelineShaderStageCreateInfo fragShaderStageInfo{};
-        fragShaderStageInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
-        fragShaderStageInfo.stage = VK_SHADER_STAGE_FRAGMENT_BIT;
-        fragShaderStageInfo.module = baseFragShaderModule;
-        fragShaderStageInfo.pName = "main";
-
-        VkPipelineShaderStageCreateInfo shaderStages[] = { vertShaderStageInfo, fragShaderStageInfo };
-
-        // vertex input
-        auto bindingDescription = VertexPosColor::getBindingDescription();
-        auto attributeDescriptions = VertexPosColor::getAttributeDescriptions();
-
-        // 그래픽 파이프라인 레이아웃을 생성합니다.
-        VkPipelineVertexInputStateCreateInfo vertexInputInfo{};
-        vertexInputInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
-        vertexInputInfo.vertexBindingDescriptionCount = 1;
-        vertexInputInfo.vertexAttributeDescriptionCount = static_cast<uint32_t>(attributeDescriptions.size());
-        vertexInputInfo.pVertexBindingDescriptions = &bindingDescription;
-        vertexInputInfo.pVertexAttributeDescriptions = attributeDescriptions.data();
-
-        // 입력 데이터를 어떤 형태로 조립할 것인지 결정합니다.
-        VkPipelineInputAssemblyStateCreateInfo inputAssembly{};
-        inputAssembly.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
-        inputAssembly.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST; // 삼각형 리스트로 설정
-        inputAssembly.primitiveRestartEnable = VK_FALSE; // 프리미티브 재시작 비활성화
-
-        VkViewport viewpport{};
-        viewpport.x = 0.0f;
-        viewpport.y = 0.0f;
-        viewpport.width = (float)this->VKswapChain->getSwapChainExtent().width;
-        viewpport.height = (float)this->VKswapChain->getSwapChainExtent().height;
-        viewpport.minDepth = 0.0f;
-        viewpport.maxDepth = 1.0f;
-
-        VkRect2D scissor{};
-        scissor.offset = { 0, 0 };
-        scissor.extent = VKswapChain->getSwapChainExtent();
-
-        // 뷰포트 설정
-        VkPipelineViewportStateCreateInfo viewportState{};
-        viewportState.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
-        viewportState.viewportCount = 1;
-        viewportState.pViewports = &viewpport;
-        viewportState.scissorCount = 1;
-        viewportState.pScissors = &scissor;
-
-        // 래스터화 설정 -> 레스터화는 그래픽 파이프라인의 일부로 정점을 픽셀로 변환하는 프로세스입니다.
-        VkPipelineRasterizationStateCreateInfo rasterizer{};
-        rasterizer.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
-        rasterizer.depthClampEnable = VK_FALSE;                   // 깊이 클램핑 비활성화
-        rasterizer.rasterizerDiscardEnable = VK_FALSE;            // 래스터화 버림 비활성화
-        rasterizer.polygonMode = VK_POLYGON_MODE_FILL;            // 다각형 모드를 채우기로 설정
-        rasterizer.lineWidth = 1.0f;                              // 라인 너비를 1.0f로 설정
-        rasterizer.cullMode = VK_CULL_MODE_BACK_BIT;              // 후면 면을 제거
-        rasterizer.frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE;   // 전면 면을 반시계 방향으로 설정
-        rasterizer.depthBiasEnable = VK_FALSE;                    // 깊이 바이어스 비활성화
-        rasterizer.depthBiasConstantFactor = 0.0f;              // 깊이 바이어스 상수 요소를 0.0f로 설정
-        rasterizer.depthBiasClamp = 0.0f;                       // 깊이 바이어스 클램프를 0.0f로 설정
-        rasterizer.depthBiasSlopeFactor = 0.0f;                 // 깊이 바이어스 슬로프 요소를 0.0f로 설정
-
-        // 다중 샘플링 설정
-        VkPipelineMultisampleStateCreateInfo multisampling{};
-        multisampling.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO; //
-        multisampling.sampleShadingEnable = VK_FALSE;               // 샘플링 쉐이딩 비활성화
-        multisampling.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT; // 래스터화 샘플 수를 1비트로 설정
-        multisampling.minSampleShading = 1.0f;                      // 최소 샘플링을 1.0f로 설정 -> option
-        multisampling.pSampleMask = nullptr;                        // 샘플 마스크를 nullptr로 설정 -> option
-        multisampling.alphaToCoverageEnable = VK_FALSE;             // 알파 커버리지 비활성화 -> option
-        multisampling.alphaToOneEnable = VK_FALSE;                  // 알파 원 비활성화 -> option
-
-        // 깊이 스텐실 테스트 설정
-        VkPipelineDepthStencilStateCreateInfo depthStencil{};
-        depthStencil.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
-        depthStencil.depthTestEnable = VK_TRUE;
-        depthStencil.depthWriteEnable = VK_TRUE;
-        depthStencil.depthCompareOp = VK_COMPARE_OP_LESS;
-        depthStencil.depthBoundsTestEnable = VK_FALSE;
-        depthStencil.stencilTestEnable = VK_FALSE;
-        depthStencil.minDepthBounds = 0.0f; // Optional
-        depthStencil.maxDepthBounds = 1.0f; // Optional
-        depthStencil.stencilTestEnable = VK_FALSE;
-        depthStencil.front = {}; // Optional
-        depthStencil.back = {}; // Optional
-
-        // 컬러 블렌딩 설정
-        VkPipelineColorBlendAttachmentState colorBlendAttachment{};
-        colorBlendAttachment.colorWriteMask = VK_COLOR_COMPONENT_R_BIT |
-            VK_COLOR_COMPONENT_G_BIT |
-            VK_COLOR_COMPONENT_B_BIT |
-            VK_COLOR_COMPONENT_A_BIT;     // 컬러 쓰기 마스크를 설정
-        colorBlendAttachment.blendEnable = VK_FALSE;                        // 블렌딩을 비활성화
-        colorBlendAttachment.srcColorBlendFactor = VK_BLEND_FACTOR_ONE;     // 소스 컬러 블렌딩 팩터를 설정
-        colorBlendAttachment.dstColorBlendFactor = VK_BLEND_FACTOR_ZERO;    // 대상 컬러 블렌딩 팩터를 설정
-        colorBlendAttachment.colorBlendOp = VK_BLEND_OP_ADD;                // 컬러 블렌딩 연산을 설정
-        colorBlendAttachment.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE;     // 소스 알파 블렌딩 팩터를 설정
-        colorBlendAttachment.dstAlphaBlendFactor = VK_BLEND_FACTOR_ZERO;    // 대상 알파 블렌딩 팩터를 설정
-        colorBlendAttachment.alphaBlendOp = VK_BLEND_OP_ADD;                // 알파 블렌딩 연산을 설정
-
-        // 컬러 블렌딩 상태 생성 정보 구조체를 초기화합니다.
-        VkPipelineColorBlendStateCreateInfo colorBlending{};
-        colorBlending.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO; // 구조체 타입을 설정
-        colorBlending.logicOpEnable = VK_FALSE;                                       // 논리 연산을 비활성화
-        colorBlending.logicOp = VK_LOGIC_OP_COPY;                                     // 논리 연산을 설정
-        colorBlending.attachmentCount = 1;                                            // 컬러 블렌딩 첨부 개수를 설정
-        colorBlending.pAttachments = &colorBlendAttachment;                           // 컬러 블렌딩 첨부 포인터를 설정
-        colorBlending.blendConstants[0] = 0.0f;                                       // 블렌딩 상수를 설정
-        colorBlending.blendConstants[1] = 0.0f;                                       // 블렌딩 상수를 설정
-        colorBlending.blendConstants[2] = 0.0f;                                       // 블렌딩 상수를 설정
-        colorBlending.blendConstants[3] = 0.0f;                                       // 블렌딩 상수를 설정
-
-        // 다이나믹 상태 설정 -> 레스터화 상태를 동적으로 변경할 수 있습니다.
-        VkPipelineDynamicStateCreateInfo dynamicState{};
-        dynamicState.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
-        dynamicState.dynamicStateCount = static_cast<uint32_t>(dynamicStates.size());
-        dynamicState.pDynamicStates = dynamicStates.data();
+        // 프레임 슬롯마다 자기 인스턴스 버퍼를 가리킵니다. (버퍼를 다시 만들면 다시 씀)
+        for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
+            VkDescriptorBufferInfo bufferInfo{};
+            bufferInfo.buffer = this->VKinstanceBuffer->getBuffer(static_cast<uint32_t>(i));
+            bufferInfo.offset = 0;
+            bufferInfo.range = VK_WHOLE_SIZE;
+
+            VkWriteDescriptorSet descriptorWrite{};
+            descriptorWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+            descriptorWrite.dstSet = this->VKdescriptorSets[i];
+            descriptorWrite.dstBinding = 1;
+            descriptorWrite.dstArrayElement = 0;
+            descriptorWrite.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+            descriptorWrite.descriptorCount = 1;
+            descriptorWrite.pBufferInfo = &bufferInfo;
+
+            vkUpdateDescriptorSets(this->VKdevice->VKdevice, 1, &descriptorWrite, 0, nullptr);
+        }
+    }
 
+    void cameraEngine::createGraphicsPipeline()
+    {
         // 그래픽 파이프라인 레이아웃을 생성합니다.
         VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
         pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO; // 구조체 타입을 설정
@@ -602,39 +806,33 @@ namespace vkengine {
 
         VK_CHECK_RESULT(vkCreatePipelineLayout(this->VKdevice->VKdevice, &pipelineLayoutInfo, nullptr, &this->VKpipelineLayout));
 
-        // 그래픽 파이프라인 생성 정보 구조체를 초기화합니다.
-        VkGraphicsPipelineCreateInfo pipelineInfo{};
-        pipelineInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
-        pipelineInfo.stageCount = 2;
-        pipelineInfo.pStages = shaderStages;
-        pipelineInfo.pVertexInputState = &vertexInputInfo;
-        pipelineInfo.pInputAssemblyState = &inputAssembly;
-        pipelineInfo.pViewportState = &viewportState;
-        pipelineInfo.pRasterizationState = &rasterizer;
-        pipelineInfo.pMultisampleState = &multisampling;
-        pipelineInfo.pDepthStencilState = &depthStencil; // Optional
-        pipelineInfo.pColorBlendState = &colorBlending;
-        pipelineInfo.pDynamicState = &dynamicState; // Optional
-        pipelineInfo.layout = this->VKpipelineLayout;
-        pipelineInfo.renderPass = *this->VKrenderPass.get();
-        pipelineInfo.subpass = 0;
-        pipelineInfo.basePipelineHandle = VK_NULL_HANDLE; // Optional
-        pipelineInfo.basePipelineIndex = -1; // Optional
-
-        VK_CHECK_RESULT(vkCreateGraphicsPipelines(this->VKdevice->VKdevice, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &this->VKgraphicsPipeline));
-
-        vkDestroyShaderModule(this->VKdevice->VKdevice, baseVertshaderModule, nullptr);
-        vkDestroyShaderModule(this->VKdevice->VKdevice, baseFragShaderModule, nullptr);
+        // 파이프라인 상태를 요약해서 관리자에 요청합니다. -> 컴파일은 백그라운드 스레드에서 진행됩니다.
+        VKGraphicsPipelineDesc desc{};
+        desc.vertexShader = this->VKpipelineManager->loadShaderModule(this->RootPath + "../../../../../../shader/vertInstanced.spv");
+        desc.fragmentShader = this->VKpipelineManager->loadShaderModule(this->RootPath + "../../../../../../shader/fragTrinagle00.spv");
+        desc.setVertexInput<VertexPosColor>();
+        desc.cullMode = VK_CULL_MODE_BACK_BIT;                    // 후면 면을 제거
+        desc.frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE;         // 전면 면을 반시계 방향으로 설정
+        desc.samples = VK_SAMPLE_COUNT_1_BIT;
+        desc.depthCompareOp = VK_COMPARE_OP_LESS;
+        desc.layout = this->VKpipelineLayout;
+        desc.renderPass = *this->VKrenderPass.get();
+        desc.subpass = 0;
+
+        this->VKgraphicsPipeline = this->VKpipelineManager->request(desc);
     }
 
     void cameraEngine::updateUniformBuffer(uint32_t currentImage)
     {
+        VK_TRACE_SCOPE("updateUniformBuffer");
+
         static auto startTime = std::chrono::high_resolution_clock::now();
         auto currentTime = std::chrono::high_resolution_clock::now();
         float time = std::chrono::duration<float, std::chrono::seconds::period>(currentTime - startTime).count();
 
         UniformBufferObject ubo{};
 
+        // 오브젝트 변환은 변환 계층이 인스턴스 버퍼로 올리므로 ubo.model은 단위 행렬입니다. (장면 전체는 getSceneRoot 노드로 움직임)
         //ubo.model = glm::rotate(glm::mat4(1.0f), time * glm::radians(90.0f), glm::vec3(0.0f, -1.0f, 0.0f));
         ubo.model = glm::mat4(1.0f);
         ubo.view = this->camera->getViewMatrix();
@@ -645,7 +843,7 @@ namespace vkengine {
 
     void cameraEngine::cleanupSwapcChain()
     {
-        this->VKdepthStencill.cleanup(this->VKdevice->VKdevice);
+        this->VKdepthStencill.cleanup(this->VKdevice->VKdevice, this->VKdevice->VKallocator.get());
 
         for (auto framebuffers : this->VKswapChainFramebuffers)
         {
@@ -3,6 +3,10 @@
 
 #include "../source/engine/VKengine.h"
 #include "../source/engine/VKimgui.h"
+#include "../source/engine/VKinstanceBuffer.h"
+#include "../source/engine/VKgpuCulling.h"
+#include "../source/engine/VKcpuCulling.h"
+#include "../source/engine/VKtransform.h"
 
 namespace vkengine
 {
@@ -10,6 +14,8 @@ namespace vkengine
         class vkGUI;
     }
 
+    constexpr float INSTANCE_GRID_SPACING = 1.5f;                  // 오브젝트 격자 간격 (큐브 한 변 = 1)
+
     class cameraEngine : public VulkanEngine
     {
     public:
@@ -22,6 +28,30 @@ namespace vkengine
         virtual void drawFrame() override;
         virtual bool mainLoop() override;
         void update(float dt);
+
+        // 오브젝트 수 (벤치마크의 오브젝트 수) -> 원점 중심의 정육면체 격자에 놓고 인스턴스 버퍼를 다시 채웁니다.
+        void setDrawCount(uint32_t count);
+        uint32_t getDrawCount() const { return this->drawCount; }
+
+        // true면 모든 오브젝트를 vkCmdDrawIndexed 한 번으로 그리고, false면 오브젝트마다 draw를 기록합니다. (firstInstance로 같은 셰이더 사용)
+        void setInstancing(bool enabled) { this->instancing = enabled; }
+        bool isInstancing() const { return this->instancing; }
+
+        // true면 컴퓨트 셰이더가 카메라 절두체로 오브젝트를 컬링하고 vkCmdDrawIndexedIndirectCountKHR로 그립니다. (instancing보다 우선)
+        // 처음 켤 때 컴퓨트 셰이더를 읽어 컬러를 만들고, 디바이스가 지원하지 않거나 (VKGpuCuller::isSupported) 셰이더가 없으면 기존 경로로 그립니다.
+        void setGpuCulling(bool enabled);
+        bool isGpuCulling() const { return this->gpuCulling && this->VKgpuCuller != nullptr; }
+        VKGpuCuller* getGpuCuller() const { return this->VKgpuCuller.get(); }
+
+        // true면 오브젝트마다 draw를 기록할 때 CPU에서 절두체 컬링(SIMD + 잡 시스템)을 하고 보이는 오브젝트만 기록합니다.
+        void setCpuCulling(bool enabled) { this->cpuCulling = enabled; }
+        bool isCpuCulling() const { return this->cpuCulling; }
+
+        // 오브젝트 변환 계층 -> 장면 루트 아래에 오브젝트마다 노드가 하나씩 있습니다. (setDrawCount가 다시 만듦)
+        // setLocal로 노드를 옮기면 다음 프레임에 월드 변환이 바뀐 오브젝트만 인스턴스 버퍼와 컬링 경계에 반영합니다.
+        VKTransformHierarchy& getTransforms() { return this->VKtransforms; }
+        uint32_t getSceneRoot() const { return this->sceneRoot; }
+        uint32_t getInstanceTransform(uint32_t instance) const { return this->instanceNodes[instance]; }
     
     protected:
         virtual bool init_sync_structures() override;
@@ -32,11 +62,16 @@ namespace vkengine
         void createVertexbuffer();
         void createIndexBuffer();
         void createUniformBuffers();
+        void createInstanceBuffer();
+        void createGpuCuller();
+        void layoutInstances();
+        void updateTransforms();
 
         // Descriptor의 set, pool, layout을 생성하기 위한 함수들
         void createDescriptorSetLayout();
         void createDescriptorPool();
         void createDescriptorSets();
+        void writeInstanceDescriptors();
 
         // grapics pipeline을 생성하기 위한 함수
         void createGraphicsPipeline();
@@ -47,10 +82,24 @@ namespace vkengine
 
         VertexBuffer VKvertexBuffer{};
         std::vector<UniformBuffer> VKuniformBuffer = {};
+        std::unique_ptr<VKInstanceBuffer> VKinstanceBuffer{};               // 오브젝트별 변환 행렬과 색 (바인딩 1, 프레임 슬롯별 버퍼)
+        std::unique_ptr<VKGpuCuller> VKgpuCuller{};                         // 오브젝트별 경계 구 -> 보이는 것만 간접 draw (지원하지 않으면 nullptr)
+        VKCullBounds VKcullBounds;                                          // CPU 컬링용 오브젝트 AABB (SoA)
+        std::vector<uint32_t> visibleObjects;                               // 이번 프레임에 CPU 컬링을 통과한 오브젝트
+        VKTransformHierarchy VKtransforms;                                  // 장면 루트 + 오브젝트별 노드
+        std::vector<uint32_t> instanceNodes;                                // 오브젝트 -> 변환 노드
+        std::vector<uint32_t> nodeInstances;                                // 변환 노드 -> 오브젝트 (없으면 TRANSFORM_NONE)
+        std::vector<uint32_t> changedInstances;                             // 이번 프레임에 월드 변환이 바뀐 오브젝트
+        uint32_t sceneRoot = TRANSFORM_NONE;
         gui::vkGUI* gui = nullptr;
 
-        VkPipeline VKgraphicsPipeline = VK_NULL_HANDLE;                      // 그래픽스 파이프라인 -> 그래픽스 파이프라인을 생성
+        VKPipelineHandle VKgraphicsPipeline;                                 // 그래픽스 파이프라인 -> 파이프라인 관리자가 컴파일하고 소유
         VkPipelineLayout VKpipelineLayout{ VK_NULL_HANDLE };
+        uint32_t drawCount = 1;
+        bool instancing = true;
+        bool gpuCulling = false;
+        bool gpuCullerUnavailable = false;                                  // 지원하지 않거나 셰이더가 없어 컬러를 만들지 못함
+        bool cpuCulling = false;
     };
 }
 
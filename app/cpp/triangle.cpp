@@ -2,6 +2,7 @@
 #include "../source/engine/helper.h"
 #include "../source/engine/Camera.h"
 #include "../source/engine/Debug.h"
+#include "../source/engine/VKtrace.h"
 #include "../source/struct.h"
 
 using namespace vkengine::helper;
@@ -25,15 +26,25 @@ namespace vkengine {
         VulkanEngine::prepare();
         this->init_sync_structures();
 
+        //   ûؼ  ε  ġ մϴ.
+        this->createDescriptorSetLayout();
+        this->createGraphicsPipeline();
+
         this->createVertexbuffer();
         this->createIndexBuffer();
+        this->VKdevice->VKstagingRing->flush();
         this->createUniformBuffers();
 
-        this->createDescriptorSetLayout();
         this->createDescriptorPool();
         this->createDescriptorSets();
 
-        this->createGraphicsPipeline();
+        // ĳ       ð
+        this->VKpipelineManager->waitIdle();
+        this->VKpipelineCache.report();
+
+#if SHADER_HOT_RELOAD
+        this->VKpipelineManager->watchShaders();
+#endif
 
         return true;
     }
@@ -44,21 +55,19 @@ namespace vkengine {
         {
             this->cleanupSwapcChain();
             
-            vkDestroyPipeline(this->VKdevice->VKdevice, this->VKgraphicsPipeline, nullptr);
             vkDestroyPipelineLayout(this->VKdevice->VKdevice, this->VKpipelineLayout, nullptr);
             vkDestroyRenderPass(this->VKdevice->VKdevice, *this->VKrenderPass.get(), nullptr);
 
             // ߰ κ
             for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++)
             {
-                vkDestroyBuffer(this->VKdevice->VKdevice, this->VKuniformBuffer[i].buffer, nullptr);
-                vkFreeMemory(this->VKdevice->VKdevice, this->VKuniformBuffer[i].memory, nullptr);
+                this->VKuniformBuffer[i].cleanup(this->VKdevice->VKallocator.get());
             }
 
             vkDestroyDescriptorPool(this->VKdevice->VKdevice, this->VKdescriptorPool, nullptr);
             vkDestroyDescriptorSetLayout(this->VKdevice->VKdevice, this->VKdescriptorSetLayout, nullptr);
 
-            this->VKvertexBuffer.cleanup(this->VKdevice->VKdevice);
+            this->VKvertexBuffer.cleanup(this->VKdevice->VKallocator.get());
 
             for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++)
             {
@@ -67,7 +76,15 @@ namespace vkengine {
                 vkDestroyFence(this->VKdevice->VKdevice, this->VKframeData[i].VkinFlightFences, nullptr);
             }
 
-            vkDestroyPipelineCache(this->VKdevice->VKdevice, this->VKpipelineCache, nullptr);
+            this->VKgpuProfiler.cleanup();
+
+            //  带 ߰   ,  ĳø Ϸ ϰ մϴ.
+            this->VKpipelineManager->cleanup();
+            this->VKpipelineCache.cleanup();
+
+            // 庰 Ŀǵ Ǯ ϰ  ý Ŀ 带 ϴ.
+            this->VKcommandRecorder->cleanup();
+            this->VKjobSystem->cleanup();
 
             this->VKdevice->cleanup();
 
@@ -75,20 +92,29 @@ namespace vkengine {
                 DestroyDebugUtilsMessengerEXT(this->VKinstance, this->VKdebugUtilsMessenger, nullptr);
             }
 
-            vkDestroySurfaceKHR(this->VKinstance, this->VKsurface, nullptr);
+            if (this->VKsurface != VK_NULL_HANDLE) {
+                vkDestroySurfaceKHR(this->VKinstance, this->VKsurface, nullptr);
+            }
             vkDestroyInstance(this->VKinstance, nullptr);
 
-            glfwDestroyWindow(this->VKwindow);
-            glfwTerminate();
+            if (!this->headless) {
+                glfwDestroyWindow(this->VKwindow);
+                glfwTerminate();
+            }
         }
 
     }
 
     void triangle::drawFrame()
     {
+        VK_TRACE_SCOPE("drawFrame");
+
         //  ϱ    غ Ǿ Ȯմϴ.
         VK_CHECK_RESULT(vkWaitForFences(this->VKdevice->VKdevice, 1, &this->getCurrnetFrameData().VkinFlightFences, VK_TRUE, UINT64_MAX));
 
+        // ٲ ̴   ٽ ϰ, ü  մϴ.
+        this->VKpipelineManager->update();
+
         // ̹    üο ̹ ε ɴϴ.
         // ־ üο  ̹ ȹϰ, 
         //   潺 Ͽ ȭ ϴ Vulkan API ԼԴϴ.
@@ -112,9 +138,11 @@ namespace vkengine {
         VKsubmitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
 
         //  ϱ   մϴ.
+        // 帮   ü ̹ ٸų Ʈ ˸ ʿ䰡 Ƿ   ʽϴ.
+        const uint32_t semaphoreCount = this->headless ? 0 : 1;
         VkSemaphore waitSemaphores[] = { this->VKframeData[this->currentFrame].VkimageavailableSemaphore };
         VkPipelineStageFlags waitStages[] = { VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT };
-        VKsubmitInfo.waitSemaphoreCount = 1;
+        VKsubmitInfo.waitSemaphoreCount = semaphoreCount;
         VKsubmitInfo.pWaitSemaphores = waitSemaphores;
         VKsubmitInfo.pWaitDstStageMask = waitStages;
 
@@ -124,12 +152,15 @@ namespace vkengine {
 
         //  ϱ   մϴ.
         VkSemaphore signalSemaphores[] = { this->VKframeData[this->currentFrame].VkrenderFinishedSemaphore };
-        VKsubmitInfo.signalSemaphoreCount = 1;
+        VKsubmitInfo.signalSemaphoreCount = semaphoreCount;
         VKsubmitInfo.pSignalSemaphores = signalSemaphores;
 
         // ÷׸ 缳մϴ. ->   ÷׸ 缳մϴ.
         vkResetFences(this->VKdevice->VKdevice, 1, &this->VKframeData[this->currentFrame].VkinFlightFences); 
         
+        // ̹ ӿ  ε带    ť մϴ. (ϵ   ƹ͵  )
+        this->VKdevice->VKstagingRing->flush();
+
         //  մϴ.
         VK_CHECK_RESULT(vkQueueSubmit(this->VKdevice->graphicsVKQueue, 1, &VKsubmitInfo, this->VKframeData[this->currentFrame].VkinFlightFences));
         
@@ -175,11 +206,15 @@ namespace vkengine {
         renderPassInfo.clearValueCount = static_cast<uint32_t>(clearValues.size());;
         renderPassInfo.pClearValues = clearValues.data();
 
+        //    ̸ ȭ鸸  ׸ ʽϴ.
+        const VkPipeline pipeline = this->VKgraphicsPipeline.get();
+
         //  н մϴ.
         vkCmdBeginRenderPass(framedata->mainCommandBuffer, &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
+        if (pipeline != VK_NULL_HANDLE)
         {
             // ׷  εմϴ.
-            vkCmdBindPipeline(framedata->mainCommandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, this->VKgraphicsPipeline);
+            vkCmdBindPipeline(framedata->mainCommandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline);
 
             VkViewport viewport{};
             viewport.x = 0.0f;
@@ -219,85 +254,31 @@ namespace vkengine {
     {
         VkDeviceSize buffersize = sizeof(testVectex_[0]) * testVectex_.size();
 
-        VkBuffer stagingBuffer;
-        VkDeviceMemory stagingBufferMemory;
-
-        helper::createBuffer(
-            this->VKdevice->VKdevice,
-            this->VKdevice->VKphysicalDevice,
-            buffersize,
-            VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-            stagingBuffer,
-            stagingBufferMemory);
-
-        void* data;
-        vkMapMemory(this->VKdevice->VKdevice, stagingBufferMemory, 0, buffersize, 0, &data);
-            memcpy(data, testVectex_.data(), (size_t)buffersize);
-        vkUnmapMemory(this->VKdevice->VKdevice, stagingBufferMemory);
-
         helper::createBuffer(
-            this->VKdevice->VKdevice,
-            this->VKdevice->VKphysicalDevice,
+            this->VKdevice->VKallocator.get(),
             buffersize,
             VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
             VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
             this->VKvertexBuffer.vertexBuffer,
             this->VKvertexBuffer.vertexMemory);
 
-        helper::copyBuffer(
-            this->VKdevice->VKdevice,
-            this->VKdevice->VKcommandPool,
-            this->VKdevice->graphicsVKQueue,
-            stagingBuffer,
-            this->VKvertexBuffer.vertexBuffer,
-            buffersize);
-
-        //    ¡ ۸ մϴ.
-        vkDestroyBuffer(this->VKdevice->VKdevice, stagingBuffer, nullptr);
-        vkFreeMemory(this->VKdevice->VKdevice, stagingBufferMemory, nullptr);
+        // ¡   ɸ մϴ. ->  flush()   ̷ϴ.
+        this->VKdevice->VKstagingRing->uploadBuffer(this->VKvertexBuffer.vertexBuffer, testVectex_.data(), buffersize);
     }
 
     void triangle::createIndexBuffer()
     {
         VkDeviceSize buffersize = sizeof(testindices_[0]) * testindices_.size();
-        VkBuffer stagingBuffer;
-        VkDeviceMemory stagingBufferMemory;
-        
         helper::createBuffer(
-            this->VKdevice->VKdevice,
-            this->VKdevice->VKphysicalDevice,
-            buffersize,
-            VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-            stagingBuffer,
-            stagingBufferMemory);
-        
-        void* data;
-        vkMapMemory(this->VKdevice->VKdevice, stagingBufferMemory, 0, buffersize, 0, &data);
-        memcpy(data, testindices_.data(), (size_t)buffersize);
-        vkUnmapMemory(this->VKdevice->VKdevice, stagingBufferMemory);
-        
-        helper::createBuffer(
-            this->VKdevice->VKdevice,
-            this->VKdevice->VKphysicalDevice,
+            this->VKdevice->VKallocator.get(),
             buffersize,
             VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT,
             VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
             this->VKvertexBuffer.indexBuffer,
             this->VKvertexBuffer .indexmemory);
         
-        helper::copyBuffer(
-            this->VKdevice->VKdevice,
-            this->VKdevice->VKcommandPool,
-            this->VKdevice->graphicsVKQueue,
-            stagingBuffer,
-            this->VKvertexBuffer.indexBuffer,
-            buffersize);
-        
-        //    ¡ ۸ մϴ.
-        vkDestroyBuffer(this->VKdevice->VKdevice, stagingBuffer, nullptr);
-        vkFreeMemory(this->VKdevice->VKdevice, stagingBufferMemory, nullptr);
+        // ¡   ɸ մϴ. ->  flush()   ̷ϴ.
+        this->VKdevice->VKstagingRing->uploadBuffer(this->VKvertexBuffer.indexBuffer, testindices_.data(), buffersize);
     }
 
     void triangle::createUniformBuffers()
@@ -309,15 +290,14 @@ namespace vkengine {
         for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++)
         {
             helper::createBuffer(
-                this->VKdevice->VKdevice,
-                this->VKdevice->VKphysicalDevice,
+                this->VKdevice->VKallocator.get(),
                 bufferSize,
                 VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
                 VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
                 this->VKuniformBuffer[i].buffer,
                 this->VKuniformBuffer[i].memory);
 
-            vkMapMemory(this->VKdevice->VKdevice, this->VKuniformBuffer[i].memory, 0, bufferSize, 0, &this->VKuniformBuffer[i].Mapped);
+            this->VKuniformBuffer[i].Mapped = this->VKuniformBuffer[i].memory.mapped;
         }
     }
 
@@ -405,131 +385,6 @@ namespace vkengine {
 
     void triangle::createGraphicsPipeline()
     {
-        VkShaderModule baseVertshaderModule = this->VKdevice->createShaderModule(this->RootPath + "../../../../../../shader/vertTrinagle00.spv");
-        VkShaderModule baseFragShaderModule = this->VKdevice->createShaderModule(this->RootPath + "../../../../../../shader/fragTrinagle00.spv");
-
-        VkPipelineShaderStageCreateInfo vertShaderStageInfo{};
-        vertShaderStageInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
-        vertShaderStageInfo.stage = VK_SHADER_STAGE_VERTEX_BIT;
-        vertShaderStageInfo.module = baseVertshaderModule;
-        vertShaderStageInfo.pName = "main";
-
-        VkPipelineShaderStageCreateInfo fragShaderStageInfo{};
-        fragShaderStageInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
-        fragShaderStageInfo.stage = VK_SHADER_STAGE_FRAGMENT_BIT;
-        fragShaderStageInfo.module = baseFragShaderModule;
-        fragShaderStageInfo.pName = "main";
-
-        VkPipelineShaderStageCreateInfo shaderStages[] = { vertShaderStageInfo, fragShaderStageInfo };
-
-        // vertex input
-        auto bindingDescription = VertexPosColor::getBindingDescription();
-        auto attributeDescriptions = VertexPosColor::getAttributeDescriptions();
-
-        // ׷  ̾ƿ մϴ.
-        VkPipelineVertexInputStateCreateInfo vertexInputInfo{};
-        vertexInputInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
-        vertexInputInfo.vertexBindingDescriptionCount = 1;
-        vertexInputInfo.vertexAttributeDescriptionCount = static_cast<uint32_t>(attributeDescriptions.size());
-        vertexInputInfo.pVertexBindingDescriptions = &bindingDescription;
-        vertexInputInfo.pVertexAttributeDescriptions = attributeDescriptions.data();
-
-        // Է ͸  ·   մϴ.
-        VkPipelineInputAssemblyStateCreateInfo inputAssembly{};
-        inputAssembly.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
-        inputAssembly.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST; // ﰢ Ʈ 
-        inputAssembly.primitiveRestartEnable = VK_FALSE; // Ƽ  Ȱȭ
-
-        VkViewport viewpport{};
-        viewpport.x = 0.0f;
-        viewpport.y = 0.0f;
-        viewpport.width = (float)this->VKswapChain->getSwapChainExtent().width;
-        viewpport.height = (float)this->VKswapChain->getSwapChainExtent().height;
-        viewpport.minDepth = 0.0f;
-        viewpport.maxDepth = 1.0f;
-
-        VkRect2D scissor{};
-        scissor.offset = { 0, 0 };
-        scissor.extent = VKswapChain->getSwapChainExtent();
-
-        // Ʈ 
-        VkPipelineViewportStateCreateInfo viewportState{};
-        viewportState.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
-        viewportState.viewportCount = 1;
-        viewportState.pViewports = &viewpport;
-        viewportState.scissorCount = 1;
-        viewportState.pScissors = &scissor;
-
-        // ȭ  -> ȭ ׷  Ϻη  ȼ ȯϴ μԴϴ.
-        VkPipelineRasterizationStateCreateInfo rasterizer{};
-        rasterizer.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
-        rasterizer.depthClampEnable = VK_FALSE;                   //  Ŭ Ȱȭ
-        rasterizer.rasterizerDiscardEnable = VK_FALSE;            // ȭ  Ȱȭ
-        rasterizer.polygonMode = VK_POLYGON_MODE_FILL;            // ٰ 带 ä 
-        rasterizer.lineWidth = 1.0f;                              //  ʺ 1.0f 
-        rasterizer.cullMode = VK_CULL_MODE_BACK_BIT;              // ĸ  
-        rasterizer.frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE;   //   ݽð  
-        rasterizer.depthBiasEnable = VK_FALSE;                    //  ̾ Ȱȭ
-        rasterizer.depthBiasConstantFactor = 0.0f;              //  ̾  Ҹ 0.0f 
-        rasterizer.depthBiasClamp = 0.0f;                       //  ̾ Ŭ 0.0f 
-        rasterizer.depthBiasSlopeFactor = 0.0f;                 //  ̾  Ҹ 0.0f 
-
-        //  ø 
-        VkPipelineMultisampleStateCreateInfo multisampling{};
-        multisampling.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO; //
-        multisampling.sampleShadingEnable = VK_FALSE;               // ø ̵ Ȱȭ
-        multisampling.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT; // ȭ   1Ʈ 
-        multisampling.minSampleShading = 1.0f;                      // ּ ø 1.0f  -> option
-        multisampling.pSampleMask = nullptr;                        //  ũ nullptr  -> option
-        multisampling.alphaToCoverageEnable = VK_FALSE;             //  Ŀ Ȱȭ -> option
-        multisampling.alphaToOneEnable = VK_FALSE;                  //   Ȱȭ -> option
-
-        //  ٽ ׽Ʈ 
-        VkPipelineDepthStencilStateCreateInfo depthStencil{};
-        depthStencil.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
-        depthStencil.depthTestEnable = VK_TRUE;
-        depthStencil.depthWriteEnable = VK_TRUE;
-        depthStencil.depthCompareOp = VK_COMPARE_OP_LESS;
-        depthStencil.depthBoundsTestEnable = VK_FALSE;
-        depthStencil.stencilTestEnable = VK_FALSE;
-        depthStencil.minDepthBounds = 0.0f; // Optional
-        depthStencil.maxDepthBounds = 1.0f; // Optional
-        depthStencil.stencilTestEnable = VK_FALSE;
-        depthStencil.front = {}; // Optional
-        depthStencil.back = {}; // Optional
-
-        // ÷  
-        VkPipelineColorBlendAttachmentState colorBlendAttachment{};
-        colorBlendAttachment.colorWriteMask = VK_COLOR_COMPONENT_R_BIT |
-            VK_COLOR_COMPONENT_G_BIT |
-            VK_COLOR_COMPONENT_B_BIT |
-            VK_COLOR_COMPONENT_A_BIT;     // ÷  ũ 
-        colorBlendAttachment.blendEnable = VK_FALSE;                        //  Ȱȭ
-        colorBlendAttachment.srcColorBlendFactor = VK_BLEND_FACTOR_ONE;     // ҽ ÷  ͸ 
-        colorBlendAttachment.dstColorBlendFactor = VK_BLEND_FACTOR_ZERO;    //  ÷  ͸ 
-        colorBlendAttachment.colorBlendOp = VK_BLEND_OP_ADD;                // ÷   
-        colorBlendAttachment.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE;     // ҽ   ͸ 
-        colorBlendAttachment.dstAlphaBlendFactor = VK_BLEND_FACTOR_ZERO;    //    ͸ 
-        colorBlendAttachment.alphaBlendOp = VK_BLEND_OP_ADD;                //    
-
-        // ÷     ü ʱȭմϴ.
-        VkPipelineColorBlendStateCreateInfo colorBlending{};
-        colorBlending.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO; // ü Ÿ 
-        colorBlending.logicOpEnable = VK_FALSE;                                       //   Ȱȭ
-        colorBlending.logicOp = VK_LOGIC_OP_COPY;                                     //   
-        colorBlending.attachmentCount = 1;                                            // ÷  ÷  
-        colorBlending.pAttachments = &colorBlendAttachment;                           // ÷  ÷ ͸ 
-        colorBlending.blendConstants[0] = 0.0f;                                       //   
-        colorBlending.blendConstants[1] = 0.0f;                                       //   
-        colorBlending.blendConstants[2] = 0.0f;                                       //   
-        colorBlending.blendConstants[3] = 0.0f;                                       //   
-
-        //   ¸ մϴ.
-        VkPipelineDynamicStateCreateInfo dynamicState{};
-        dynamicState.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
-        dynamicState.dynamicStateCount = static_cast<uint32_t>(dynamicStates.size());
-        dynamicState.pDynamicStates = dynamicStates.data();
-
         // ׷  ̾ƿ մϴ.
         VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
         pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO; // ü Ÿ 
@@ -540,33 +395,26 @@ namespace vkengine {
 
         VK_CHECK_RESULT(vkCreatePipelineLayout(this->VKdevice->VKdevice, &pipelineLayoutInfo, nullptr, &this->VKpipelineLayout));
 
-        // ׷    ü ʱȭմϴ.
-        VkGraphicsPipelineCreateInfo pipelineInfo{};
-        pipelineInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
-        pipelineInfo.stageCount = 2;
-        pipelineInfo.pStages = shaderStages;
-        pipelineInfo.pVertexInputState = &vertexInputInfo;
-        pipelineInfo.pInputAssemblyState = &inputAssembly;
-        pipelineInfo.pViewportState = &viewportState;
-        pipelineInfo.pRasterizationState = &rasterizer;
-        pipelineInfo.pMultisampleState = &multisampling;
-        pipelineInfo.pDepthStencilState = &depthStencil; // Optional
-        pipelineInfo.pColorBlendState = &colorBlending;
-        pipelineInfo.pDynamicState = &dynamicState; // Optional
-        pipelineInfo.layout = this->VKpipelineLayout;
-        pipelineInfo.renderPass = *this->VKrenderPass.get();
-        pipelineInfo.subpass = 0;
-        pipelineInfo.basePipelineHandle = VK_NULL_HANDLE; // Optional
-        pipelineInfo.basePipelineIndex = -1; // Optional
-
-        VK_CHECK_RESULT(vkCreateGraphicsPipelines(this->VKdevice->VKdevice, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &this->VKgraphicsPipeline));
-
-        vkDestroyShaderModule(this->VKdevice->VKdevice, baseVertshaderModule, nullptr);
-        vkDestroyShaderModule(this->VKdevice->VKdevice, baseFragShaderModule, nullptr);
+        //  ¸ ؼ ڿ ûմϴ. ->  ׶ 忡 ˴ϴ.
+        VKGraphicsPipelineDesc desc{};
+        desc.vertexShader = this->VKpipelineManager->loadShaderModule(this->RootPath + "../../../../../../shader/vertTrinagle00.spv");
+        desc.fragmentShader = this->VKpipelineManager->loadShaderModule(this->RootPath + "../../../../../../shader/fragTrinagle00.spv");
+        desc.setVertexInput<VertexPosColor>();
+        desc.cullMode = VK_CULL_MODE_BACK_BIT;                    // ĸ  
+        desc.frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE;         //   ݽð  
+        desc.samples = VK_SAMPLE_COUNT_1_BIT;
+        desc.depthCompareOp = VK_COMPARE_OP_LESS;
+        desc.layout = this->VKpipelineLayout;
+        desc.renderPass = *this->VKrenderPass.get();
+        desc.subpass = 0;
+
+        this->VKgraphicsPipeline = this->VKpipelineManager->request(desc);
     }
 
     void triangle::updateUniformBuffer(uint32_t currentImage)
     {
+        VK_TRACE_SCOPE("updateUniformBuffer");
+
         static auto startTime = std::chrono::high_resolution_clock::now();
         auto currentTime = std::chrono::high_resolution_clock::now();
         float time = std::chrono::duration<float, std::chrono::seconds::period>(currentTime - startTime).count();
@@ -584,7 +432,7 @@ namespace vkengine {
 
     void triangle::cleanupSwapcChain()
     {
-        this->VKdepthStencill.cleanup(this->VKdevice->VKdevice);
+        this->VKdepthStencill.cleanup(this->VKdevice->VKdevice, this->VKdevice->VKallocator.get());
 
         for (auto framebuffers : this->VKswapChainFramebuffers)
         {
@@ -49,7 +49,7 @@ namespace vkengine
         VertexBuffer VKvertexBuffer{};
         std::vector<UniformBuffer> VKuniformBuffer = {};
 
-        VkPipeline VKgraphicsPipeline = VK_NULL_HANDLE;                      // 그래픽스 파이프라인 -> 그래픽스 파이프라인을 생성
+        VKPipelineHandle VKgraphicsPipeline;                                 // 그래픽스 파이프라인 -> 파이프라인 관리자가 컴파일하고 소유
         VkPipelineLayout VKpipelineLayout{ VK_NULL_HANDLE };
 
     };
@@ -1,10 +1,35 @@
 #include "_common.h"
 #include "struct.h"
+#include "engine/VKallocator.h"
+
+#include <mutex>
 
 namespace vkutil {
 
     namespace helper_
     {
+        namespace {
+            // ܹ߼  ϳ  ɹۿ fence
+            struct SingleTimeSlot {
+                VkCommandBuffer commandBuffer{ VK_NULL_HANDLE };
+                VkFence fence{ VK_NULL_HANDLE };
+            };
+
+            // Ŀǵ Ǯ     ξٰ  begin  ϴ.
+            // -> ε帶 vkAllocateCommandBuffers/vkCreateFence ȣ ʽϴ.
+            struct SingleTimeCache {
+                std::mutex mutex;
+                std::unordered_map<VkCommandPool, std::vector<SingleTimeSlot>> freeSlots;
+                std::unordered_map<VkCommandBuffer, SingleTimeSlot> activeSlots;    // begin ~ end  
+            };
+
+            SingleTimeCache& getSingleTimeCache()
+            {
+                static SingleTimeCache cache;
+                return cache;
+            }
+        }
+
         std::vector<char> readFile(const std::string& filename) {
 
             //   ̵Ͽ  ũ⸦ ɴϴ.
@@ -24,6 +49,42 @@ namespace vkutil {
             return buffer;
         }
 
+        uint32_t findTransferQueueFamily(VkPhysicalDevice device, uint32_t fallbackFamily)
+        {
+            uint32_t queueFamilyCount = 0;
+            vkGetPhysicalDeviceQueueFamilyProperties(device, &queueFamilyCount, nullptr);
+
+            std::vector<VkQueueFamilyProperties> queueFamilies(queueFamilyCount);
+            vkGetPhysicalDeviceQueueFamilyProperties(device, &queueFamilyCount, queueFamilies.data());
+
+            uint32_t target = fallbackFamily;
+            int bestScore = 0;
+
+            for (uint32_t i = 0; i < queueFamilyCount; i++)
+            {
+                const VkQueueFamilyProperties& queueFamily = queueFamilies[i];
+                const VkExtent3D& granularity = queueFamily.minImageTransferGranularity;
+
+                //    ϹǷ 1ؼ  簡 Ǵ йи մϴ.
+                if (!(queueFamily.queueFlags & VK_QUEUE_TRANSFER_BIT) || (queueFamily.queueFlags & VK_QUEUE_GRAPHICS_BIT) ||
+                    granularity.width != 1 || granularity.height != 1 || granularity.depth != 1) {
+                    continue;
+                }
+
+                const int score = (queueFamily.queueFlags & VK_QUEUE_COMPUTE_BIT) ? 1 : 2;
+                if (score > bestScore) {
+                    bestScore = score;
+                    target = i;
+                }
+            }
+
+#ifdef DEBUG_
+            printf("Transfer QueueFamily index: %u (%s)\n", target, target == fallbackFamily ? "shared" : "dedicated");
+#endif // DEBUG_
+
+            return target;
+        }
+
         uint32_t findMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties, VkPhysicalDevice VKphysicalDevice)
         {
             VkPhysicalDeviceMemoryProperties memProperties;
@@ -39,7 +100,7 @@ namespace vkutil {
             throw std::runtime_error("failed to find suitable memory type!");
         }
 
-        void createBuffer(VkDevice device, VkPhysicalDevice physicalDevice, VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, VkBuffer& buffer, VkDeviceMemory& bufferMemory)
+        void createBuffer(vkengine::memory::VKMemoryAllocator* allocator, VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, VkBuffer& buffer, vkengine::memory::VKAllocation& bufferMemory)
         {
             VkBufferCreateInfo bufferInfo{};
             bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
@@ -47,23 +108,10 @@ namespace vkutil {
             bufferInfo.usage = usage;
             bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
 
-            if (vkCreateBuffer(device, &bufferInfo, nullptr, &buffer) != VK_SUCCESS) {
+            //   ->   Ҵ -> offset ġ ε
+            if (allocator->createBuffer(bufferInfo, properties, buffer, bufferMemory) != VK_SUCCESS) {
                 throw std::runtime_error("failed to create buffer!");
             }
-
-            VkMemoryRequirements memRequirements;
-            vkGetBufferMemoryRequirements(device, buffer, &memRequirements);
-
-            VkMemoryAllocateInfo allocInfo{};
-            allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-            allocInfo.allocationSize = memRequirements.size;
-            allocInfo.memoryTypeIndex = findMemoryType(memRequirements.memoryTypeBits, properties, physicalDevice);
-            
-            if (vkAllocateMemory(device, &allocInfo, nullptr, &bufferMemory) != VK_SUCCESS) {
-                throw std::runtime_error("failed to allocate buffer memory!");
-            }
-
-            vkBindBufferMemory(device, buffer, bufferMemory, 0);
         }
         
         void copyBuffer(VkDevice& VKdevice, VkCommandPool& VKcommandPool, VkQueue& graphicsVKQueue, VkBuffer srcBuffer, VkBuffer dstBuffer, VkDeviceSize size)
@@ -77,7 +125,7 @@ namespace vkutil {
             helper_::endSingleTimeCommands(VKdevice, VKcommandPool, graphicsVKQueue, commandBuffer);
         }
 
-        void createImage(VkDevice& VKdevice, VkPhysicalDevice& VKphysicalDevice, uint32_t width, uint32_t height, uint32_t mipLevels, VkSampleCountFlagBits numSamples, VkFormat format, VkImageTiling tiling, VkImageUsageFlags usage, VkMemoryPropertyFlags properties, VkImage& image, VkDeviceMemory& imageMemory)
+        void createImage(vkengine::memory::VKMemoryAllocator* allocator, uint32_t width, uint32_t height, uint32_t mipLevels, VkSampleCountFlagBits numSamples, VkFormat format, VkImageTiling tiling, VkImageUsageFlags usage, VkMemoryPropertyFlags properties, VkImage& image, vkengine::memory::VKAllocation& imageMemory)
         {
             VkImageCreateInfo imageInfo{};
 
@@ -96,35 +144,45 @@ namespace vkutil {
             imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
             imageInfo.flags = 0; // Optional
 
-            if (vkCreateImage(VKdevice, &imageInfo, nullptr, &image) != VK_SUCCESS) {
+            if (allocator->createImage(imageInfo, properties, image, imageMemory) != VK_SUCCESS) {
                 throw std::runtime_error("failed to create image!");
             }
-
-            VkMemoryRequirements memRequirements;
-            vkGetImageMemoryRequirements(VKdevice, image, &memRequirements);
-
-            VkMemoryAllocateInfo allocInfo{};
-            allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-            allocInfo.allocationSize = memRequirements.size;
-            allocInfo.memoryTypeIndex = helper_::findMemoryType(memRequirements.memoryTypeBits, properties, VKphysicalDevice);
-
-            if (vkAllocateMemory(VKdevice, &allocInfo, nullptr, &imageMemory) != VK_SUCCESS) {
-                throw std::runtime_error("failed to allocate image memory!");
-            }
-
-            vkBindImageMemory(VKdevice, image, imageMemory, 0);
         }
 
         VkCommandBuffer beginSingleTimeCommands(VkDevice& device, VkCommandPool& commandPool)
         {
-            VkCommandBufferAllocateInfo allocInfo{};
-            allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
-            allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
-            allocInfo.commandPool = commandPool;
-            allocInfo.commandBufferCount = 1;
+            SingleTimeCache& cache = getSingleTimeCache();
+            SingleTimeSlot slot{};
+            {
+                std::lock_guard<std::mutex> lock(cache.mutex);
+                std::vector<SingleTimeSlot>& freeSlots = cache.freeSlots[commandPool];
+                if (!freeSlots.empty()) {
+                    slot = freeSlots.back();
+                    freeSlots.pop_back();
+                }
+            }
+
+            //  ִ     ϴ. (ÿ  ܹ߼  ŭ )
+            if (slot.commandBuffer == VK_NULL_HANDLE)
+            {
+                VkCommandBufferAllocateInfo allocInfo{};
+                allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+                allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+                allocInfo.commandPool = commandPool;
+                allocInfo.commandBufferCount = 1;
+                VK_CHECK_RESULT(vkAllocateCommandBuffers(device, &allocInfo, &slot.commandBuffer));
+
+                VkFenceCreateInfo fenceInfo{};
+                fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+                VK_CHECK_RESULT(vkCreateFence(device, &fenceInfo, nullptr, &slot.fence));
+            }
 
-            VkCommandBuffer commandBuffer;
-            vkAllocateCommandBuffers(device, &allocInfo, &commandBuffer);
+            {
+                std::lock_guard<std::mutex> lock(cache.mutex);
+                cache.activeSlots[slot.commandBuffer] = slot;
+            }
+
+            VkCommandBuffer commandBuffer = slot.commandBuffer;
 
             VkCommandBufferBeginInfo beginInfo{};
             beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
@@ -145,10 +203,47 @@ namespace vkutil {
             submitInfo.commandBufferCount = 1;
             submitInfo.pCommandBuffers = &commandBuffer;
 
-            vkQueueSubmit(graphicsQueue, 1, &submitInfo, VK_NULL_HANDLE);
-            vkQueueWaitIdle(graphicsQueue);
+            SingleTimeCache& cache = getSingleTimeCache();
+            SingleTimeSlot slot{};
+            {
+                std::lock_guard<std::mutex> lock(cache.mutex);
+                auto active = cache.activeSlots.find(commandBuffer);
+                if (active == cache.activeSlots.end()) {
+                    throw std::runtime_error("command buffer was not begun with beginSingleTimeCommands!");
+                }
+                slot = active->second;
+                cache.activeSlots.erase(active);
+            }
+
+            // vkQueueWaitIdle  ť ö  ٸǷ  ⸸ fence ٸϴ.
+            VK_CHECK_RESULT(vkQueueSubmit(graphicsQueue, 1, &submitInfo, slot.fence));
+            VK_CHECK_RESULT(vkWaitForFences(device, 1, &slot.fence, VK_TRUE, UINT64_MAX));
+
+            //    ؼ Ǯ  Ӵϴ. (Ŀǵ Ǯ RESET_COMMAND_BUFFER_BIT )
+            VK_CHECK_RESULT(vkResetFences(device, 1, &slot.fence));
+            VK_CHECK_RESULT(vkResetCommandBuffer(slot.commandBuffer, 0));
+            {
+                std::lock_guard<std::mutex> lock(cache.mutex);
+                cache.freeSlots[commandPool].push_back(slot);
+            }
+        }
+
+        void releaseSingleTimeCommands(VkDevice device, VkCommandPool commandPool)
+        {
+            SingleTimeCache& cache = getSingleTimeCache();
+            std::lock_guard<std::mutex> lock(cache.mutex);
+
+            auto entry = cache.freeSlots.find(commandPool);
+            if (entry == cache.freeSlots.end()) {
+                return;
+            }
 
-            vkFreeCommandBuffers(device, commandPool, 1, &commandBuffer);
+            for (const SingleTimeSlot& slot : entry->second)
+            {
+                vkDestroyFence(device, slot.fence, nullptr);
+                vkFreeCommandBuffers(device, commandPool, 1, &slot.commandBuffer);
+            }
+            cache.freeSlots.erase(entry);
         }
 
         void transitionImageLayout(VkDevice& device, VkCommandPool& commandPool, VkQueue& graphicsQueue, VkImage image, VkFormat format, VkImageLayout oldLayout, VkImageLayout newLayout, uint32_t mipLevels)
@@ -298,19 +393,8 @@ namespace vkutil {
             return format == VK_FORMAT_D32_SFLOAT_S8_UINT || format == VK_FORMAT_D24_UNORM_S8_UINT;
         }
 
-        void generateMipmaps(VkPhysicalDevice physicalDevice, VkDevice device, VkCommandPool commandPool, VkQueue graphicsQueue, VkImage image, VkFormat imageFormat, int32_t texWidth, int32_t texHeight, uint32_t mipLevels)
+        void recordMipmaps(VkCommandBuffer commandBuffer, VkImage image, int32_t texWidth, int32_t texHeight, uint32_t mipLevels)
         {
-
-            // Check if image format supports linear blitting
-            VkFormatProperties formatProperties;
-            vkGetPhysicalDeviceFormatProperties(physicalDevice, imageFormat, &formatProperties);
-
-            if (!(formatProperties.optimalTilingFeatures & VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT)) {
-                throw std::runtime_error("texture image format does not support linear blitting!");
-            }
-
-            VkCommandBuffer commandBuffer = beginSingleTimeCommands(device, commandPool);
-            
             // ̾ƿ ȯ
             VkImageMemoryBarrier barrier{};
 
@@ -397,6 +481,22 @@ namespace vkutil {
                 0, nullptr,
                 0, nullptr,
                 1, &barrier);
+        }
+
+        void generateMipmaps(VkPhysicalDevice physicalDevice, VkDevice device, VkCommandPool commandPool, VkQueue graphicsQueue, VkImage image, VkFormat imageFormat, int32_t texWidth, int32_t texHeight, uint32_t mipLevels)
+        {
+
+            // Check if image format supports linear blitting
+            VkFormatProperties formatProperties;
+            vkGetPhysicalDeviceFormatProperties(physicalDevice, imageFormat, &formatProperties);
+
+            if (!(formatProperties.optimalTilingFeatures & VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT)) {
+                throw std::runtime_error("texture image format does not support linear blitting!");
+            }
+
+            VkCommandBuffer commandBuffer = beginSingleTimeCommands(device, commandPool);
+
+            recordMipmaps(commandBuffer, image, texWidth, texHeight, mipLevels);
 
             endSingleTimeCommands(device, commandPool, graphicsQueue, commandBuffer);
         }
@@ -14,9 +14,11 @@
 #include <map>
 #include <unordered_map>
 
+#ifdef _WIN32
 #define VK_USE_PLATFORM_WIN32_KHR
-#define GLFW_INCLUDE_VULKAN
 #define GLFW_EXPOSE_NATIVE_WIN32
+#endif
+#define GLFW_INCLUDE_VULKAN
 #include <GLFW/glfw3.h>
 #include <GLFW/glfw3native.h>
 
@@ -32,6 +34,7 @@ constexpr int HEIGHT = 720;
 constexpr int MAX_FRAMES = 4;
 constexpr int MAX_FRAMES_IN_FLIGHT = 2;
 constexpr int CREATESURFACE_VKWIN32SURFACECREATEINFOKHR = 0;
+constexpr uint32_t HEADLESS_FRAME_COUNT = 1000;     // 헤드리스 모드에서 기본으로 렌더링할 프레임 수
 
 //#ifdef _WIN32
 //
@@ -43,6 +46,17 @@ constexpr int CREATESURFACE_VKWIN32SURFACECREATEINFOKHR = 0;
 //#endif
 
 #define UNIQUE_VERTEXTYPE 1
+#define PACKED_VERTEXTYPE 1                 // 1이면 메시를 불러올 때 가능한 경우 압축 버텍스(VertexPacked)를 사용
+#define SHADER_HOT_RELOAD 1                 // 1이면 shader 디렉터리를 감시해서 바뀐 .spv를 쓰는 파이프라인만 다시 컴파일
+
+// 1이면 VK_TRACE_SCOPE 구간을 기록 (VKtrace.h) -> 디버그 빌드 기본값, 현장 진단용 릴리스 빌드는 CPU_TRACE=1을 정의
+#ifndef CPU_TRACE
+#ifdef DEBUG_
+#define CPU_TRACE 1
+#else
+#define CPU_TRACE 0
+#endif
+#endif
 
 #define CHECK_RESULT(f)                                                 \
 {                                                                        \
@@ -79,6 +93,16 @@ const std::vector<const char*> deviceExtensions = {
     VK_KHR_SHADER_NON_SEMANTIC_INFO_EXTENSION_NAME
 };
 
+// 헤드리스 모드는 오프스크린 이미지에 렌더링하므로 스왑 체인 확장이 필요 없습니다.
+const std::vector<const char*> headlessDeviceExtensions = {
+    VK_KHR_SHADER_NON_SEMANTIC_INFO_EXTENSION_NAME
+};
+
+// 지원할 때만 켜는 확장 -> 켜졌는지는 VKDevice_::enabledExtensions로 확인합니다.
+const std::vector<const char*> optionalDeviceExtensions = {
+    VK_KHR_DRAW_INDIRECT_COUNT_EXTENSION_NAME         // GPU 컬링 (vkCmdDrawIndexedIndirectCountKHR)
+};
+
 const std::vector<VkDynamicState> dynamicStates = {
     VK_DYNAMIC_STATE_VIEWPORT,
     VK_DYNAMIC_STATE_SCISSOR
@@ -93,6 +117,15 @@ const bool enableValidationLayers = true;
 const bool enableValidationLayers = false;
 #endif
 
+namespace vkengine
+{
+    namespace memory
+    {
+        class VKMemoryAllocator;
+        struct VKAllocation;
+    }
+}
+
 namespace vkutil
 {
     namespace helper_
@@ -100,18 +133,21 @@ namespace vkutil
         // 파일을 읽어오는 함수
         std::vector<char> readFile(const std::string& filename);
         
+        // 그래픽스 큐와 따로 동작하는 전송 큐 패밀리를 찾는 함수
+        // 전송 전용(DMA) > 전송+컴퓨트 순으로 고르고, 없으면 fallbackFamily를 반환합니다.
+        uint32_t findTransferQueueFamily(VkPhysicalDevice device, uint32_t fallbackFamily);
+
         // 물리 디바이스의 확장 기능을 지원하는지 확인하는 함수
         uint32_t findMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties, VkPhysicalDevice VKphysicalDevice);
         
         // 버퍼를 생성하는 함수
-        // 버퍼를 생성하고 메모리를 할당합니다.
-        void createBuffer(VkDevice device, 
-            VkPhysicalDevice physicalDevice, 
+        // 버퍼를 생성하고 할당기의 블록에서 메모리를 서브 할당합니다.
+        void createBuffer(vkengine::memory::VKMemoryAllocator* allocator,
             VkDeviceSize size, 
             VkBufferUsageFlags usage, 
             VkMemoryPropertyFlags properties, 
             VkBuffer& buffer, 
-            VkDeviceMemory& bufferMemory);
+            vkengine::memory::VKAllocation& bufferMemory);
 
         // 버퍼를 복사하는 함수
         void copyBuffer(
@@ -124,8 +160,7 @@ namespace vkutil
         
         // 이미지를 생성하는 함수
         void createImage(
-            VkDevice& VKdevice,
-            VkPhysicalDevice& VKphysicalDevice,
+            vkengine::memory::VKMemoryAllocator* allocator,
             uint32_t width,
             uint32_t height,
             uint32_t mipLevels,
@@ -135,14 +170,19 @@ namespace vkutil
             VkImageUsageFlags usage,
             VkMemoryPropertyFlags properties,
             VkImage& image,
-            VkDeviceMemory& imageMemory);
+            vkengine::memory::VKAllocation& imageMemory);
 
         //  시작하려는 명령버퍼를 생성하는 함수
         VkCommandBuffer beginSingleTimeCommands(VkDevice& device, VkCommandPool& commandPool);
     
         // 명령버퍼를 종료하는 함수
+        // 큐 전체가 아니라 이번에 제출한 명령버퍼의 fence만 기다립니다.
+        // 명령버퍼와 fence는 해제하지 않고 리셋해서 같은 커맨드 풀의 다음 begin에서 다시 씁니다.
         void endSingleTimeCommands(VkDevice& device, VkCommandPool& commandPool, VkQueue& graphicsQueue, VkCommandBuffer& commandBuffer);
 
+        // 커맨드 풀에 쌓아 둔 단발성 명령버퍼와 fence를 해제하는 함수 -> vkDestroyCommandPool 전에 호출
+        void releaseSingleTimeCommands(VkDevice device, VkCommandPool commandPool);
+
         // 이미지 레이아웃을 전환하는 함수
         void transitionImageLayout(
             VkDevice& device,
@@ -187,7 +227,17 @@ namespace vkutil
         // 스텐실 컴포넌트를 가지고 있는지 확인하는 함수
         bool hasStencilComponent(VkFormat format);
 
+        // mip 0에서 나머지 mip을 blit으로 만드는 명령을 commandBuffer에 기록하는 함수
+        // 모든 mip이 TRANSFER_DST 상태여야 하고, 끝나면 모든 mip이 SHADER_READ_ONLY가 됩니다.
+        void recordMipmaps(
+            VkCommandBuffer commandBuffer,
+            VkImage image,
+            int32_t texWidth,
+            int32_t texHeight,
+            uint32_t mipLevels);
+
         // Mipmaps을 생성하는 함수
+        // 형식이 선형 blit을 지원하지 않으면 예외 -> CPU에서 만든 mip(asset::generateMipLevels)을 모두 올려야 합니다.
         void generateMipmaps(
             VkPhysicalDevice physicalDevice,
             VkDevice device,
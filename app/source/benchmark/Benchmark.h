@@ -0,0 +1,129 @@
+﻿#ifndef INCLUDE_BENCHMARK_H_
+#define INCLUDE_BENCHMARK_H_
+
+#include "../_common.h"
+#include "../struct.h"
+#include "../engine/VKjobSystem.h"
+
+namespace vkengine {
+    namespace benchmark {
+
+        using BenchmarkClock = std::chrono::high_resolution_clock;
+
+        // start부터 지금까지 걸린 시간(ms)
+        inline double elapsedMs(BenchmarkClock::time_point start)
+        {
+            return std::chrono::duration<double, std::milli>(BenchmarkClock::now() - start).count();
+        }
+
+        // 1, 2, 4, ... maxThreads 순서의 스레드 수 목록 (마지막은 항상 maxThreads)
+        inline std::vector<uint32_t> threadCountSteps(uint32_t maxThreads)
+        {
+            std::vector<uint32_t> steps;
+            for (uint32_t count = 1; count < maxThreads; count *= 2)
+            {
+                steps.push_back(count);
+            }
+            steps.push_back(maxThreads);
+            return steps;
+        }
+
+        // rounds번 prepare() 후 run()을 실행하고 run()만 잰 가장 짧은 시간(ms) -> 캐시/스케줄링 잡음을 덜어냅니다.
+        template <typename Prepare, typename Run>
+        double measureBestMs(uint32_t rounds, Prepare&& prepare, Run&& run)
+        {
+            double bestMs = 1.0e30;
+            for (uint32_t round = 0; round < rounds; round++)
+            {
+                prepare();
+
+                auto start = BenchmarkClock::now();
+                run();
+                bestMs = std::min(bestMs, elapsedMs(start));
+            }
+            return bestMs;
+        }
+
+        template <typename Run>
+        double measureBestMs(uint32_t rounds, Run&& run)
+        {
+            return measureBestMs(rounds, []() {}, run);
+        }
+
+        // threadCountSteps(하드웨어 스레드 수)마다 잡 시스템을 만들어 measure("<name> + jobs xN", &jobSystem)를 호출합니다.
+        // measure가 false를 반환하면 (기준 구현과 다름) 나머지 단계를 건너뛰고 false
+        template <typename Measure>
+        bool measureJobThreads(const char* name, Measure&& measure)
+        {
+            const uint32_t maxThreads = std::max(1u, std::thread::hardware_concurrency());
+            for (uint32_t threadCount : threadCountSteps(maxThreads))
+            {
+                job::VKJobSystem jobSystem(threadCount);
+
+                char label[48];
+                snprintf(label, sizeof(label), "%s + jobs x%u", name, threadCount);
+                const bool matched = measure(label, &jobSystem);
+
+                jobSystem.cleanup();
+                if (!matched) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        // Application::loadModel과 같은 방식으로 OBJ의 모서리를 펼칩니다. -> 파일이 없으면 false
+        bool loadObjCorners(const std::string& path, std::vector<Vertex>& corners);
+
+        // 셰이더 경로의 기준이 되는 실행 파일 경로 (main_engine과 같은 방식)
+        std::string executablePath();
+
+        // gridSize x gridSize 사각형 격자 -> 내부 Vertex 하나를 모서리 6개가 공유합니다.
+        void buildGridCorners(uint32_t gridSize, std::vector<Vertex>& corners);
+
+        // 잡 시스템의 스케줄링 오버헤드와 1..N 코어 확장성을 측정합니다.
+        int runJobBenchmark(const std::vector<std::string>& args);
+
+        // std::unordered_map 중복 제거와 샤드별 개방 주소법 중복 제거를 비교합니다.
+        // args[0]: OBJ 경로 (기본값 viking_room.obj), args[1]: 합성 격자 한 변의 사각형 수 (기본값 1024)
+        int runDedupBenchmark(const std::vector<std::string>& args);
+
+        // 메시렛 생성/검증(모든 삼각형이 정확히 한 번씩 포함되는지)과 CPU 컬링을 측정합니다.
+        // args[0]: OBJ 경로 (기본값 viking_room.obj), args[1]: 합성 격자 한 변의 사각형 수 (기본값 512)
+        int runMeshletBenchmark(const std::vector<std::string>& args);
+
+        // 장면 파일(카메라 경로, 오브젝트 수, 해상도)을 헤드리스로 렌더링하고 프레임 시간 분포를 JSON으로 저장합니다.
+        // args[0]: 장면 파일 (기본값 실행 파일 기준 source/benchmark.scene, 없으면 내장 장면), args[1]: 결과 JSON (기본값 frame_benchmark.json),
+        // args[2]: --window 이면 창을 띄워서 렌더링
+        int runFrameBenchmark(const std::vector<std::string>& args);
+
+        // sRGB mip 다운샘플링 (box, kaiser): 스칼라 기준 구현과 SIMD, SIMD + 1..N 스레드를 비교하고 결과 차이를 검증합니다.
+        // args[0]: 정사각형 테스트 이미지 한 변 (기본값 2048)
+        int runMipmapBenchmark(const std::vector<std::string>& args);
+
+        // 큐브 1천 ~ 100만 개를 헤드리스로 그려 오브젝트마다 draw를 기록할 때와 인스턴싱(draw 1번)의 CPU/GPU 시간을 비교합니다.
+        // args[0]: 최대 오브젝트 수 (기본값 1000000), args[1]: 오브젝트마다 draw를 잴 최대 오브젝트 수 (기본값 100000)
+        int runInstancingBenchmark(const std::vector<std::string>& args);
+
+        // 큐브 1만 ~ 100만 개를 GPU 컬링으로 그리고, 컴퓨트 컬링 시간을 CPU 기준 구현(cullObjectsReference)과 비교합니다.
+        // 마지막 프레임의 간접 draw 명령을 읽어 기준 구현과 같은지 검증합니다. (평면 경계에 걸친 오브젝트만 차이 허용)
+        // args[0]: 최대 오브젝트 수 (기본값 1000000)
+        int runGpuCullBenchmark(const std::vector<std::string>& args);
+
+        // 무작위 오브젝트 10만 ~ 100만 개의 구/AABB 절두체 컬링: 스칼라 기준 구현과 SIMD, SIMD + 1..N 스레드를 비교하고 결과를 검증합니다.
+        // args[0]: 최대 오브젝트 수 (기본값 1000000)
+        int runFrustumCullBenchmark(const std::vector<std::string>& args);
+
+        // 무작위 상자 1천 ~ 1000만 개의 장면 BVH: SAH 빌드(1..N 스레드), 전체/부분 refit, 절두체/반직선/최근접 질의 처리량을 측정합니다.
+        // 질의 결과는 부분 refit 뒤의 상자로 전수 검사와 비교합니다. (1000만 개는 메모리 약 1GB)
+        // args[0]: 최대 오브젝트 수 (기본값 10000000)
+        int runBvhBenchmark(const std::vector<std::string>& args);
+
+        // 무작위 변환 계층 1천 ~ 100만 노드: glm 기준 구현, 전체 dirty(SIMD, 1..N 스레드), 1% 이동, 정지 장면의 갱신 시간과 올릴 행렬 수를 측정합니다.
+        // 갱신할 때마다 월드 변환을 glm 기준 구현과 비교합니다.
+        // args[0]: 최대 노드 수 (기본값 1000000)
+        int runTransformBenchmark(const std::vector<std::string>& args);
+    }
+}
+
+#endif // INCLUDE_BENCHMARK_H_
@@ -0,0 +1,272 @@
+﻿#include "Benchmark.h"
+#include "../engine/Camera.h"
+#include "../engine/VKbvh.h"
+#include "../engine/VKcpuCulling.h"
+
+#include <cfloat>
+#include <cmath>
+#include <iterator>
+
+namespace vkengine {
+    namespace benchmark {
+
+        namespace {
+            constexpr float BVH_OBJECT_SPACING = 2.0f;              // 오브젝트 하나가 차지하는 정육면체 한 변 (크기와 상관없이 밀도가 같음)
+            constexpr float BVH_MOVED_FRACTION = 0.01f;             // 부분 refit에서 프레임마다 움직이는 오브젝트 비율
+            constexpr float BVH_MOVE_DISTANCE = 0.5f;
+            constexpr uint32_t BVH_QUERY_COUNT = 10000;             // 반직선/최근접 질의 수
+            constexpr uint32_t BVH_VERIFY_QUERY_COUNT = 16;         // 전수 검사로 검증할 반직선/최근접 질의 수
+            constexpr float BVH_EPSILON = 1e-3f;
+
+            // 난수 (FrustumCullBenchmark와 같은 LCG)
+            struct BvhRandom {
+                uint32_t seed = 12345;
+
+                float next()
+                {
+                    this->seed = this->seed * 1664525u + 1013904223u;
+                    return static_cast<float>(this->seed >> 8) / static_cast<float>(1u << 24);
+                }
+
+                float signedNext() { return this->next() * 2.0f - 1.0f; }
+            };
+
+            // 오브젝트 수에 맞춰 장면 크기를 키웁니다. -> 크기마다 잎 하나당 겹침이 비슷함
+            float sceneHalfExtent(uint32_t count)
+            {
+                return 0.5f * BVH_OBJECT_SPACING * std::cbrt(static_cast<float>(count));
+            }
+
+            void buildBoxes(uint32_t count, float halfExtent, BvhRandom& random, std::vector<VKAabb>& boxes)
+            {
+                boxes.resize(count);
+                for (uint32_t i = 0; i < count; i++)
+                {
+                    const glm::vec3 center(random.signedNext() * halfExtent, random.signedNext() * halfExtent, random.signedNext() * halfExtent);
+                    const glm::vec3 size(0.1f + random.next() * 0.9f, 0.1f + random.next() * 0.9f, 0.1f + random.next() * 0.9f);
+                    boxes[i] = { center - size, center + size };
+                }
+            }
+
+            // 장면 가장자리에서 안쪽을 보는 카메라 -> 오브젝트의 일부만 보입니다.
+            std::array<glm::vec4, 6> buildFrustumPlanes(float halfExtent)
+            {
+                object::Camera camera;
+                camera.setViewTarget(glm::vec3(0.0f, 0.0f, -halfExtent), glm::vec3(0.0f, 0.0f, halfExtent));
+                camera.setPerspectiveProjection(glm::radians(60.0f), 16.0f / 9.0f, 0.1f, halfExtent);
+                return camera.getFrustumPlanes();
+            }
+
+            // 전수 검사: 절두체는 VKcpuCulling의 AABB 기준 구현과 비교합니다.
+            void bruteForceFrustum(const std::vector<VKAabb>& boxes, const std::array<glm::vec4, 6>& planes, VKCullBounds& bounds, std::vector<uint32_t>& visible)
+            {
+                bounds.resize(static_cast<uint32_t>(boxes.size()));
+                for (uint32_t i = 0; i < boxes.size(); i++)
+                {
+                    const glm::vec3 halfExtent = (boxes[i].max - boxes[i].min) * 0.5f;
+                    bounds.set(i, (boxes[i].min + boxes[i].max) * 0.5f, glm::length(halfExtent), halfExtent);
+                }
+                cullFrustumReference(bounds, planes, VKCullVolume::Aabb, visible);
+            }
+
+            // 한쪽에만 있는 오브젝트는 평면 경계에 걸린 경우만 허용합니다.
+            bool frustumMatches(const std::vector<VKAabb>& boxes, const std::array<glm::vec4, 6>& planes, const std::vector<uint32_t>& expected, std::vector<uint32_t> result)
+            {
+                std::sort(result.begin(), result.end());
+
+                std::vector<uint32_t> difference;
+                std::set_symmetric_difference(expected.begin(), expected.end(), result.begin(), result.end(), std::back_inserter(difference));
+
+                for (uint32_t i : difference)
+                {
+                    const glm::vec3 center = (boxes[i].min + boxes[i].max) * 0.5f;
+                    const glm::vec3 extent = (boxes[i].max - boxes[i].min) * 0.5f;
+
+                    float margin = FLT_MAX;
+                    for (const glm::vec4& plane : planes)
+                    {
+                        const glm::vec3 normal(plane);
+                        margin = std::min(margin, glm::dot(normal, center) + plane.w + glm::dot(glm::abs(normal), extent));
+                    }
+
+                    if (std::fabs(margin) > BVH_EPSILON) {
+                        printf("[bvh] frustum object %u differs from brute force\n", i);
+                        return false;
+                    }
+                }
+                return true;
+            }
+
+            float bruteForceRay(const std::vector<VKAabb>& boxes, const glm::vec3& origin, const glm::vec3& direction, float maxT)
+            {
+                const glm::vec3 inverseDirection = 1.0f / direction;
+                float closest = FLT_MAX;
+                for (const VKAabb& box : boxes)
+                {
+                    const glm::vec3 t0 = (box.min - origin) * inverseDirection;
+                    const glm::vec3 t1 = (box.max - origin) * inverseDirection;
+                    const glm::vec3 tNear = glm::min(t0, t1);
+                    const glm::vec3 tFar = glm::max(t0, t1);
+                    const float enter = std::max(std::max(tNear.x, tNear.y), std::max(tNear.z, 0.0f));
+                    const float exit = std::min(std::min(tFar.x, tFar.y), std::min(tFar.z, maxT));
+                    if (enter <= exit) {
+                        closest = std::min(closest, enter);
+                    }
+                }
+                return closest;
+            }
+
+            float bruteForceNearest(const std::vector<VKAabb>& boxes, const glm::vec3& point)
+            {
+                float closest = FLT_MAX;
+                for (const VKAabb& box : boxes)
+                {
+                    const glm::vec3 offset = glm::max(glm::max(box.min - point, point - box.max), glm::vec3(0.0f));
+                    closest = std::min(closest, glm::dot(offset, offset));
+                }
+                return closest;
+            }
+
+            void printRow(const char* label, double ms, double items)
+            {
+                printf("[bvh] %-22s %10.3f %12.2f\n", label, ms, items / ms / 1000.0);
+            }
+
+            int runScene(uint32_t count)
+            {
+                const uint32_t rounds = (count >= 1000000) ? 2 : 10;
+                const float halfExtent = sceneHalfExtent(count);
+
+                BvhRandom random;
+                std::vector<VKAabb> boxes;
+                buildBoxes(count, halfExtent, random, boxes);
+
+                VKBvh bvh;
+
+                const double buildMs = measureBestMs(rounds, [&]() { bvh.build(boxes.data(), count); });
+
+                printf("[bvh] %u objects, %zu nodes (%zu bytes)\n", count, bvh.getNodes().size(), bvh.getNodes().size() * sizeof(VKBvhNode));
+                printf("[bvh] %-22s %10s %12s\n", "method", "ms", "Mitems/s");
+                printRow("build", buildMs, count);
+
+                // 빌드 결과는 질의에서 전수 검사와 비교하므로 여기서는 시간만 잽니다.
+                measureJobThreads("build", [&](const char* label, job::VKJobSystem* jobSystem) {
+                    printRow(label, measureBestMs(rounds, [&]() { bvh.build(boxes.data(), count, jobSystem); }), count);
+                    return true;
+                });
+
+                // 모든 오브젝트 refit
+                const double refitMs = measureBestMs(rounds, [&]() { bvh.refit(boxes.data()); });
+                printRow("refit all", refitMs, count);
+
+                // 매 라운드 일부 오브젝트를 옮기고 그 오브젝트만 refit
+                const uint32_t movedCount = std::max(1u, static_cast<uint32_t>(count * BVH_MOVED_FRACTION));
+                std::vector<uint32_t> moved(movedCount);
+                auto moveObjects = [&]() {
+                    for (uint32_t& object : moved)
+                    {
+                        object = static_cast<uint32_t>(random.next() * count) % count;
+                        const glm::vec3 offset(random.signedNext(), random.signedNext(), random.signedNext());
+                        boxes[object].min += offset * BVH_MOVE_DISTANCE;
+                        boxes[object].max += offset * BVH_MOVE_DISTANCE;
+                    }
+                };
+                const double movedMs = measureBestMs(rounds, moveObjects, [&]() { bvh.refit(boxes.data(), moved.data(), movedCount); });
+                printRow("refit 1% moved", movedMs, movedCount);
+
+                // 절두체 -> 옮긴 뒤의 상자로 전수 검사와 비교 (부분 refit 검증 포함)
+                const std::array<glm::vec4, 6> planes = buildFrustumPlanes(halfExtent);
+                std::vector<uint32_t> visible;
+                const double frustumMs = measureBestMs(rounds, [&]() { bvh.queryFrustum(planes, visible); });
+
+                {
+                    VKCullBounds bounds;
+                    std::vector<uint32_t> expected;
+                    bruteForceFrustum(boxes, planes, bounds, expected);
+                    if (!frustumMatches(boxes, planes, expected, visible)) {
+                        return EXIT_FAILURE;
+                    }
+                }
+
+                char frustumLabel[48];
+                snprintf(frustumLabel, sizeof(frustumLabel), "frustum (%zu visible)", visible.size());
+                printRow(frustumLabel, frustumMs, count);
+
+                // 반직선 (피킹)
+                std::vector<glm::vec3> origins(BVH_QUERY_COUNT);
+                std::vector<glm::vec3> directions(BVH_QUERY_COUNT);
+                for (uint32_t i = 0; i < BVH_QUERY_COUNT; i++)
+                {
+                    origins[i] = glm::vec3(random.signedNext(), random.signedNext(), random.signedNext()) * halfExtent;
+                    directions[i] = glm::normalize(glm::vec3(random.signedNext(), random.signedNext(), random.signedNext()) + glm::vec3(0.0f, 0.0f, 1e-3f));
+                }
+
+                const float maxT = halfExtent * 4.0f;
+                uint32_t rayHits = 0;
+                auto start = BenchmarkClock::now();
+                for (uint32_t i = 0; i < BVH_QUERY_COUNT; i++)
+                {
+                    VKBvhRayHit hit;
+                    rayHits += bvh.raycast(origins[i], directions[i], maxT, hit) ? 1 : 0;
+                }
+                const double rayMs = elapsedMs(start);
+
+                for (uint32_t i = 0; i < BVH_VERIFY_QUERY_COUNT; i++)
+                {
+                    VKBvhRayHit hit;
+                    const bool found = bvh.raycast(origins[i], directions[i], maxT, hit);
+                    const float expected = bruteForceRay(boxes, origins[i], directions[i], maxT);
+                    if (found != (expected != FLT_MAX) || (found && std::fabs(hit.t - expected) > BVH_EPSILON)) {
+                        printf("[bvh] ray %u differs from brute force\n", i);
+                        return EXIT_FAILURE;
+                    }
+                }
+
+                char rayLabel[48];
+                snprintf(rayLabel, sizeof(rayLabel), "raycast (%u hits)", rayHits);
+                printRow(rayLabel, rayMs, BVH_QUERY_COUNT);
+
+                // 최근접
+                start = BenchmarkClock::now();
+                float nearestSum = 0.0f;
+                for (uint32_t i = 0; i < BVH_QUERY_COUNT; i++)
+                {
+                    VKBvhNearestHit hit;
+                    bvh.nearest(origins[i], hit);
+                    nearestSum += hit.distanceSquared;
+                }
+                const double nearestMs = elapsedMs(start);
+
+                for (uint32_t i = 0; i < BVH_VERIFY_QUERY_COUNT; i++)
+                {
+                    VKBvhNearestHit hit;
+                    const bool found = bvh.nearest(origins[i], hit);
+                    if (!found || std::fabs(hit.distanceSquared - bruteForceNearest(boxes, origins[i])) > BVH_EPSILON) {
+                        printf("[bvh] nearest %u differs from brute force\n", i);
+                        return EXIT_FAILURE;
+                    }
+                }
+
+                char nearestLabel[48];
+                snprintf(nearestLabel, sizeof(nearestLabel), "nearest (avg d2 %.2f)", nearestSum / BVH_QUERY_COUNT);
+                printRow(nearestLabel, nearestMs, BVH_QUERY_COUNT);
+
+                return EXIT_SUCCESS;
+            }
+        }
+
+        int runBvhBenchmark(const std::vector<std::string>& args)
+        {
+            const uint32_t maxCount = (args.size() > 0) ? static_cast<uint32_t>(std::stoul(args[0])) : 10000000;
+
+            for (uint64_t rowCount = 1000; rowCount <= maxCount; rowCount *= 10)
+            {
+                if (runScene(static_cast<uint32_t>(rowCount)) != EXIT_SUCCESS) {
+                    return EXIT_FAILURE;
+                }
+            }
+
+            return EXIT_SUCCESS;
+        }
+    }
+}
@@ -0,0 +1,167 @@
+﻿#include "Benchmark.h"
+#include "../engine/VKvertexDedup.h"
+
+#define TINYOBJLOADER_IMPLEMENTATION
+#include "../../include/common/tiny_obj_loader.h"
+
+namespace vkengine {
+    namespace benchmark {
+
+        bool loadObjCorners(const std::string& path, std::vector<Vertex>& corners)
+        {
+            tinyobj::attrib_t attrib;
+            std::vector<tinyobj::shape_t> shapes;
+            std::vector<tinyobj::material_t> materials;
+            std::string warn, err;
+
+            if (!tinyobj::LoadObj(&attrib, &shapes, &materials, &warn, &err, path.c_str())) {
+                return false;
+            }
+
+            for (const auto& shape : shapes) {
+                for (const auto& index : shape.mesh.indices) {
+                    Vertex vertex{};
+                    vertex.pos = {
+                        attrib.vertices[3 * index.vertex_index + 0],
+                        attrib.vertices[3 * index.vertex_index + 1],
+                        attrib.vertices[3 * index.vertex_index + 2]
+                    };
+                    if (index.texcoord_index >= 0) {
+                        vertex.texCoord = {
+                            attrib.texcoords[2 * index.texcoord_index + 0],
+                            1.0f - attrib.texcoords[2 * index.texcoord_index + 1]
+                        };
+                    }
+                    vertex.color = { 1.0f, 1.0f, 1.0f };
+                    corners.push_back(vertex);
+                }
+            }
+
+            return true;
+        }
+
+        void buildGridCorners(uint32_t gridSize, std::vector<Vertex>& corners)
+        {
+            corners.clear();
+            corners.reserve(static_cast<size_t>(gridSize) * gridSize * 6);
+
+            auto makeVertex = [gridSize](uint32_t x, uint32_t y) {
+                Vertex vertex{};
+                const float u = static_cast<float>(x) / gridSize;
+                const float v = static_cast<float>(y) / gridSize;
+                vertex.pos = { u * 2.0f - 1.0f, v * 2.0f - 1.0f, std::sin(u * 10.0f) * std::cos(v * 10.0f) * 0.1f };
+                vertex.color = { 1.0f, 1.0f, 1.0f };
+                vertex.texCoord = { u, v };
+                return vertex;
+            };
+
+            for (uint32_t y = 0; y < gridSize; y++)
+            {
+                for (uint32_t x = 0; x < gridSize; x++)
+                {
+                    corners.push_back(makeVertex(x, y));
+                    corners.push_back(makeVertex(x + 1, y));
+                    corners.push_back(makeVertex(x + 1, y + 1));
+                    corners.push_back(makeVertex(x, y));
+                    corners.push_back(makeVertex(x + 1, y + 1));
+                    corners.push_back(makeVertex(x, y + 1));
+                }
+            }
+        }
+
+        namespace {
+
+            constexpr uint32_t DEDUP_ROUNDS = 3;
+
+            // 기존 loadModel의 UNIQUE_VERTEXTYPE 경로
+            void deduplicateWithMap(const std::vector<Vertex>& corners, std::vector<Vertex>& vertices, std::vector<uint32_t>& indices)
+            {
+                std::unordered_map<Vertex, uint32_t> uniqueVertices{};
+                vertices.clear();
+                indices.clear();
+
+                for (const Vertex& vertex : corners)
+                {
+                    if (uniqueVertices.count(vertex) == 0) {
+                        uniqueVertices[vertex] = static_cast<uint32_t>(vertices.size());
+                        vertices.push_back(vertex);
+                    }
+                    indices.push_back(uniqueVertices[vertex]);
+                }
+            }
+
+            int runMesh(const char* name, const std::vector<Vertex>& corners)
+            {
+                const uint32_t cornerCount = static_cast<uint32_t>(corners.size());
+                const uint32_t maxThreads = std::max(1u, std::thread::hardware_concurrency());
+
+                std::vector<Vertex> expectedVertices;
+                std::vector<uint32_t> expectedIndices;
+
+                double mapMs = 1.0e30;
+                for (uint32_t round = 0; round < DEDUP_ROUNDS; round++)
+                {
+                    auto start = BenchmarkClock::now();
+                    deduplicateWithMap(corners, expectedVertices, expectedIndices);
+                    mapMs = std::min(mapMs, elapsedMs(start));
+                }
+
+                printf("[dedup] %s: %u corners -> %zu vertices\n", name, cornerCount, expectedVertices.size());
+                printf("[dedup] %-22s %10s %12s %10s\n", "method", "ms", "Mcorners/s", "speedup");
+                printf("[dedup] %-22s %10.3f %12.2f %9.2fx\n", "unordered_map", mapMs, cornerCount / mapMs / 1000.0, 1.0);
+
+                std::vector<Vertex> vertices;
+                std::vector<uint32_t> indices;
+
+                for (uint32_t threadCount : threadCountSteps(maxThreads))
+                {
+                    job::VKJobSystem jobSystem(threadCount);
+                    asset::VKVertexDeduplicator deduplicator(&jobSystem);
+
+                    double dedupMs = 1.0e30;
+                    for (uint32_t round = 0; round < DEDUP_ROUNDS; round++)
+                    {
+                        auto start = BenchmarkClock::now();
+                        deduplicator.deduplicate(corners.data(), cornerCount, vertices, indices);
+                        dedupMs = std::min(dedupMs, elapsedMs(start));
+                    }
+
+                    // 처음 등장한 순서대로 번호를 매기므로 결과가 완전히 같아야 합니다.
+                    if (vertices.size() != expectedVertices.size() || indices != expectedIndices ||
+                        !std::equal(vertices.begin(), vertices.end(), expectedVertices.begin())) {
+                        printf("[dedup] result mismatch with %u threads\n", threadCount);
+                        return EXIT_FAILURE;
+                    }
+
+                    char label[32];
+                    snprintf(label, sizeof(label), "open addressing x%u", threadCount);
+                    printf("[dedup] %-22s %10.3f %12.2f %9.2fx\n", label, dedupMs, cornerCount / dedupMs / 1000.0, mapMs / dedupMs);
+
+                    jobSystem.cleanup();
+                }
+
+                return EXIT_SUCCESS;
+            }
+        }
+
+        int runDedupBenchmark(const std::vector<std::string>& args)
+        {
+            const std::string objPath = (args.size() > 0) ? args[0] : "viking_room.obj";
+            const uint32_t gridSize = (args.size() > 1) ? static_cast<uint32_t>(std::stoul(args[1])) : 1024;
+
+            std::vector<Vertex> corners;
+
+            if (loadObjCorners(objPath, corners)) {
+                if (runMesh(objPath.c_str(), corners) != EXIT_SUCCESS) {
+                    return EXIT_FAILURE;
+                }
+            }
+            else {
+                printf("[dedup] %s not found, skipping OBJ mesh\n", objPath.c_str());
+            }
+
+            buildGridCorners(gridSize, corners);
+            return runMesh("synthetic grid", corners);
+        }
+    }
+}
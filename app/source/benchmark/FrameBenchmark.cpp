@@ -0,0 +1,379 @@
+﻿#include "Benchmark.h"
+#include "../engine/Camera.h"
+#include "../../cpp/cameraEngine.h"
+#include "../engine/VKtrace.h"
+
+#include <cmath>
+#include <sstream>
+
+#ifndef _WIN32
+#include <unistd.h>
+#endif
+
+namespace vkengine {
+    namespace benchmark {
+
+        namespace {
+
+            constexpr float SCENE_FRAME_STEP = 1.0f / 60.0f;     // 카메라 경로를 재생하는 고정 시간 간격 -> 실행마다 같은 화면
+            const std::string SCENE_PATH = "../../../../../../source/benchmark.scene";   // 실행 파일 경로(RootPath) 기준, MODEL_PATH와 같은 방식
+
+            // 카메라 경로의 키 -> 키 사이는 선형 보간합니다.
+            struct CameraKey {
+                float time = 0.0f;
+                glm::vec3 position{ 0.0f };
+                glm::vec3 target{ 0.0f };
+            };
+
+            struct FrameScene {
+                std::string name = "built-in";
+                uint32_t width = WIDTH;
+                uint32_t height = HEIGHT;
+                uint32_t objectCount = 64;
+                bool instancing = true;
+                uint32_t warmupFrames = 120;
+                uint32_t measuredFrames = 600;
+                std::vector<CameraKey> cameraPath;
+            };
+
+            // 한 단계의 시간 분포(ms)
+            struct TimingStats {
+                double mean = 0.0;
+                double min = 0.0;
+                double p50 = 0.0;
+                double p90 = 0.0;
+                double p95 = 0.0;
+                double p99 = 0.0;
+                double max = 0.0;
+                size_t count = 0;
+            };
+
+            // 기본 장면 -> 원점의 큐브 둘레를 한 바퀴 돕니다.
+            void buildDefaultCameraPath(std::vector<CameraKey>& path)
+            {
+                const float radius = 4.0f;
+                for (uint32_t i = 0; i <= 8; i++)
+                {
+                    const float angle = glm::radians(45.0f * static_cast<float>(i));
+
+                    CameraKey key{};
+                    key.time = static_cast<float>(i) * 1.25f;
+                    key.position = glm::vec3(radius * std::cos(angle), 2.0f, radius * std::sin(angle));
+                    key.target = glm::vec3(0.0f);
+                    path.push_back(key);
+                }
+            }
+
+            // 장면 파일 -> 한 줄에 하나씩, '#'부터 줄 끝까지는 주석
+            //   resolution <width> <height>
+            //   objects <count>
+            //   instancing <0|1>
+            //   warmup <frames>
+            //   frames <frames>
+            //   camera <time> <px> <py> <pz> <tx> <ty> <tz>
+            bool loadFrameScene(std::istream& file, const std::string& path, FrameScene& scene)
+            {
+                scene.name = path;
+                scene.cameraPath.clear();
+
+                std::string line;
+                uint32_t lineNumber = 0;
+                while (std::getline(file, line))
+                {
+                    lineNumber++;
+
+                    const size_t comment = line.find('#');
+                    if (comment != std::string::npos) {
+                        line.erase(comment);
+                    }
+
+                    std::istringstream stream(line);
+                    std::string keyword;
+                    if (!(stream >> keyword)) {
+                        continue;
+                    }
+
+                    bool parsed = false;
+                    if (keyword == "resolution") {
+                        parsed = static_cast<bool>(stream >> scene.width >> scene.height) && scene.width > 0 && scene.height > 0;
+                    }
+                    else if (keyword == "objects") {
+                        parsed = static_cast<bool>(stream >> scene.objectCount);
+                    }
+                    else if (keyword == "instancing") {
+                        parsed = static_cast<bool>(stream >> scene.instancing);
+                    }
+                    else if (keyword == "warmup") {
+                        parsed = static_cast<bool>(stream >> scene.warmupFrames);
+                    }
+                    else if (keyword == "frames") {
+                        parsed = static_cast<bool>(stream >> scene.measuredFrames) && scene.measuredFrames > 0;
+                    }
+                    else if (keyword == "camera") {
+                        CameraKey key{};
+                        parsed = static_cast<bool>(stream >> key.time
+                            >> key.position.x >> key.position.y >> key.position.z
+                            >> key.target.x >> key.target.y >> key.target.z);
+                        if (parsed) {
+                            scene.cameraPath.push_back(key);
+                        }
+                    }
+
+                    if (!parsed) {
+                        printf("[frame] %s:%u: invalid line '%s'\n", path.c_str(), lineNumber, line.c_str());
+                        return false;
+                    }
+                }
+
+                if (scene.cameraPath.empty()) {
+                    buildDefaultCameraPath(scene.cameraPath);
+                }
+
+                std::stable_sort(scene.cameraPath.begin(), scene.cameraPath.end(),
+                    [](const CameraKey& a, const CameraKey& b) { return a.time < b.time; });
+
+                return true;
+            }
+
+            // time의 카메라 위치와 목표 -> 경로 끝을 넘으면 처음부터 반복합니다.
+            void sampleCameraPath(const std::vector<CameraKey>& path, float time, glm::vec3& position, glm::vec3& target)
+            {
+                const float duration = path.back().time;
+                if (duration > 0.0f) {
+                    time = std::fmod(time, duration);
+                }
+
+                size_t next = 0;
+                while (next < path.size() && path[next].time <= time)
+                {
+                    next++;
+                }
+
+                if (next == 0 || next == path.size()) {
+                    const CameraKey& key = (next == 0) ? path.front() : path.back();
+                    position = key.position;
+                    target = key.target;
+                    return;
+                }
+
+                const CameraKey& a = path[next - 1];
+                const CameraKey& b = path[next];
+                const float t = (time - a.time) / (b.time - a.time);
+                position = glm::mix(a.position, b.position, t);
+                target = glm::mix(a.target, b.target, t);
+            }
+
+            // 가장 가까운 순위(nearest-rank) 백분위수
+            TimingStats computeStats(std::vector<double> samples)
+            {
+                TimingStats stats{};
+                stats.count = samples.size();
+                if (samples.empty()) {
+                    return stats;
+                }
+
+                std::sort(samples.begin(), samples.end());
+
+                auto percentile = [&samples](double p) {
+                    const size_t rank = static_cast<size_t>(std::ceil(p / 100.0 * samples.size()));
+                    return samples[std::min(samples.size() - 1, rank > 0 ? rank - 1 : 0)];
+                };
+
+                double sum = 0.0;
+                for (double sample : samples)
+                {
+                    sum += sample;
+                }
+
+                stats.mean = sum / samples.size();
+                stats.min = samples.front();
+                stats.p50 = percentile(50.0);
+                stats.p90 = percentile(90.0);
+                stats.p95 = percentile(95.0);
+                stats.p99 = percentile(99.0);
+                stats.max = samples.back();
+                return stats;
+            }
+
+            void writeStats(FILE* file, const char* name, const TimingStats& stats, bool last)
+            {
+                if (stats.count == 0) {
+                    fprintf(file, "    \"%s\": null%s\n", name, last ? "" : ",");
+                    return;
+                }
+
+                fprintf(file, "    \"%s\": { \"mean\": %.4f, \"min\": %.4f, \"p50\": %.4f, \"p90\": %.4f, \"p95\": %.4f, \"p99\": %.4f, \"max\": %.4f, \"count\": %zu }%s\n",
+                    name, stats.mean, stats.min, stats.p50, stats.p90, stats.p95, stats.p99, stats.max, stats.count, last ? "" : ",");
+            }
+
+            // JSON 문자열 안에 넣을 수 있도록 따옴표와 역슬래시를 이스케이프합니다.
+            std::string escapeJson(const std::string& text)
+            {
+                std::string escaped;
+                for (char c : text)
+                {
+                    if (c == '"' || c == '\\') {
+                        escaped.push_back('\\');
+                    }
+                    escaped.push_back(c);
+                }
+                return escaped;
+            }
+        }
+
+        std::string executablePath()
+        {
+#ifdef _WIN32
+            char path[MAX_PATH];
+            if (GetModuleFileNameA(NULL, path, MAX_PATH)) {
+                return path;
+            }
+#else
+            char path[4096];
+            const ssize_t length = readlink("/proc/self/exe", path, sizeof(path) - 1);
+            if (length > 0) {
+                path[length] = '\0';
+                return path;
+            }
+#endif
+            return std::string();
+        }
+
+        int runFrameBenchmark(const std::vector<std::string>& args)
+        {
+            // 기본 장면은 작업 디렉터리가 아니라 실행 파일 위치 기준으로 찾습니다. (다른 에셋과 같음)
+            const std::string rootPath = executablePath();
+            const std::string scenePath = (args.size() > 0) ? args[0] : rootPath + SCENE_PATH;
+            const std::string outputPath = (args.size() > 1) ? args[1] : "frame_benchmark.json";
+            const bool windowed = (args.size() > 2) && args[2] == "--window";
+
+            FrameScene scene{};
+            std::ifstream sceneFile(scenePath);
+            if (sceneFile.is_open()) {
+                if (!loadFrameScene(sceneFile, scenePath, scene)) {
+                    return EXIT_FAILURE;
+                }
+            }
+            else {
+                printf("[frame] %s not found, using built-in scene\n", scenePath.c_str());
+                buildDefaultCameraPath(scene.cameraPath);
+            }
+
+            cameraEngine engine(rootPath);
+            engine.setHeadless(!windowed, 0);
+            engine.setWindowWidth(static_cast<int>(scene.width));
+            engine.setWindowHeight(static_cast<int>(scene.height));
+
+            engine.init();
+            engine.prepare();
+            engine.setDrawCount(scene.objectCount);
+            engine.setInstancing(scene.instancing);
+
+            const std::shared_ptr<object::Camera> camera = engine.getCamera();
+            const VkExtent2D extent = engine.getSwapChain()->getSwapChainExtent();
+            camera->setPerspectiveProjection(glm::radians(45.0f), static_cast<float>(extent.width) / static_cast<float>(extent.height), 0.1f, 100.0f);
+
+            std::vector<double> frameMs, waitMs, acquireMs, uniformMs, recordMs, submitMs, presentMs, gpuMs;
+            frameMs.reserve(scene.measuredFrames);
+
+            const uint32_t totalFrames = scene.warmupFrames + scene.measuredFrames;
+            for (uint32_t frame = 0; frame < totalFrames; frame++)
+            {
+                if (windowed) {
+                    glfwPollEvents();
+                }
+
+                glm::vec3 position, target;
+                sampleCameraPath(scene.cameraPath, static_cast<float>(frame) * SCENE_FRAME_STEP, position, target);
+                camera->setViewTarget(position, target);
+
+                auto start = BenchmarkClock::now();
+                engine.drawFrame();
+                const double ms = elapsedMs(start);
+
+                if (frame < scene.warmupFrames) {
+                    continue;
+                }
+
+                const FrameTimings& timings = engine.getFrameTimings();
+                frameMs.push_back(ms);
+                waitMs.push_back(timings.wait);
+                acquireMs.push_back(timings.acquire);
+                uniformMs.push_back(timings.uniform);
+                recordMs.push_back(timings.record);
+                submitMs.push_back(timings.submit);
+                presentMs.push_back(timings.present);
+                if (timings.gpu >= 0.0) {
+                    gpuMs.push_back(timings.gpu);
+                }
+            }
+
+            vkDeviceWaitIdle(engine.getDevice()->VKdevice);
+
+            const std::string deviceName = engine.getDevice()->properties.deviceName;
+            engine.cleanup();
+
+            const TimingStats frameStats = computeStats(frameMs);
+            const TimingStats gpuStats = computeStats(gpuMs);
+
+            printf("[frame] %s on %s (%s), %ux%u, %u objects (%s), %u warm-up + %u measured frames\n",
+                scene.name.c_str(), deviceName.c_str(), windowed ? "window" : "headless",
+                scene.width, scene.height, scene.objectCount, scene.instancing ? "instanced" : "draw per object",
+                scene.warmupFrames, scene.measuredFrames);
+            printf("[frame] %-8s %10s %10s %10s %10s\n", "", "mean", "p50", "p99", "max");
+            printf("[frame] %-8s %10.3f %10.3f %10.3f %10.3f\n", "cpu", frameStats.mean, frameStats.p50, frameStats.p99, frameStats.max);
+            if (gpuStats.count > 0) {
+                printf("[frame] %-8s %10.3f %10.3f %10.3f %10.3f\n", "gpu", gpuStats.mean, gpuStats.p50, gpuStats.p99, gpuStats.max);
+            }
+
+            FILE* file = fopen(outputPath.c_str(), "w");
+            if (file == nullptr) {
+                printf("[frame] failed to open %s\n", outputPath.c_str());
+                return EXIT_FAILURE;
+            }
+
+            fprintf(file, "{\n");
+            fprintf(file, "  \"benchmark\": \"frame\",\n");
+            fprintf(file, "  \"scene\": \"%s\",\n", escapeJson(scene.name).c_str());
+            fprintf(file, "  \"device\": \"%s\",\n", escapeJson(deviceName).c_str());
+            fprintf(file, "  \"headless\": %s,\n", windowed ? "false" : "true");
+            fprintf(file, "  \"resolution\": [ %u, %u ],\n", scene.width, scene.height);
+            fprintf(file, "  \"objects\": %u,\n", scene.objectCount);
+            fprintf(file, "  \"instancing\": %s,\n", scene.instancing ? "true" : "false");
+            fprintf(file, "  \"warmupFrames\": %u,\n", scene.warmupFrames);
+            fprintf(file, "  \"measuredFrames\": %u,\n", scene.measuredFrames);
+            fprintf(file, "  \"frameMs\": {\n");
+            writeStats(file, "cpu", frameStats, false);
+            writeStats(file, "gpu", gpuStats, true);
+            fprintf(file, "  },\n");
+            fprintf(file, "  \"phaseMs\": {\n");
+            writeStats(file, "wait", computeStats(waitMs), false);
+            writeStats(file, "acquire", computeStats(acquireMs), false);
+            writeStats(file, "uniform", computeStats(uniformMs), false);
+            writeStats(file, "record", computeStats(recordMs), false);
+            writeStats(file, "submit", computeStats(submitMs), false);
+            writeStats(file, "present", computeStats(presentMs), true);
+            fprintf(file, "  }\n");
+            fprintf(file, "}\n");
+            fclose(file);
+
+            printf("[frame] results written to %s\n", outputPath.c_str());
+
+            // 마지막 프레임들의 GPU 구간 (render pass 등)은 Chrome 트레이스로 따로 남깁니다.
+            const size_t extension = outputPath.rfind(".json");
+            const std::string traceBase = (extension == std::string::npos) ? outputPath : outputPath.substr(0, extension);
+            const std::string tracePath = traceBase + "_gpu_trace.json";
+            if (engine.getGpuProfiler().writeTrace(tracePath)) {
+                printf("[frame] gpu trace written to %s\n", tracePath.c_str());
+            }
+
+            // CPU 구간 (drawFrame, 기록 슬라이스, 파이프라인 컴파일 등) -> 디버그 빌드 또는 CPU_TRACE=1일 때만 남습니다.
+            const std::string cpuTracePath = traceBase + "_cpu_trace.json";
+            if (VK_TRACE_WRITE(cpuTracePath)) {
+                printf("[frame] cpu trace written to %s\n", cpuTracePath.c_str());
+            }
+
+            return EXIT_SUCCESS;
+        }
+    }
+}
@@ -0,0 +1,131 @@
+﻿#include "Benchmark.h"
+#include "../engine/Camera.h"
+#include "../engine/VKcpuCulling.h"
+
+#include <cmath>
+#include <iterator>
+#include <limits>
+
+namespace vkengine {
+    namespace benchmark {
+
+        namespace {
+            constexpr uint32_t FRUSTUM_ROUNDS = 10;
+            constexpr float FRUSTUM_WORLD_EXTENT = 1000.0f;         // 오브젝트를 흩뿌리는 정육면체의 반 크기
+            constexpr float FRUSTUM_BOUNDARY_EPSILON = 1e-3f;       // 평면에 닿는 볼륨은 곱셈-덧셈 융합 여부에 따라 결과가 갈릴 수 있음
+
+            // 원점 근처에서 바깥을 보는 카메라 -> 오브젝트의 일부만 보입니다.
+            std::array<glm::vec4, 6> buildFrustumPlanes()
+            {
+                object::Camera camera;
+                camera.setViewTarget(glm::vec3(0.0f, 0.0f, -FRUSTUM_WORLD_EXTENT * 0.5f), glm::vec3(0.0f, 0.0f, FRUSTUM_WORLD_EXTENT));
+                camera.setPerspectiveProjection(glm::radians(60.0f), 16.0f / 9.0f, 0.1f, FRUSTUM_WORLD_EXTENT);
+                return camera.getFrustumPlanes();
+            }
+
+            void buildBounds(uint32_t count, VKCullBounds& bounds)
+            {
+                bounds.resize(count);
+
+                uint32_t seed = 12345;
+                auto random = [&seed]() {
+                    seed = seed * 1664525u + 1013904223u;
+                    return static_cast<float>(seed >> 8) / static_cast<float>(1u << 24);
+                };
+
+                for (uint32_t i = 0; i < count; i++)
+                {
+                    const glm::vec3 center(
+                        (random() * 2.0f - 1.0f) * FRUSTUM_WORLD_EXTENT,
+                        (random() * 2.0f - 1.0f) * FRUSTUM_WORLD_EXTENT,
+                        (random() * 2.0f - 1.0f) * FRUSTUM_WORLD_EXTENT);
+                    const glm::vec3 halfExtent(0.5f + random() * 4.5f, 0.5f + random() * 4.5f, 0.5f + random() * 4.5f);
+                    bounds.set(i, center, glm::length(halfExtent), halfExtent);
+                }
+            }
+
+            // 가장 가까운 평면까지의 여유 (음수면 바깥) -> 경계 근처인지 판단
+            float volumeMargin(const VKCullBounds& bounds, uint32_t i, const std::array<glm::vec4, 6>& planes, VKCullVolume volume)
+            {
+                float margin = std::numeric_limits<float>::max();
+                for (const glm::vec4& plane : planes)
+                {
+                    const float d = plane.x * bounds.centerX[i] + plane.y * bounds.centerY[i] + plane.z * bounds.centerZ[i] + plane.w;
+                    const float r = (volume == VKCullVolume::Aabb)
+                        ? std::fabs(plane.x) * bounds.extentX[i] + std::fabs(plane.y) * bounds.extentY[i] + std::fabs(plane.z) * bounds.extentZ[i]
+                        : bounds.radius[i];
+                    margin = std::min(margin, d + r);
+                }
+                return margin;
+            }
+
+            // 두 목록은 오름차순 -> 한쪽에만 있는 오브젝트는 평면 경계에 걸린 경우만 허용합니다.
+            bool matches(const VKCullBounds& bounds, const std::vector<uint32_t>& expected, const std::vector<uint32_t>& result,
+                const std::array<glm::vec4, 6>& planes, VKCullVolume volume)
+            {
+                std::vector<uint32_t> difference;
+                std::set_symmetric_difference(expected.begin(), expected.end(), result.begin(), result.end(), std::back_inserter(difference));
+
+                for (uint32_t i : difference)
+                {
+                    if (std::fabs(volumeMargin(bounds, i, planes, volume)) > FRUSTUM_BOUNDARY_EPSILON) {
+                        printf("[frustum] object %u differs from reference\n", i);
+                        return false;
+                    }
+                }
+                return std::is_sorted(result.begin(), result.end());
+            }
+
+            int runVolume(const char* name, VKCullVolume volume, const VKCullBounds& bounds, const std::array<glm::vec4, 6>& planes)
+            {
+                const uint32_t count = bounds.getCount();
+
+                std::vector<uint32_t> expected;
+                std::vector<uint32_t> result;
+
+                const double referenceMs = measureBestMs(FRUSTUM_ROUNDS, [&]() { cullFrustumReference(bounds, planes, volume, expected); });
+
+                printf("[frustum] %s: %u objects, %zu visible (%s)\n", name, count, expected.size(), getCullSimdName());
+                printf("[frustum] %-22s %10s %12s %10s\n", "method", "ms", "Mobjects/s", "speedup");
+                printf("[frustum] %-22s %10.3f %12.2f %9.2fx\n", "scalar reference", referenceMs, count / referenceMs / 1000.0, 1.0);
+
+                auto measure = [&](const char* label, job::VKJobSystem* jobSystem) {
+                    const double ms = measureBestMs(FRUSTUM_ROUNDS, [&]() { cullFrustum(bounds, planes, volume, result, jobSystem); });
+
+                    if (!matches(bounds, expected, result, planes, volume)) {
+                        printf("[frustum] %s differs from reference\n", label);
+                        return false;
+                    }
+
+                    printf("[frustum] %-22s %10.3f %12.2f %9.2fx\n", label, ms, count / ms / 1000.0, referenceMs / ms);
+                    return true;
+                };
+
+                if (!measure("simd", nullptr) || !measureJobThreads("simd", measure)) {
+                    return EXIT_FAILURE;
+                }
+
+                return EXIT_SUCCESS;
+            }
+        }
+
+        int runFrustumCullBenchmark(const std::vector<std::string>& args)
+        {
+            const uint32_t maxCount = (args.size() > 0) ? static_cast<uint32_t>(std::stoul(args[0])) : 1000000;
+            const std::array<glm::vec4, 6> planes = buildFrustumPlanes();
+
+            for (uint64_t rowCount = 100000; rowCount <= maxCount; rowCount *= 10)
+            {
+                VKCullBounds bounds;
+                buildBounds(static_cast<uint32_t>(rowCount), bounds);
+
+                if (runVolume("sphere", VKCullVolume::Sphere, bounds, planes) != EXIT_SUCCESS ||
+                    runVolume("aabb", VKCullVolume::Aabb, bounds, planes) != EXIT_SUCCESS) {
+                    return EXIT_FAILURE;
+                }
+            }
+
+            return EXIT_SUCCESS;
+        }
+    }
+}
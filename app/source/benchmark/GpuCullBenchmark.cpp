@@ -0,0 +1,209 @@
+﻿#include "Benchmark.h"
+#include "../engine/Camera.h"
+#include "../../cpp/cameraEngine.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+namespace vkengine {
+    namespace benchmark {
+
+        namespace {
+            constexpr uint32_t GPU_CULL_WARMUP_FRAMES = 30;
+            constexpr uint32_t GPU_CULL_MEASURED_FRAMES = 120;
+            constexpr uint32_t GPU_CULL_REFERENCE_RUNS = 10;
+            constexpr float GPU_CULL_BOUNDARY_EPSILON = 1e-4f;          // 평면에 닿는 구는 CPU/GPU 부동소수점 차이로 결과가 갈릴 수 있음 (격자 크기에 비례)
+
+            struct GpuCullResult {
+                uint32_t visible = 0;
+                double referenceMs = 0.0;                           // cullObjectsReference 평균
+                double cullMs = -1.0;                               // "cull" 구간 타임스탬프 평균 (측정하지 못하면 음수)
+                double cpuMs = 0.0;                                 // drawFrame 평균
+                uint32_t boundaryMismatches = 0;                    // 평면 경계에 걸린 오브젝트의 불일치 (허용)
+                bool verified = false;
+            };
+
+            double findScopeMs(const VKGpuFrameResult& frame, const char* name)
+            {
+                for (const VKGpuScopeResult& scope : frame.scopes)
+                {
+                    if (scope.name != nullptr && strcmp(scope.name, name) == 0) {
+                        return scope.durationMs;
+                    }
+                }
+
+                return -1.0;
+            }
+
+            // 가장 가까운 평면까지의 여유 (음수면 바깥) -> 경계 근처인지 판단
+            float sphereMargin(const glm::vec4& sphere, const std::array<glm::vec4, 6>& planes)
+            {
+                float margin = std::numeric_limits<float>::max();
+                for (const glm::vec4& plane : planes)
+                {
+                    margin = std::min(margin, glm::dot(glm::vec3(plane), glm::vec3(sphere)) + plane.w + sphere.w);
+                }
+
+                return margin;
+            }
+
+            // GPU 결과를 firstInstance로 정렬해 기준 구현과 비교합니다.
+            bool verify(const VKGpuCuller& culler, std::vector<VkDrawIndexedIndirectCommand>& gpuDraws,
+                const std::vector<VkDrawIndexedIndirectCommand>& referenceDraws, const std::array<glm::vec4, 6>& planes,
+                float epsilon, uint32_t& boundaryMismatches)
+            {
+                std::sort(gpuDraws.begin(), gpuDraws.end(), [](const VkDrawIndexedIndirectCommand& a, const VkDrawIndexedIndirectCommand& b) {
+                    return a.firstInstance < b.firstInstance;
+                });
+
+                const VKCullObject* objects = culler.getObjects();
+                auto sameDraw = [](const VkDrawIndexedIndirectCommand& a, const VkDrawIndexedIndirectCommand& b) {
+                    return a.indexCount == b.indexCount && a.instanceCount == b.instanceCount &&
+                        a.firstIndex == b.firstIndex && a.vertexOffset == b.vertexOffset && a.firstInstance == b.firstInstance;
+                };
+                auto isBoundary = [&](uint32_t instance) {
+                    return instance < culler.getCount() && std::fabs(sphereMargin(objects[instance].sphere, planes)) <= epsilon;
+                };
+
+                boundaryMismatches = 0;
+                size_t g = 0;
+                size_t r = 0;
+                while (g < gpuDraws.size() || r < referenceDraws.size())
+                {
+                    // 같은 오브젝트 -> 명령까지 같아야 합니다.
+                    if (g < gpuDraws.size() && r < referenceDraws.size() && gpuDraws[g].firstInstance == referenceDraws[r].firstInstance) {
+                        if (!sameDraw(gpuDraws[g], referenceDraws[r])) {
+                            printf("[gpucull] draw mismatch at instance %u\n", gpuDraws[g].firstInstance);
+                            return false;
+                        }
+                        g++;
+                        r++;
+                        continue;
+                    }
+
+                    // 한쪽에만 있는 오브젝트 -> 평면 경계에 걸린 경우만 허용합니다.
+                    const bool gpuOnly = (r >= referenceDraws.size()) || (g < gpuDraws.size() && gpuDraws[g].firstInstance < referenceDraws[r].firstInstance);
+                    const uint32_t instance = gpuOnly ? gpuDraws[g].firstInstance : referenceDraws[r].firstInstance;
+                    if (!isBoundary(instance)) {
+                        printf("[gpucull] instance %u visible only on the %s\n", instance, gpuOnly ? "GPU" : "CPU");
+                        return false;
+                    }
+
+                    boundaryMismatches++;
+                    if (gpuOnly) {
+                        g++;
+                    }
+                    else {
+                        r++;
+                    }
+                }
+
+                return true;
+            }
+
+            GpuCullResult measure(cameraEngine& engine, uint32_t count)
+            {
+                engine.setDrawCount(count);
+
+                // 격자 가장자리에서 중심을 보고, 먼 평면을 격자 크기로 잘라 일부만 보이게 합니다.
+                const float extent = std::max(1.0f, std::ceil(std::cbrt(static_cast<float>(count)))) * INSTANCE_GRID_SPACING;
+                const VkExtent2D swapChainExtent = engine.getSwapChain()->getSwapChainExtent();
+                const std::shared_ptr<object::Camera> camera = engine.getCamera();
+                camera->setViewTarget(glm::vec3(extent * 0.25f, extent * 0.1f, extent * 0.75f), glm::vec3(0.0f));
+                camera->setPerspectiveProjection(glm::radians(45.0f),
+                    static_cast<float>(swapChainExtent.width) / static_cast<float>(swapChainExtent.height), 0.1f, extent);
+
+                GpuCullResult result{};
+                uint32_t gpuSamples = 0;
+                double gpuSum = 0.0;
+
+                for (uint32_t frame = 0; frame < GPU_CULL_WARMUP_FRAMES + GPU_CULL_MEASURED_FRAMES; frame++)
+                {
+                    auto start = BenchmarkClock::now();
+                    engine.drawFrame();
+                    const double ms = elapsedMs(start);
+
+                    if (frame < GPU_CULL_WARMUP_FRAMES) {
+                        continue;
+                    }
+
+                    result.cpuMs += ms;
+                    const double cullMs = findScopeMs(engine.getGpuProfiler().getLastFrame(), "cull");
+                    if (cullMs >= 0.0) {
+                        gpuSum += cullMs;
+                        gpuSamples++;
+                    }
+                }
+
+                result.cpuMs /= GPU_CULL_MEASURED_FRAMES;
+                if (gpuSamples > 0) {
+                    result.cullMs = gpuSum / gpuSamples;
+                }
+
+                // 같은 카메라로 CPU 기준 구현을 돌립니다.
+                VKGpuCuller& culler = *engine.getGpuCuller();
+                const std::array<glm::vec4, 6> planes = camera->getFrustumPlanes();
+                std::vector<VkDrawIndexedIndirectCommand> referenceDraws;
+                referenceDraws.reserve(count);
+
+                auto start = BenchmarkClock::now();
+                for (uint32_t run = 0; run < GPU_CULL_REFERENCE_RUNS; run++)
+                {
+                    cullObjectsReference(culler.getObjects(), culler.getCount(), planes, referenceDraws);
+                }
+                result.referenceMs = elapsedMs(start) / GPU_CULL_REFERENCE_RUNS;
+
+                // 마지막 프레임의 GPU 결과를 읽어 비교합니다.
+                vkDeviceWaitIdle(engine.getDevice()->VKdevice);
+                std::vector<VkDrawIndexedIndirectCommand> gpuDraws;
+                result.visible = culler.readResults(gpuDraws);
+                result.verified = verify(culler, gpuDraws, referenceDraws, planes, GPU_CULL_BOUNDARY_EPSILON * extent, result.boundaryMismatches);
+
+                return result;
+            }
+        }
+
+        int runGpuCullBenchmark(const std::vector<std::string>& args)
+        {
+            const uint32_t maxCount = (args.size() > 0) ? static_cast<uint32_t>(std::stoul(args[0])) : 1000000;
+
+            cameraEngine engine(executablePath());
+            engine.setHeadless(true, 0);
+            engine.setGpuCulling(true);
+            engine.init();
+            engine.prepare();
+
+            if (!engine.isGpuCulling()) {
+                printf("[gpucull] %s does not support GPU culling -> skipped\n", engine.getDevice()->properties.deviceName);
+                vkDeviceWaitIdle(engine.getDevice()->VKdevice);
+                engine.cleanup();
+                return EXIT_SUCCESS;
+            }
+
+            printf("[gpucull] %s, %u warm-up + %u measured frames per row\n",
+                engine.getDevice()->properties.deviceName, GPU_CULL_WARMUP_FRAMES, GPU_CULL_MEASURED_FRAMES);
+            printf("[gpucull] %10s %10s %12s %12s %10s %9s %s\n", "objects", "visible", "cpu ref ms", "gpu cull ms", "frame ms", "speedup", "verify");
+
+            bool passed = true;
+            for (uint64_t rowCount = 10000; rowCount <= maxCount; rowCount *= 10)
+            {
+                const uint32_t count = static_cast<uint32_t>(rowCount);
+                const GpuCullResult result = measure(engine, count);
+
+                const double speedup = (result.cullMs > 0.0) ? result.referenceMs / result.cullMs : 0.0;
+                printf("[gpucull] %10u %10u %12.3f %12.3f %10.3f %8.2fx %s (%u on boundary)\n",
+                    count, result.visible, result.referenceMs, result.cullMs, result.cpuMs, speedup,
+                    result.verified ? "ok" : "FAILED", result.boundaryMismatches);
+
+                passed = passed && result.verified;
+            }
+
+            vkDeviceWaitIdle(engine.getDevice()->VKdevice);
+            engine.cleanup();
+
+            return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+        }
+    }
+}
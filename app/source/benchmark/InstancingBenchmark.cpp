@@ -0,0 +1,110 @@
+﻿#include "Benchmark.h"
+#include "../engine/Camera.h"
+#include "../../cpp/cameraEngine.h"
+
+#include <cmath>
+
+namespace vkengine {
+    namespace benchmark {
+
+        namespace {
+            constexpr uint32_t INSTANCING_WARMUP_FRAMES = 30;       // 인스턴스 버퍼 복사(슬롯마다 한 번)와 파이프라인 준비가 끝나도록
+            constexpr uint32_t INSTANCING_MEASURED_FRAMES = 120;
+            constexpr uint32_t CUBE_TRIANGLES = 12;
+
+            struct InstancingResult {
+                double cpuMs = 0.0;                                 // drawFrame 평균
+                double recordMs = 0.0;                              // 커맨드 버퍼 기록 평균 (FrameTimings::record)
+                double gpuMs = -1.0;                                // 타임스탬프 평균 (측정하지 못하면 음수)
+            };
+
+            InstancingResult measure(cameraEngine& engine, uint32_t count, bool instancing)
+            {
+                engine.setDrawCount(count);
+                engine.setInstancing(instancing);
+
+                // 격자 전체가 화면에 들어오도록 카메라를 뒤로 빼고 먼 평면을 늘립니다.
+                const float extent = std::max(1.0f, std::ceil(std::cbrt(static_cast<float>(count)))) * INSTANCE_GRID_SPACING;
+                const VkExtent2D swapChainExtent = engine.getSwapChain()->getSwapChainExtent();
+                const std::shared_ptr<object::Camera> camera = engine.getCamera();
+                camera->setViewTarget(glm::vec3(0.0f, extent * 0.75f, extent * 1.5f), glm::vec3(0.0f));
+                camera->setPerspectiveProjection(glm::radians(45.0f),
+                    static_cast<float>(swapChainExtent.width) / static_cast<float>(swapChainExtent.height), 0.1f, extent * 4.0f);
+
+                InstancingResult result{};
+                uint32_t gpuSamples = 0;
+                double gpuSum = 0.0;
+
+                for (uint32_t frame = 0; frame < INSTANCING_WARMUP_FRAMES + INSTANCING_MEASURED_FRAMES; frame++)
+                {
+                    auto start = BenchmarkClock::now();
+                    engine.drawFrame();
+                    const double ms = elapsedMs(start);
+
+                    if (frame < INSTANCING_WARMUP_FRAMES) {
+                        continue;
+                    }
+
+                    const FrameTimings& timings = engine.getFrameTimings();
+                    result.cpuMs += ms;
+                    result.recordMs += timings.record;
+                    if (timings.gpu >= 0.0) {
+                        gpuSum += timings.gpu;
+                        gpuSamples++;
+                    }
+                }
+
+                result.cpuMs /= INSTANCING_MEASURED_FRAMES;
+                result.recordMs /= INSTANCING_MEASURED_FRAMES;
+                if (gpuSamples > 0) {
+                    result.gpuMs = gpuSum / gpuSamples;
+                }
+
+                return result;
+            }
+
+            void printResult(uint32_t count, const char* mode, uint32_t draws, const InstancingResult& result, double baselineCpuMs)
+            {
+                const double trianglesPerSecond = (result.gpuMs > 0.0) ? static_cast<double>(count) * CUBE_TRIANGLES / result.gpuMs / 1000.0 : 0.0;
+                printf("[instancing] %10u %-16s %10u %10.3f %10.3f %10.3f %10.1f %9.2fx\n",
+                    count, mode, draws, result.cpuMs, result.recordMs, result.gpuMs, trianglesPerSecond, baselineCpuMs / result.cpuMs);
+            }
+        }
+
+        int runInstancingBenchmark(const std::vector<std::string>& args)
+        {
+            const uint32_t maxCount = (args.size() > 0) ? static_cast<uint32_t>(std::stoul(args[0])) : 1000000;
+            const uint32_t maxPerObjectCount = (args.size() > 1) ? static_cast<uint32_t>(std::stoul(args[1])) : 100000;
+
+            cameraEngine engine(executablePath());
+            engine.setHeadless(true, 0);
+            engine.init();
+            engine.prepare();
+
+            printf("[instancing] %s, %u warm-up + %u measured frames per row\n",
+                engine.getDevice()->properties.deviceName, INSTANCING_WARMUP_FRAMES, INSTANCING_MEASURED_FRAMES);
+            printf("[instancing] %10s %-16s %10s %10s %10s %10s %10s %10s\n", "objects", "mode", "draws", "cpu ms", "record ms", "gpu ms", "Mtris/s", "speedup");
+
+            for (uint64_t rowCount = 1000; rowCount <= maxCount; rowCount *= 10)
+            {
+                const uint32_t count = static_cast<uint32_t>(rowCount);
+
+                // 오브젝트마다 draw를 기록하는 기존 방식이 기준 -> 너무 많으면 인스턴싱만 잽니다.
+                double baselineCpuMs = 0.0;
+                if (count <= maxPerObjectCount) {
+                    const InstancingResult perObject = measure(engine, count, false);
+                    baselineCpuMs = perObject.cpuMs;
+                    printResult(count, "draw per object", count, perObject, baselineCpuMs);
+                }
+
+                const InstancingResult instanced = measure(engine, count, true);
+                printResult(count, "instanced", 1, instanced, baselineCpuMs > 0.0 ? baselineCpuMs : instanced.cpuMs);
+            }
+
+            vkDeviceWaitIdle(engine.getDevice()->VKdevice);
+            engine.cleanup();
+
+            return EXIT_SUCCESS;
+        }
+    }
+}
@@ -0,0 +1,137 @@
+﻿#include "Benchmark.h"
+#include "../engine/VKjobSystem.h"
+
+#include <cmath>
+
+namespace vkengine {
+    namespace benchmark {
+
+        namespace {
+
+            constexpr uint32_t EMPTY_JOB_BATCH = 4000;          // 한 번에 만드는 빈 작업 수 (< JOB_POOL_SIZE)
+            constexpr uint32_t EMPTY_JOB_ROUNDS = 250;
+            constexpr uint32_t CHAIN_LENGTH = 2000;             // 의존성 체인 길이 (< JOB_POOL_SIZE)
+            constexpr uint32_t PARALLEL_FOR_COUNT = 1u << 20;
+            constexpr uint32_t PARALLEL_FOR_GRAIN = 2048;
+            constexpr uint32_t PARALLEL_FOR_ROUNDS = 10;
+
+            // 원소 하나당 적당한 양의 계산 -> 메모리 대역폭이 아니라 스케줄링/계산 확장성을 봅니다.
+            float workload(uint32_t index)
+            {
+                float value = static_cast<float>(index) * 0.001f;
+                for (int i = 0; i < 64; i++)
+                {
+                    value = std::sin(value) * 0.5f + std::sqrt(value + 1.0f);
+                }
+                return value;
+            }
+
+            // 빈 작업을 root의 자식으로 만들어 실행 -> 작업 하나당 생성/큐/실행/완료 비용
+            double measureEmptyJobs(job::VKJobSystem& jobSystem)
+            {
+                auto start = BenchmarkClock::now();
+
+                for (uint32_t round = 0; round < EMPTY_JOB_ROUNDS; round++)
+                {
+                    job::VKJob* root = jobSystem.createJob(nullptr);
+                    for (uint32_t i = 0; i < EMPTY_JOB_BATCH; i++)
+                    {
+                        jobSystem.run(jobSystem.createChildJob(root, []() {}));
+                    }
+                    jobSystem.run(root);
+                    jobSystem.wait(root);
+                }
+
+                const double totalJobs = static_cast<double>(EMPTY_JOB_BATCH) * EMPTY_JOB_ROUNDS;
+                return elapsedMs(start) * 1.0e6 / totalJobs;     // ns / job
+            }
+
+            // 앞 작업이 끝나야 다음 작업이 큐에 들어가는 체인 -> 의존성 해제 지연
+            double measureDependencyChain(job::VKJobSystem& jobSystem)
+            {
+                std::vector<job::VKJob*> chain(CHAIN_LENGTH);
+                for (uint32_t i = 0; i < CHAIN_LENGTH; i++)
+                {
+                    chain[i] = jobSystem.createJob([]() {});
+                    if (i > 0) {
+                        jobSystem.addDependency(chain[i], chain[i - 1]);
+                    }
+                }
+
+                auto start = BenchmarkClock::now();
+
+                // 뒤에서부터 제출해도 앞 작업이 끝나기 전에는 실행되지 않습니다.
+                for (uint32_t i = CHAIN_LENGTH; i > 0; i--)
+                {
+                    jobSystem.run(chain[i - 1]);
+                }
+                jobSystem.wait(chain.back());
+
+                return elapsedMs(start) * 1.0e6 / CHAIN_LENGTH;  // ns / hop
+            }
+
+            double measureParallelFor(job::VKJobSystem& jobSystem, std::vector<float>& output)
+            {
+                auto start = BenchmarkClock::now();
+
+                for (uint32_t round = 0; round < PARALLEL_FOR_ROUNDS; round++)
+                {
+                    jobSystem.parallelFor(PARALLEL_FOR_COUNT, PARALLEL_FOR_GRAIN, [&output](uint32_t begin, uint32_t end) {
+                        for (uint32_t i = begin; i < end; i++)
+                        {
+                            output[i] = workload(i);
+                        }
+                    });
+                }
+
+                return elapsedMs(start) / PARALLEL_FOR_ROUNDS;   // ms / round
+            }
+        }
+
+        int runJobBenchmark(const std::vector<std::string>&)
+        {
+            const uint32_t maxThreads = std::max(1u, std::thread::hardware_concurrency());
+            std::vector<float> output(PARALLEL_FOR_COUNT);
+
+            // 스레드 하나로 직접 돌린 기준 시간
+            auto start = BenchmarkClock::now();
+            for (uint32_t round = 0; round < PARALLEL_FOR_ROUNDS; round++)
+            {
+                for (uint32_t i = 0; i < PARALLEL_FOR_COUNT; i++)
+                {
+                    output[i] = workload(i);
+                }
+            }
+            const double serialMs = elapsedMs(start) / PARALLEL_FOR_ROUNDS;
+            const float reference = output[PARALLEL_FOR_COUNT - 1];
+
+            printf("[job] hardware threads : %u\n", maxThreads);
+            printf("[job] serial loop      : %.3f ms (%u elements)\n", serialMs, PARALLEL_FOR_COUNT);
+            printf("[job] %8s %14s %14s %16s %10s %10s\n", "threads", "empty ns/job", "chain ns/hop", "parallelFor ms", "speedup", "efficiency");
+
+            for (uint32_t threadCount : threadCountSteps(maxThreads))
+            {
+                job::VKJobSystem jobSystem(threadCount);
+
+                const double emptyNs = measureEmptyJobs(jobSystem);
+                const double chainNs = measureDependencyChain(jobSystem);
+
+                std::fill(output.begin(), output.end(), 0.0f);
+                const double parallelMs = measureParallelFor(jobSystem, output);
+
+                if (output[PARALLEL_FOR_COUNT - 1] != reference) {
+                    printf("[job] parallelFor result mismatch with %u threads\n", threadCount);
+                    return EXIT_FAILURE;
+                }
+
+                const double speedup = serialMs / parallelMs;
+                printf("[job] %8u %14.1f %14.1f %16.3f %9.2fx %9.1f%%\n",
+                    threadCount, emptyNs, chainNs, parallelMs, speedup, speedup / threadCount * 100.0);
+
+                jobSystem.cleanup();
+            }
+
+            return EXIT_SUCCESS;
+        }
+    }
+}
@@ -0,0 +1,199 @@
+﻿#include "Benchmark.h"
+#include "../engine/VKvertexDedup.h"
+#include "../engine/VKmeshOptimizer.h"
+#include "../engine/VKmeshlet.h"
+
+namespace vkengine {
+    namespace benchmark {
+
+        namespace {
+
+            constexpr uint32_t MESHLET_ROUNDS = 3;
+            constexpr uint32_t CULL_ROUNDS = 100;
+
+            // 컬링된 메시렛의 삼각형은 모두 카메라 반대를 보거나 한 평면 바깥에 있어야 합니다.
+            // -> 컬러가 보이는 삼각형을 버리지 않는지(보수적인지) 확인합니다.
+            bool verifyCulling(
+                const std::vector<Vertex>& vertices,
+                const std::vector<uint32_t>& indices,
+                const asset::VKMeshletData& data,
+                const glm::mat4& viewProjection,
+                const glm::vec3& cameraPosition,
+                const std::vector<uint32_t>& visible)
+            {
+                std::vector<bool> isVisible(data.meshlets.size(), false);
+                for (uint32_t index : visible)
+                {
+                    isVisible[index] = true;
+                }
+
+                auto outsideSamePlane = [&viewProjection](const glm::vec3& p0, const glm::vec3& p1, const glm::vec3& p2) {
+                    const glm::vec4 c0 = viewProjection * glm::vec4(p0, 1.0f);
+                    const glm::vec4 c1 = viewProjection * glm::vec4(p1, 1.0f);
+                    const glm::vec4 c2 = viewProjection * glm::vec4(p2, 1.0f);
+
+                    for (int axis = 0; axis < 2; axis++)
+                    {
+                        if (c0[axis] > c0.w && c1[axis] > c1.w && c2[axis] > c2.w) return true;
+                        if (c0[axis] < -c0.w && c1[axis] < -c1.w && c2[axis] < -c2.w) return true;
+                    }
+                    if (c0.z < 0.0f && c1.z < 0.0f && c2.z < 0.0f) return true;
+                    if (c0.z > c0.w && c1.z > c1.w && c2.z > c2.w) return true;
+                    return false;
+                };
+
+                for (uint32_t m = 0; m < static_cast<uint32_t>(data.meshlets.size()); m++)
+                {
+                    if (isVisible[m]) {
+                        continue;
+                    }
+
+                    const asset::VKMeshlet& meshlet = data.meshlets[m];
+                    for (uint32_t t = 0; t < meshlet.triangleCount; t++)
+                    {
+                        const glm::vec3& p0 = vertices[indices[meshlet.indexOffset + t * 3 + 0]].pos;
+                        const glm::vec3& p1 = vertices[indices[meshlet.indexOffset + t * 3 + 1]].pos;
+                        const glm::vec3& p2 = vertices[indices[meshlet.indexOffset + t * 3 + 2]].pos;
+
+                        const bool backFacing = glm::dot(glm::cross(p1 - p0, p2 - p0), p0 - cameraPosition) >= 0.0f;
+                        if (!backFacing && !outsideSamePlane(p0, p1, p2)) {
+                            return false;
+                        }
+                    }
+                }
+
+                return true;
+            }
+
+            int runMesh(const char* name, const std::vector<Vertex>& corners)
+            {
+                // Application::loadModel과 같은 순서로 중복 제거 -> 최적화
+                std::vector<Vertex> vertices;
+                std::vector<uint32_t> indices;
+                asset::VKVertexDeduplicator deduplicator;
+                deduplicator.deduplicate(corners.data(), static_cast<uint32_t>(corners.size()), vertices, indices);
+                asset::optimizeMesh(vertices, indices);
+
+                const uint32_t vertexCount = static_cast<uint32_t>(vertices.size());
+                const uint32_t indexCount = static_cast<uint32_t>(indices.size());
+
+                asset::VKMeshletData data;
+                double buildMs = 1.0e30;
+                for (uint32_t round = 0; round < MESHLET_ROUNDS; round++)
+                {
+                    auto start = BenchmarkClock::now();
+                    asset::buildMeshlets(vertices.data(), vertexCount, indices.data(), indexCount, data);
+                    buildMs = std::min(buildMs, elapsedMs(start));
+                }
+
+                auto validateStart = BenchmarkClock::now();
+                const bool valid = asset::validateMeshlets(data, indices.data(), indexCount, vertexCount);
+                const double validateMs = elapsedMs(validateStart);
+
+                if (!valid) {
+                    printf("[meshlet] %s: coverage check failed\n", name);
+                    return EXIT_FAILURE;
+                }
+
+                // 검증이 실제로 빠진 삼각형을 잡아내는지도 확인합니다.
+                if (!data.meshlets.empty()) {
+                    asset::VKMeshletData broken = data;
+                    broken.meshlets.pop_back();
+                    if (asset::validateMeshlets(broken, indices.data(), indexCount, vertexCount)) {
+                        printf("[meshlet] %s: coverage check missed dropped triangles\n", name);
+                        return EXIT_FAILURE;
+                    }
+                }
+
+                double averageVertices = 0.0;
+                double averageTriangles = 0.0;
+                for (const asset::VKMeshlet& meshlet : data.meshlets)
+                {
+                    averageVertices += meshlet.vertexCount;
+                    averageTriangles += meshlet.triangleCount;
+                }
+                if (!data.meshlets.empty()) {
+                    averageVertices /= data.meshlets.size();
+                    averageTriangles /= data.meshlets.size();
+                }
+
+                printf("[meshlet] %s: %u triangles -> %zu meshlets (avg %.1f vertices, %.1f triangles)\n",
+                    name, indexCount / 3, data.meshlets.size(), averageVertices, averageTriangles);
+                printf("[meshlet] build %.3f ms, validate %.3f ms\n", buildMs, validateMs);
+
+                // 바운딩 구 주위의 여러 방향에서 메시 중심을 바라봅니다.
+                glm::vec3 boundsMin = vertices[0].pos;
+                glm::vec3 boundsMax = boundsMin;
+                for (const Vertex& vertex : vertices)
+                {
+                    boundsMin = glm::min(boundsMin, vertex.pos);
+                    boundsMax = glm::max(boundsMax, vertex.pos);
+                }
+                const glm::vec3 center = (boundsMin + boundsMax) * 0.5f;
+                const float radius = std::max(glm::length(boundsMax - center), 1.0e-3f);
+
+                const glm::vec3 directions[] = {
+                    { 1.0f, 0.0f, 0.0f }, { -1.0f, 0.0f, 0.0f },
+                    { 0.0f, 1.0f, 0.0f }, { 0.0f, -1.0f, 0.0f },
+                    { 0.0f, 0.0f, 1.0f }, { 0.0f, 0.0f, -1.0f },
+                    { 1.0f, 1.0f, 1.0f }, { -0.3f, 0.2f, 0.1f },
+                };
+
+                printf("[meshlet] %-24s %10s %10s %10s\n", "view", "visible", "us/cull", "draws");
+
+                std::vector<uint32_t> visible;
+                std::vector<asset::VKMeshletDraw> draws;
+                for (const glm::vec3& direction : directions)
+                {
+                    const glm::vec3 eye = center + glm::normalize(direction) * radius * 1.5f;
+                    const glm::vec3 up = (std::abs(glm::normalize(direction).z) > 0.99f) ? glm::vec3(0.0f, 1.0f, 0.0f) : glm::vec3(0.0f, 0.0f, 1.0f);
+
+                    glm::mat4 proj = glm::perspective(glm::radians(45.0f), 16.0f / 9.0f, 0.1f, radius * 4.0f);
+                    proj[1][1] *= -1;
+                    const glm::mat4 viewProjection = proj * glm::lookAt(eye, center, up);
+
+                    auto start = BenchmarkClock::now();
+                    for (uint32_t round = 0; round < CULL_ROUNDS; round++)
+                    {
+                        asset::cullMeshlets(data.meshlets.data(), static_cast<uint32_t>(data.meshlets.size()), viewProjection, eye, visible);
+                    }
+                    const double cullUs = elapsedMs(start) * 1000.0 / CULL_ROUNDS;
+
+                    if (!verifyCulling(vertices, indices, data, viewProjection, eye, visible)) {
+                        printf("[meshlet] %s: visible triangle culled (view %.1f %.1f %.1f)\n", name, direction.x, direction.y, direction.z);
+                        return EXIT_FAILURE;
+                    }
+
+                    // 이어지는 메시렛을 합친 draw 수 (메시렛마다 draw하면 visible 수만큼)
+                    asset::mergeMeshletDraws(data.meshlets.data(), static_cast<uint32_t>(data.meshlets.size()), visible, static_cast<uint32_t>(indices.size()), draws);
+
+                    char label[48];
+                    snprintf(label, sizeof(label), "(%.1f, %.1f, %.1f)", direction.x, direction.y, direction.z);
+                    printf("[meshlet] %-24s %9.1f%% %10.2f %10zu\n", label, 100.0 * visible.size() / std::max<size_t>(1, data.meshlets.size()), cullUs, draws.size());
+                }
+
+                return EXIT_SUCCESS;
+            }
+        }
+
+        int runMeshletBenchmark(const std::vector<std::string>& args)
+        {
+            const std::string objPath = (args.size() > 0) ? args[0] : "viking_room.obj";
+            const uint32_t gridSize = (args.size() > 1) ? static_cast<uint32_t>(std::stoul(args[1])) : 512;
+
+            std::vector<Vertex> corners;
+
+            if (loadObjCorners(objPath, corners)) {
+                if (runMesh(objPath.c_str(), corners) != EXIT_SUCCESS) {
+                    return EXIT_FAILURE;
+                }
+            }
+            else {
+                printf("[meshlet] %s not found, skipping OBJ mesh\n", objPath.c_str());
+            }
+
+            buildGridCorners(gridSize, corners);
+            return runMesh("synthetic grid", corners);
+        }
+    }
+}
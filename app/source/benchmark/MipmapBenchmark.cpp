@@ -0,0 +1,107 @@
+﻿#include "Benchmark.h"
+#include "../engine/VKmipmap.h"
+
+namespace vkengine {
+    namespace benchmark {
+
+        namespace {
+            constexpr uint32_t MIPMAP_ROUNDS = 3;
+            constexpr int MIPMAP_MAX_ERROR = 1;                     // 표 기반 sRGB 변환 때문에 한 단계까지는 허용
+
+            // 그라디언트 + 가는 줄무늬 + 잡음 (필터 차이가 드러나도록 고주파 성분을 섞음)
+            void buildTestImage(uint32_t size, std::vector<uint8_t>& pixels)
+            {
+                pixels.resize(static_cast<size_t>(size) * size * 4);
+
+                uint32_t seed = 12345;
+                for (uint32_t y = 0; y < size; y++)
+                {
+                    for (uint32_t x = 0; x < size; x++)
+                    {
+                        seed = seed * 1664525u + 1013904223u;
+                        const uint8_t noise = static_cast<uint8_t>(seed >> 27);
+                        uint8_t* texel = pixels.data() + (static_cast<size_t>(y) * size + x) * 4;
+
+                        texel[0] = static_cast<uint8_t>((x * 255) / size);
+                        texel[1] = static_cast<uint8_t>(((x / 3 + y / 5) & 1) ? 230 : 20);
+                        texel[2] = static_cast<uint8_t>(((y * 255) / size) ^ noise);
+                        texel[3] = static_cast<uint8_t>(255 - (x + y) * 128 / size);
+                    }
+                }
+            }
+
+            int maxDifference(const std::vector<uint8_t>& a, const std::vector<uint8_t>& b)
+            {
+                int difference = 0;
+                for (size_t i = 0; i < a.size(); i++)
+                {
+                    difference = std::max(difference, std::abs(static_cast<int>(a[i]) - static_cast<int>(b[i])));
+                }
+                return difference;
+            }
+
+            int runFilter(const char* name, asset::VKMipFilter filter, const std::vector<uint8_t>& source, uint32_t size)
+            {
+                const uint32_t dstSize = std::max(1u, size / 2);
+                const double texels = static_cast<double>(size) * size;
+                const uint32_t maxThreads = std::max(1u, std::thread::hardware_concurrency());
+
+                std::vector<uint8_t> expected(static_cast<size_t>(dstSize) * dstSize * 4);
+                std::vector<uint8_t> result(expected.size());
+
+                // 스칼라 기준 구현은 느리므로 한 번만 잽니다.
+                auto start = BenchmarkClock::now();
+                asset::downsampleRGBA8Reference(source.data(), size, size, expected.data(), filter);
+                const double referenceMs = elapsedMs(start);
+
+                printf("[mipmap] %s: %ux%u -> %ux%u (%s)\n", name, size, size, dstSize, dstSize, asset::getMipSimdName());
+                printf("[mipmap] %-22s %10s %12s %10s\n", "method", "ms", "Mtexels/s", "speedup");
+                printf("[mipmap] %-22s %10.3f %12.2f %9.2fx\n", "scalar reference", referenceMs, texels / referenceMs / 1000.0, 1.0);
+
+                auto measure = [&](const char* label, job::VKJobSystem* jobSystem) {
+                    const double ms = measureBestMs(MIPMAP_ROUNDS, [&]() {
+                        asset::downsampleRGBA8(source.data(), size, size, result.data(), filter, jobSystem);
+                    });
+
+                    const int difference = maxDifference(expected, result);
+                    if (difference > MIPMAP_MAX_ERROR) {
+                        printf("[mipmap] %s differs from reference by %d\n", label, difference);
+                        return false;
+                    }
+
+                    printf("[mipmap] %-22s %10.3f %12.2f %9.2fx\n", label, ms, texels / ms / 1000.0, referenceMs / ms);
+                    return true;
+                };
+
+                if (!measure("simd", nullptr) || !measureJobThreads("simd", measure)) {
+                    return EXIT_FAILURE;
+                }
+
+                // 변환 도구와 같은 전체 mip 체인 (1x1까지)
+                job::VKJobSystem jobSystem(maxThreads);
+                size_t levelCount = 0;
+                const double chainMs = measureBestMs(MIPMAP_ROUNDS, [&]() {
+                    levelCount = asset::generateMipLevels(source.data(), size, size, filter, &jobSystem).size();
+                });
+                jobSystem.cleanup();
+
+                printf("[mipmap] full chain (%zu levels, x%u threads): %.3f ms\n", levelCount, maxThreads, chainMs);
+
+                return EXIT_SUCCESS;
+            }
+        }
+
+        int runMipmapBenchmark(const std::vector<std::string>& args)
+        {
+            const uint32_t size = (args.size() > 0) ? static_cast<uint32_t>(std::stoul(args[0])) : 2048;
+
+            std::vector<uint8_t> source;
+            buildTestImage(size, source);
+
+            if (runFilter("box", asset::VKMipFilter::Box, source, size) != EXIT_SUCCESS) {
+                return EXIT_FAILURE;
+            }
+            return runFilter("kaiser", asset::VKMipFilter::Kaiser, source, size);
+        }
+    }
+}
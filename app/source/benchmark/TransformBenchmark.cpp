@@ -0,0 +1,165 @@
+﻿#include "Benchmark.h"
+#include "../engine/VKtransform.h"
+
+#include <cmath>
+
+namespace vkengine {
+    namespace benchmark {
+
+        namespace {
+            constexpr uint32_t TRANSFORM_ROOT_COUNT = 64;           // 장면 루트 수 (나머지 노드는 앞에 만든 노드 중 하나가 부모)
+            constexpr float TRANSFORM_MOVED_FRACTION = 0.01f;       // 부분 갱신에서 프레임마다 움직이는 노드 비율
+            constexpr float TRANSFORM_EPSILON = 1e-4f;              // glm 곱셈과 더하는 순서가 달라 생기는 오차 (상대)
+
+            struct TransformRandom {
+                uint32_t seed = 12345;
+
+                float next()
+                {
+                    this->seed = this->seed * 1664525u + 1013904223u;
+                    return static_cast<float>(this->seed >> 8) / static_cast<float>(1u << 24);
+                }
+
+                float signedNext() { return this->next() * 2.0f - 1.0f; }
+            };
+
+            // 작은 이동 + 회전 + 1 근처의 크기 -> 깊은 노드에서도 값이 발산하지 않습니다.
+            glm::mat4 randomLocal(TransformRandom& random)
+            {
+                glm::mat4 local = glm::translate(glm::mat4(1.0f), glm::vec3(random.signedNext(), random.signedNext(), random.signedNext()) * 2.0f);
+                local = glm::rotate(local, random.signedNext() * 3.14159265f, glm::vec3(random.signedNext(), random.signedNext(), 1.0f));
+                return glm::scale(local, glm::vec3(0.9f + random.next() * 0.2f));
+            }
+
+            // 노드 번호 순서로 glm 곱셈 (부모 번호가 항상 더 작음)
+            void computeReference(const VKTransformHierarchy& hierarchy, std::vector<glm::mat4>& worlds)
+            {
+                worlds.resize(hierarchy.getCount());
+                for (uint32_t node = 0; node < hierarchy.getCount(); node++)
+                {
+                    const uint32_t parent = hierarchy.getParent(node);
+                    worlds[node] = (parent != TRANSFORM_NONE) ? worlds[parent] * hierarchy.getLocal(node) : hierarchy.getLocal(node);
+                }
+            }
+
+            bool matchesReference(const VKTransformHierarchy& hierarchy, const std::vector<glm::mat4>& worlds)
+            {
+                for (uint32_t node = 0; node < hierarchy.getCount(); node++)
+                {
+                    const glm::mat4& world = hierarchy.getWorld(node);
+                    for (int c = 0; c < 4; c++)
+                    {
+                        for (int r = 0; r < 4; r++)
+                        {
+                            const float expected = worlds[node][c][r];
+                            if (std::fabs(world[c][r] - expected) > TRANSFORM_EPSILON * std::max(1.0f, std::fabs(expected))) {
+                                printf("[transform] node %u differs from reference\n", node);
+                                return false;
+                            }
+                        }
+                    }
+                }
+                return true;
+            }
+
+            void printRow(const char* label, double ms, uint32_t changed)
+            {
+                printf("[transform] %-22s %10.3f %12.2f %10u %12.1f\n", label, ms, changed / std::max(ms, 1.0e-6) / 1000.0, changed,
+                    changed * sizeof(InstanceData) / 1024.0);
+            }
+
+            int runHierarchy(uint32_t count)
+            {
+                const uint32_t rounds = (count >= 1000000) ? 3 : 10;
+
+                TransformRandom random;
+                VKTransformHierarchy hierarchy;
+                hierarchy.reserve(count);
+                for (uint32_t node = 0; node < count; node++)
+                {
+                    const uint32_t parent = (node < TRANSFORM_ROOT_COUNT) ? TRANSFORM_NONE : static_cast<uint32_t>(random.next() * node) % node;
+                    hierarchy.createNode(parent, randomLocal(random));
+                }
+
+                // 첫 update는 깊이 순서 정렬을 포함합니다.
+                auto start = BenchmarkClock::now();
+                hierarchy.update();
+                const double firstMs = elapsedMs(start);
+
+                std::vector<glm::mat4> reference;
+                const double referenceMs = measureBestMs(rounds, [&]() { computeReference(hierarchy, reference); });
+                if (!matchesReference(hierarchy, reference)) {
+                    return EXIT_FAILURE;
+                }
+
+                printf("[transform] %u nodes (%s)\n", count, getTransformSimdName());
+                printf("[transform] %-22s %10s %12s %10s %12s\n", "method", "ms", "Mnodes/s", "changed", "upload KB");
+                printRow("glm reference (all)", referenceMs, count);
+                printRow("first update + sort", firstMs, count);
+
+                // 루트를 모두 움직이면 모든 노드가 바뀝니다.
+                auto moveRoots = [&]() {
+                    for (uint32_t root = 0; root < std::min(count, TRANSFORM_ROOT_COUNT); root++)
+                    {
+                        hierarchy.setLocal(root, randomLocal(random));
+                    }
+                };
+                auto measureAll = [&](const char* label, job::VKJobSystem* jobSystem) {
+                    uint32_t changed = 0;
+                    const double ms = measureBestMs(rounds, moveRoots, [&]() { changed = hierarchy.update(jobSystem); });
+
+                    computeReference(hierarchy, reference);
+                    if (changed != count || !matchesReference(hierarchy, reference)) {
+                        printf("[transform] %s differs from reference\n", label);
+                        return false;
+                    }
+
+                    printRow(label, ms, changed);
+                    return true;
+                };
+
+                if (!measureAll("all dirty", nullptr) || !measureJobThreads("all dirty", measureAll)) {
+                    return EXIT_FAILURE;
+                }
+
+                // 일부 노드만 움직이면 그 하위 트리만 다시 계산합니다.
+                const uint32_t movedCount = std::max(1u, static_cast<uint32_t>(count * TRANSFORM_MOVED_FRACTION));
+                auto moveNodes = [&]() {
+                    for (uint32_t i = 0; i < movedCount; i++)
+                    {
+                        hierarchy.setLocal(static_cast<uint32_t>(random.next() * count) % count, randomLocal(random));
+                    }
+                };
+                uint32_t movedChanged = 0;
+                const double movedMs = measureBestMs(rounds, moveNodes, [&]() { movedChanged = hierarchy.update(); });
+
+                computeReference(hierarchy, reference);
+                if (!matchesReference(hierarchy, reference)) {
+                    return EXIT_FAILURE;
+                }
+                printRow("1% moved", movedMs, movedChanged);
+
+                // 움직이지 않는 장면 -> 계산도 업로드도 없습니다.
+                start = BenchmarkClock::now();
+                const uint32_t staticChanged = hierarchy.update();
+                printRow("static", elapsedMs(start), staticChanged);
+
+                return (staticChanged == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+            }
+        }
+
+        int runTransformBenchmark(const std::vector<std::string>& args)
+        {
+            const uint32_t maxCount = (args.size() > 0) ? static_cast<uint32_t>(std::stoul(args[0])) : 1000000;
+
+            for (uint64_t rowCount = 1000; rowCount <= maxCount; rowCount *= 10)
+            {
+                if (runHierarchy(static_cast<uint32_t>(rowCount)) != EXIT_SUCCESS) {
+                    return EXIT_FAILURE;
+                }
+            }
+
+            return EXIT_SUCCESS;
+        }
+    }
+}
@@ -147,6 +147,32 @@ namespace vkengine {
             projectionMatrix[1][1] *= -1.f;
         }
 
+        std::array<glm::vec4, 6> Camera::getFrustumPlanes() const
+        {
+            // Gribb-Hartmann: Ŭ ǥ -w <= x, y <= w, 0 <= z <= w    Ǯ ϴ.
+            const glm::mat4 m = this->projectionMatrix * this->viewMatrix;
+            const glm::vec4 row0(m[0][0], m[1][0], m[2][0], m[3][0]);
+            const glm::vec4 row1(m[0][1], m[1][1], m[2][1], m[3][1]);
+            const glm::vec4 row2(m[0][2], m[1][2], m[2][2], m[3][2]);
+            const glm::vec4 row3(m[0][3], m[1][3], m[2][3], m[3][3]);
+
+            std::array<glm::vec4, 6> planes = {
+                row3 + row0,
+                row3 - row0,
+                row3 + row1,
+                row3 - row1,
+                row2,
+                row3 - row2,
+            };
+
+            for (glm::vec4& plane : planes)
+            {
+                plane = plane / glm::length(glm::vec3(plane));
+            }
+
+            return planes;
+        }
+
         void Camera::setViewDirection(glm::vec3 pos, glm::vec3 dir, glm::vec3 up)
         {
             const glm::vec3 w{ glm::normalize(dir) };
@@ -29,6 +29,10 @@ namespace vkengine {
             const glm::mat4& getProjectionMatrix() { return this->projectionMatrix; }
             const glm::mat4& getViewMatrix() { return this->viewMatrix; }
 
+            // 투영 * 뷰 행렬에서 절두체 평면 6개 (왼, 오, 아래, 위, 가까운, 먼)를 뽑습니다. (깊이 범위 [0, 1])
+            // xyz는 안쪽을 향하는 단위 법선, w는 거리 -> dot(plane.xyz, p) + plane.w >= 0 이면 p는 평면 안쪽
+            std::array<glm::vec4, 6> getFrustumPlanes() const;
+
             void setViewDirection(glm::vec3 pos, glm::vec3 dir, glm::vec3 up = glm::vec3(0.f, 1.f, 0.f));
             void setViewTarget(glm::vec3 pos, glm::vec3 target, glm::vec3 up = glm::vec3(0.f, 1.f, 0.f));
             void setViewXYZ(glm::vec3 pos, glm::vec3 rot);
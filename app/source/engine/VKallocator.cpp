@@ -0,0 +1,463 @@
+﻿#include "VKallocator.h"
+
+namespace vkengine {
+    namespace memory {
+
+        static VkDeviceSize alignUp(VkDeviceSize value, VkDeviceSize alignment)
+        {
+            return (value + alignment - 1) & ~(alignment - 1);
+        }
+
+        // 블록 안에서 first-fit으로 정렬된 구간을 찾습니다.
+        static bool allocateFromBlock(VKMemoryBlock* block, VkDeviceSize size, VkDeviceSize alignment, VkDeviceSize& outOffset)
+        {
+            for (auto it = block->freeRanges.begin(); it != block->freeRanges.end(); ++it)
+            {
+                const VkDeviceSize rangeOffset = it->first;
+                const VkDeviceSize rangeSize = it->second;
+                const VkDeviceSize alignedOffset = alignUp(rangeOffset, alignment);
+                const VkDeviceSize padding = alignedOffset - rangeOffset;
+
+                if (padding + size > rangeSize) {
+                    continue;
+                }
+
+                block->freeRanges.erase(it);
+
+                // 정렬 때문에 앞에 남는 공간과 뒤에 남는 공간을 다시 빈 구간으로 돌려놓습니다.
+                if (padding > 0) {
+                    block->freeRanges.emplace(rangeOffset, padding);
+                }
+
+                const VkDeviceSize remain = rangeSize - padding - size;
+                if (remain > 0) {
+                    block->freeRanges.emplace(alignedOffset + size, remain);
+                }
+
+                outOffset = alignedOffset;
+                return true;
+            }
+
+            return false;
+        }
+
+        // 반환된 구간을 넣고 앞뒤 빈 구간과 병합합니다.
+        static void releaseToBlock(VKMemoryBlock* block, VkDeviceSize offset, VkDeviceSize size)
+        {
+            auto next = block->freeRanges.lower_bound(offset);
+
+            if (next != block->freeRanges.begin()) {
+                auto prev = std::prev(next);
+                if (prev->first + prev->second == offset) {
+                    offset = prev->first;
+                    size += prev->second;
+                    block->freeRanges.erase(prev);
+                }
+            }
+
+            if (next != block->freeRanges.end() && offset + size == next->first) {
+                size += next->second;
+                block->freeRanges.erase(next);
+            }
+
+            block->freeRanges.emplace(offset, size);
+        }
+
+        VKMemoryAllocator::VKMemoryAllocator(VkPhysicalDevice physicalDevice, VkDevice device, VkDeviceSize preferredBlockSize)
+        {
+            assert(physicalDevice);
+            assert(device);
+
+            this->VKphysicalDevice = physicalDevice;
+            this->VKdevice = device;
+            this->preferredBlockSize = preferredBlockSize;
+
+            vkGetPhysicalDeviceMemoryProperties(this->VKphysicalDevice, &this->memoryProperties);
+
+            for (uint32_t i = 0; i < static_cast<uint32_t>(this->pools.size()); i++)
+            {
+                this->pools[i].memoryTypeIndex = i / 2;
+                this->pools[i].linear = (i % 2) == 0;
+            }
+        }
+
+        VKMemoryAllocator::~VKMemoryAllocator()
+        {
+            this->cleanup();
+        }
+
+        VkResult VKMemoryAllocator::allocate(const VkMemoryRequirements& requirements, VkMemoryPropertyFlags properties, bool linear, VKAllocation& allocation)
+        {
+            std::lock_guard<std::mutex> lock(this->allocatorMutex);
+
+            const uint32_t memoryTypeIndex = this->findMemoryType(requirements.memoryTypeBits, properties);
+            const VkDeviceSize blockSize = this->getBlockSize(memoryTypeIndex);
+
+            // 블록의 절반을 넘는 큰 리소스는 전용 할당으로 처리합니다.
+            if (requirements.size > blockSize / 2) {
+                return this->allocateDedicated(requirements, memoryTypeIndex, allocation);
+            }
+
+            VKMemoryPool& pool = this->pools[memoryTypeIndex * 2 + (linear ? 0 : 1)];
+            const VkDeviceSize alignment = std::max<VkDeviceSize>(requirements.alignment, 1);
+
+            VKMemoryBlock* target = nullptr;
+            VkDeviceSize offset = 0;
+
+            for (auto& block : pool.blocks)
+            {
+                if (block->size - block->usedBytes < requirements.size) {
+                    continue;
+                }
+
+                if (allocateFromBlock(block.get(), requirements.size, alignment, offset)) {
+                    target = block.get();
+                    break;
+                }
+            }
+
+            // 기존 블록에 자리가 없으면 새 블록을 만듭니다.
+            if (target == nullptr)
+            {
+                target = this->createBlock(pool, blockSize);
+
+                if (target == nullptr) {
+                    return VK_ERROR_OUT_OF_DEVICE_MEMORY;
+                }
+
+                if (!allocateFromBlock(target, requirements.size, alignment, offset)) {
+                    return VK_ERROR_OUT_OF_DEVICE_MEMORY;
+                }
+            }
+
+            target->usedBytes += requirements.size;
+            target->allocationCount++;
+
+            allocation.memory = target->memory;
+            allocation.offset = offset;
+            allocation.size = requirements.size;
+            allocation.memoryTypeIndex = memoryTypeIndex;
+            allocation.mapped = target->mapped ? static_cast<char*>(target->mapped) + offset : nullptr;
+            allocation.block = target;
+
+            return VK_SUCCESS;
+        }
+
+        void VKMemoryAllocator::free(VKAllocation& allocation)
+        {
+            if (!allocation.isValid()) {
+                return;
+            }
+
+            std::lock_guard<std::mutex> lock(this->allocatorMutex);
+
+            const uint32_t heapIndex = this->memoryProperties.memoryTypes[allocation.memoryTypeIndex].heapIndex;
+
+            if (allocation.block == nullptr)
+            {
+                // 전용 할당은 바로 해제합니다.
+                if (allocation.mapped) {
+                    vkUnmapMemory(this->VKdevice, allocation.memory);
+                }
+                vkFreeMemory(this->VKdevice, allocation.memory, nullptr);
+                this->dedicatedAllocations.erase(allocation.memory);
+
+                this->dedicatedBytes[heapIndex] -= allocation.size;
+                this->dedicatedCounts[heapIndex]--;
+                this->deviceMemoryCount--;
+            }
+            else
+            {
+                VKMemoryBlock* block = allocation.block;
+
+                releaseToBlock(block, allocation.offset, allocation.size);
+                block->usedBytes -= allocation.size;
+                block->allocationCount--;
+
+                // 비어 있는 블록은 풀마다 하나만 남기고 반환합니다.
+                if (block->allocationCount == 0)
+                {
+                    for (auto& pool : this->pools)
+                    {
+                        auto it = std::find_if(pool.blocks.begin(), pool.blocks.end(),
+                            [block](const std::unique_ptr<VKMemoryBlock>& b) { return b.get() == block; });
+
+                        if (it == pool.blocks.end()) {
+                            continue;
+                        }
+
+                        const size_t emptyBlocks = std::count_if(pool.blocks.begin(), pool.blocks.end(),
+                            [](const std::unique_ptr<VKMemoryBlock>& b) { return b->allocationCount == 0; });
+
+                        if (emptyBlocks > 1) {
+                            this->destroyBlock(it->get());
+                            pool.blocks.erase(it);
+                        }
+                        break;
+                    }
+                }
+            }
+
+            allocation = VKAllocation{};
+        }
+
+        VkResult VKMemoryAllocator::createBuffer(const VkBufferCreateInfo& bufferInfo, VkMemoryPropertyFlags properties, VkBuffer& buffer, VKAllocation& allocation)
+        {
+            VkResult result = vkCreateBuffer(this->VKdevice, &bufferInfo, nullptr, &buffer);
+            if (result != VK_SUCCESS) {
+                return result;
+            }
+
+            VkMemoryRequirements memRequirements;
+            vkGetBufferMemoryRequirements(this->VKdevice, buffer, &memRequirements);
+
+            result = this->allocate(memRequirements, properties, true, allocation);
+            if (result != VK_SUCCESS) {
+                vkDestroyBuffer(this->VKdevice, buffer, nullptr);
+                buffer = VK_NULL_HANDLE;
+                return result;
+            }
+
+            return vkBindBufferMemory(this->VKdevice, buffer, allocation.memory, allocation.offset);
+        }
+
+        VkResult VKMemoryAllocator::createImage(const VkImageCreateInfo& imageInfo, VkMemoryPropertyFlags properties, VkImage& image, VKAllocation& allocation)
+        {
+            VkResult result = vkCreateImage(this->VKdevice, &imageInfo, nullptr, &image);
+            if (result != VK_SUCCESS) {
+                return result;
+            }
+
+            VkMemoryRequirements memRequirements;
+            vkGetImageMemoryRequirements(this->VKdevice, image, &memRequirements);
+
+            result = this->allocate(memRequirements, properties, imageInfo.tiling == VK_IMAGE_TILING_LINEAR, allocation);
+            if (result != VK_SUCCESS) {
+                vkDestroyImage(this->VKdevice, image, nullptr);
+                image = VK_NULL_HANDLE;
+                return result;
+            }
+
+            return vkBindImageMemory(this->VKdevice, image, allocation.memory, allocation.offset);
+        }
+
+        void VKMemoryAllocator::destroyBuffer(VkBuffer& buffer, VKAllocation& allocation)
+        {
+            vkDestroyBuffer(this->VKdevice, buffer, nullptr);
+            buffer = VK_NULL_HANDLE;
+            this->free(allocation);
+        }
+
+        void VKMemoryAllocator::destroyImage(VkImage& image, VKAllocation& allocation)
+        {
+            vkDestroyImage(this->VKdevice, image, nullptr);
+            image = VK_NULL_HANDLE;
+            this->free(allocation);
+        }
+
+        VKAllocatorStats VKMemoryAllocator::getStats()
+        {
+            std::lock_guard<std::mutex> lock(this->allocatorMutex);
+
+            VKAllocatorStats stats{};
+            stats.heapCount = this->memoryProperties.memoryHeapCount;
+            stats.deviceMemoryCount = this->deviceMemoryCount;
+
+            for (uint32_t i = 0; i < this->memoryProperties.memoryHeapCount; i++)
+            {
+                stats.heaps[i].heapSize = this->memoryProperties.memoryHeaps[i].size;
+                stats.heaps[i].blockBytes = this->dedicatedBytes[i];
+                stats.heaps[i].usedBytes = this->dedicatedBytes[i];
+                stats.heaps[i].blockCount = this->dedicatedCounts[i];
+                stats.heaps[i].allocationCount = this->dedicatedCounts[i];
+                stats.dedicatedCount += this->dedicatedCounts[i];
+            }
+
+            for (const auto& pool : this->pools)
+            {
+                for (const auto& block : pool.blocks)
+                {
+                    const uint32_t heapIndex = this->memoryProperties.memoryTypes[block->memoryTypeIndex].heapIndex;
+                    VKHeapStats& heap = stats.heaps[heapIndex];
+
+                    heap.blockBytes += block->size;
+                    heap.usedBytes += block->usedBytes;
+                    heap.blockCount++;
+                    heap.allocationCount += block->allocationCount;
+
+                    for (const auto& range : block->freeRanges)
+                    {
+                        stats.freeRangeCount++;
+                        stats.totalFreeBytes += range.second;
+                        stats.largestFreeRange = std::max(stats.largestFreeRange, range.second);
+                    }
+                }
+            }
+
+            return stats;
+        }
+
+        void VKMemoryAllocator::printStats()
+        {
+            VKAllocatorStats stats = this->getStats();
+
+            printf("[memory] deviceMemory: %u (dedicated %u), free ranges: %u, fragmentation: %.3f\n",
+                stats.deviceMemoryCount, stats.dedicatedCount, stats.freeRangeCount, stats.fragmentation());
+
+            for (uint32_t i = 0; i < stats.heapCount; i++)
+            {
+                const VKHeapStats& heap = stats.heaps[i];
+                printf("[memory] heap %u: used %llu / block %llu / heap %llu bytes, blocks %u, allocations %u\n",
+                    i,
+                    static_cast<unsigned long long>(heap.usedBytes),
+                    static_cast<unsigned long long>(heap.blockBytes),
+                    static_cast<unsigned long long>(heap.heapSize),
+                    heap.blockCount,
+                    heap.allocationCount);
+            }
+        }
+
+        void VKMemoryAllocator::cleanup()
+        {
+            std::lock_guard<std::mutex> lock(this->allocatorMutex);
+
+            for (auto& pool : this->pools)
+            {
+                for (auto& block : pool.blocks)
+                {
+#ifdef DEBUG_
+                    if (block->allocationCount > 0) {
+                        printf("[memory] leak: %u allocations left in memory type %u\n", block->allocationCount, block->memoryTypeIndex);
+                    }
+#endif // DEBUG_
+                    this->destroyBlock(block.get());
+                }
+                pool.blocks.clear();
+            }
+
+            // 해제되지 않은 전용 할당도 vkDestroyDevice 전에 반환합니다.
+            for (const auto& entry : this->dedicatedAllocations)
+            {
+                const VKAllocation& allocation = entry.second;
+#ifdef DEBUG_
+                printf("[memory] leak: dedicated allocation of %llu bytes left in memory type %u\n",
+                    static_cast<unsigned long long>(allocation.size), allocation.memoryTypeIndex);
+#endif // DEBUG_
+                if (allocation.mapped) {
+                    vkUnmapMemory(this->VKdevice, allocation.memory);
+                }
+                vkFreeMemory(this->VKdevice, allocation.memory, nullptr);
+
+                const uint32_t heapIndex = this->memoryProperties.memoryTypes[allocation.memoryTypeIndex].heapIndex;
+                this->dedicatedBytes[heapIndex] -= allocation.size;
+                this->dedicatedCounts[heapIndex]--;
+                this->deviceMemoryCount--;
+            }
+            this->dedicatedAllocations.clear();
+        }
+
+        uint32_t VKMemoryAllocator::findMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties) const
+        {
+            for (uint32_t i = 0; i < this->memoryProperties.memoryTypeCount; i++)
+            {
+                if ((typeFilter & (1 << i)) && (this->memoryProperties.memoryTypes[i].propertyFlags & properties) == properties)
+                {
+                    return i;
+                }
+            }
+
+            throw std::runtime_error("failed to find suitable memory type!");
+        }
+
+        VkDeviceSize VKMemoryAllocator::getBlockSize(uint32_t memoryTypeIndex) const
+        {
+            // 1GB 이하의 작은 힙(예: BAR 영역)은 힙의 1/8 크기로 블록을 만듭니다.
+            const uint32_t heapIndex = this->memoryProperties.memoryTypes[memoryTypeIndex].heapIndex;
+            const VkDeviceSize heapSize = this->memoryProperties.memoryHeaps[heapIndex].size;
+
+            if (heapSize <= 1024ull * 1024 * 1024) {
+                return std::min(this->preferredBlockSize, heapSize / 8);
+            }
+
+            return this->preferredBlockSize;
+        }
+
+        VkResult VKMemoryAllocator::allocateDedicated(const VkMemoryRequirements& requirements, uint32_t memoryTypeIndex, VKAllocation& allocation)
+        {
+            VkMemoryAllocateInfo allocInfo{};
+            allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+            allocInfo.allocationSize = requirements.size;
+            allocInfo.memoryTypeIndex = memoryTypeIndex;
+
+            VkDeviceMemory memory = VK_NULL_HANDLE;
+            VkResult result = vkAllocateMemory(this->VKdevice, &allocInfo, nullptr, &memory);
+            if (result != VK_SUCCESS) {
+                return result;
+            }
+
+            void* mapped = nullptr;
+            if (this->memoryProperties.memoryTypes[memoryTypeIndex].propertyFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) {
+                VK_CHECK_RESULT(vkMapMemory(this->VKdevice, memory, 0, VK_WHOLE_SIZE, 0, &mapped));
+            }
+
+            const uint32_t heapIndex = this->memoryProperties.memoryTypes[memoryTypeIndex].heapIndex;
+            this->dedicatedBytes[heapIndex] += requirements.size;
+            this->dedicatedCounts[heapIndex]++;
+            this->deviceMemoryCount++;
+
+            allocation.memory = memory;
+            allocation.offset = 0;
+            allocation.size = requirements.size;
+            allocation.memoryTypeIndex = memoryTypeIndex;
+            allocation.mapped = mapped;
+            allocation.block = nullptr;
+            this->dedicatedAllocations[memory] = allocation;
+
+            return VK_SUCCESS;
+        }
+
+        VKMemoryBlock* VKMemoryAllocator::createBlock(VKMemoryPool& pool, VkDeviceSize size)
+        {
+            VkMemoryAllocateInfo allocInfo{};
+            allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+            allocInfo.allocationSize = size;
+            allocInfo.memoryTypeIndex = pool.memoryTypeIndex;
+
+            VkDeviceMemory memory = VK_NULL_HANDLE;
+            if (vkAllocateMemory(this->VKdevice, &allocInfo, nullptr, &memory) != VK_SUCCESS) {
+                return nullptr;
+            }
+
+            auto block = std::make_unique<VKMemoryBlock>();
+            block->memory = memory;
+            block->size = size;
+            block->memoryTypeIndex = pool.memoryTypeIndex;
+            block->freeRanges.emplace(0, size);
+
+            if (this->memoryProperties.memoryTypes[pool.memoryTypeIndex].propertyFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) {
+                VK_CHECK_RESULT(vkMapMemory(this->VKdevice, memory, 0, VK_WHOLE_SIZE, 0, &block->mapped));
+            }
+
+            this->deviceMemoryCount++;
+
+#ifdef DEBUG_
+            printf("[memory] new block: type %u, %llu bytes\n", pool.memoryTypeIndex, static_cast<unsigned long long>(size));
+#endif // DEBUG_
+
+            pool.blocks.push_back(std::move(block));
+            return pool.blocks.back().get();
+        }
+
+        void VKMemoryAllocator::destroyBlock(VKMemoryBlock* block)
+        {
+            if (block->mapped) {
+                vkUnmapMemory(this->VKdevice, block->memory);
+                block->mapped = nullptr;
+            }
+
+            vkFreeMemory(this->VKdevice, block->memory, nullptr);
+            block->memory = VK_NULL_HANDLE;
+            this->deviceMemoryCount--;
+        }
+    }
+}
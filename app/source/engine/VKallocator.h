@@ -0,0 +1,126 @@
+﻿#ifndef INCLUDE_VULKANALLOCATOR_H_
+#define INCLUDE_VULKANALLOCATOR_H_
+
+#include "../_common.h"
+
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+namespace vkengine {
+    namespace memory {
+
+        // 하나의 VkDeviceMemory 블록과 그 안의 빈 구간 목록
+        struct VKMemoryBlock {
+            VkDeviceMemory memory{ VK_NULL_HANDLE };
+            VkDeviceSize size = 0;
+            VkDeviceSize usedBytes = 0;
+            uint32_t allocationCount = 0;
+            uint32_t memoryTypeIndex = UINT32_MAX;
+            void* mapped = nullptr;                               // HOST_VISIBLE 블록은 생성 시 한 번만 매핑합니다.
+            std::map<VkDeviceSize, VkDeviceSize> freeRanges;      // offset -> size (offset 순으로 정렬)
+        };
+
+        // 서브 할당된 메모리 조각
+        // memory + offset 위치에 리소스를 바인딩합니다.
+        struct VKAllocation {
+            VkDeviceMemory memory{ VK_NULL_HANDLE };        // 블록(또는 전용 할당)의 메모리 핸들
+            VkDeviceSize offset = 0;                        // 블록 안에서의 시작 위치
+            VkDeviceSize size = 0;                          // 할당 크기
+            uint32_t memoryTypeIndex = UINT32_MAX;          // 메모리 타입 인덱스
+            void* mapped = nullptr;                         // HOST_VISIBLE 메모리일 때 영구 매핑된 주소 (offset 적용됨)
+            VKMemoryBlock* block = nullptr;                 // 소속 블록 -> nullptr이면 전용(dedicated) 할당
+
+            bool isValid() const { return this->memory != VK_NULL_HANDLE; }
+        };
+
+        // 힙 하나의 사용량 카운터
+        struct VKHeapStats {
+            VkDeviceSize heapSize = 0;                      // 힙 전체 크기
+            VkDeviceSize blockBytes = 0;                    // vkAllocateMemory로 확보한 바이트
+            VkDeviceSize usedBytes = 0;                     // 실제 리소스가 사용 중인 바이트
+            uint32_t blockCount = 0;                        // 블록(VkDeviceMemory) 개수
+            uint32_t allocationCount = 0;                   // 서브 할당 개수
+        };
+
+        // 할당기 전체 통계 (단편화 정보 포함)
+        struct VKAllocatorStats {
+            std::array<VKHeapStats, VK_MAX_MEMORY_HEAPS> heaps{};
+            uint32_t heapCount = 0;
+            uint32_t deviceMemoryCount = 0;                 // 살아 있는 VkDeviceMemory 개수 -> maxMemoryAllocationCount와 비교
+            uint32_t dedicatedCount = 0;                    // 전용 할당 개수
+            uint32_t freeRangeCount = 0;                    // 블록 안의 빈 구간 개수
+            VkDeviceSize totalFreeBytes = 0;                // 블록 안의 빈 공간 총합
+            VkDeviceSize largestFreeRange = 0;              // 가장 큰 빈 구간
+
+            // 0이면 빈 공간이 한 덩어리, 1에 가까울수록 잘게 쪼개져 있음
+            float fragmentation() const {
+                if (this->totalFreeBytes == 0) return 0.0f;
+                return 1.0f - static_cast<float>(this->largestFreeRange) / static_cast<float>(this->totalFreeBytes);
+            }
+        };
+
+        // 메모리 타입별로 큰 블록을 미리 할당하고 그 안을 잘라서 나눠주는 할당기
+        // 버퍼/이미지마다 vkAllocateMemory를 호출하지 않으므로 드라이버 할당 개수 제한에 걸리지 않습니다.
+        class VKMemoryAllocator {
+        public:
+            VKMemoryAllocator(VkPhysicalDevice physicalDevice, VkDevice device, VkDeviceSize preferredBlockSize = 64ull * 1024 * 1024);
+            ~VKMemoryAllocator();
+
+            VKMemoryAllocator(const VKMemoryAllocator&) = delete;
+            VKMemoryAllocator& operator=(const VKMemoryAllocator&) = delete;
+
+            // 메모리 요구사항에 맞는 영역을 할당합니다.
+            // linear: 버퍼/LINEAR 이미지이면 true, OPTIMAL 이미지이면 false
+            // -> bufferImageGranularity 충돌을 피하기 위해 서로 다른 블록에 배치합니다.
+            VkResult allocate(const VkMemoryRequirements& requirements, VkMemoryPropertyFlags properties, bool linear, VKAllocation& allocation);
+
+            // 할당을 반환하고 인접한 빈 구간과 병합합니다.
+            void free(VKAllocation& allocation);
+
+            // 버퍼/이미지를 생성하고 메모리를 바인딩하는 함수
+            VkResult createBuffer(const VkBufferCreateInfo& bufferInfo, VkMemoryPropertyFlags properties, VkBuffer& buffer, VKAllocation& allocation);
+            VkResult createImage(const VkImageCreateInfo& imageInfo, VkMemoryPropertyFlags properties, VkImage& image, VKAllocation& allocation);
+            void destroyBuffer(VkBuffer& buffer, VKAllocation& allocation);
+            void destroyImage(VkImage& image, VKAllocation& allocation);
+
+            // 힙별 사용량과 단편화 통계를 가져오는 함수
+            VKAllocatorStats getStats();
+            void printStats();
+
+            VkDevice getDevice() const { return this->VKdevice; }
+            const VkPhysicalDeviceMemoryProperties& getMemoryProperties() const { return this->memoryProperties; }
+
+            // 모든 블록을 해제하는 함수 -> vkDestroyDevice 전에 호출
+            void cleanup();
+
+        private:
+            struct VKMemoryPool {
+                uint32_t memoryTypeIndex = UINT32_MAX;
+                bool linear = true;
+                std::vector<std::unique_ptr<VKMemoryBlock>> blocks;
+            };
+
+            uint32_t findMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties) const;
+            VkDeviceSize getBlockSize(uint32_t memoryTypeIndex) const;
+            VkResult allocateDedicated(const VkMemoryRequirements& requirements, uint32_t memoryTypeIndex, VKAllocation& allocation);
+            VKMemoryBlock* createBlock(VKMemoryPool& pool, VkDeviceSize size);
+            void destroyBlock(VKMemoryBlock* block);
+
+            VkPhysicalDevice VKphysicalDevice{ VK_NULL_HANDLE };
+            VkDevice VKdevice{ VK_NULL_HANDLE };
+            VkPhysicalDeviceMemoryProperties memoryProperties{};
+            VkDeviceSize preferredBlockSize = 0;
+
+            std::array<VKMemoryPool, VK_MAX_MEMORY_TYPES * 2> pools{};   // [memoryType * 2 + (linear ? 0 : 1)]
+            std::array<VkDeviceSize, VK_MAX_MEMORY_HEAPS> dedicatedBytes{};
+            std::array<uint32_t, VK_MAX_MEMORY_HEAPS> dedicatedCounts{};
+            std::unordered_map<VkDeviceMemory, VKAllocation> dedicatedAllocations;   // 살아 있는 전용 할당 -> cleanup에서 남은 것을 해제
+            uint32_t deviceMemoryCount = 0;
+
+            std::mutex allocatorMutex;
+        };
+    }
+}
+
+#endif // INCLUDE_VULKANALLOCATOR_H_
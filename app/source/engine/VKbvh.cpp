@@ -0,0 +1,567 @@
+﻿#include "VKbvh.h"
+#include "VKtrace.h"
+
+#include <cfloat>
+#include <numeric>
+
+namespace vkengine {
+
+    namespace {
+        constexpr uint32_t BVH_CENTROID_GRAIN = 16 * 1024;          // 상자 중심을 미리 계산할 때 잡 하나가 맡는 최소 오브젝트 수
+        constexpr uint32_t BVH_JOBS_PER_THREAD = 4;                 // 상자 중심 계산을 스레드당 이 정도 잡으로 나눔 (잡 수를 오브젝트 수와 무관하게 묶음)
+
+        VKAabb emptyAabb()
+        {
+            return { glm::vec3(FLT_MAX), glm::vec3(-FLT_MAX) };
+        }
+
+        void grow(VKAabb& box, const VKAabb& other)
+        {
+            box.min = glm::min(box.min, other.min);
+            box.max = glm::max(box.max, other.max);
+        }
+
+        void grow(VKAabb& box, const glm::vec3& point)
+        {
+            box.min = glm::min(box.min, point);
+            box.max = glm::max(box.max, point);
+        }
+
+        glm::vec3 centroid(const VKAabb& box)
+        {
+            return (box.min + box.max) * 0.5f;
+        }
+
+        float surfaceArea(const VKAabb& box)
+        {
+            const glm::vec3 size = box.max - box.min;
+            if (size.x < 0.0f || size.y < 0.0f || size.z < 0.0f) {
+                return 0.0f;
+            }
+            return 2.0f * (size.x * size.y + size.y * size.z + size.z * size.x);
+        }
+
+        // 축별 구간
+        struct BvhBin {
+            VKAabb bounds = emptyAabb();
+            uint32_t count = 0;
+        };
+
+        using BvhBins = std::array<std::array<BvhBin, BVH_BIN_COUNT>, 3>;
+
+        // 중심의 구간 번호 -> 빌드의 분류와 나누기에서 같은 식을 씁니다.
+        uint32_t binIndex(float value, float minimum, float scale, uint32_t binCount)
+        {
+            const int32_t index = static_cast<int32_t>((value - minimum) * scale);
+            return static_cast<uint32_t>(std::min(std::max(index, 0), static_cast<int32_t>(binCount) - 1));
+        }
+
+        // 반직선이 상자에 들어가는 t (슬랩 방식) -> 놓치면 false
+        bool intersectRayBox(const glm::vec3& origin, const glm::vec3& inverseDirection, const glm::vec3& boxMin, const glm::vec3& boxMax, float maxT, float& enterT)
+        {
+            const glm::vec3 t0 = (boxMin - origin) * inverseDirection;
+            const glm::vec3 t1 = (boxMax - origin) * inverseDirection;
+            const glm::vec3 tNear = glm::min(t0, t1);
+            const glm::vec3 tFar = glm::max(t0, t1);
+
+            const float enter = std::max(std::max(tNear.x, tNear.y), std::max(tNear.z, 0.0f));
+            const float exit = std::min(std::min(tFar.x, tFar.y), std::min(tFar.z, maxT));
+            enterT = enter;
+            return enter <= exit;
+        }
+
+        float distanceSquaredToBox(const glm::vec3& point, const glm::vec3& boxMin, const glm::vec3& boxMax)
+        {
+            const glm::vec3 offset = glm::max(glm::max(boxMin - point, point - boxMax), glm::vec3(0.0f));
+            return glm::dot(offset, offset);
+        }
+
+        // 평면 하나 -> AABB는 법선 성분의 절댓값으로 반 크기를 투영합니다. (VKcpuCulling과 같은 판정)
+        struct BvhPlane {
+            glm::vec3 normal;
+            glm::vec3 absNormal;
+            float distance;
+        };
+
+        // 0: 바깥, 그 외: 아직 걸쳐 있는 평면 비트 + 1 (모두 안쪽이면 1)
+        uint32_t classifyBox(const glm::vec3& boxMin, const glm::vec3& boxMax, const std::array<BvhPlane, 6>& planes, uint32_t mask)
+        {
+            const glm::vec3 center = (boxMin + boxMax) * 0.5f;
+            const glm::vec3 extent = (boxMax - boxMin) * 0.5f;
+
+            uint32_t remaining = 0;
+            for (uint32_t i = 0; i < 6; i++)
+            {
+                if ((mask & (1u << i)) == 0) {
+                    continue;
+                }
+
+                const float d = glm::dot(planes[i].normal, center) + planes[i].distance;
+                const float r = glm::dot(planes[i].absNormal, extent);
+                if (d < -r) {
+                    return 0;
+                }
+                if (d < r) {
+                    remaining |= 1u << i;
+                }
+            }
+            return remaining + 1;
+        }
+    }
+
+    void VKBvh::build(const VKAabb* bounds, uint32_t count, job::VKJobSystem* jobSystem)
+    {
+        VK_TRACE_SCOPE("VKBvh::build");
+
+        this->objectIndices.resize(count);
+        std::iota(this->objectIndices.begin(), this->objectIndices.end(), 0u);
+        this->objectLeaves.resize(count);
+
+        // 잎마다 오브젝트가 하나 이상이므로 노드는 2 * count - 1개를 넘지 않습니다.
+        const size_t maxNodes = std::max<size_t>(1, static_cast<size_t>(count) * 2);
+        this->nodes.resize(maxNodes);
+        this->parents.resize(maxNodes);
+        this->parents[0] = UINT32_MAX;
+        this->nodeCount.store(1);
+
+        if (count == 0) {
+            this->nodes[0] = { glm::vec3(0.0f), 0, glm::vec3(0.0f), 0 };
+        }
+        else {
+            this->buildBounds = bounds;
+            this->buildJobSystem = jobSystem;
+
+            // 잡으로 넘기는 하위 트리는 서로 겹치지 않으므로 개수가 2 * count / 문턱값 이하입니다.
+            // -> 잡 풀의 1/4 안에 들어오도록 문턱값을 올립니다. (살아 있는 잡이 링 풀을 한 바퀴 돌아 덮이지 않게)
+            this->buildForkThreshold = std::max(BVH_PARALLEL_THRESHOLD, static_cast<uint32_t>(static_cast<uint64_t>(count) * 8 / job::JOB_POOL_SIZE));
+
+            this->buildCentroids.resize(count);
+            auto computeCentroids = [this](uint32_t begin, uint32_t end) {
+                for (uint32_t i = begin; i < end; i++)
+                {
+                    this->buildCentroids[i] = centroid(this->buildBounds[i]);
+                }
+            };
+            if (jobSystem != nullptr) {
+                const uint32_t grainSize = std::max(BVH_CENTROID_GRAIN, count / (jobSystem->getThreadCount() * BVH_JOBS_PER_THREAD) + 1);
+                jobSystem->parallelFor(count, grainSize, computeCentroids);
+            }
+            else {
+                computeCentroids(0, count);
+            }
+
+            this->buildNode(0, 0, count, 0);
+
+            this->buildBounds = nullptr;
+            this->buildJobSystem = nullptr;
+            this->buildCentroids.clear();
+            this->buildCentroids.shrink_to_fit();
+        }
+
+        this->nodes.resize(this->nodeCount.load());
+        this->nodes.shrink_to_fit();
+        this->parents.resize(this->nodes.size());
+        this->parents.shrink_to_fit();
+
+        // 질의가 연속된 메모리를 읽도록 오브젝트 상자를 잎 순서로 복사합니다.
+        this->leafBounds.resize(count);
+        this->objectSlots.resize(count);
+        for (uint32_t slot = 0; slot < count; slot++)
+        {
+            const uint32_t object = this->objectIndices[slot];
+            this->leafBounds[slot] = bounds[object];
+            this->objectSlots[object] = slot;
+        }
+    }
+
+    void VKBvh::refit(const VKAabb* bounds)
+    {
+        VK_TRACE_SCOPE("VKBvh::refit");
+
+        for (uint32_t slot = 0; slot < this->leafBounds.size(); slot++)
+        {
+            this->leafBounds[slot] = bounds[this->objectIndices[slot]];
+        }
+
+        // 자식은 항상 부모 뒤에 있으므로 뒤에서부터 맞추면 자식이 먼저 끝납니다.
+        for (size_t i = this->nodes.size(); i-- > 0;)
+        {
+            this->updateNodeBounds(static_cast<uint32_t>(i));
+        }
+    }
+
+    void VKBvh::refit(const VKAabb* bounds, const uint32_t* moved, uint32_t movedCount)
+    {
+        VK_TRACE_SCOPE("VKBvh::refit moved");
+
+        for (uint32_t i = 0; i < movedCount; i++)
+        {
+            const uint32_t object = moved[i];
+            this->leafBounds[this->objectSlots[object]] = bounds[object];
+
+            // 상자가 그대로면 그 위의 조상도 그대로입니다.
+            for (uint32_t node = this->objectLeaves[object]; node != UINT32_MAX; node = this->parents[node])
+            {
+                const glm::vec3 oldMin = this->nodes[node].boundsMin;
+                const glm::vec3 oldMax = this->nodes[node].boundsMax;
+                this->updateNodeBounds(node);
+                if (oldMin == this->nodes[node].boundsMin && oldMax == this->nodes[node].boundsMax) {
+                    break;
+                }
+            }
+        }
+    }
+
+    uint32_t VKBvh::queryFrustum(const std::array<glm::vec4, 6>& planes, std::vector<uint32_t>& visible) const
+    {
+        visible.clear();
+        if (this->objectIndices.empty()) {
+            return 0;
+        }
+
+        std::array<BvhPlane, 6> bvhPlanes{};
+        for (size_t i = 0; i < planes.size(); i++)
+        {
+            bvhPlanes[i].normal = glm::vec3(planes[i]);
+            bvhPlanes[i].absNormal = glm::abs(bvhPlanes[i].normal);
+            bvhPlanes[i].distance = planes[i].w;
+        }
+
+        // 부모가 완전히 안쪽에 있는 평면은 자식에서 다시 검사하지 않습니다.
+        struct StackEntry {
+            uint32_t node;
+            uint32_t mask;
+        };
+        StackEntry stack[BVH_STACK_SIZE];
+        uint32_t stackSize = 0;
+        stack[stackSize++] = { 0, 0x3Fu };
+
+        while (stackSize > 0)
+        {
+            const StackEntry entry = stack[--stackSize];
+            const VKBvhNode& node = this->nodes[entry.node];
+
+            const uint32_t classified = classifyBox(node.boundsMin, node.boundsMax, bvhPlanes, entry.mask);
+            if (classified == 0) {
+                continue;
+            }
+            const uint32_t mask = classified - 1;
+
+            if (node.count == 0) {
+                stack[stackSize++] = { node.leftOrFirst + 1, mask };
+                stack[stackSize++] = { node.leftOrFirst, mask };
+                continue;
+            }
+
+            for (uint32_t slot = node.leftOrFirst; slot < node.leftOrFirst + node.count; slot++)
+            {
+                const VKAabb& box = this->leafBounds[slot];
+                if (mask == 0 || classifyBox(box.min, box.max, bvhPlanes, mask) != 0) {
+                    visible.push_back(this->objectIndices[slot]);
+                }
+            }
+        }
+
+        return static_cast<uint32_t>(visible.size());
+    }
+
+    bool VKBvh::raycast(const glm::vec3& origin, const glm::vec3& direction, float maxT, VKBvhRayHit& hit) const
+    {
+        hit = VKBvhRayHit{};
+        if (this->objectIndices.empty()) {
+            return false;
+        }
+
+        const glm::vec3 inverseDirection = 1.0f / direction;
+        float closestT = maxT;
+
+        float rootT = 0.0f;
+        if (!intersectRayBox(origin, inverseDirection, this->nodes[0].boundsMin, this->nodes[0].boundsMax, closestT, rootT)) {
+            return false;
+        }
+
+        uint32_t stack[BVH_STACK_SIZE];
+        uint32_t stackSize = 0;
+        stack[stackSize++] = 0;
+
+        while (stackSize > 0)
+        {
+            const VKBvhNode& node = this->nodes[stack[--stackSize]];
+
+            if (node.count > 0) {
+                for (uint32_t slot = node.leftOrFirst; slot < node.leftOrFirst + node.count; slot++)
+                {
+                    float t = 0.0f;
+                    if (intersectRayBox(origin, inverseDirection, this->leafBounds[slot].min, this->leafBounds[slot].max, closestT, t) && t < closestT) {
+                        closestT = t;
+                        hit.object = this->objectIndices[slot];
+                        hit.t = t;
+                    }
+                }
+                continue;
+            }
+
+            // 가까운 자식을 먼저 꺼내도록 먼 자식을 먼저 넣습니다. -> closestT가 빨리 줄어 먼 쪽을 더 많이 건너뜀
+            const uint32_t left = node.leftOrFirst;
+            float leftT = 0.0f;
+            float rightT = 0.0f;
+            const bool hitLeft = intersectRayBox(origin, inverseDirection, this->nodes[left].boundsMin, this->nodes[left].boundsMax, closestT, leftT);
+            const bool hitRight = intersectRayBox(origin, inverseDirection, this->nodes[left + 1].boundsMin, this->nodes[left + 1].boundsMax, closestT, rightT);
+
+            if (hitLeft && hitRight) {
+                const bool leftFirst = leftT <= rightT;
+                stack[stackSize++] = leftFirst ? left + 1 : left;
+                stack[stackSize++] = leftFirst ? left : left + 1;
+            }
+            else if (hitLeft) {
+                stack[stackSize++] = left;
+            }
+            else if (hitRight) {
+                stack[stackSize++] = left + 1;
+            }
+        }
+
+        return hit.object != UINT32_MAX;
+    }
+
+    bool VKBvh::nearest(const glm::vec3& point, VKBvhNearestHit& hit) const
+    {
+        hit = VKBvhNearestHit{};
+        if (this->objectIndices.empty()) {
+            return false;
+        }
+
+        struct StackEntry {
+            uint32_t node;
+            float distanceSquared;
+        };
+        StackEntry stack[BVH_STACK_SIZE];
+        uint32_t stackSize = 0;
+        stack[stackSize++] = { 0, distanceSquaredToBox(point, this->nodes[0].boundsMin, this->nodes[0].boundsMax) };
+
+        float closest = FLT_MAX;
+
+        while (stackSize > 0)
+        {
+            const StackEntry entry = stack[--stackSize];
+            if (entry.distanceSquared >= closest) {
+                continue;
+            }
+
+            const VKBvhNode& node = this->nodes[entry.node];
+            if (node.count > 0) {
+                for (uint32_t slot = node.leftOrFirst; slot < node.leftOrFirst + node.count; slot++)
+                {
+                    const float distanceSquared = distanceSquaredToBox(point, this->leafBounds[slot].min, this->leafBounds[slot].max);
+                    if (distanceSquared < closest) {
+                        closest = distanceSquared;
+                        hit.object = this->objectIndices[slot];
+                        hit.distanceSquared = distanceSquared;
+                    }
+                }
+                continue;
+            }
+
+            const uint32_t left = node.leftOrFirst;
+            const float leftDistance = distanceSquaredToBox(point, this->nodes[left].boundsMin, this->nodes[left].boundsMax);
+            const float rightDistance = distanceSquaredToBox(point, this->nodes[left + 1].boundsMin, this->nodes[left + 1].boundsMax);
+
+            // 가까운 자식을 먼저 꺼냅니다.
+            if (leftDistance <= rightDistance) {
+                stack[stackSize++] = { left + 1, rightDistance };
+                stack[stackSize++] = { left, leftDistance };
+            }
+            else {
+                stack[stackSize++] = { left, leftDistance };
+                stack[stackSize++] = { left + 1, rightDistance };
+            }
+        }
+
+        return hit.object != UINT32_MAX;
+    }
+
+    void VKBvh::buildNode(uint32_t nodeIndex, uint32_t begin, uint32_t end, uint32_t depth)
+    {
+        const uint32_t count = end - begin;
+        const VKBvhBuildRange range = this->computeRange(begin, end);
+
+        VKBvhNode& node = this->nodes[nodeIndex];
+        node.boundsMin = range.bounds.min;
+        node.boundsMax = range.bounds.max;
+
+        if (count == 1) {
+            this->makeLeaf(nodeIndex, begin, end);
+            return;
+        }
+
+        const glm::vec3 centroidExtent = range.centroidBounds.max - range.centroidBounds.min;
+        uint32_t mid = begin;
+
+        if (depth < BVH_MAX_SAH_DEPTH && (centroidExtent.x > 0.0f || centroidExtent.y > 0.0f || centroidExtent.z > 0.0f)) {
+            // 축마다 중심을 구간에 나눠 담습니다. (작은 노드는 오브젝트 수만큼만 -> 대부분인 아래쪽 노드의 쓸기 비용을 줄임)
+            const uint32_t binCount = std::min(BVH_BIN_COUNT, count);
+            glm::vec3 scale(0.0f);
+            for (int axis = 0; axis < 3; axis++)
+            {
+                if (centroidExtent[axis] > 0.0f) {
+                    scale[axis] = static_cast<float>(binCount) / centroidExtent[axis];
+                }
+            }
+
+            auto binObjects = [this, &range, &scale, binCount](uint32_t binBegin, uint32_t binEnd, BvhBins& bins) {
+                for (uint32_t i = binBegin; i < binEnd; i++)
+                {
+                    const uint32_t object = this->objectIndices[i];
+                    const VKAabb& box = this->buildBounds[object];
+                    const glm::vec3& center = this->buildCentroids[object];
+                    for (int axis = 0; axis < 3; axis++)
+                    {
+                        BvhBin& bin = bins[axis][binIndex(center[axis], range.centroidBounds.min[axis], scale[axis], binCount)];
+                        grow(bin.bounds, box);
+                        bin.count++;
+                    }
+                }
+            };
+
+            BvhBins bins{};
+            binObjects(begin, end, bins);
+
+            // 구간 경계마다 왼쪽/오른쪽 넓이 * 개수를 쓸어서 SAH 비용이 가장 작은 경계를 고릅니다.
+            float bestCost = FLT_MAX;
+            int bestAxis = -1;
+            uint32_t bestSplit = 0;
+            for (int axis = 0; axis < 3; axis++)
+            {
+                if (scale[axis] == 0.0f) {
+                    continue;
+                }
+
+                std::array<float, BVH_BIN_COUNT> rightCosts{};
+                VKAabb rightBounds = emptyAabb();
+                uint32_t rightCount = 0;
+                for (uint32_t b = binCount - 1; b > 0; b--)
+                {
+                    grow(rightBounds, bins[axis][b].bounds);
+                    rightCount += bins[axis][b].count;
+                    rightCosts[b] = rightCount * surfaceArea(rightBounds);
+                }
+
+                VKAabb leftBounds = emptyAabb();
+                uint32_t leftCount = 0;
+                for (uint32_t split = 1; split < binCount; split++)
+                {
+                    grow(leftBounds, bins[axis][split - 1].bounds);
+                    leftCount += bins[axis][split - 1].count;
+
+                    const float cost = leftCount * surfaceArea(leftBounds) + rightCosts[split];
+                    if (leftCount > 0 && leftCount < count && cost < bestCost) {
+                        bestCost = cost;
+                        bestAxis = axis;
+                        bestSplit = split;
+                    }
+                }
+            }
+
+            const float nodeArea = surfaceArea(range.bounds);
+            const float leafCost = count * nodeArea;
+            bestCost += BVH_TRAVERSAL_COST * nodeArea;
+
+            if (count <= BVH_MAX_LEAF_SIZE && (bestAxis < 0 || bestCost >= leafCost)) {
+                this->makeLeaf(nodeIndex, begin, end);
+                return;
+            }
+
+            if (bestAxis >= 0) {
+                const float minimum = range.centroidBounds.min[bestAxis];
+                const float axisScale = scale[bestAxis];
+                auto* middle = std::partition(this->objectIndices.data() + begin, this->objectIndices.data() + end, [&](uint32_t object) {
+                    return binIndex(this->buildCentroids[object][bestAxis], minimum, axisScale, binCount) < bestSplit;
+                });
+                mid = static_cast<uint32_t>(middle - this->objectIndices.data());
+            }
+        }
+        else if (count <= BVH_MAX_LEAF_SIZE) {
+            this->makeLeaf(nodeIndex, begin, end);
+            return;
+        }
+
+        // SAH로 나누지 못했거나 너무 깊으면 가장 긴 축의 중심 순서로 개수 절반씩 나눕니다.
+        if (mid == begin || mid == end) {
+            const int axis = (centroidExtent.x >= centroidExtent.y && centroidExtent.x >= centroidExtent.z) ? 0 : (centroidExtent.y >= centroidExtent.z ? 1 : 2);
+            mid = begin + count / 2;
+            std::nth_element(this->objectIndices.data() + begin, this->objectIndices.data() + mid, this->objectIndices.data() + end, [&](uint32_t a, uint32_t b) {
+                return this->buildCentroids[a][axis] < this->buildCentroids[b][axis];
+            });
+        }
+
+        const uint32_t left = this->allocateNodePair(nodeIndex);
+        node.leftOrFirst = left;
+        node.count = 0;
+
+        // 큰 하위 트리는 왼쪽을 잡으로 넘기고 오른쪽은 이 스레드에서 만듭니다. (기다리는 동안 다른 잡을 실행)
+        if (this->buildJobSystem != nullptr && count >= this->buildForkThreshold) {
+            job::VKJob* leftJob = this->buildJobSystem->createJob([this, left, begin, mid, depth]() {
+                this->buildNode(left, begin, mid, depth + 1);
+            });
+            this->buildJobSystem->run(leftJob);
+            this->buildNode(left + 1, mid, end, depth + 1);
+            this->buildJobSystem->wait(leftJob);
+        }
+        else {
+            this->buildNode(left, begin, mid, depth + 1);
+            this->buildNode(left + 1, mid, end, depth + 1);
+        }
+    }
+
+    VKBvh::VKBvhBuildRange VKBvh::computeRange(uint32_t begin, uint32_t end) const
+    {
+        VKBvhBuildRange range{ emptyAabb(), emptyAabb() };
+        for (uint32_t i = begin; i < end; i++)
+        {
+            const uint32_t object = this->objectIndices[i];
+            grow(range.bounds, this->buildBounds[object]);
+            grow(range.centroidBounds, this->buildCentroids[object]);
+        }
+        return range;
+    }
+
+    uint32_t VKBvh::allocateNodePair(uint32_t parent)
+    {
+        // 하위 트리를 여러 스레드가 만들므로 형제 한 쌍씩 원자적으로 잡습니다.
+        const uint32_t left = this->nodeCount.fetch_add(2);
+        this->parents[left] = parent;
+        this->parents[left + 1] = parent;
+        return left;
+    }
+
+    void VKBvh::makeLeaf(uint32_t nodeIndex, uint32_t begin, uint32_t end)
+    {
+        this->nodes[nodeIndex].leftOrFirst = begin;
+        this->nodes[nodeIndex].count = end - begin;
+
+        for (uint32_t i = begin; i < end; i++)
+        {
+            this->objectLeaves[this->objectIndices[i]] = nodeIndex;
+        }
+    }
+
+    void VKBvh::updateNodeBounds(uint32_t nodeIndex)
+    {
+        VKBvhNode& node = this->nodes[nodeIndex];
+        VKAabb box = emptyAabb();
+
+        if (node.count > 0) {
+            for (uint32_t slot = node.leftOrFirst; slot < node.leftOrFirst + node.count; slot++)
+            {
+                grow(box, this->leafBounds[slot]);
+            }
+        }
+        else {
+            grow(box, VKAabb{ this->nodes[node.leftOrFirst].boundsMin, this->nodes[node.leftOrFirst].boundsMax });
+            grow(box, VKAabb{ this->nodes[node.leftOrFirst + 1].boundsMin, this->nodes[node.leftOrFirst + 1].boundsMax });
+        }
+
+        node.boundsMin = box.min;
+        node.boundsMax = box.max;
+    }
+}
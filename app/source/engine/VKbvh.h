@@ -0,0 +1,100 @@
+﻿#ifndef INCLUDE_VULKANBVH_H_
+#define INCLUDE_VULKANBVH_H_
+
+#include "../_common.h"
+#include "../struct.h"
+#include "VKjobSystem.h"
+
+namespace vkengine {
+
+    constexpr uint32_t BVH_BIN_COUNT = 16;                          // SAH 후보를 고르는 축별 구간 수
+    constexpr uint32_t BVH_MAX_LEAF_SIZE = 4;                       // 잎 하나의 최대 오브젝트 수
+    constexpr float BVH_TRAVERSAL_COST = 1.0f;                      // SAH에서 노드 하나를 내려가는 비용 (오브젝트 검사 1 기준)
+    constexpr uint32_t BVH_MAX_SAH_DEPTH = 32;                      // 이보다 깊으면 개수 절반으로 나눠서 탐색 스택(BVH_STACK_SIZE)을 넘지 않게 함
+    constexpr uint32_t BVH_STACK_SIZE = 64;
+    constexpr uint32_t BVH_PARALLEL_THRESHOLD = 64 * 1024;          // 이보다 큰 구간은 하위 트리 빌드를 잡으로 나눔 (오브젝트가 아주 많으면 더 커짐)
+
+    // 축 정렬 경계 상자
+    struct VKAabb {
+        glm::vec3 min;
+        glm::vec3 max;
+    };
+
+    // 평탄화한 노드 (32바이트 -> 캐시 라인 하나에 2개, 형제는 항상 붙어 있음)
+    // count == 0 이면 내부 노드: 왼쪽 자식 = leftOrFirst, 오른쪽 자식 = leftOrFirst + 1
+    // count > 0 이면 잎: 잎 순서의 오브젝트 [leftOrFirst, leftOrFirst + count)
+    struct VKBvhNode {
+        glm::vec3 boundsMin;
+        uint32_t leftOrFirst;
+        glm::vec3 boundsMax;
+        uint32_t count;
+    };
+    static_assert(sizeof(VKBvhNode) == 32, "VKBvhNode must stay 32 bytes");
+
+    struct VKBvhRayHit {
+        uint32_t object = UINT32_MAX;
+        float t = 0.0f;                                             // origin + direction * t에서 오브젝트 상자에 들어감
+    };
+
+    struct VKBvhNearestHit {
+        uint32_t object = UINT32_MAX;
+        float distanceSquared = 0.0f;                               // 점에서 오브젝트 상자까지 (안에 있으면 0)
+    };
+
+    // 장면 오브젝트의 경계 상자 BVH
+    // 빌드는 축별 구간(bin) SAH로 나누고, jobSystem이 있으면 큰 하위 트리를 잡으로 나눕니다.
+    // 노드 하나의 상자 계산과 구간 분류는 스레드 하나에서 합니다. -> 빌드 전체의 잡 수가 하위 트리 수로 묶여 잡 풀(JOB_POOL_SIZE)을 넘지 않습니다.
+    // 오브젝트가 움직이면 refit으로 트리 모양은 그대로 두고 상자만 다시 맞춥니다. -> 많이 움직였으면 다시 build
+    // 오브젝트 상자는 잎 순서로 복사해 두므로 질의는 입력 배열 없이 연속된 메모리만 읽습니다.
+    class VKBvh {
+    public:
+        // bounds[0, count)로 트리를 만듭니다. 오브젝트 번호는 bounds의 인덱스입니다.
+        void build(const VKAabb* bounds, uint32_t count, job::VKJobSystem* jobSystem = nullptr);
+
+        // 모든 오브젝트의 상자를 다시 읽고 모든 노드를 아래에서 위로 다시 맞춥니다. (build와 같은 count)
+        void refit(const VKAabb* bounds);
+
+        // moved에 있는 오브젝트만 다시 읽고, 그 잎에서 루트 쪽으로 상자가 바뀌는 동안만 올라갑니다.
+        void refit(const VKAabb* bounds, const uint32_t* moved, uint32_t movedCount);
+
+        // 평면 (Camera::getFrustumPlanes) 안쪽에 걸친 오브젝트를 visible에 담습니다. (순서는 잎 순서) -> 수 반환
+        uint32_t queryFrustum(const std::array<glm::vec4, 6>& planes, std::vector<uint32_t>& visible) const;
+
+        // 반직선이 처음 들어가는 오브젝트 상자 (피킹) -> 없으면 false
+        bool raycast(const glm::vec3& origin, const glm::vec3& direction, float maxT, VKBvhRayHit& hit) const;
+
+        // 점에서 가장 가까운 오브젝트 상자 -> 오브젝트가 없으면 false
+        bool nearest(const glm::vec3& point, VKBvhNearestHit& hit) const;
+
+        const std::vector<VKBvhNode>& getNodes() const { return this->nodes; }
+        uint32_t getObjectCount() const { return static_cast<uint32_t>(this->objectIndices.size()); }
+
+    private:
+        struct VKBvhBuildRange {
+            VKAabb bounds;
+            VKAabb centroidBounds;
+        };
+
+        void buildNode(uint32_t nodeIndex, uint32_t begin, uint32_t end, uint32_t depth);
+        VKBvhBuildRange computeRange(uint32_t begin, uint32_t end) const;
+        uint32_t allocateNodePair(uint32_t parent);
+        void makeLeaf(uint32_t nodeIndex, uint32_t begin, uint32_t end);
+        void updateNodeBounds(uint32_t nodeIndex);
+
+        std::vector<VKBvhNode> nodes;                               // 0 = 루트, 자식은 항상 부모 뒤에 있음
+        std::vector<uint32_t> parents;                              // 노드 -> 부모 (루트는 UINT32_MAX)
+        std::vector<VKAabb> leafBounds;                             // 잎 순서의 오브젝트 상자
+        std::vector<uint32_t> objectIndices;                        // 잎 순서 -> 오브젝트 번호
+        std::vector<uint32_t> objectSlots;                          // 오브젝트 번호 -> 잎 순서
+        std::vector<uint32_t> objectLeaves;                         // 오브젝트 번호 -> 잎 노드
+
+        // 빌드 중에만 사용
+        const VKAabb* buildBounds = nullptr;
+        std::vector<glm::vec3> buildCentroids;                      // 오브젝트 번호 -> 상자 중심 (분류할 때마다 다시 계산하지 않음)
+        job::VKJobSystem* buildJobSystem = nullptr;
+        uint32_t buildForkThreshold = BVH_PARALLEL_THRESHOLD;        // 이보다 큰 구간만 왼쪽 하위 트리를 잡으로 넘김
+        std::atomic<uint32_t> nodeCount{ 0 };
+    };
+}
+
+#endif // INCLUDE_VULKANBVH_H_
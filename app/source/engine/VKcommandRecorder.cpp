@@ -0,0 +1,169 @@
+﻿#include "VKcommandRecorder.h"
+#include "VKtrace.h"
+
+namespace vkengine {
+
+    VKCommandRecorder::VKCommandRecorder(VkDevice device, uint32_t queueFamilyIndex, job::VKJobSystem& jobSystem)
+    {
+        assert(device);
+
+        this->VKdevice = device;
+        this->VKjobSystem = &jobSystem;
+
+        const uint32_t threadCount = jobSystem.getThreadCount();
+        this->slots.resize(threadCount);
+
+        VkCommandPoolCreateInfo poolInfo{};
+        poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+        poolInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;         // 프레임마다 풀 단위로 리셋합니다.
+        poolInfo.queueFamilyIndex = queueFamilyIndex;
+
+        for (auto& slot : this->slots)
+        {
+            for (auto& frame : slot.frames)
+            {
+                VK_CHECK_RESULT(vkCreateCommandPool(this->VKdevice, &poolInfo, nullptr, &frame.commandPool));
+            }
+        }
+
+#ifdef DEBUG_
+        printf("[recorder] %u recording threads\n", threadCount);
+#endif // DEBUG_
+    }
+
+    VKCommandRecorder::~VKCommandRecorder()
+    {
+        this->cleanup();
+    }
+
+    void VKCommandRecorder::resetFrame(uint32_t frameIndex)
+    {
+        for (auto& slot : this->slots)
+        {
+            VKRecorderFrame& frame = slot.frames[frameIndex];
+            VK_CHECK_RESULT(vkResetCommandPool(this->VKdevice, frame.commandPool, 0));
+            frame.usedCount = 0;
+        }
+    }
+
+    void VKCommandRecorder::record(
+        VkCommandBuffer primary,
+        uint32_t frameIndex,
+        const VkCommandBufferInheritanceInfo& inheritanceInfo,
+        uint32_t drawCount,
+        const VKRecordFunction& recordFunction,
+        const std::function<void(VkCommandBuffer commandBuffer)>& overlayFunction)
+    {
+        // 슬라이스 수 = min(스레드 수, drawCount / 최소 draw 수) -> 적은 draw는 메인 스레드 혼자 기록
+        const uint32_t maxSlices = std::max(1u, drawCount / this->minDrawsPerSlice);
+        const uint32_t sliceCount = std::min(this->getThreadCount(), maxSlices);
+
+        this->sliceBuffers.assign(sliceCount, VK_NULL_HANDLE);
+
+        // 슬라이스마다 잡 하나 -> 훔쳐 간 스레드가 자기 슬롯의 커맨드 풀로 기록합니다.
+        this->VKjobSystem->parallelFor(sliceCount, 1, [&](uint32_t begin, uint32_t end) {
+            for (uint32_t i = begin; i < end; i++)
+            {
+                this->sliceBuffers[i] = this->recordSlice(i, sliceCount, frameIndex, inheritanceInfo, drawCount, recordFunction);
+            }
+        });
+
+        std::vector<VkCommandBuffer> commandBuffers(this->sliceBuffers);
+        commandBuffers.reserve(sliceCount + 1);
+
+        if (overlayFunction) {
+            VkCommandBuffer overlay = this->acquireCommandBuffer(this->slots[this->VKjobSystem->getThreadIndex()], frameIndex);
+
+            VkCommandBufferBeginInfo beginInfo{};
+            beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+            beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT | VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT;
+            beginInfo.pInheritanceInfo = &inheritanceInfo;
+
+            VK_CHECK_RESULT(vkBeginCommandBuffer(overlay, &beginInfo));
+            overlayFunction(overlay);
+            VK_CHECK_RESULT(vkEndCommandBuffer(overlay));
+
+            commandBuffers.push_back(overlay);
+        }
+
+        // 슬라이스 순서대로 실행하므로 draw 순서는 단일 스레드 기록과 같습니다.
+        vkCmdExecuteCommands(primary, static_cast<uint32_t>(commandBuffers.size()), commandBuffers.data());
+    }
+
+    void VKCommandRecorder::cleanup()
+    {
+        if (this->VKdevice == VK_NULL_HANDLE) {
+            return;
+        }
+
+        // 커맨드 버퍼는 풀과 함께 해제됩니다.
+        for (auto& slot : this->slots)
+        {
+            for (auto& frame : slot.frames)
+            {
+                vkDestroyCommandPool(this->VKdevice, frame.commandPool, nullptr);
+                frame.commandPool = VK_NULL_HANDLE;
+                frame.commandBuffers.clear();
+            }
+        }
+        this->slots.clear();
+        this->sliceBuffers.clear();
+
+        this->VKjobSystem = nullptr;
+        this->VKdevice = VK_NULL_HANDLE;
+    }
+
+    VkCommandBuffer VKCommandRecorder::acquireCommandBuffer(VKRecorderSlot& slot, uint32_t frameIndex)
+    {
+        VKRecorderFrame& frame = slot.frames[frameIndex];
+
+        // 풀을 리셋한 뒤에는 이전에 할당한 버퍼를 다시 사용합니다.
+        if (frame.usedCount == frame.commandBuffers.size()) {
+            VkCommandBufferAllocateInfo allocInfo{};
+            allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+            allocInfo.commandPool = frame.commandPool;
+            allocInfo.level = VK_COMMAND_BUFFER_LEVEL_SECONDARY;
+            allocInfo.commandBufferCount = 1;
+
+            VkCommandBuffer commandBuffer = VK_NULL_HANDLE;
+            VK_CHECK_RESULT(vkAllocateCommandBuffers(this->VKdevice, &allocInfo, &commandBuffer));
+            frame.commandBuffers.push_back(commandBuffer);
+        }
+
+        return frame.commandBuffers[frame.usedCount++];
+    }
+
+    VkCommandBuffer VKCommandRecorder::recordSlice(
+        uint32_t sliceIndex,
+        uint32_t sliceCount,
+        uint32_t frameIndex,
+        const VkCommandBufferInheritanceInfo& inheritanceInfo,
+        uint32_t drawCount,
+        const VKRecordFunction& recordFunction)
+    {
+        VK_TRACE_SCOPE("record slice");
+
+        VKRecorderSlot& slot = this->slots[this->VKjobSystem->getThreadIndex()];
+
+        // draw를 슬라이스 수로 균등하게 나눕니다. (앞쪽 슬라이스가 하나씩 더 가져감)
+        const uint32_t base = drawCount / sliceCount;
+        const uint32_t remain = drawCount % sliceCount;
+        const uint32_t first = sliceIndex * base + std::min(sliceIndex, remain);
+        const uint32_t count = base + (sliceIndex < remain ? 1 : 0);
+
+        VkCommandBuffer commandBuffer = this->acquireCommandBuffer(slot, frameIndex);
+
+        VkCommandBufferBeginInfo beginInfo{};
+        beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+        beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT | VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT;
+        beginInfo.pInheritanceInfo = &inheritanceInfo;
+
+        VK_CHECK_RESULT(vkBeginCommandBuffer(commandBuffer, &beginInfo));
+        if (count > 0) {
+            recordFunction(commandBuffer, first, count);
+        }
+        VK_CHECK_RESULT(vkEndCommandBuffer(commandBuffer));
+
+        return commandBuffer;
+    }
+}
@@ -0,0 +1,79 @@
+﻿#ifndef INCLUDE_VULKANCOMMANDRECORDER_H_
+#define INCLUDE_VULKANCOMMANDRECORDER_H_
+
+#include "../_common.h"
+#include "VKjobSystem.h"
+
+#include <functional>
+
+namespace vkengine {
+
+    // secondary 커맨드 버퍼에 draw 목록의 [first, first + count) 구간을 기록하는 함수
+    // commandBuffer는 이미 RENDER_PASS_CONTINUE로 begin된 상태로 전달됩니다.
+    // -> 파이프라인/뷰포트/디스크립터 같은 상태는 상속되지 않으므로 각 구간에서 다시 바인딩해야 합니다.
+    using VKRecordFunction = std::function<void(VkCommandBuffer commandBuffer, uint32_t first, uint32_t count)>;
+
+    // draw 목록을 잡 시스템의 스레드 수만큼 나눠 secondary 커맨드 버퍼에 병렬로 기록하는 클래스
+    // 잡 시스템 스레드(슬롯)마다 프레임별 커맨드 풀을 가지므로 풀에 대한 잠금 없이 기록합니다.
+    // 슬라이스는 잡으로 실행되며, 실행한 스레드의 슬롯에서 커맨드 버퍼를 가져옵니다.
+    class VKCommandRecorder {
+    public:
+        VKCommandRecorder(VkDevice device, uint32_t queueFamilyIndex, job::VKJobSystem& jobSystem);
+        ~VKCommandRecorder();
+
+        VKCommandRecorder(const VKCommandRecorder&) = delete;
+        VKCommandRecorder& operator=(const VKCommandRecorder&) = delete;
+
+        // frameIndex 프레임의 커맨드 풀을 리셋합니다. -> 그 프레임의 fence를 기다린 뒤 호출
+        void resetFrame(uint32_t frameIndex);
+
+        // drawCount개의 draw를 슬라이스로 나눠 각 슬롯이 secondary 커맨드 버퍼에 기록하고,
+        // 모두 끝나면 primary에 vkCmdExecuteCommands로 실행합니다.
+        // primary는 VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS로 렌더 패스를 시작한 상태여야 합니다.
+        // overlayFunction이 있으면 draw 다음에 메인 스레드에서 따로 기록합니다. (UI 등)
+        void record(
+            VkCommandBuffer primary,
+            uint32_t frameIndex,
+            const VkCommandBufferInheritanceInfo& inheritanceInfo,
+            uint32_t drawCount,
+            const VKRecordFunction& recordFunction,
+            const std::function<void(VkCommandBuffer commandBuffer)>& overlayFunction = nullptr);
+
+        uint32_t getThreadCount() const { return static_cast<uint32_t>(this->slots.size()); }
+
+        // 한 슬라이스의 최소 draw 수 -> 이보다 적으면 스레드를 나누지 않습니다.
+        void setMinDrawsPerSlice(uint32_t count) { this->minDrawsPerSlice = std::max(1u, count); }
+
+        // 커맨드 풀을 해제하는 함수 -> vkDestroyDevice 전에 호출
+        void cleanup();
+
+    private:
+        // 슬롯 하나가 프레임마다 사용하는 커맨드 풀과 secondary 커맨드 버퍼
+        struct VKRecorderFrame {
+            VkCommandPool commandPool{ VK_NULL_HANDLE };
+            std::vector<VkCommandBuffer> commandBuffers;
+            uint32_t usedCount = 0;
+        };
+
+        struct VKRecorderSlot {
+            std::array<VKRecorderFrame, MAX_FRAMES_IN_FLIGHT> frames{};
+        };
+
+        VkCommandBuffer acquireCommandBuffer(VKRecorderSlot& slot, uint32_t frameIndex);
+        VkCommandBuffer recordSlice(
+            uint32_t sliceIndex,
+            uint32_t sliceCount,
+            uint32_t frameIndex,
+            const VkCommandBufferInheritanceInfo& inheritanceInfo,
+            uint32_t drawCount,
+            const VKRecordFunction& recordFunction);
+
+        VkDevice VKdevice{ VK_NULL_HANDLE };
+        job::VKJobSystem* VKjobSystem{ nullptr };
+        std::vector<VKRecorderSlot> slots;                  // 잡 시스템 스레드 인덱스별 슬롯
+        std::vector<VkCommandBuffer> sliceBuffers;          // 이번 record()에서 슬라이스별로 기록한 버퍼
+        uint32_t minDrawsPerSlice = 64;
+    };
+}
+
+#endif // INCLUDE_VULKANCOMMANDRECORDER_H_
@@ -0,0 +1,362 @@
+﻿#include "VKcpuCulling.h"
+#include "VKtrace.h"
+
+#include <cstring>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define VK_CULL_AVX2 1
+#define VK_CULL_SSE2 1
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define VK_CULL_SSE2 1
+#elif defined(__ARM_NEON) || defined(_M_ARM64)
+#include <arm_neon.h>
+#define VK_CULL_NEON 1
+#endif
+
+namespace vkengine {
+
+    namespace {
+        // 블록 마스크(8비트) -> 보이는 레인 번호를 앞으로 모은 표
+        // 레인 8개를 항상 쓰고 보이는 수만큼만 앞으로 나가므로 분기 없이 인덱스를 모읍니다.
+        struct CompactTable {
+            uint32_t lanes[256][CPU_CULL_BLOCK];
+            uint32_t count[256];
+
+            CompactTable()
+            {
+                for (uint32_t mask = 0; mask < 256; mask++)
+                {
+                    uint32_t n = 0;
+                    for (uint32_t lane = 0; lane < CPU_CULL_BLOCK; lane++)
+                    {
+                        if (mask & (1u << lane)) {
+                            this->lanes[mask][n++] = lane;
+                        }
+                    }
+                    for (uint32_t lane = n; lane < CPU_CULL_BLOCK; lane++)
+                    {
+                        this->lanes[mask][lane] = 0;
+                    }
+                    this->count[mask] = n;
+                }
+            }
+        };
+
+        const CompactTable& getCompactTable()
+        {
+            static const CompactTable table;
+            return table;
+        }
+
+        // 평면 하나 -> AABB는 법선 성분의 절댓값으로 반 크기를 투영합니다.
+        struct CullPlane {
+            float nx, ny, nz, w;
+            float ax, ay, az;
+        };
+
+        std::array<CullPlane, 6> makeCullPlanes(const std::array<glm::vec4, 6>& planes)
+        {
+            std::array<CullPlane, 6> cullPlanes{};
+            for (size_t i = 0; i < planes.size(); i++)
+            {
+                cullPlanes[i] = { planes[i].x, planes[i].y, planes[i].z, planes[i].w,
+                    std::fabs(planes[i].x), std::fabs(planes[i].y), std::fabs(planes[i].z) };
+            }
+            return cullPlanes;
+        }
+
+        // 스칼라 판정 -> SIMD 경로와 같은 순서로 더합니다.
+        template <bool Aabb>
+        bool isVisibleScalar(const VKCullBounds& bounds, uint32_t i, const std::array<CullPlane, 6>& planes)
+        {
+            for (const CullPlane& plane : planes)
+            {
+                const float d = plane.nx * bounds.centerX[i] + plane.ny * bounds.centerY[i] + plane.nz * bounds.centerZ[i] + plane.w;
+                const float r = Aabb
+                    ? plane.ax * bounds.extentX[i] + plane.ay * bounds.extentY[i] + plane.az * bounds.extentZ[i]
+                    : bounds.radius[i];
+                if (d < -r) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        // first부터 CPU_CULL_BLOCK개의 보이는 비트 마스크
+        template <bool Aabb>
+        uint32_t cullBlock(const VKCullBounds& bounds, uint32_t first, const std::array<CullPlane, 6>& planes)
+        {
+#if defined(VK_CULL_AVX2)
+            const __m256 cx = _mm256_loadu_ps(bounds.centerX.data() + first);
+            const __m256 cy = _mm256_loadu_ps(bounds.centerY.data() + first);
+            const __m256 cz = _mm256_loadu_ps(bounds.centerZ.data() + first);
+            const __m256 zero = _mm256_setzero_ps();
+            __m256 ex = zero, ey = zero, ez = zero, radius = zero;
+            if (Aabb) {
+                ex = _mm256_loadu_ps(bounds.extentX.data() + first);
+                ey = _mm256_loadu_ps(bounds.extentY.data() + first);
+                ez = _mm256_loadu_ps(bounds.extentZ.data() + first);
+            }
+            else {
+                radius = _mm256_loadu_ps(bounds.radius.data() + first);
+            }
+
+            __m256 visible = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+            for (const CullPlane& plane : planes)
+            {
+                __m256 d = _mm256_mul_ps(_mm256_set1_ps(plane.nx), cx);
+                d = _mm256_add_ps(d, _mm256_mul_ps(_mm256_set1_ps(plane.ny), cy));
+                d = _mm256_add_ps(d, _mm256_mul_ps(_mm256_set1_ps(plane.nz), cz));
+                d = _mm256_add_ps(d, _mm256_set1_ps(plane.w));
+
+                __m256 r;
+                if (Aabb) {
+                    r = _mm256_mul_ps(_mm256_set1_ps(plane.ax), ex);
+                    r = _mm256_add_ps(r, _mm256_mul_ps(_mm256_set1_ps(plane.ay), ey));
+                    r = _mm256_add_ps(r, _mm256_mul_ps(_mm256_set1_ps(plane.az), ez));
+                }
+                else {
+                    r = radius;
+                }
+
+                // d < -r 이면 바깥 -> 나머지를 남깁니다.
+                visible = _mm256_andnot_ps(_mm256_cmp_ps(d, _mm256_sub_ps(zero, r), _CMP_LT_OQ), visible);
+            }
+            return static_cast<uint32_t>(_mm256_movemask_ps(visible));
+#elif defined(VK_CULL_SSE2) || defined(VK_CULL_NEON)
+            // 4개짜리 레지스터 두 개로 블록 하나를 검사합니다.
+            uint32_t mask = 0;
+            for (uint32_t half = 0; half < 2; half++)
+            {
+                const uint32_t offset = first + half * 4;
+#if defined(VK_CULL_SSE2)
+                const __m128 cx = _mm_loadu_ps(bounds.centerX.data() + offset);
+                const __m128 cy = _mm_loadu_ps(bounds.centerY.data() + offset);
+                const __m128 cz = _mm_loadu_ps(bounds.centerZ.data() + offset);
+                const __m128 zero = _mm_setzero_ps();
+                __m128 ex = zero, ey = zero, ez = zero, radius = zero;
+                if (Aabb) {
+                    ex = _mm_loadu_ps(bounds.extentX.data() + offset);
+                    ey = _mm_loadu_ps(bounds.extentY.data() + offset);
+                    ez = _mm_loadu_ps(bounds.extentZ.data() + offset);
+                }
+                else {
+                    radius = _mm_loadu_ps(bounds.radius.data() + offset);
+                }
+
+                __m128 culled = zero;
+                for (const CullPlane& plane : planes)
+                {
+                    __m128 d = _mm_mul_ps(_mm_set1_ps(plane.nx), cx);
+                    d = _mm_add_ps(d, _mm_mul_ps(_mm_set1_ps(plane.ny), cy));
+                    d = _mm_add_ps(d, _mm_mul_ps(_mm_set1_ps(plane.nz), cz));
+                    d = _mm_add_ps(d, _mm_set1_ps(plane.w));
+
+                    __m128 r;
+                    if (Aabb) {
+                        r = _mm_mul_ps(_mm_set1_ps(plane.ax), ex);
+                        r = _mm_add_ps(r, _mm_mul_ps(_mm_set1_ps(plane.ay), ey));
+                        r = _mm_add_ps(r, _mm_mul_ps(_mm_set1_ps(plane.az), ez));
+                    }
+                    else {
+                        r = radius;
+                    }
+
+                    culled = _mm_or_ps(culled, _mm_cmplt_ps(d, _mm_sub_ps(zero, r)));
+                }
+                mask |= (~static_cast<uint32_t>(_mm_movemask_ps(culled)) & 0xFu) << (half * 4);
+#else
+                const float32x4_t cx = vld1q_f32(bounds.centerX.data() + offset);
+                const float32x4_t cy = vld1q_f32(bounds.centerY.data() + offset);
+                const float32x4_t cz = vld1q_f32(bounds.centerZ.data() + offset);
+                float32x4_t ex = vdupq_n_f32(0.0f), ey = ex, ez = ex, radius = ex;
+                if (Aabb) {
+                    ex = vld1q_f32(bounds.extentX.data() + offset);
+                    ey = vld1q_f32(bounds.extentY.data() + offset);
+                    ez = vld1q_f32(bounds.extentZ.data() + offset);
+                }
+                else {
+                    radius = vld1q_f32(bounds.radius.data() + offset);
+                }
+
+                uint32x4_t culled = vdupq_n_u32(0);
+                for (const CullPlane& plane : planes)
+                {
+                    float32x4_t d = vmulq_n_f32(cx, plane.nx);
+                    d = vaddq_f32(d, vmulq_n_f32(cy, plane.ny));
+                    d = vaddq_f32(d, vmulq_n_f32(cz, plane.nz));
+                    d = vaddq_f32(d, vdupq_n_f32(plane.w));
+
+                    float32x4_t r;
+                    if (Aabb) {
+                        r = vmulq_n_f32(ex, plane.ax);
+                        r = vaddq_f32(r, vmulq_n_f32(ey, plane.ay));
+                        r = vaddq_f32(r, vmulq_n_f32(ez, plane.az));
+                    }
+                    else {
+                        r = radius;
+                    }
+
+                    culled = vorrq_u32(culled, vcltq_f32(d, vnegq_f32(r)));
+                }
+
+                // 레인마다 비트 하나를 골라 합치면 movemask와 같습니다. (vaddvq_u32는 AArch64 전용이라 32비트 ARM도 되도록 레인을 꺼냄)
+                static const uint32_t laneBits[4] = { 1, 2, 4, 8 };
+                const uint32x4_t culledBits = vandq_u32(culled, vld1q_u32(laneBits));
+                const uint32_t culledMask = vgetq_lane_u32(culledBits, 0) | vgetq_lane_u32(culledBits, 1) | vgetq_lane_u32(culledBits, 2) | vgetq_lane_u32(culledBits, 3);
+                mask |= (~culledMask & 0xFu) << (half * 4);
+#endif
+            }
+            return mask;
+#else
+            uint32_t mask = 0;
+            for (uint32_t lane = 0; lane < CPU_CULL_BLOCK; lane++)
+            {
+                if (isVisibleScalar<Aabb>(bounds, first + lane, planes)) {
+                    mask |= 1u << lane;
+                }
+            }
+            return mask;
+#endif
+        }
+
+        // [begin, end)의 보이는 인덱스를 out에 씁니다. (begin은 CPU_CULL_BLOCK의 배수)
+        // 블록마다 레인 8개를 쓰므로 out은 end - begin을 CPU_CULL_BLOCK의 배수로 올린 만큼 있어야 합니다. -> 보이는 수 반환
+        template <bool Aabb>
+        uint32_t cullRange(const VKCullBounds& bounds, const std::array<CullPlane, 6>& planes, uint32_t begin, uint32_t end, uint32_t* out)
+        {
+            const CompactTable& table = getCompactTable();
+            uint32_t n = 0;
+
+            for (uint32_t first = begin; first < end; first += CPU_CULL_BLOCK)
+            {
+                uint32_t mask = cullBlock<Aabb>(bounds, first, planes);
+
+                // 마지막 블록의 채움 레인은 버립니다.
+                if (end - first < CPU_CULL_BLOCK) {
+                    mask &= (1u << (end - first)) - 1u;
+                }
+
+#if defined(VK_CULL_AVX2)
+                const __m256i lanes = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(table.lanes[mask]));
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + n), _mm256_add_epi32(lanes, _mm256_set1_epi32(static_cast<int>(first))));
+#else
+                for (uint32_t lane = 0; lane < CPU_CULL_BLOCK; lane++)
+                {
+                    out[n + lane] = first + table.lanes[mask][lane];
+                }
+#endif
+                n += table.count[mask];
+            }
+
+            return n;
+        }
+
+        template <bool Aabb>
+        uint32_t cullFrustumImpl(const VKCullBounds& bounds, const std::array<CullPlane, 6>& planes, std::vector<uint32_t>& visible, job::VKJobSystem* jobSystem)
+        {
+            const uint32_t count = bounds.getCount();
+            visible.resize(bounds.centerX.size());
+
+            if (jobSystem == nullptr || count <= CPU_CULL_GRAIN) {
+                const uint32_t visibleCount = cullRange<Aabb>(bounds, planes, 0, count, visible.data());
+                visible.resize(visibleCount);
+                return visibleCount;
+            }
+
+            // 구간마다 자기 시작 위치에 쓰고, 끝난 뒤 순서대로 앞으로 당깁니다.
+            const uint32_t chunkCount = (count + CPU_CULL_GRAIN - 1) / CPU_CULL_GRAIN;
+            std::vector<uint32_t> chunkCounts(chunkCount);
+
+            jobSystem->parallelFor(chunkCount, 1, [&](uint32_t beginChunk, uint32_t endChunk) {
+                for (uint32_t chunk = beginChunk; chunk < endChunk; chunk++)
+                {
+                    const uint32_t begin = chunk * CPU_CULL_GRAIN;
+                    const uint32_t end = std::min(count, begin + CPU_CULL_GRAIN);
+                    chunkCounts[chunk] = cullRange<Aabb>(bounds, planes, begin, end, visible.data() + begin);
+                }
+            });
+
+            uint32_t visibleCount = chunkCounts[0];
+            for (uint32_t chunk = 1; chunk < chunkCount; chunk++)
+            {
+                memmove(visible.data() + visibleCount, visible.data() + static_cast<size_t>(chunk) * CPU_CULL_GRAIN, chunkCounts[chunk] * sizeof(uint32_t));
+                visibleCount += chunkCounts[chunk];
+            }
+
+            visible.resize(visibleCount);
+            return visibleCount;
+        }
+    }
+
+    void VKCullBounds::resize(uint32_t count)
+    {
+        // 블록 단위로 읽으므로 CPU_CULL_BLOCK의 배수로 늘립니다.
+        const size_t padded = (static_cast<size_t>(count) + CPU_CULL_BLOCK - 1) / CPU_CULL_BLOCK * CPU_CULL_BLOCK;
+
+        this->centerX.resize(padded, 0.0f);
+        this->centerY.resize(padded, 0.0f);
+        this->centerZ.resize(padded, 0.0f);
+        this->radius.resize(padded, 0.0f);
+        this->extentX.resize(padded, 0.0f);
+        this->extentY.resize(padded, 0.0f);
+        this->extentZ.resize(padded, 0.0f);
+        this->count = count;
+    }
+
+    void VKCullBounds::set(uint32_t index, const glm::vec3& center, float radius, const glm::vec3& halfExtent)
+    {
+        this->centerX[index] = center.x;
+        this->centerY[index] = center.y;
+        this->centerZ[index] = center.z;
+        this->radius[index] = radius;
+        this->extentX[index] = halfExtent.x;
+        this->extentY[index] = halfExtent.y;
+        this->extentZ[index] = halfExtent.z;
+    }
+
+    const char* getCullSimdName()
+    {
+#if defined(VK_CULL_AVX2)
+        return "avx2";
+#elif defined(VK_CULL_SSE2)
+        return "sse2";
+#elif defined(VK_CULL_NEON)
+        return "neon";
+#else
+        return "scalar";
+#endif
+    }
+
+    uint32_t cullFrustum(const VKCullBounds& bounds, const std::array<glm::vec4, 6>& planes, VKCullVolume volume,
+        std::vector<uint32_t>& visible, job::VKJobSystem* jobSystem)
+    {
+        VK_TRACE_SCOPE("cullFrustum");
+
+        const std::array<CullPlane, 6> cullPlanes = makeCullPlanes(planes);
+        return (volume == VKCullVolume::Aabb)
+            ? cullFrustumImpl<true>(bounds, cullPlanes, visible, jobSystem)
+            : cullFrustumImpl<false>(bounds, cullPlanes, visible, jobSystem);
+    }
+
+    uint32_t cullFrustumReference(const VKCullBounds& bounds, const std::array<glm::vec4, 6>& planes, VKCullVolume volume,
+        std::vector<uint32_t>& visible)
+    {
+        const std::array<CullPlane, 6> cullPlanes = makeCullPlanes(planes);
+        visible.clear();
+
+        for (uint32_t i = 0; i < bounds.getCount(); i++)
+        {
+            const bool isVisible = (volume == VKCullVolume::Aabb)
+                ? isVisibleScalar<true>(bounds, i, cullPlanes)
+                : isVisibleScalar<false>(bounds, i, cullPlanes);
+            if (isVisible) {
+                visible.push_back(i);
+            }
+        }
+
+        return static_cast<uint32_t>(visible.size());
+    }
+}
@@ -0,0 +1,55 @@
+﻿#ifndef INCLUDE_VULKANCPUCULLING_H_
+#define INCLUDE_VULKANCPUCULLING_H_
+
+#include "../_common.h"
+#include "../struct.h"
+#include "VKjobSystem.h"
+
+namespace vkengine {
+
+    constexpr uint32_t CPU_CULL_BLOCK = 8;                          // 한 번에 검사하는 오브젝트 수 (AVX2 레지스터 1개, SSE/NEON 2개)
+    constexpr uint32_t CPU_CULL_GRAIN = 32 * 1024;                  // 잡 하나가 맡는 오브젝트 수 (CPU_CULL_BLOCK의 배수)
+
+    // 절두체와 비교할 경계 볼륨
+    enum class VKCullVolume {
+        Sphere,                                                     // 중심 + 반지름 (평면마다 곱셈 3번)
+        Aabb,                                                       // 중심 + 반 크기 -> 평면 법선 방향으로 투영한 반지름과 비교 (더 정확함)
+    };
+
+    // 오브젝트 경계 볼륨을 성분별 배열(SoA)로 담습니다. -> SIMD 레지스터 하나에 오브젝트 8개의 같은 성분을 읽습니다.
+    // 구와 AABB는 중심을 같이 씁니다. 배열은 CPU_CULL_BLOCK의 배수로 0을 채워 두므로 마지막 블록도 그대로 읽습니다.
+    class VKCullBounds {
+    public:
+        // 오브젝트 수를 바꿉니다. -> 늘어난 부분은 set으로 채웁니다.
+        void resize(uint32_t count);
+
+        void set(uint32_t index, const glm::vec3& center, float radius, const glm::vec3& halfExtent);
+
+        uint32_t getCount() const { return this->count; }
+
+        std::vector<float> centerX;
+        std::vector<float> centerY;
+        std::vector<float> centerZ;
+        std::vector<float> radius;
+        std::vector<float> extentX;
+        std::vector<float> extentY;
+        std::vector<float> extentZ;
+
+    private:
+        uint32_t count = 0;
+    };
+
+    // 컴파일된 SIMD 경로 ("avx2", "sse2", "neon", "scalar")
+    const char* getCullSimdName();
+
+    // 평면 (Camera::getFrustumPlanes) 6개 중 하나라도 볼륨이 완전히 바깥에 있으면 버리고, 보이는 오브젝트의 인덱스를 오름차순으로 visible에 씁니다.
+    // jobSystem이 있으면 CPU_CULL_GRAIN 단위로 나눠 병렬로 검사한 뒤 순서대로 이어 붙입니다. -> 보이는 수 반환
+    uint32_t cullFrustum(const VKCullBounds& bounds, const std::array<glm::vec4, 6>& planes, VKCullVolume volume,
+        std::vector<uint32_t>& visible, job::VKJobSystem* jobSystem = nullptr);
+
+    // cullFrustum과 같은 판정을 하는 스칼라 기준 구현 (벤치마크와 검증용)
+    uint32_t cullFrustumReference(const VKCullBounds& bounds, const std::array<glm::vec4, 6>& planes, VKCullVolume volume,
+        std::vector<uint32_t>& visible);
+}
+
+#endif // INCLUDE_VULKANCPUCULLING_H_
@@ -39,7 +39,7 @@ namespace vkengine {
         helper::getDeviceExtensionSupport(physicalDevice, &this->supportedExtensions);
     }
 
-    VkResult VKDevice_::createLogicalDevice()
+    VkResult VKDevice_::createLogicalDevice(const std::vector<const char*>& extensions)
     {
         // 1.  ġ ť йи ε ãϴ. ->  ܰ迡 ̹ ãҽϴ.
         // 2. ť   ü ʱȭմϴ. -> ̹ ãҽϴ.
@@ -52,7 +52,8 @@ namespace vkengine {
 
         std::set<uint32_t> uniqueQueueFamilies = {
             this->queueFamilyIndices.graphicsAndComputeFamily,
-            this->queueFamilyIndices.presentFamily
+            this->queueFamilyIndices.presentFamily,
+            this->queueFamilyIndices.transferFamily
         };
 
         float queuePriority = 1.0f;                                                                    // ť 켱 մϴ.
@@ -72,8 +73,8 @@ namespace vkengine {
         createInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;                            // ü Ÿ մϴ.
         createInfo.queueCreateInfoCount = static_cast<uint32_t>(queueCreateInfos.size());   // ť    մϴ.
         createInfo.pQueueCreateInfos = queueCreateInfos.data();                             // ť   ͸ մϴ.
-        createInfo.enabledExtensionCount = static_cast<uint32_t>(deviceExtensions.size());  // Ȱȭ Ȯ  մϴ.
-        createInfo.ppEnabledExtensionNames = deviceExtensions.data();                       // Ȱȭ Ȯ  մϴ.
+        createInfo.enabledExtensionCount = static_cast<uint32_t>(extensions.size());        // Ȱȭ Ȯ  մϴ.
+        createInfo.ppEnabledExtensionNames = extensions.data();                             // Ȱȭ Ȯ  մϴ.
         createInfo.pEnabledFeatures = &this->features;                                      //  ġ  ͸ մϴ.
 
         if (enableValidationLayers) {
@@ -91,16 +92,32 @@ namespace vkengine {
             return result;
         }
 
+        this->enabledExtensions.insert(extensions.begin(), extensions.end());
+
         //  ̽ ׷ ť ڵ ɴϴ.
         vkGetDeviceQueue(this->VKdevice, this->queueFamilyIndices.graphicsAndComputeFamily, 0, &this->graphicsVKQueue);
         
         //  ̽ ̼ ť ڵ ɴϴ.
         vkGetDeviceQueue(this->VKdevice, this->queueFamilyIndices.presentFamily, 0, &this->presentVKQueue);
 
+        //  ̽  ť ڵ ɴϴ.
+        vkGetDeviceQueue(this->VKdevice, this->queueFamilyIndices.transferFamily, 0, &this->transferVKQueue);
+
+        //  ̽ ޸ Ҵ⸦ մϴ.
+        this->VKallocator = std::make_unique<memory::VKMemoryAllocator>(this->VKphysicalDevice, this->VKdevice);
+
+        //  ť ϴ ¡  ۸ մϴ.
+        //  ť йи   ε尡  ҽ  ׷Ƚ ť ѱϴ.
+        this->VKstagingRing = std::make_unique<memory::VKStagingRing>(
+            this->VKdevice,
+            this->transferVKQueue, this->queueFamilyIndices.transferFamily,
+            this->graphicsVKQueue, this->queueFamilyIndices.graphicsAndComputeFamily,
+            this->VKallocator.get());
+
         return result;
     }
 
-    void VKDevice_::createimageview(uint32_t width, uint32_t height, uint32_t mipLevels, VkSampleCountFlagBits numSamples, VkFormat format, VkImageTiling tiling, VkImageUsageFlags usage, VkMemoryPropertyFlags properties, VkImage& image, VkDeviceMemory& imageMemory)
+    void VKDevice_::createimageview(uint32_t width, uint32_t height, uint32_t mipLevels, VkSampleCountFlagBits numSamples, VkFormat format, VkImageTiling tiling, VkImageUsageFlags usage, VkMemoryPropertyFlags properties, VkImage& image, memory::VKAllocation& imageMemory)
     {
         VkImageCreateInfo imageInfo{};
 
@@ -117,38 +134,30 @@ namespace vkengine {
         imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
         imageInfo.flags = 0; // Optional
 
-        VK_CHECK_RESULT(vkCreateImage(VKdevice, &imageInfo, nullptr, &image));
-
-        VkMemoryRequirements memRequirements;
-        vkGetImageMemoryRequirements(VKdevice, image, &memRequirements);
-
-        VkMemoryAllocateInfo allocInfo{};
-        allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-        allocInfo.allocationSize = memRequirements.size;
-        allocInfo.memoryTypeIndex = helper::findMemoryType(VKphysicalDevice, memRequirements.memoryTypeBits, properties);
-
-        VK_CHECK_RESULT(vkAllocateMemory(VKdevice, &allocInfo, nullptr, &imageMemory));
-        VK_CHECK_RESULT(vkBindImageMemory(VKdevice, image, imageMemory, 0));
+        // ̹ ϰ Ҵ (OPTIMAL  Ǯ) εմϴ.
+        VK_CHECK_RESULT(this->VKallocator->createImage(imageInfo, properties, image, imageMemory));
     }
 
-    const VkShaderModule VKDevice_::createShaderModule(const std::string& path)
+    void VKDevice_::cleanup()
     {
-        auto shaderCode = helper::readFile(path);
-
-        VkShaderModuleCreateInfo createInfo{};
-        createInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
-        createInfo.codeSize = shaderCode.size();
-        createInfo.pCode = reinterpret_cast<const uint32_t*>(shaderCode.data());
+        helper::releaseSingleTimeCommands(VKdevice, VKcommandPool);
+        vkDestroyCommandPool(VKdevice, VKcommandPool, nullptr);
 
-        VkShaderModule shaderModule;
-        VK_CHECK_RESULT(vkCreateShaderModule(this->VKdevice, &createInfo, nullptr, &shaderModule));
+        // ¡  Ҵ ۸ Ƿ Ҵ⺸  մϴ.
+        if (this->VKstagingRing) {
+            this->VKstagingRing->cleanup();
+            this->VKstagingRing.reset();
+        }
 
-        return shaderModule;
-    }
+        // Ҵ  ̽  Ǿ մϴ.
+        if (this->VKallocator) {
+#ifdef DEBUG_
+            this->VKallocator->printStats();
+#endif // DEBUG_
+            this->VKallocator->cleanup();
+            this->VKallocator.reset();
+        }
 
-    void VKDevice_::cleanup()
-    {
-        vkDestroyCommandPool(VKdevice, VKcommandPool, nullptr);
         vkDestroyDevice(VKdevice, nullptr);
     }
 }
\ No newline at end of file
@@ -3,6 +3,8 @@
 
 #include "../_common.h"
 #include "../struct.h"
+#include "VKallocator.h"
+#include "VKstaging.h"
 
 namespace vkengine {
 
@@ -18,12 +20,16 @@ namespace vkengine {
         VkPhysicalDeviceMemoryProperties memoryProperties{};                  // ޸ Ӽ
         QueueFamilyIndices queueFamilyIndices{};                              // ť йи ε
         std::set<std::string> supportedExtensions;                            // Ǵ Extensions 
+        std::set<std::string> enabledExtensions;                              //  ̽    Extensions
         VkCommandPool VKcommandPool{ VK_NULL_HANDLE };                        // Ŀǵ Ǯ -> Ŀǵ ۸ ϴ  
         VkQueue graphicsVKQueue{ VK_NULL_HANDLE };                            // ׷Ƚ ť -> ׷Ƚ  óϴ ť
         VkQueue presentVKQueue{ VK_NULL_HANDLE };                             // Ʈ ť ->  ý۰ Vulkan ϴ ̽
+        VkQueue transferVKQueue{ VK_NULL_HANDLE };                            //  ť -> ε()  óϴ ť
+        std::unique_ptr<memory::VKMemoryAllocator> VKallocator;               // ̽ ޸ Ҵ -> /̹ ޸𸮸   
+        std::unique_ptr<memory::VKStagingRing> VKstagingRing;                 // ¡   -> ε带    
 
         explicit VKDevice_(VkPhysicalDevice physicalDevice, QueueFamilyIndices indice);
-        VkResult createLogicalDevice();
+        VkResult createLogicalDevice(const std::vector<const char*>& extensions = deviceExtensions);   // 帮  headlessDeviceExtensions
         void createimageview(
             uint32_t width,
             uint32_t height,
@@ -34,8 +40,7 @@ namespace vkengine {
             VkImageUsageFlags usage,
             VkMemoryPropertyFlags properties,
             VkImage& image,
-            VkDeviceMemory& imageMemory);
-        const VkShaderModule createShaderModule(const std::string& path);
+            memory::VKAllocation& imageMemory);
 
         void cleanup();
     };
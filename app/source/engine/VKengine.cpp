@@ -2,6 +2,7 @@
 #include "VKkey.h"
 #include "Debug.h"
 #include "helper.h"
+#include "VKtrace.h"
 
 using vkengine::input::key_callback;
 using vkengine::VKDevice_;
@@ -20,6 +21,8 @@ namespace vkengine
     }
 
     VulkanEngine::VulkanEngine(std::string root_path) {
+        VK_TRACE_THREAD_NAME("main");
+
         this->RootPath = root_path;
         this->VKwindow = nullptr;
         this->VKinstance = {};
@@ -45,6 +48,14 @@ namespace vkengine
 
     VulkanEngine& VulkanEngine::Get() { return *loadedEngine; }
 
+    void VulkanEngine::setHeadless(bool value, uint32_t frameCount)
+    {
+        assert(!this->_isInitialized);
+
+        this->headless = value;
+        this->headlessFrameCount = frameCount;
+    }
+
     void VulkanEngine::init()
     {
         assert(loadedEngine == nullptr);
@@ -61,7 +72,7 @@ namespace vkengine
     {
         if (this->_isInitialized)
         {
-            this->VKdepthStencill.cleanup(this->VKdevice->VKdevice);
+            this->VKdepthStencill.cleanup(this->VKdevice->VKdevice, this->VKdevice->VKallocator.get());
 
             for (auto framebuffers : this->VKswapChainFramebuffers)
             {
@@ -79,7 +90,15 @@ namespace vkengine
                 vkDestroyFence(this->VKdevice->VKdevice, this->VKframeData[i].VkinFlightFences, nullptr);
             }
 
-            vkDestroyPipelineCache(this->VKdevice->VKdevice, this->VKpipelineCache, nullptr);
+            this->VKgpuProfiler.cleanup();
+
+            //  带 ߰   ,  ĳø Ϸ ϰ մϴ.
+            this->VKpipelineManager->cleanup();
+            this->VKpipelineCache.cleanup();
+
+            // 庰 Ŀǵ Ǯ ϰ  ý Ŀ 带 ϴ.
+            this->VKcommandRecorder->cleanup();
+            this->VKjobSystem->cleanup();
 
             this->VKdevice->cleanup();
 
@@ -87,11 +106,15 @@ namespace vkengine
                 DestroyDebugUtilsMessengerEXT(this->VKinstance, this->VKdebugUtilsMessenger, nullptr);
             }
 
-            vkDestroySurfaceKHR(this->VKinstance, this->VKsurface, nullptr);
+            if (this->VKsurface != VK_NULL_HANDLE) {
+                vkDestroySurfaceKHR(this->VKinstance, this->VKsurface, nullptr);
+            }
             vkDestroyInstance(this->VKinstance, nullptr);
 
-            glfwDestroyWindow(this->VKwindow);
-            glfwTerminate();
+            if (!this->headless) {
+                glfwDestroyWindow(this->VKwindow);
+                glfwTerminate();
+            }
         }
 
         loadedEngine = nullptr;
@@ -99,8 +122,7 @@ namespace vkengine
 
     bool VulkanEngine::mainLoop()
     {
-        while (!glfwWindowShouldClose(this->VKwindow)) {
-            glfwPollEvents();
+        while (this->nextFrame()) {
             drawFrame();
 #ifdef DEBUG_
             //printf("update\n");
@@ -114,16 +136,32 @@ namespace vkengine
         return state;
     }
 
+    bool VulkanEngine::nextFrame()
+    {
+        if (this->headless) {
+            return this->renderedFrameCount++ < this->headlessFrameCount;
+        }
+
+        if (glfwWindowShouldClose(this->VKwindow)) {
+            return false;
+        }
+
+        glfwPollEvents();
+        return true;
+    }
+
     void VulkanEngine::initWindow()
     {
+        // 帮  â  ʽϴ. -> GLFW ʱȭ 
+        if (this->headless) {
+            return;
+        }
+
         glfwInit();
 
         glfwWindowHint(GLFW_CLIENT_API, GLFW_NO_API);
 
-        int WIDTH_ = WIDTH;
-        int HEIGHT_ = HEIGHT;
-
-        this->VKwindow = glfwCreateWindow(WIDTH_, HEIGHT_, "vulkan game engine", nullptr, nullptr);
+        this->VKwindow = glfwCreateWindow(this->windowWidth, this->windowHeight, "vulkan game engine", nullptr, nullptr);
 
         glfwSetWindowUserPointer(this->VKwindow, this);
         glfwSetFramebufferSizeCallback(this->VKwindow, framebufferResizeCallback);
@@ -146,14 +184,27 @@ namespace vkengine
         VulkanEngine::createFramebuffers();
         
         VulkanEngine::init_sync_structures();
+
+        VulkanEngine::createGpuProfiler();
         
         VulkanEngine::createPipelineCache();
 
+        //  ׷Ƚ  ڸ   ĳ÷ ϴ.
+        this->VKpipelineManager = std::make_unique<VKPipelineManager>(this->VKdevice->VKdevice, this->VKpipelineCache);
+
+        //  ܰ(, uniform  )  ϴ  ý մϴ.
+        this->VKjobSystem = std::make_unique<job::VKJobSystem>();
+
+        //  ý 庰 Ŀǵ Ǯ secondary Ŀǵ ۸ ϴ ڴ մϴ.
+        this->VKcommandRecorder = std::make_unique<VKCommandRecorder>(this->VKdevice->VKdevice, this->VKdevice->queueFamilyIndices.graphicsAndComputeFamily, *this->VKjobSystem);
+
         return true;
     }
 
     void VulkanEngine::prepareFame(uint32_t* imageIndex)
     {
+        VK_TRACE_SCOPE("prepareFame");
+
         VkResult result = this->VKswapChain->acquireNextImage(this->getCurrnetFrameData().VkimageavailableSemaphore, *imageIndex);
 
         if (result == VK_ERROR_OUT_OF_DATE_KHR) {
@@ -167,6 +218,12 @@ namespace vkengine
 
     void VulkanEngine::presentFrame(uint32_t* imageIndex)
     {
+        VK_TRACE_SCOPE("presentFrame");
+
+        // ũ ̹ Ʈ ʽϴ.
+        if (this->headless) {
+            return;
+        }
 
         VkPresentInfoKHR presentInfo{};
 
@@ -200,7 +257,7 @@ namespace vkengine
 
     bool VulkanEngine::initVulkan()
     {
-        if (glfwVulkanSupported() == GLFW_FALSE) {
+        if (!this->headless && glfwVulkanSupported() == GLFW_FALSE) {
             throw std::runtime_error("Vulkan is not supported");
         }
 
@@ -211,7 +268,10 @@ namespace vkengine
             this->setupDebugCallback();
         }
 
-        this->createSurface();
+        // 帮  ǽ  ̽ ϴ. (VKsurface == VK_NULL_HANDLE)
+        if (!this->headless) {
+            this->createSurface();
+        }
         this->createDevice();
 
         return true;
@@ -220,7 +280,15 @@ namespace vkengine
     bool VulkanEngine::init_swapchain()
     {
         this->VKswapChain = std::make_unique<VKSwapChain>(this->VKdevice->VKphysicalDevice, this->VKdevice->VKdevice, this->VKsurface, &this->VKinstance);
-        this->VKswapChain->createSwapChain(&this->VKdevice->queueFamilyIndices);
+
+        if (this->headless) {
+            // Ӹ ϳ  ũ ̹ -> â   üΰ   
+            VkExtent2D extent = { static_cast<uint32_t>(this->windowWidth), static_cast<uint32_t>(this->windowHeight) };
+            this->VKswapChain->createOffscreen(this->VKdevice->VKallocator.get(), extent, VK_FORMAT_B8G8R8A8_SRGB, MAX_FRAMES_IN_FLIGHT);
+        }
+        else {
+            this->VKswapChain->createSwapChain(&this->VKdevice->queueFamilyIndices);
+        }
         this->VKswapChain->createImageViews();
 
         return true;
@@ -311,7 +379,7 @@ namespace vkengine
 
     void VulkanEngine::createSurface()
     {
-#if CREATESURFACE_VKWIN32SURFACECREATEINFOKHR == 0
+#if defined(_WIN32) && CREATESURFACE_VKWIN32SURFACECREATEINFOKHR == 0
         VkWin32SurfaceCreateInfoKHR createInfo{};
         createInfo.sType = VK_STRUCTURE_TYPE_WIN32_SURFACE_CREATE_INFO_KHR;
         createInfo.hwnd = glfwGetWin32Window(this->VKwindow);
@@ -387,8 +455,15 @@ namespace vkengine
         this->VKdevice->features.samplerAnisotropy = VK_TRUE; // ÷ Ͽ ؽó մϴ.
         this->VKdevice->features.sampleRateShading = VK_TRUE; //  Ʈ ̵ Ͽ ȼ ׸ϴ.
 
-        //  ̽ մϴ.
-        VkResult result = this->VKdevice->createLogicalDevice();
+        // ʼ Ȯ忡 ϴ  Ȯ   ̽ մϴ.
+        std::vector<const char*> extensions = this->headless ? headlessDeviceExtensions : deviceExtensions;
+        for (const char* extension : optionalDeviceExtensions)
+        {
+            if (this->VKdevice->supportedExtensions.count(extension) != 0) {
+                extensions.push_back(extension);
+            }
+        }
+        VK_CHECK_RESULT(this->VKdevice->createLogicalDevice(extensions));
 
         // depth format ɴϴ.
         this->VKdepthStencill.depthFormat = helper::findDepthFormat(this->VKdevice->VKphysicalDevice);
@@ -444,7 +519,9 @@ namespace vkengine
         colorAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE; //  
         colorAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE; //  
         colorAttachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED; //  ̾ƿ ߿ .
-        colorAttachment.finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR; // ̼ǿ 
+        colorAttachment.finalLayout = this->headless
+            ? VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL      // 帮  ->     ֵ
+            : VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;          // ̼ǿ 
 
         ////  ÷  մϴ.
         //VkAttachmentDescription colorAttachmentResolve{};
@@ -526,12 +603,22 @@ namespace vkengine
         VK_CHECK_RESULT(vkCreateRenderPass(this->VKdevice->VKdevice, &renderPassInfo, nullptr, this->VKrenderPass.get()));
     }
 
-    void VulkanEngine::createPipelineCache()
+    void VulkanEngine::createGpuProfiler()
     {
-        VkPipelineCacheCreateInfo pipelineCacheCreateInfo{};
-        pipelineCacheCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+        this->VKgpuProfiler.create(this->VKdevice->VKdevice, this->VKdevice->properties, this->VKdevice->queueFamilyIndices.queueFamilyProperties.timestampValidBits);
+    }
 
-        VK_CHECK_RESULT(vkCreatePipelineCache(this->VKdevice->VKdevice, &pipelineCacheCreateInfo, nullptr, &this->VKpipelineCache));
+    double VulkanEngine::lapMs(std::chrono::high_resolution_clock::time_point& start)
+    {
+        const auto now = std::chrono::high_resolution_clock::now();
+        const double ms = std::chrono::duration<double, std::milli>(now - start).count();
+        start = now;
+        return ms;
+    }
+
+    void VulkanEngine::createPipelineCache()
+    {
+        this->VKpipelineCache.create(this->VKdevice->VKdevice, this->VKdevice->properties, this->RootPath + PIPELINE_CACHE_FILE);
     }
 
     void VulkanEngine::createFramebuffers()
@@ -572,7 +659,7 @@ namespace vkengine
 
         vkDeviceWaitIdle(this->VKdevice->VKdevice);
         
-        this->VKdepthStencill.cleanup(this->VKdevice->VKdevice);
+        this->VKdepthStencill.cleanup(this->VKdevice->VKdevice, this->VKdevice->VKallocator.get());
 
         for (auto framebuffers : this->VKswapChainFramebuffers)
         {
@@ -633,11 +720,16 @@ namespace vkengine
 
     std::vector<const char*> VulkanEngine::getRequiredExtensions()
     {
-        uint32_t glfwExtensionCount = 0;
-        const char** glfwExtensions;
-        glfwExtensions = glfwGetRequiredInstanceExtensions(&glfwExtensionCount);
+        std::vector<const char*> extensions;
 
-        std::vector<const char*> extensions(glfwExtensions, glfwExtensions + glfwExtensionCount);
+        // 帮  ǽ  Ƿ â ý Ȯ ʿ ϴ.
+        if (!this->headless) {
+            uint32_t glfwExtensionCount = 0;
+            const char** glfwExtensions;
+            glfwExtensions = glfwGetRequiredInstanceExtensions(&glfwExtensionCount);
+
+            extensions.assign(glfwExtensions, glfwExtensions + glfwExtensionCount);
+        }
 
         if (enableValidationLayers) {
             extensions.push_back(VK_EXT_DEBUG_UTILS_EXTENSION_NAME);
@@ -6,6 +6,11 @@
 
 #include "VKdevice.h"
 #include "VKswapchain.h"
+#include "VKjobSystem.h"
+#include "VKcommandRecorder.h"
+#include "VKpipelineCache.h"
+#include "VKpipelineManager.h"
+#include "VKgpuProfiler.h"
 
 namespace vkengine {
 
@@ -50,10 +55,17 @@ namespace vkengine {
         // present frame -> ȭ鿡  ̹ ǥ
         void presentFrame(uint32_t* imageIndex);
 
+        // 帮  -> init()  ȣմϴ.
+        // â ǽ  ũ ̹ ϰ, mainLoop frameCount  ׸  ϴ.
+        void setHeadless(bool value, uint32_t frameCount = HEADLESS_FRAME_COUNT);
+
     public:
         bool isInitialized() const { return _isInitialized; }
         bool isStopRendering() const { return stop_rendering; }
         bool isFramebufferResized() const { return framebufferResized; }
+        bool isHeadless() const { return headless; }
+        uint32_t getHeadlessFrameCount() const { return headlessFrameCount; }
+        const FrameTimings& getFrameTimings() const { return VKframeTimings; }
         GLFWwindow* getWindow() const { return VKwindow; }
         VkInstance getInstance() const { return VKinstance; }
         VkDebugUtilsMessengerEXT getDebugUtilsMessenger() const { return VKdebugUtilsMessenger; }
@@ -64,8 +76,12 @@ namespace vkengine {
         depthStencill getDepthStencill() const { return VKdepthStencill; }
         VKSwapChain* getSwapChain() const { return VKswapChain.get(); }
         VKDevice_* getDevice() const { return VKdevice.get(); }
+        VKCommandRecorder* getCommandRecorder() const { return VKcommandRecorder.get(); }
+        job::VKJobSystem* getJobSystem() const { return VKjobSystem.get(); }
         VkSampleCountFlagBits getMsaaSamples() const { return VKmsaaSamples; }
-        VkPipelineCache getPipelineCache() const { return VKpipelineCache; }
+        VKGpuProfiler& getGpuProfiler() { return VKgpuProfiler; }
+        VkPipelineCache getPipelineCache() const { return VKpipelineCache.getHandle(); }
+        VKPipelineManager* getPipelineManager() const { return VKpipelineManager.get(); }
         std::string getRootPath() const { return RootPath; }
         size_t getCurrentFrame() const { return currentFrame; }
         bool getState() const { return state; }
@@ -90,13 +106,22 @@ namespace vkengine {
         virtual void createDevice();                               // ̽(logical, pysical) 
         virtual void createDepthStencilResources();                //  ٽ 
         virtual void createRenderPass();                           //  н 
-        virtual void createPipelineCache();                        //  ĳ 
+        virtual void createPipelineCache();                        //  ĳ  ->  ĳ   ҷ
         virtual void createFramebuffers();                         //   
         virtual void recreateSwapChain();                          //  ü 
         virtual bool createCommandBuffer();                        // Ŀǵ  
 
         virtual void recordCommandBuffer(FrameData* framedata, uint32_t imageIndex);    // Ŀǵ  ڵ
 
+        //   ׸ Ȯմϴ. -> â  â  , 帮    ŭ
+        bool nextFrame();
+
+        // GPU Ϸ  -> ť Ÿӽ   Ȱ · Ӵϴ.
+        void createGpuProfiler();
+
+        // start ݱ ɸ ð(ms) -> start  Űܼ  ܰ踦 ̾   ֽϴ.
+        static double lapMs(std::chrono::high_resolution_clock::time_point& start);
+
         // 
         bool checkValidationLayerSupport();               //  ̾  Ȯ
         std::vector<const char*> getRequiredExtensions(); // ʿ Ȯ  
@@ -113,8 +138,14 @@ namespace vkengine {
 
         std::unique_ptr<VKSwapChain> VKswapChain;  //  ü ->  ü Ŭ
         std::unique_ptr<VKDevice_> VKdevice{};  // ̽ -> GPU Logical,Physical struct Handle
+        std::unique_ptr<job::VKJobSystem> VKjobSystem{};  //  ý -> ۾ ġ ٷ  ܰ踦  
+        std::unique_ptr<VKCommandRecorder> VKcommandRecorder{};  // Ƽ Ŀǵ ڴ -> 庰 Ŀǵ Ǯ secondary Ŀǵ  
         VkSampleCountFlagBits VKmsaaSamples = VK_SAMPLE_COUNT_1_BIT; // MSAA  -> MSAA  
-        VkPipelineCache VKpipelineCache{ VK_NULL_HANDLE }; //  ĳ ->  ĳø 
+        VKPipelineCache VKpipelineCache;  //  ĳ ->   Ϸ ϰ  ࿡ ҷ
+        std::unique_ptr<VKPipelineManager> VKpipelineManager{};  //   ->  ؽ÷ ߺ , ׶ 忡 
+
+        FrameTimings VKframeTimings{};  //   ܰ躰 ð
+        VKGpuProfiler VKgpuProfiler;  // GPU Ϸ ->  Ժ  Ǯ ̸   Ÿӽ 
 
         VkDescriptorPool VKdescriptorPool{ VK_NULL_HANDLE };
         VkDescriptorSetLayout VKdescriptorSetLayout{ VK_NULL_HANDLE };
@@ -131,6 +162,10 @@ namespace vkengine {
         int windowWidth = WIDTH;                                  //  ʺ
         int windowHeight = HEIGHT;                                //  
 
+        bool headless = false;                                    // 帮  -> â, ǽ,  ü  
+        uint32_t headlessFrameCount = HEADLESS_FRAME_COUNT;       // 帮 忡   
+        uint32_t renderedFrameCount = 0;                          // 帮 忡 ݱ   
+
         //  Ű尡 ȴ ¸ ϴ 迭
         bool m_keyPressed[256] = {
             false,
@@ -0,0 +1,386 @@
+﻿#include "VKgpuCulling.h"
+#include "helper.h"
+#include "VKtrace.h"
+
+namespace vkengine {
+
+    namespace {
+        bool isSphereVisible(const glm::vec4& sphere, const std::array<glm::vec4, 6>& planes)
+        {
+            // cull.comp와 같은 식과 같은 순서로 계산합니다.
+            for (const glm::vec4& plane : planes)
+            {
+                if (glm::dot(glm::vec3(plane), glm::vec3(sphere)) + plane.w < -sphere.w) {
+                    return false;
+                }
+            }
+
+            return true;
+        }
+    }
+
+    uint32_t cullObjectsReference(const VKCullObject* objects, uint32_t count, const std::array<glm::vec4, 6>& planes,
+        std::vector<VkDrawIndexedIndirectCommand>& draws)
+    {
+        VK_TRACE_SCOPE("cullObjectsReference");
+
+        draws.clear();
+
+        for (uint32_t i = 0; i < count; i++)
+        {
+            const VKCullObject& object = objects[i];
+            if (!isSphereVisible(object.sphere, planes)) {
+                continue;
+            }
+
+            VkDrawIndexedIndirectCommand draw{};
+            draw.indexCount = object.indexCount;
+            draw.instanceCount = 1;
+            draw.firstIndex = object.firstIndex;
+            draw.vertexOffset = object.vertexOffset;
+            draw.firstInstance = object.instanceIndex;
+            draws.push_back(draw);
+        }
+
+        return static_cast<uint32_t>(draws.size());
+    }
+
+    VKGpuCuller::VKGpuCuller(VKDevice_* device, VkShaderModule shader, VkPipelineCache pipelineCache, uint32_t capacity)
+    {
+        this->VKdevice = device;
+        this->capacity = std::max(1u, capacity);
+        this->objects.resize(this->capacity);
+
+        this->cmdDrawIndexedIndirectCount = reinterpret_cast<PFN_vkCmdDrawIndexedIndirectCountKHR>(
+            vkGetDeviceProcAddr(this->VKdevice->VKdevice, "vkCmdDrawIndexedIndirectCountKHR"));
+        if (this->cmdDrawIndexedIndirectCount == nullptr) {
+            throw std::runtime_error("failed to load vkCmdDrawIndexedIndirectCountKHR!");
+        }
+
+        // Binding 0: 오브젝트 (읽기), Binding 1: draw 명령 (쓰기), Binding 2: draw 수 (atomicAdd)
+        std::array<VkDescriptorSetLayoutBinding, 3> bindings{};
+        for (uint32_t i = 0; i < bindings.size(); i++)
+        {
+            bindings[i].binding = i;
+            bindings[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+            bindings[i].descriptorCount = 1;
+            bindings[i].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+            bindings[i].pImmutableSamplers = nullptr;
+        }
+
+        VkDescriptorSetLayoutCreateInfo layoutInfo{};
+        layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+        layoutInfo.bindingCount = static_cast<uint32_t>(bindings.size());
+        layoutInfo.pBindings = bindings.data();
+        VK_CHECK_RESULT(vkCreateDescriptorSetLayout(this->VKdevice->VKdevice, &layoutInfo, nullptr, &this->VKdescriptorSetLayout));
+
+        VkDescriptorPoolSize poolSize{};
+        poolSize.type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        poolSize.descriptorCount = static_cast<uint32_t>(bindings.size() * MAX_FRAMES_IN_FLIGHT);
+
+        VkDescriptorPoolCreateInfo poolInfo{};
+        poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+        poolInfo.poolSizeCount = 1;
+        poolInfo.pPoolSizes = &poolSize;
+        poolInfo.maxSets = static_cast<uint32_t>(MAX_FRAMES_IN_FLIGHT);
+        VK_CHECK_RESULT(vkCreateDescriptorPool(this->VKdevice->VKdevice, &poolInfo, nullptr, &this->VKdescriptorPool));
+
+        std::vector<VkDescriptorSetLayout> layouts(MAX_FRAMES_IN_FLIGHT, this->VKdescriptorSetLayout);
+        std::array<VkDescriptorSet, MAX_FRAMES_IN_FLIGHT> descriptorSets{};
+        VkDescriptorSetAllocateInfo allocInfo{};
+        allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+        allocInfo.descriptorPool = this->VKdescriptorPool;
+        allocInfo.descriptorSetCount = static_cast<uint32_t>(MAX_FRAMES_IN_FLIGHT);
+        allocInfo.pSetLayouts = layouts.data();
+        VK_CHECK_RESULT(vkAllocateDescriptorSets(this->VKdevice->VKdevice, &allocInfo, descriptorSets.data()));
+
+        for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++)
+        {
+            this->frames[i].descriptorSet = descriptorSets[i];
+        }
+
+        // 평면과 오브젝트 수는 푸시 상수로 넘깁니다.
+        VkPushConstantRange pushConstantRange{};
+        pushConstantRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+        pushConstantRange.offset = 0;
+        pushConstantRange.size = sizeof(VKCullPushConstants);
+
+        VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
+        pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+        pipelineLayoutInfo.setLayoutCount = 1;
+        pipelineLayoutInfo.pSetLayouts = &this->VKdescriptorSetLayout;
+        pipelineLayoutInfo.pushConstantRangeCount = 1;
+        pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
+        VK_CHECK_RESULT(vkCreatePipelineLayout(this->VKdevice->VKdevice, &pipelineLayoutInfo, nullptr, &this->VKpipelineLayout));
+
+        // 컴퓨트 파이프라인은 하나뿐이고 작으므로 파이프라인 관리자를 거치지 않고 캐시만 같이 씁니다.
+        VkComputePipelineCreateInfo pipelineInfo{};
+        pipelineInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+        pipelineInfo.stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+        pipelineInfo.stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+        pipelineInfo.stage.module = shader;
+        pipelineInfo.stage.pName = "main";
+        pipelineInfo.layout = this->VKpipelineLayout;
+        VK_CHECK_RESULT(vkCreateComputePipelines(this->VKdevice->VKdevice, pipelineCache, 1, &pipelineInfo, nullptr, &this->VKpipeline));
+
+        this->createBuffers();
+    }
+
+    VKGpuCuller::~VKGpuCuller()
+    {
+        this->cleanup();
+    }
+
+    bool VKGpuCuller::isSupported(const VKDevice_* device)
+    {
+        return device->enabledExtensions.count(VK_KHR_DRAW_INDIRECT_COUNT_EXTENSION_NAME) != 0 &&
+            device->features.drawIndirectFirstInstance == VK_TRUE;
+    }
+
+    bool VKGpuCuller::reserve(uint32_t capacity)
+    {
+        if (capacity <= this->capacity) {
+            return false;
+        }
+
+        this->destroyBuffers();
+
+        this->capacity = capacity;
+        this->objects.resize(this->capacity);
+        this->createBuffers();
+        this->markDirty();
+
+        return true;
+    }
+
+    void VKGpuCuller::setCount(uint32_t count)
+    {
+        if (count > this->capacity) {
+            throw std::runtime_error("cull object count exceeds culler capacity!");
+        }
+
+        this->count = count;
+    }
+
+    void VKGpuCuller::record(VkCommandBuffer commandBuffer, uint32_t frameIndex, const std::array<glm::vec4, 6>& planes)
+    {
+        VK_TRACE_SCOPE("VKGpuCuller::record");
+
+        VKCullFrame& frame = this->frames[frameIndex];
+        this->lastFrameIndex = frameIndex;
+
+        // 오브젝트가 바뀐 뒤 이 슬롯에 아직 복사하지 않았으면 복사합니다. (coherent -> 제출 시 보임)
+        if (frame.version != this->version) {
+            memcpy(frame.objectMemory.mapped, this->objects.data(), static_cast<size_t>(this->count) * sizeof(VKCullObject));
+            frame.version = this->version;
+        }
+
+        // 카운트를 0으로 지웁니다. -> 컴퓨트의 atomicAdd보다 먼저
+        vkCmdFillBuffer(commandBuffer, frame.countBuffer, 0, sizeof(uint32_t), 0);
+
+        VkMemoryBarrier clearBarrier{};
+        clearBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+        clearBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        clearBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+        vkCmdPipelineBarrier(commandBuffer,
+            VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+            0, 1, &clearBarrier, 0, nullptr, 0, nullptr);
+
+        if (this->count > 0) {
+            VKCullPushConstants pushConstants{};
+            std::copy(planes.begin(), planes.end(), pushConstants.planes);
+            pushConstants.objectCount = this->count;
+
+            vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, this->VKpipeline);
+            vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, this->VKpipelineLayout, 0, 1, &frame.descriptorSet, 0, nullptr);
+            vkCmdPushConstants(commandBuffer, this->VKpipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(VKCullPushConstants), &pushConstants);
+            vkCmdDispatch(commandBuffer, (this->count + GPU_CULL_WORKGROUP_SIZE - 1) / GPU_CULL_WORKGROUP_SIZE, 1, 1);
+        }
+
+        // 간접 draw가 컴퓨트가 쓴 명령과 수를 읽도록 합니다.
+        VkMemoryBarrier cullBarrier{};
+        cullBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+        cullBarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+        cullBarrier.dstAccessMask = VK_ACCESS_INDIRECT_COMMAND_READ_BIT;
+        vkCmdPipelineBarrier(commandBuffer,
+            VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT,
+            0, 1, &cullBarrier, 0, nullptr, 0, nullptr);
+    }
+
+    void VKGpuCuller::draw(VkCommandBuffer commandBuffer, uint32_t frameIndex) const
+    {
+        if (this->count == 0) {
+            return;
+        }
+
+        const VKCullFrame& frame = this->frames[frameIndex];
+        this->cmdDrawIndexedIndirectCount(commandBuffer, frame.drawBuffer, 0, frame.countBuffer, 0,
+            this->count, sizeof(VkDrawIndexedIndirectCommand));
+    }
+
+    uint32_t VKGpuCuller::readResults(std::vector<VkDrawIndexedIndirectCommand>& draws)
+    {
+        const VKCullFrame& frame = this->frames[this->lastFrameIndex];
+        const VkDeviceSize drawsSize = static_cast<VkDeviceSize>(this->count) * sizeof(VkDrawIndexedIndirectCommand);
+
+        // [수][draw 명령 count개]로 읽기용 버퍼에 복사합니다.
+        VkBuffer readbackBuffer = VK_NULL_HANDLE;
+        memory::VKAllocation readbackMemory{};
+        helper::createBuffer(
+            this->VKdevice->VKallocator.get(),
+            sizeof(uint32_t) + drawsSize,
+            VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+            readbackBuffer,
+            readbackMemory);
+
+        VkCommandBuffer commandBuffer = helper::beginSingleTimeCommands(this->VKdevice->VKdevice, this->VKdevice->VKcommandPool);
+
+        VkBufferCopy countCopy{};
+        countCopy.srcOffset = 0;
+        countCopy.dstOffset = 0;
+        countCopy.size = sizeof(uint32_t);
+        vkCmdCopyBuffer(commandBuffer, frame.countBuffer, readbackBuffer, 1, &countCopy);
+
+        if (drawsSize > 0) {
+            VkBufferCopy drawsCopy{};
+            drawsCopy.srcOffset = 0;
+            drawsCopy.dstOffset = sizeof(uint32_t);
+            drawsCopy.size = drawsSize;
+            vkCmdCopyBuffer(commandBuffer, frame.drawBuffer, readbackBuffer, 1, &drawsCopy);
+        }
+
+        VkMemoryBarrier hostBarrier{};
+        hostBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+        hostBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        hostBarrier.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+        vkCmdPipelineBarrier(commandBuffer,
+            VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_HOST_BIT,
+            0, 1, &hostBarrier, 0, nullptr, 0, nullptr);
+
+        helper::endSingleTimeCommands(this->VKdevice->VKdevice, this->VKdevice->VKcommandPool, this->VKdevice->graphicsVKQueue, commandBuffer);
+
+        const uint8_t* mapped = static_cast<const uint8_t*>(readbackMemory.mapped);
+        uint32_t visibleCount = 0;
+        memcpy(&visibleCount, mapped, sizeof(uint32_t));
+
+        // 카운트가 용량을 넘는 일은 없어야 하지만, 넘으면 버퍼에 있는 만큼만 읽습니다.
+        const uint32_t readCount = std::min(visibleCount, this->count);
+        draws.resize(readCount);
+        memcpy(draws.data(), mapped + sizeof(uint32_t), static_cast<size_t>(readCount) * sizeof(VkDrawIndexedIndirectCommand));
+
+        this->VKdevice->VKallocator->destroyBuffer(readbackBuffer, readbackMemory);
+
+        return visibleCount;
+    }
+
+    void VKGpuCuller::cleanup()
+    {
+        if (this->VKdevice == nullptr) {
+            return;
+        }
+
+        this->destroyBuffers();
+
+        vkDestroyPipeline(this->VKdevice->VKdevice, this->VKpipeline, nullptr);
+        vkDestroyPipelineLayout(this->VKdevice->VKdevice, this->VKpipelineLayout, nullptr);
+        vkDestroyDescriptorPool(this->VKdevice->VKdevice, this->VKdescriptorPool, nullptr);
+        vkDestroyDescriptorSetLayout(this->VKdevice->VKdevice, this->VKdescriptorSetLayout, nullptr);
+
+        this->VKpipeline = VK_NULL_HANDLE;
+        this->VKpipelineLayout = VK_NULL_HANDLE;
+        this->VKdescriptorPool = VK_NULL_HANDLE;
+        this->VKdescriptorSetLayout = VK_NULL_HANDLE;
+        this->VKdevice = nullptr;
+    }
+
+    void VKGpuCuller::createBuffers()
+    {
+        // 디스패치 하나로 모든 오브젝트를 덮어야 합니다.
+        const uint64_t maxObjects = static_cast<uint64_t>(this->VKdevice->properties.limits.maxComputeWorkGroupCount[0]) * GPU_CULL_WORKGROUP_SIZE;
+        if (this->capacity > maxObjects) {
+            throw std::runtime_error("cull object capacity exceeds maxComputeWorkGroupCount!");
+        }
+
+        memory::VKMemoryAllocator* allocator = this->VKdevice->VKallocator.get();
+
+        for (VKCullFrame& frame : this->frames)
+        {
+            helper::createBuffer(
+                allocator,
+                static_cast<VkDeviceSize>(this->capacity) * sizeof(VKCullObject),
+                VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                frame.objectBuffer,
+                frame.objectMemory);
+
+            helper::createBuffer(
+                allocator,
+                static_cast<VkDeviceSize>(this->capacity) * sizeof(VkDrawIndexedIndirectCommand),
+                VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+                frame.drawBuffer,
+                frame.drawMemory);
+
+            helper::createBuffer(
+                allocator,
+                sizeof(uint32_t),
+                VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+                frame.countBuffer,
+                frame.countMemory);
+
+            frame.version = 0;
+        }
+
+        this->writeDescriptors();
+    }
+
+    void VKGpuCuller::destroyBuffers()
+    {
+        memory::VKMemoryAllocator* allocator = this->VKdevice->VKallocator.get();
+
+        for (VKCullFrame& frame : this->frames)
+        {
+            if (frame.objectBuffer != VK_NULL_HANDLE) {
+                allocator->destroyBuffer(frame.objectBuffer, frame.objectMemory);
+            }
+            if (frame.drawBuffer != VK_NULL_HANDLE) {
+                allocator->destroyBuffer(frame.drawBuffer, frame.drawMemory);
+            }
+            if (frame.countBuffer != VK_NULL_HANDLE) {
+                allocator->destroyBuffer(frame.countBuffer, frame.countMemory);
+            }
+            frame.version = 0;
+        }
+    }
+
+    void VKGpuCuller::writeDescriptors()
+    {
+        // 버퍼를 다시 만들면 디스크립터 세트는 그대로 두고 다시 씁니다.
+        for (VKCullFrame& frame : this->frames)
+        {
+            std::array<VkDescriptorBufferInfo, 3> bufferInfos{};
+            bufferInfos[0].buffer = frame.objectBuffer;
+            bufferInfos[1].buffer = frame.drawBuffer;
+            bufferInfos[2].buffer = frame.countBuffer;
+
+            std::array<VkWriteDescriptorSet, 3> descriptorWrites{};
+            for (uint32_t i = 0; i < descriptorWrites.size(); i++)
+            {
+                bufferInfos[i].offset = 0;
+                bufferInfos[i].range = VK_WHOLE_SIZE;
+
+                descriptorWrites[i].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+                descriptorWrites[i].dstSet = frame.descriptorSet;
+                descriptorWrites[i].dstBinding = i;
+                descriptorWrites[i].dstArrayElement = 0;
+                descriptorWrites[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+                descriptorWrites[i].descriptorCount = 1;
+                descriptorWrites[i].pBufferInfo = &bufferInfos[i];
+            }
+
+            vkUpdateDescriptorSets(this->VKdevice->VKdevice, static_cast<uint32_t>(descriptorWrites.size()), descriptorWrites.data(), 0, nullptr);
+        }
+    }
+}
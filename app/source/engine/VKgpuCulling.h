@@ -0,0 +1,106 @@
+﻿#ifndef INCLUDE_VULKANGPUCULLING_H_
+#define INCLUDE_VULKANGPUCULLING_H_
+
+#include "../_common.h"
+#include "VKdevice.h"
+
+namespace vkengine {
+
+    constexpr uint32_t GPU_CULL_WORKGROUP_SIZE = 64;               // cull.comp의 local_size_x
+
+    // 컬링할 오브젝트 하나 (cull.comp의 CullObject와 같은 배치, std430 32바이트)
+    struct VKCullObject {
+        glm::vec4 sphere;                                           // xyz = 월드 공간 중심, w = 반지름
+        uint32_t indexCount;
+        uint32_t firstIndex;
+        int32_t vertexOffset;
+        uint32_t instanceIndex;                                     // 보이면 firstInstance로 들어갑니다. -> gl_InstanceIndex
+    };
+
+    // 컴퓨트 셰이더의 푸시 상수 (cull.comp의 CullPushConstants)
+    struct VKCullPushConstants {
+        glm::vec4 planes[6];
+        uint32_t objectCount;
+    };
+
+    // CPU 기준 구현 -> 평면 6개 중 하나라도 구가 완전히 바깥이면 버리고, 보이는 오브젝트의 draw 명령을 오브젝트 순서로 씁니다.
+    // GPU 결과는 순서가 정해지지 않으므로 firstInstance로 정렬해 비교합니다. -> 보이는 수 반환
+    uint32_t cullObjectsReference(const VKCullObject* objects, uint32_t count, const std::array<glm::vec4, 6>& planes,
+        std::vector<VkDrawIndexedIndirectCommand>& draws);
+
+    // GPU 구동 렌더링용 컴퓨트 프러스텀 컬러
+    // 오브젝트 배열을 프레임 슬롯마다 HOST_VISIBLE 버퍼에 두고 (VKInstanceBuffer와 같은 버전 방식),
+    // 컴퓨트 셰이더가 보이는 오브젝트의 VkDrawIndexedIndirectCommand와 그 수를 DEVICE_LOCAL 버퍼에 씁니다.
+    // 그래픽스는 vkCmdDrawIndexedIndirectCountKHR 한 번으로 그리므로 CPU는 보이는 수를 알 필요가 없습니다.
+    // VK_KHR_draw_indirect_count와 drawIndirectFirstInstance가 필요합니다. -> isSupported
+    class VKGpuCuller {
+    public:
+        VKGpuCuller(VKDevice_* device, VkShaderModule shader, VkPipelineCache pipelineCache, uint32_t capacity);
+        ~VKGpuCuller();
+
+        VKGpuCuller(const VKGpuCuller&) = delete;
+        VKGpuCuller& operator=(const VKGpuCuller&) = delete;
+
+        static bool isSupported(const VKDevice_* device);
+
+        // 용량을 늘립니다. 버퍼를 다시 만들므로 GPU가 쓰지 않을 때 호출합니다. -> 다시 만들었으면 true
+        bool reserve(uint32_t capacity);
+
+        // 오브젝트 수를 바꿉니다. (capacity 이하) -> 늘어난 부분은 getObjects()로 채운 뒤 markDirty
+        void setCount(uint32_t count);
+
+        VKCullObject* getObjects() { return this->objects.data(); }
+        const VKCullObject* getObjects() const { return this->objects.data(); }
+        void markDirty() { this->version++; }
+
+        // 렌더 패스 밖에서 기록합니다. 슬롯의 오브젝트 버퍼를 최신으로 만들고 (fence를 기다린 뒤),
+        // 카운트를 0으로 지운 뒤 컬링을 디스패치하고 간접 draw가 결과를 읽도록 배리어를 겁니다.
+        void record(VkCommandBuffer commandBuffer, uint32_t frameIndex, const std::array<glm::vec4, 6>& planes);
+
+        // 같은 슬롯의 결과로 그립니다. -> 파이프라인, 버텍스/인덱스 버퍼, 디스크립터는 호출한 쪽이 바인딩
+        void draw(VkCommandBuffer commandBuffer, uint32_t frameIndex) const;
+
+        // 마지막으로 record한 슬롯의 결과를 읽어 옵니다. (디바이스가 idle일 때, 검증과 벤치마크용)
+        // draws는 GPU가 쓴 순서 그대로입니다. -> 보이는 수 반환
+        uint32_t readResults(std::vector<VkDrawIndexedIndirectCommand>& draws);
+
+        uint32_t getCount() const { return this->count; }
+        uint32_t getCapacity() const { return this->capacity; }
+
+        // 버퍼, 파이프라인, 디스크립터를 해제합니다. -> GPU가 쓰지 않을 때 (vkDeviceWaitIdle 뒤) 호출
+        void cleanup();
+
+    private:
+        struct VKCullFrame {
+            VkBuffer objectBuffer = VK_NULL_HANDLE;                 // HOST_VISIBLE, 영구 매핑
+            memory::VKAllocation objectMemory{};
+            VkBuffer drawBuffer = VK_NULL_HANDLE;                   // DEVICE_LOCAL, 컴퓨트가 쓰고 간접 draw가 읽음
+            memory::VKAllocation drawMemory{};
+            VkBuffer countBuffer = VK_NULL_HANDLE;                  // DEVICE_LOCAL, uint32 하나
+            memory::VKAllocation countMemory{};
+            VkDescriptorSet descriptorSet = VK_NULL_HANDLE;
+            uint64_t version = 0;                                   // 이 슬롯에 마지막으로 복사한 버전
+        };
+
+        void createBuffers();
+        void destroyBuffers();
+        void writeDescriptors();
+
+        VKDevice_* VKdevice = nullptr;
+        PFN_vkCmdDrawIndexedIndirectCountKHR cmdDrawIndexedIndirectCount = nullptr;   // 확장 함수 -> vkGetDeviceProcAddr로 불러옴
+
+        VkDescriptorSetLayout VKdescriptorSetLayout{ VK_NULL_HANDLE };
+        VkDescriptorPool VKdescriptorPool{ VK_NULL_HANDLE };
+        VkPipelineLayout VKpipelineLayout{ VK_NULL_HANDLE };
+        VkPipeline VKpipeline{ VK_NULL_HANDLE };
+
+        std::array<VKCullFrame, MAX_FRAMES_IN_FLIGHT> frames{};
+        std::vector<VKCullObject> objects;                          // 원본 (capacity개)
+        uint32_t capacity = 0;
+        uint32_t count = 0;
+        uint32_t lastFrameIndex = 0;                                // 마지막으로 record한 슬롯 (readResults)
+        uint64_t version = 1;
+    };
+}
+
+#endif // INCLUDE_VULKANGPUCULLING_H_
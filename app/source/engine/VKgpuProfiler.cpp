@@ -0,0 +1,198 @@
+﻿#include "VKgpuProfiler.h"
+
+namespace vkengine {
+
+    VKGpuProfiler::~VKGpuProfiler()
+    {
+        this->cleanup();
+    }
+
+    void VKGpuProfiler::create(VkDevice device, const VkPhysicalDeviceProperties& properties, uint32_t timestampValidBits)
+    {
+        if (timestampValidBits == 0) {
+#ifdef DEBUG_
+            printf("[gpu profiler] timestamps are not supported on the graphics queue\n");
+#endif // DEBUG_
+            return;
+        }
+
+        this->VKdevice = device;
+        this->tickMs = static_cast<double>(properties.limits.timestampPeriod) / 1.0e6;
+        this->tickMask = (timestampValidBits >= 64) ? ~0ull : ((1ull << timestampValidBits) - 1);
+
+        VkQueryPoolCreateInfo queryPoolInfo{};
+        queryPoolInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+        queryPoolInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+        queryPoolInfo.queryCount = GPU_PROFILER_MAX_SCOPES * 2;
+
+        for (VKGpuFrameSlot& slot : this->frameSlots)
+        {
+            VK_CHECK_RESULT(vkCreateQueryPool(this->VKdevice, &queryPoolInfo, nullptr, &slot.queryPool));
+            slot.scopes.reserve(GPU_PROFILER_MAX_SCOPES);
+        }
+
+        this->openScopes.reserve(GPU_PROFILER_MAX_SCOPES);
+    }
+
+    bool VKGpuProfiler::collect(uint32_t frameIndex)
+    {
+        VKGpuFrameSlot& slot = this->frameSlots[frameIndex];
+        if (!this->isEnabled() || !slot.written) {
+            return false;
+        }
+        slot.written = false;
+
+        // 펜스를 기다린 뒤이므로 결과가 준비되어 있습니다. -> WAIT 플래그 없이 읽고, 제출되지 않은 프레임이면 버립니다.
+        const uint32_t queryCount = static_cast<uint32_t>(slot.scopes.size()) * 2;
+        uint64_t timestamps[GPU_PROFILER_MAX_SCOPES * 2];
+        if (vkGetQueryPoolResults(this->VKdevice, slot.queryPool, 0, queryCount,
+            sizeof(timestamps), timestamps, sizeof(uint64_t), VK_QUERY_RESULT_64_BIT) != VK_SUCCESS) {
+            return false;
+        }
+
+        VKGpuFrameResult result{};
+        result.frameNumber = slot.frameNumber;
+        result.startTick = timestamps[0] & this->tickMask;
+        result.scopes.resize(slot.scopes.size());
+
+        for (size_t i = 0; i < slot.scopes.size(); i++)
+        {
+            const uint64_t begin = (timestamps[i * 2] - timestamps[0]) & this->tickMask;
+            const uint64_t end = (timestamps[i * 2 + 1] - timestamps[0]) & this->tickMask;
+
+            VKGpuScopeResult& scope = result.scopes[i];
+            scope.name = slot.scopes[i].name;
+            scope.depth = slot.scopes[i].depth;
+            scope.startMs = static_cast<double>(begin) * this->tickMs;
+            scope.durationMs = (end > begin) ? static_cast<double>(end - begin) * this->tickMs : 0.0;
+        }
+
+        this->lastFrame = result;
+
+        this->history.push_back(std::move(result));
+        if (this->history.size() > GPU_PROFILER_HISTORY_FRAMES) {
+            this->history.pop_front();
+        }
+
+        return true;
+    }
+
+    void VKGpuProfiler::beginFrame(VkCommandBuffer commandBuffer, uint32_t frameIndex)
+    {
+        if (!this->isEnabled()) {
+            return;
+        }
+
+        VKGpuFrameSlot& slot = this->frameSlots[frameIndex];
+        slot.scopes.clear();
+        slot.frameNumber = this->frameCounter++;
+        slot.written = true;
+
+        // 쿼리 리셋은 렌더 패스 밖에서만 할 수 있습니다.
+        vkCmdResetQueryPool(commandBuffer, slot.queryPool, 0, GPU_PROFILER_MAX_SCOPES * 2);
+
+        this->recordingSlot = &slot;
+        this->openScopes.clear();
+        this->beginScope(commandBuffer, "frame");
+    }
+
+    void VKGpuProfiler::endFrame(VkCommandBuffer commandBuffer)
+    {
+        if (this->recordingSlot == nullptr) {
+            return;
+        }
+
+        // 닫지 않은 구간이 있으면 끝 타임스탬프가 비어 결과를 읽을 수 없으므로 여기서 모두 닫습니다.
+        while (!this->openScopes.empty()) {
+            this->endScope(commandBuffer, this->openScopes.back());
+        }
+
+        this->recordingSlot = nullptr;
+    }
+
+    uint32_t VKGpuProfiler::beginScope(VkCommandBuffer commandBuffer, const char* name)
+    {
+        if (this->recordingSlot == nullptr || this->recordingSlot->scopes.size() >= GPU_PROFILER_MAX_SCOPES) {
+            return UINT32_MAX;
+        }
+
+        const uint32_t scope = static_cast<uint32_t>(this->recordingSlot->scopes.size());
+
+        VKGpuScope entry{};
+        entry.name = name;
+        entry.depth = static_cast<uint32_t>(this->openScopes.size());
+        this->recordingSlot->scopes.push_back(entry);
+        this->openScopes.push_back(scope);
+
+        vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, this->recordingSlot->queryPool, scope * 2);
+
+        return scope;
+    }
+
+    void VKGpuProfiler::endScope(VkCommandBuffer commandBuffer, uint32_t scope)
+    {
+        if (this->recordingSlot == nullptr || scope == UINT32_MAX) {
+            return;
+        }
+
+        // 구간은 연 순서의 반대로 닫아야 합니다.
+        assert(!this->openScopes.empty() && this->openScopes.back() == scope);
+        this->openScopes.pop_back();
+
+        vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, this->recordingSlot->queryPool, scope * 2 + 1);
+    }
+
+    bool VKGpuProfiler::writeTrace(const std::string& path) const
+    {
+        FILE* file = fopen(path.c_str(), "w");
+        if (file == nullptr) {
+#ifdef DEBUG_
+            printf("[gpu profiler] failed to open %s\n", path.c_str());
+#endif // DEBUG_
+            return false;
+        }
+
+        // 완료 이벤트("X")만 씁니다. -> ts, dur 단위는 us, 첫 프레임의 시작이 0
+        fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+        fprintf(file, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":1,\"args\":{\"name\":\"GPU\"}}");
+
+        const uint64_t firstTick = this->history.empty() ? 0 : this->history.front().startTick;
+        for (const VKGpuFrameResult& frame : this->history)
+        {
+            const double frameStartUs = static_cast<double>((frame.startTick - firstTick) & this->tickMask) * this->tickMs * 1000.0;
+
+            for (const VKGpuScopeResult& scope : frame.scopes)
+            {
+                fprintf(file, ",\n{\"name\":\"%s\",\"cat\":\"gpu\",\"ph\":\"X\",\"pid\":0,\"tid\":1,\"ts\":%.3f,\"dur\":%.3f,\"args\":{\"frame\":%llu}}",
+                    scope.name, frameStartUs + scope.startMs * 1000.0, scope.durationMs * 1000.0,
+                    static_cast<unsigned long long>(frame.frameNumber));
+            }
+        }
+
+        fprintf(file, "\n]}\n");
+        fclose(file);
+
+#ifdef DEBUG_
+        printf("[gpu profiler] %zu frames written to %s\n", this->history.size(), path.c_str());
+#endif // DEBUG_
+
+        return true;
+    }
+
+    void VKGpuProfiler::cleanup()
+    {
+        if (this->VKdevice == VK_NULL_HANDLE) {
+            return;
+        }
+
+        for (VKGpuFrameSlot& slot : this->frameSlots)
+        {
+            vkDestroyQueryPool(this->VKdevice, slot.queryPool, nullptr);
+            slot.queryPool = VK_NULL_HANDLE;
+            slot.written = false;
+        }
+
+        this->recordingSlot = nullptr;
+        this->VKdevice = VK_NULL_HANDLE;
+    }
+}
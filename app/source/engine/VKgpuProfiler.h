@@ -0,0 +1,111 @@
+﻿#ifndef INCLUDE_VULKANGPUPROFILER_H_
+#define INCLUDE_VULKANGPUPROFILER_H_
+
+#include "../_common.h"
+
+#include <deque>
+
+namespace vkengine {
+
+    constexpr uint32_t GPU_PROFILER_MAX_SCOPES = 32;                // 한 프레임에 기록할 수 있는 구간 수 (구간마다 쿼리 2개)
+    constexpr uint32_t GPU_PROFILER_HISTORY_FRAMES = 300;           // 트레이스로 남길 최근 프레임 수
+    constexpr const char* GPU_PROFILER_TRACE_FILE = "gpu_trace.json";  // 실행 경로(RootPath) 기준
+
+    // 읽어 온 구간 하나 -> 시간은 모두 ms
+    struct VKGpuScopeResult {
+        const char* name = nullptr;                             // 문자열 리터럴 (복사하지 않음)
+        uint32_t depth = 0;                                     // 중첩 깊이 -> 0은 프레임 전체
+        double startMs = 0.0;                                   // 프레임 첫 타임스탬프 기준 시작 시간
+        double durationMs = 0.0;
+    };
+
+    struct VKGpuFrameResult {
+        uint64_t frameNumber = 0;
+        uint64_t startTick = 0;                                 // 프레임 첫 타임스탬프 (트레이스에서 프레임 사이 간격 계산)
+        std::vector<VKGpuScopeResult> scopes;                   // beginScope 순서
+    };
+
+    // GPU 타임스탬프 프로파일러
+    // 프레임 슬롯(MAX_FRAMES_IN_FLIGHT)마다 쿼리 풀을 따로 두고, 슬롯의 펜스를 기다린 뒤 지난번 결과를 읽습니다.
+    // -> 결과는 MAX_FRAMES_IN_FLIGHT 프레임 늦게 나오지만 vkGetQueryPoolResults가 GPU를 기다리지 않습니다.
+    // beginScope/endScope는 기록 스레드 하나에서만 부릅니다. (secondary 커맨드 버퍼 안에서도 됨, 리셋은 beginFrame이 primary에서)
+    class VKGpuProfiler {
+    public:
+        VKGpuProfiler() = default;
+        ~VKGpuProfiler();
+
+        VKGpuProfiler(const VKGpuProfiler&) = delete;
+        VKGpuProfiler& operator=(const VKGpuProfiler&) = delete;
+
+        // 큐가 타임스탬프를 지원하지 않으면 (timestampValidBits == 0) 아무것도 만들지 않고 모든 기록이 무시됩니다.
+        void create(VkDevice device, const VkPhysicalDeviceProperties& properties, uint32_t timestampValidBits);
+
+        // frameIndex 슬롯의 펜스를 기다린 뒤 호출 -> 그 슬롯에 지난번 기록한 구간을 읽어 최신 결과로 둡니다.
+        // 새로 읽은 결과가 없으면 false
+        bool collect(uint32_t frameIndex);
+
+        // 커맨드 버퍼 시작 직후 (렌더 패스 밖) -> 슬롯의 쿼리를 리셋하고 프레임 전체 구간을 엽니다.
+        void beginFrame(VkCommandBuffer commandBuffer, uint32_t frameIndex);
+        void endFrame(VkCommandBuffer commandBuffer);
+
+        // 이름 붙은 구간 -> 중첩할 수 있고, 구간 수가 넘치면 UINT32_MAX를 돌려주고 기록하지 않습니다.
+        uint32_t beginScope(VkCommandBuffer commandBuffer, const char* name);
+        void endScope(VkCommandBuffer commandBuffer, uint32_t scope);
+
+        // 최근 프레임들의 구간을 Chrome 트레이스(JSON) 형식으로 저장합니다. (chrome://tracing, Perfetto)
+        bool writeTrace(const std::string& path) const;
+
+        // 쿼리 풀을 해제합니다. (기록은 남아서 cleanup 뒤에도 writeTrace 가능)
+        void cleanup();
+
+        bool isEnabled() const { return this->VKdevice != VK_NULL_HANDLE; }
+        const VKGpuFrameResult& getLastFrame() const { return this->lastFrame; }
+        const std::deque<VKGpuFrameResult>& getHistory() const { return this->history; }
+
+        // 마지막으로 읽은 프레임 전체의 GPU 시간 -> 아직 결과가 없으면 음수
+        double getFrameMs() const { return this->lastFrame.scopes.empty() ? -1.0 : this->lastFrame.scopes[0].durationMs; }
+
+    private:
+        struct VKGpuScope {
+            const char* name = nullptr;
+            uint32_t depth = 0;                                 // 쿼리 2 * i (시작), 2 * i + 1 (끝)
+        };
+
+        struct VKGpuFrameSlot {
+            VkQueryPool queryPool = VK_NULL_HANDLE;
+            std::vector<VKGpuScope> scopes;                     // 이번에 기록한 구간
+            uint64_t frameNumber = 0;
+            bool written = false;                               // 쿼리를 리셋한 뒤 제출할 커맨드 버퍼에 기록했는지
+        };
+
+        VkDevice VKdevice = VK_NULL_HANDLE;
+        double tickMs = 0.0;                                    // 한 틱의 ms (timestampPeriod는 ns)
+        uint64_t tickMask = 0;                                  // 유효 비트 밖의 위쪽 비트는 의미가 없습니다.
+
+        VKGpuFrameSlot frameSlots[MAX_FRAMES_IN_FLIGHT];
+        VKGpuFrameSlot* recordingSlot = nullptr;                // beginFrame ~ endFrame 사이의 슬롯
+        std::vector<uint32_t> openScopes;                       // 열린 구간 스택 -> 깊이
+        uint64_t frameCounter = 0;
+
+        VKGpuFrameResult lastFrame;
+        std::deque<VKGpuFrameResult> history;
+    };
+
+    // 블록 범위 구간 -> 생성자에서 beginScope, 소멸자에서 endScope
+    class VKGpuScopeGuard {
+    public:
+        VKGpuScopeGuard(VKGpuProfiler& profiler, VkCommandBuffer commandBuffer, const char* name)
+            : profiler(profiler), commandBuffer(commandBuffer), scope(profiler.beginScope(commandBuffer, name)) {}
+        ~VKGpuScopeGuard() { this->profiler.endScope(this->commandBuffer, this->scope); }
+
+        VKGpuScopeGuard(const VKGpuScopeGuard&) = delete;
+        VKGpuScopeGuard& operator=(const VKGpuScopeGuard&) = delete;
+
+    private:
+        VKGpuProfiler& profiler;
+        VkCommandBuffer commandBuffer;
+        uint32_t scope;
+    };
+}
+
+#endif // INCLUDE_VULKANGPUPROFILER_H_
@@ -43,13 +43,14 @@ namespace vkengine {
             init_info.Device = engine->getDevice()->VKdevice;
             init_info.QueueFamily = engine->getDevice()->queueFamilyIndices.getGraphicsQueueFamilyIndex();
             init_info.Queue = engine->getDevice()->graphicsVKQueue;
-            init_info.DescriptorPool = engine->getDescriptorPool();
+            init_info.DescriptorPoolSize = IMGUI_IMPL_VULKAN_MINIMUM_IMAGE_SAMPLER_POOL_SIZE + 1;   // 엔진의 풀에는 이미지 샘플러가 없으므로 백엔드가 만듭니다.
+            init_info.PipelineCache = engine->getPipelineCache();
             init_info.Allocator = nullptr;
             init_info.MinImageCount = 2;
             init_info.ImageCount = engine->getSwapChain()->getSwapChainImageCount();
             init_info.CheckVkResultFn = nullptr;
             init_info.RenderPass = engine->getRenderPass();
-            init_info.MSAASamples = VK_SAMPLE_COUNT_1_BIT;
+            init_info.MSAASamples = engine->getMsaaSamples();
 
             CHECK_RESULT(ImGui_ImplVulkan_Init(&init_info));
 
@@ -62,7 +63,7 @@ namespace vkengine {
         {
 
         }
-        void vkGUI::update()
+        void vkGUI::update(VkCommandBuffer commandBuffer)
         {
             // Start the Dear ImGui frame
             ImGui_ImplVulkan_NewFrame();
@@ -70,11 +71,11 @@ namespace vkengine {
 
             ImGui::NewFrame();
 
-            ImGui::ShowDemoWindow();
+            this->drawGpuProfiler(VulkanEngine::Get().getGpuProfiler());
 
             // Rendering
             ImGui::Render();
-            ImGui_ImplVulkan_RenderDrawData(ImGui::GetDrawData(), VulkanEngine::Get().getCurrnetFrameData().mainCommandBuffer);
+            ImGui_ImplVulkan_RenderDrawData(ImGui::GetDrawData(), commandBuffer);
 
             //ImDrawData* draw_data = ImGui::GetDrawData();
             //const bool is_minimized = (draw_data->DisplaySize.x <= 0.0f || draw_data->DisplaySize.y <= 0.0f);
@@ -88,5 +89,38 @@ namespace vkengine {
                 //FramePresent(wd);
             }
         }
+
+        void vkGUI::drawGpuProfiler(const VKGpuProfiler& profiler)
+        {
+            // 화면 왼쪽 위에 고정된 반투명 창
+            ImGui::SetNextWindowPos(ImVec2(10.0f, 10.0f), ImGuiCond_Always);
+            ImGui::SetNextWindowBgAlpha(0.6f);
+
+            const ImGuiWindowFlags flags = ImGuiWindowFlags_NoDecoration | ImGuiWindowFlags_AlwaysAutoResize |
+                ImGuiWindowFlags_NoSavedSettings | ImGuiWindowFlags_NoFocusOnAppearing | ImGuiWindowFlags_NoNav;
+
+            if (ImGui::Begin("GPU profiler", nullptr, flags))
+            {
+                const VKGpuFrameResult& frame = profiler.getLastFrame();
+
+                if (!profiler.isEnabled()) {
+                    ImGui::TextUnformatted("GPU timestamps are not supported");
+                }
+                else if (frame.scopes.empty()) {
+                    ImGui::TextUnformatted("GPU: waiting for results");
+                }
+                else {
+                    ImGui::Text("GPU frame %llu", static_cast<unsigned long long>(frame.frameNumber));
+                    ImGui::Separator();
+
+                    // 구간 이름은 중첩 깊이만큼 들여씁니다.
+                    for (const VKGpuScopeResult& scope : frame.scopes)
+                    {
+                        ImGui::Text("%*s%-16s %8.3f ms", static_cast<int>(scope.depth * 2), "", scope.name, scope.durationMs);
+                    }
+                }
+            }
+            ImGui::End();
+        }
     }
 }
\ No newline at end of file
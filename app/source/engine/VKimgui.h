@@ -2,6 +2,7 @@
 #define INCLUDE_IMGUI_H_
 
 #include "../_common.h"
+#include "VKgpuProfiler.h"
 
 namespace vkengine {
     namespace gui {
@@ -11,7 +12,11 @@ namespace vkengine {
             ~vkGUI();
             void init();
             void initResources(VkRenderPass renderPass, VkQueue copyQueue, const std::string& shadersPath);
-            void update();
+            // 새 ImGui 프레임을 만들고 commandBuffer에 기록합니다. (렌더 패스 안의 secondary 버퍼)
+            void update(VkCommandBuffer commandBuffer);
+
+            // GPU 프로파일러의 마지막 결과를 구간별 시간 오버레이로 그립니다.
+            void drawGpuProfiler(const VKGpuProfiler& profiler);
         private:
         };
     }
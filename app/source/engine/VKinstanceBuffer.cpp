@@ -0,0 +1,133 @@
+﻿#include "VKinstanceBuffer.h"
+#include "helper.h"
+#include "VKtrace.h"
+
+namespace vkengine {
+
+    VKInstanceBuffer::VKInstanceBuffer(memory::VKMemoryAllocator* allocator, uint32_t capacity)
+    {
+        this->VKallocator = allocator;
+        this->capacity = std::max(1u, capacity);
+        this->instances.resize(this->capacity);
+        this->createBuffers();
+    }
+
+    VKInstanceBuffer::~VKInstanceBuffer()
+    {
+        this->cleanup();
+    }
+
+    bool VKInstanceBuffer::reserve(uint32_t capacity)
+    {
+        if (capacity <= this->capacity) {
+            return false;
+        }
+
+        this->cleanup();
+
+        this->capacity = capacity;
+        this->instances.resize(this->capacity);
+        this->createBuffers();
+        this->markDirty();
+
+        return true;
+    }
+
+    void VKInstanceBuffer::setCount(uint32_t count)
+    {
+        if (count > this->capacity) {
+            throw std::runtime_error("instance count exceeds instance buffer capacity!");
+        }
+
+        this->count = count;
+    }
+
+    void VKInstanceBuffer::markDirty(const uint32_t* indices, uint32_t indexCount)
+    {
+        const size_t limit = static_cast<size_t>(this->count * INSTANCE_PARTIAL_LIMIT);
+
+        for (VKInstanceFrame& frame : this->frames)
+        {
+            // 버전이 지난 슬롯은 어차피 전체를 복사합니다.
+            if (frame.version != this->version) {
+                continue;
+            }
+
+            if (frame.pending.size() + indexCount > limit) {
+                frame.version = 0;
+                frame.pending.clear();
+                continue;
+            }
+
+            frame.pending.insert(frame.pending.end(), indices, indices + indexCount);
+        }
+    }
+
+    bool VKInstanceBuffer::update(uint32_t frameIndex, job::VKJobSystem* jobSystem)
+    {
+        VKInstanceFrame& frame = this->frames[frameIndex];
+        InstanceData* mapped = static_cast<InstanceData*>(frame.memory.mapped);
+
+        if (frame.version == this->version) {
+            if (frame.pending.empty()) {
+                return false;
+            }
+
+            VK_TRACE_SCOPE("VKInstanceBuffer::update partial");
+
+            for (uint32_t index : frame.pending)
+            {
+                if (index < this->count) {
+                    mapped[index] = this->instances[index];
+                }
+            }
+            frame.pending.clear();
+            return true;
+        }
+
+        VK_TRACE_SCOPE("VKInstanceBuffer::update");
+
+        frame.pending.clear();
+        auto copyRange = [this, mapped](uint32_t begin, uint32_t end) {
+            memcpy(mapped + begin, this->instances.data() + begin, static_cast<size_t>(end - begin) * sizeof(InstanceData));
+        };
+
+        if (jobSystem != nullptr && this->count > INSTANCE_COPY_GRAIN) {
+            jobSystem->parallelFor(this->count, INSTANCE_COPY_GRAIN, copyRange);
+        }
+        else {
+            copyRange(0, this->count);
+        }
+
+        frame.version = this->version;
+        return true;
+    }
+
+    void VKInstanceBuffer::cleanup()
+    {
+        for (VKInstanceFrame& frame : this->frames)
+        {
+            if (frame.buffer != VK_NULL_HANDLE) {
+                this->VKallocator->destroyBuffer(frame.buffer, frame.memory);
+            }
+            frame.version = 0;
+            frame.pending.clear();
+        }
+    }
+
+    void VKInstanceBuffer::createBuffers()
+    {
+        for (VKInstanceFrame& frame : this->frames)
+        {
+            // GPU가 읽는 동안 다음 슬롯을 쓰므로 슬롯마다 버퍼를 둡니다. (coherent -> flush 불필요)
+            helper::createBuffer(
+                this->VKallocator,
+                this->getBufferSize(),
+                VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                frame.buffer,
+                frame.memory);
+            frame.version = 0;
+        }
+    }
+}
@@ -0,0 +1,74 @@
+﻿#ifndef INCLUDE_VULKANINSTANCEBUFFER_H_
+#define INCLUDE_VULKANINSTANCEBUFFER_H_
+
+#include "../_common.h"
+#include "../struct.h"
+#include "VKallocator.h"
+#include "VKjobSystem.h"
+
+namespace vkengine {
+
+    constexpr uint32_t INSTANCE_COPY_GRAIN = 16 * 1024;            // 프레임 버퍼로 복사할 때 잡 하나가 맡는 인스턴스 수
+    constexpr float INSTANCE_PARTIAL_LIMIT = 0.25f;                 // 바뀐 인스턴스가 이 비율을 넘으면 흩어진 복사 대신 전체를 복사
+
+    // 인스턴스 데이터(변환 행렬 + 색)를 담는 스토리지 버퍼
+    // CPU 쪽 배열이 원본이고, 프레임 슬롯(MAX_FRAMES_IN_FLIGHT)마다 영구 매핑된 HOST_VISIBLE 버퍼를 따로 둡니다.
+    // 인스턴스가 바뀌면 버전이 올라가고, update가 각 슬롯을 한 번씩만 최신으로 복사합니다.
+    // 일부만 바뀌었으면 markDirty(indices)로 슬롯마다 그 인스턴스만 복사합니다.
+    // -> 움직이지 않는 장면은 프레임마다 복사가 없습니다.
+    // 버텍스 셰이더는 instances[gl_InstanceIndex]를 읽으므로 N개의 오브젝트를 vkCmdDrawIndexed 한 번으로 그립니다.
+    class VKInstanceBuffer {
+    public:
+        VKInstanceBuffer(memory::VKMemoryAllocator* allocator, uint32_t capacity);
+        ~VKInstanceBuffer();
+
+        VKInstanceBuffer(const VKInstanceBuffer&) = delete;
+        VKInstanceBuffer& operator=(const VKInstanceBuffer&) = delete;
+
+        // 용량을 늘립니다. 버퍼를 다시 만들므로 GPU가 쓰지 않을 때 호출하고 디스크립터를 다시 써야 합니다. -> 다시 만들었으면 true
+        bool reserve(uint32_t capacity);
+
+        // 인스턴스 수를 바꿉니다. (capacity 이하) -> 늘어난 부분은 getInstances()로 채운 뒤 markDirty
+        void setCount(uint32_t count);
+
+        // CPU 쪽 인스턴스 배열 -> 고친 뒤 markDirty를 불러야 GPU 버퍼에 반영됩니다.
+        InstanceData* getInstances() { return this->instances.data(); }
+        const InstanceData* getInstances() const { return this->instances.data(); }
+        void markDirty() { this->version++; }
+
+        // indices의 인스턴스만 바뀌었습니다. -> 각 슬롯이 다음 update에서 그 인스턴스만 복사합니다.
+        // 슬롯에 쌓인 인스턴스가 INSTANCE_PARTIAL_LIMIT 비율을 넘으면 그 슬롯은 전체를 복사합니다.
+        void markDirty(const uint32_t* indices, uint32_t indexCount);
+
+        // frameIndex 슬롯의 버퍼를 최신으로 만듭니다. 바뀌지 않았으면 아무것도 하지 않습니다.
+        // 그 슬롯의 fence를 기다린 뒤 호출하고, jobSystem이 있으면 구간을 나눠 병렬로 복사합니다. -> 복사했으면 true
+        bool update(uint32_t frameIndex, job::VKJobSystem* jobSystem = nullptr);
+
+        VkBuffer getBuffer(uint32_t frameIndex) const { return this->frames[frameIndex].buffer; }
+        VkDeviceSize getBufferSize() const { return static_cast<VkDeviceSize>(this->capacity) * sizeof(InstanceData); }
+        uint32_t getCount() const { return this->count; }
+        uint32_t getCapacity() const { return this->capacity; }
+
+        // 버퍼를 해제합니다. -> GPU가 쓰지 않을 때 (vkDeviceWaitIdle 뒤) 호출
+        void cleanup();
+
+    private:
+        struct VKInstanceFrame {
+            VkBuffer buffer = VK_NULL_HANDLE;
+            memory::VKAllocation memory{};
+            uint64_t version = 0;                                   // 이 슬롯에 마지막으로 복사한 버전
+            std::vector<uint32_t> pending;                          // 버전은 최신이지만 그 뒤에 바뀐 인스턴스 (중복 가능)
+        };
+
+        void createBuffers();
+
+        memory::VKMemoryAllocator* VKallocator = nullptr;
+        std::array<VKInstanceFrame, MAX_FRAMES_IN_FLIGHT> frames{};
+        std::vector<InstanceData> instances;                        // 원본 (capacity개)
+        uint32_t capacity = 0;
+        uint32_t count = 0;
+        uint64_t version = 1;                                       // 슬롯 버전은 0에서 시작하므로 처음 한 번은 항상 복사
+    };
+}
+
+#endif // INCLUDE_VULKANINSTANCEBUFFER_H_
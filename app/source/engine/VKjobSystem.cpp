@@ -0,0 +1,316 @@
+﻿#include "VKjobSystem.h"
+#include "VKtrace.h"
+
+namespace vkengine {
+    namespace job {
+
+        thread_local uint32_t VKJobSystem::threadIndex = 0;
+        thread_local const VKJobSystem* VKJobSystem::threadOwner = nullptr;
+
+        VKJobSystem::VKJobSystem(uint32_t threadCount)
+        {
+            if (threadCount == 0) {
+                threadCount = std::max(1u, std::thread::hardware_concurrency());
+            }
+
+            for (uint32_t i = 0; i < threadCount; i++)
+            {
+                this->queues.push_back(std::make_unique<VKJobQueue>());
+                this->jobPools.push_back(std::make_unique<VKJob[]>(JOB_POOL_SIZE));
+            }
+            this->jobPoolCursors.resize(threadCount, 0);
+
+            // 생성한 스레드를 스레드 0으로 등록합니다.
+            VKJobSystem::threadIndex = 0;
+            VKJobSystem::threadOwner = this;
+            this->ownerThread = std::this_thread::get_id();
+
+            for (uint32_t i = 1; i < threadCount; i++)
+            {
+                this->workers.emplace_back(&VKJobSystem::workerLoop, this, i);
+            }
+
+#ifdef DEBUG_
+            printf("[job] %u threads\n", threadCount);
+#endif // DEBUG_
+        }
+
+        VKJobSystem::~VKJobSystem()
+        {
+            this->cleanup();
+        }
+
+        VKJob* VKJobSystem::createJob(std::function<void()> function)
+        {
+            VKJob* job = this->allocateJob();
+            assert(job->isFinished() && "job pool slot reused while its job is still pending");
+            job->function = std::move(function);
+            job->parent = nullptr;
+            job->unfinished.store(1, std::memory_order_relaxed);
+            job->dependencies.store(1, std::memory_order_relaxed);     // run()이 1을 풀어줍니다.
+            job->dependentCount = 0;
+            return job;
+        }
+
+        VKJob* VKJobSystem::createChildJob(VKJob* parent, std::function<void()> function)
+        {
+            assert(parent);
+
+            parent->unfinished.fetch_add(1, std::memory_order_relaxed);
+
+            VKJob* job = this->createJob(std::move(function));
+            job->parent = parent;
+            return job;
+        }
+
+        void VKJobSystem::addDependency(VKJob* job, VKJob* prerequisite)
+        {
+            assert(job && prerequisite);
+            assert(prerequisite->dependentCount < MAX_JOB_DEPENDENTS);
+
+            job->dependencies.fetch_add(1, std::memory_order_relaxed);
+            prerequisite->dependents[prerequisite->dependentCount++] = job;
+        }
+
+        void VKJobSystem::run(VKJob* job)
+        {
+            // 선행 작업이 모두 끝났으면 바로 큐에 넣습니다.
+            if (job->dependencies.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                this->push(job);
+            }
+        }
+
+        void VKJobSystem::wait(const VKJob* job)
+        {
+            const uint32_t index = this->getThreadIndex();
+
+            // 기다리는 동안 다른 작업을 실행합니다. -> 작업 안에서 wait()를 불러도 교착되지 않습니다.
+            while (!job->isFinished())
+            {
+                VKJob* next = this->getJob(index);
+                if (next) {
+                    this->execute(next);
+                }
+                else {
+                    std::this_thread::yield();
+                }
+            }
+        }
+
+        void VKJobSystem::parallelFor(uint32_t count, uint32_t grainSize, const std::function<void(uint32_t begin, uint32_t end)>& function)
+        {
+            if (count == 0) {
+                return;
+            }
+
+            grainSize = std::max(1u, grainSize);
+
+            // 한 덩어리면 스케줄러를 거치지 않습니다.
+            if (count <= grainSize || this->getThreadCount() == 1) {
+                function(0, count);
+                return;
+            }
+
+            VKJob* root = this->createJob(nullptr);
+
+            for (uint32_t begin = 0; begin < count; begin += grainSize)
+            {
+                const uint32_t end = std::min(count, begin + grainSize);
+                VKJob* child = this->createChildJob(root, [&function, begin, end]() { function(begin, end); });
+                this->run(child);
+            }
+
+            this->run(root);
+            this->wait(root);
+        }
+
+        uint32_t VKJobSystem::getThreadIndex() const
+        {
+            if (VKJobSystem::threadOwner == this) {
+                return VKJobSystem::threadIndex;
+            }
+
+            // 생성한 스레드가 그 뒤에 다른 잡 시스템을 만들었으면 threadOwner가 바뀌어 있습니다. -> 여전히 스레드 0
+            // 그 밖의 스레드는 자기 큐가 없어서 스레드 0의 큐를 잠금 없이 쓰는 링 풀과 함께 경합합니다.
+            assert(std::this_thread::get_id() == this->ownerThread && "VKJobSystem used from a thread that is neither its owner nor a worker");
+            return 0;
+        }
+
+        void VKJobSystem::cleanup()
+        {
+            if (this->workers.empty()) {
+                return;
+            }
+
+            this->quit.store(true, std::memory_order_release);
+            {
+                std::lock_guard<std::mutex> lock(this->sleepMutex);
+            }
+            this->sleepCondition.notify_all();
+
+            for (auto& worker : this->workers)
+            {
+                worker.join();
+            }
+            this->workers.clear();
+        }
+
+        VKJob* VKJobSystem::allocateJob()
+        {
+            const uint32_t index = this->getThreadIndex();
+            uint32_t& cursor = this->jobPoolCursors[index];
+
+            while (true)
+            {
+                // 끝나지 않은 작업(실행 전 부모 작업 포함)의 슬롯은 건너뜁니다.
+                for (uint32_t probe = 0; probe < JOB_POOL_SIZE; probe++)
+                {
+                    VKJob* job = &this->jobPools[index][cursor++ & (JOB_POOL_SIZE - 1)];
+                    if (job->isFinished()) {
+                        return job;
+                    }
+                }
+
+                // 모든 슬롯이 사용 중이면 대기 중인 작업을 실행해서 슬롯이 비기를 기다립니다.
+                VKJob* next = this->getJob(index);
+                if (next) {
+                    this->execute(next);
+                }
+                else {
+                    std::this_thread::yield();
+                }
+            }
+        }
+
+        void VKJobSystem::push(VKJob* job)
+        {
+            VKJobQueue& queue = *this->queues[this->getThreadIndex()];
+            {
+                std::lock_guard<std::mutex> lock(queue.mutex);
+                queue.jobs.push_back(job);
+            }
+
+            this->queuedJobs.fetch_add(1, std::memory_order_release);
+
+            // 잠든 워커가 있으면 하나 깨웁니다.
+            this->sleepCondition.notify_one();
+        }
+
+        VKJob* VKJobSystem::pop(uint32_t threadIndex)
+        {
+            VKJobQueue& queue = *this->queues[threadIndex];
+            std::lock_guard<std::mutex> lock(queue.mutex);
+
+            if (queue.jobs.empty()) {
+                return nullptr;
+            }
+
+            // 자기 deque는 마지막에 넣은 작업부터 꺼냅니다. -> 캐시에 남아 있는 데이터를 재사용
+            VKJob* job = queue.jobs.back();
+            queue.jobs.pop_back();
+            this->queuedJobs.fetch_sub(1, std::memory_order_relaxed);
+            return job;
+        }
+
+        VKJob* VKJobSystem::steal(uint32_t threadIndex)
+        {
+            const uint32_t threadCount = this->getThreadCount();
+
+            // 옆 스레드부터 차례로 훔칩니다. -> 모든 스레드가 같은 곳을 훔치지 않도록
+            for (uint32_t i = 1; i < threadCount; i++)
+            {
+                VKJobQueue& queue = *this->queues[(threadIndex + i) % threadCount];
+                std::lock_guard<std::mutex> lock(queue.mutex);
+
+                if (!queue.jobs.empty()) {
+                    // 다른 스레드의 deque는 가장 오래된 작업부터 가져갑니다. -> 보통 더 큰 작업
+                    VKJob* job = queue.jobs.front();
+                    queue.jobs.pop_front();
+                    this->queuedJobs.fetch_sub(1, std::memory_order_relaxed);
+                    return job;
+                }
+            }
+
+            return nullptr;
+        }
+
+        VKJob* VKJobSystem::getJob(uint32_t threadIndex)
+        {
+            if (this->queuedJobs.load(std::memory_order_acquire) == 0) {
+                return nullptr;
+            }
+
+            VKJob* job = this->pop(threadIndex);
+            if (job) {
+                return job;
+            }
+
+            return this->steal(threadIndex);
+        }
+
+        void VKJobSystem::execute(VKJob* job)
+        {
+            if (job->function) {
+                job->function();
+            }
+
+            this->finish(job);
+        }
+
+        void VKJobSystem::finish(VKJob* job)
+        {
+            // 완료되는 순간 wait() 중인 스레드가 작업 슬롯을 재사용할 수 있으므로 필요한 값을 먼저 복사합니다.
+            VKJob* parent = job->parent;
+            const uint32_t dependentCount = job->dependentCount;
+            std::array<VKJob*, MAX_JOB_DEPENDENTS> dependents;
+            std::copy_n(job->dependents.begin(), dependentCount, dependents.begin());
+
+            if (job->unfinished.fetch_sub(1, std::memory_order_acq_rel) != 1) {
+                return;
+            }
+
+            // 완료된 작업에 걸려 있던 후속 작업을 풀어줍니다.
+            for (uint32_t i = 0; i < dependentCount; i++)
+            {
+                if (dependents[i]->dependencies.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                    this->push(dependents[i]);
+                }
+            }
+
+            if (parent) {
+                this->finish(parent);
+            }
+        }
+
+        void VKJobSystem::workerLoop(uint32_t threadIndex)
+        {
+            VKJobSystem::threadIndex = threadIndex;
+            VKJobSystem::threadOwner = this;
+
+            VK_TRACE_THREAD_NAME("job worker");
+
+            uint32_t idleSpins = 0;
+
+            while (!this->quit.load(std::memory_order_acquire))
+            {
+                VKJob* job = this->getJob(threadIndex);
+                if (job) {
+                    this->execute(job);
+                    idleSpins = 0;
+                    continue;
+                }
+
+                // 잠깐은 양보하면서 기다리고, 오래 비어 있으면 잠듭니다.
+                if (++idleSpins < 64) {
+                    std::this_thread::yield();
+                    continue;
+                }
+
+                std::unique_lock<std::mutex> lock(this->sleepMutex);
+                this->sleepCondition.wait_for(lock, std::chrono::milliseconds(1), [this]() {
+                    return this->quit.load(std::memory_order_acquire) || this->queuedJobs.load(std::memory_order_acquire) > 0;
+                });
+            }
+        }
+    }
+}
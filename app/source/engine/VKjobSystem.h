@@ -0,0 +1,109 @@
+﻿#ifndef INCLUDE_VULKANJOBSYSTEM_H_
+#define INCLUDE_VULKANJOBSYSTEM_H_
+
+#include "../_common.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+namespace vkengine {
+    namespace job {
+
+        constexpr uint32_t MAX_JOB_DEPENDENTS = 16;         // 한 작업이 끝났을 때 풀어줄 수 있는 후속 작업 수
+        constexpr uint32_t JOB_POOL_SIZE = 4096;            // 스레드별 작업 풀 크기 (2의 거듭제곱)
+
+        // 작업 하나
+        // unfinished  : 자기 자신 + 아직 끝나지 않은 자식 작업 수 -> 0이 되면 완료
+        // dependencies: 아직 끝나지 않은 선행 작업 수 + run() 전이면 1 -> 0이 되면 큐에 들어감
+        struct VKJob {
+            std::function<void()> function;
+            VKJob* parent = nullptr;
+            std::atomic<int32_t> unfinished{ 0 };
+            std::atomic<int32_t> dependencies{ 0 };
+            std::array<VKJob*, MAX_JOB_DEPENDENTS> dependents{};
+            uint32_t dependentCount = 0;
+
+            bool isFinished() const { return this->unfinished.load(std::memory_order_acquire) == 0; }
+        };
+
+        // 작업 훔치기(work-stealing) 스케줄러
+        // 스레드마다 deque를 가지고, 자기 deque는 뒤에서(LIFO) 꺼내고 다른 스레드의 deque는 앞에서(FIFO) 훔칩니다.
+        // 스레드 0은 생성한 스레드(메인 스레드)이며 wait() 중에 작업을 같이 실행합니다.
+        //
+        // 작업은 스레드별 링 풀에서 할당합니다. 아직 끝나지 않은 작업의 슬롯은 건너뛰고, 모든 슬롯이 사용 중이면 대기 중인 작업을 실행하며 빈 슬롯을 기다립니다.
+        // -> 한 스레드에서 JOB_POOL_SIZE개 넘게 살아 있으면 덮어쓰지 않는 대신 느려집니다.
+        // 작업 생성/제출/대기는 잡 시스템 스레드(생성한 스레드 또는 작업 안)에서만 해야 합니다. -> 다른 스레드는 큐 0을 두고 생성한 스레드와 경합하므로 디버그 빌드에서 assert로 막습니다.
+        class VKJobSystem {
+        public:
+            // threadCount가 0이면 하드웨어 스레드 수를 사용합니다.
+            explicit VKJobSystem(uint32_t threadCount = 0);
+            ~VKJobSystem();
+
+            VKJobSystem(const VKJobSystem&) = delete;
+            VKJobSystem& operator=(const VKJobSystem&) = delete;
+
+            // 작업을 만듭니다. run()을 호출해야 실행됩니다.
+            VKJob* createJob(std::function<void()> function);
+
+            // parent의 자식 작업을 만듭니다. parent는 모든 자식이 끝나야 완료됩니다. (parent의 run() 전에 호출)
+            VKJob* createChildJob(VKJob* parent, std::function<void()> function);
+
+            // job이 prerequisite가 끝난 뒤에 실행되게 합니다. (둘 다 run() 전에 호출)
+            void addDependency(VKJob* job, VKJob* prerequisite);
+
+            // 작업을 제출합니다. 선행 작업이 남아 있으면 모두 끝났을 때 자동으로 큐에 들어갑니다.
+            void run(VKJob* job);
+
+            // 작업이 끝날 때까지 기다립니다. 기다리는 동안 다른 작업을 실행합니다.
+            void wait(const VKJob* job);
+
+            // [0, count)를 grainSize 단위로 나눠 병렬로 실행하고 모두 끝날 때까지 기다립니다.
+            void parallelFor(uint32_t count, uint32_t grainSize, const std::function<void(uint32_t begin, uint32_t end)>& function);
+
+            uint32_t getThreadCount() const { return static_cast<uint32_t>(this->queues.size()); }
+
+            // 현재 스레드의 인덱스 (0 = 생성한 스레드) -> 스레드별 리소스(커맨드 풀 등)를 고를 때 사용
+            // 생성한 스레드나 워커 스레드에서만 호출해야 합니다.
+            uint32_t getThreadIndex() const;
+
+            // 워커 스레드를 종료하는 함수
+            void cleanup();
+
+        private:
+            // 스레드 하나의 작업 deque
+            struct VKJobQueue {
+                std::mutex mutex;
+                std::deque<VKJob*> jobs;
+            };
+
+            VKJob* allocateJob();
+            void push(VKJob* job);
+            VKJob* pop(uint32_t threadIndex);
+            VKJob* steal(uint32_t threadIndex);
+            VKJob* getJob(uint32_t threadIndex);
+            void execute(VKJob* job);
+            void finish(VKJob* job);
+            void workerLoop(uint32_t threadIndex);
+
+            std::vector<std::unique_ptr<VKJobQueue>> queues;
+            std::vector<std::unique_ptr<VKJob[]>> jobPools;
+            std::vector<uint32_t> jobPoolCursors;
+            std::vector<std::thread> workers;
+
+            std::atomic<uint32_t> queuedJobs{ 0 };         // 큐에 들어 있는 작업 수
+            std::atomic<bool> quit{ false };
+            std::thread::id ownerThread;                    // 생성한 스레드 (스레드 0)
+            std::mutex sleepMutex;
+            std::condition_variable sleepCondition;
+
+            static thread_local uint32_t threadIndex;
+            static thread_local const VKJobSystem* threadOwner;
+        };
+    }
+}
+
+#endif // INCLUDE_VULKANJOBSYSTEM_H_
@@ -1,6 +1,7 @@
 #include "VKkey.h"
 #include "VKengine.h"
 #include "Camera.h"
+#include "VKtrace.h"
 
 using vkengine::VulkanEngine;
 using vkengine::object::Camera;
@@ -14,6 +15,12 @@ namespace vkengine
             if (key == GLFW_KEY_ESCAPE && action == GLFW_PRESS) {
                 glfwSetWindowShouldClose(window, GLFW_TRUE);
             }
+
+            // F12 -> ֱ  GPU  CPU  Ʈ̽ Ϸ 
+            if (key == GLFW_KEY_F12 && action == GLFW_PRESS) {
+                app->getGpuProfiler().writeTrace(app->getRootPath() + GPU_PROFILER_TRACE_FILE);
+                VK_TRACE_WRITE(app->getRootPath() + trace::CPU_TRACE_FILE);
+            }
             
             // ȿ Ű Ȯ
             if (key < GLFW_KEY_A || key > GLFW_KEY_Z) {
@@ -0,0 +1,337 @@
+﻿#include "VKmeshCache.h"
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace vkengine {
+    namespace asset {
+
+        namespace {
+            uint64_t alignUp(uint64_t value, uint64_t alignment)
+            {
+                return (value + alignment - 1) & ~(alignment - 1);
+            }
+        }
+
+        uint64_t hashBytes(const uint8_t* data, uint64_t size)
+        {
+            constexpr uint64_t FNV_OFFSET = 0xcbf29ce484222325ull;
+            constexpr uint64_t FNV_PRIME = 0x100000001b3ull;
+
+            uint64_t hash = FNV_OFFSET ^ size;
+            uint64_t i = 0;
+
+            for (; i + 8 <= size; i += 8)
+            {
+                uint64_t word;
+                memcpy(&word, data + i, sizeof(word));
+                hash = (hash ^ word) * FNV_PRIME;
+                hash ^= hash >> 29;
+            }
+
+            for (; i < size; i++)
+            {
+                hash = (hash ^ data[i]) * FNV_PRIME;
+            }
+
+            return hash;
+        }
+
+        VKMappedFile::~VKMappedFile()
+        {
+            this->close();
+        }
+
+        bool VKMappedFile::open(const std::string& path)
+        {
+            this->close();
+
+#ifdef _WIN32
+            this->file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+            if (this->file == INVALID_HANDLE_VALUE) {
+                return false;
+            }
+
+            LARGE_INTEGER fileSize{};
+            if (!GetFileSizeEx(this->file, &fileSize) || fileSize.QuadPart == 0) {
+                this->close();
+                return false;
+            }
+
+            this->mapping = CreateFileMappingA(this->file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+            if (!this->mapping) {
+                this->close();
+                return false;
+            }
+
+            this->data = static_cast<const uint8_t*>(MapViewOfFile(this->mapping, FILE_MAP_READ, 0, 0, 0));
+            this->size = static_cast<uint64_t>(fileSize.QuadPart);
+#else
+            this->file = ::open(path.c_str(), O_RDONLY);
+            if (this->file < 0) {
+                return false;
+            }
+
+            struct stat fileStat {};
+            if (fstat(this->file, &fileStat) != 0 || fileStat.st_size == 0) {
+                this->close();
+                return false;
+            }
+
+            void* mapped = mmap(nullptr, static_cast<size_t>(fileStat.st_size), PROT_READ, MAP_PRIVATE, this->file, 0);
+            this->data = (mapped == MAP_FAILED) ? nullptr : static_cast<const uint8_t*>(mapped);
+            this->size = static_cast<uint64_t>(fileStat.st_size);
+#endif
+
+            if (!this->data) {
+                this->close();
+                return false;
+            }
+
+            return true;
+        }
+
+        void VKMappedFile::close()
+        {
+#ifdef _WIN32
+            if (this->data) {
+                UnmapViewOfFile(this->data);
+            }
+            if (this->mapping) {
+                CloseHandle(this->mapping);
+                this->mapping = nullptr;
+            }
+            if (this->file != INVALID_HANDLE_VALUE) {
+                CloseHandle(this->file);
+                this->file = INVALID_HANDLE_VALUE;
+            }
+#else
+            if (this->data) {
+                munmap(const_cast<uint8_t*>(this->data), static_cast<size_t>(this->size));
+            }
+            if (this->file >= 0) {
+                ::close(this->file);
+                this->file = -1;
+            }
+#endif
+            this->data = nullptr;
+            this->size = 0;
+        }
+
+        bool VKMeshCache::open(const std::string& cachePath, uint64_t sourceHash)
+        {
+            this->close();
+
+            if (!this->mappedFile.open(cachePath)) {
+                return false;
+            }
+
+            const uint8_t* data = this->mappedFile.getData();
+            const uint64_t fileSize = this->mappedFile.getSize();
+
+            if (fileSize < sizeof(VKMeshCacheHeader)) {
+                this->close();
+                return false;
+            }
+
+            VKMeshCacheHeader header;
+            memcpy(&header, data, sizeof(header));
+
+            const uint64_t vertexBytes = static_cast<uint64_t>(header.vertexCount) * sizeof(Vertex);
+            const uint64_t indexBytes = static_cast<uint64_t>(header.indexCount) * sizeof(uint32_t);
+            const uint64_t meshletBytes = static_cast<uint64_t>(header.meshletCount) * sizeof(VKMeshlet);
+            const uint64_t meshletVertexBytes = static_cast<uint64_t>(header.meshletVertexCount) * sizeof(uint32_t);
+            const uint64_t meshletTriangleBytes = static_cast<uint64_t>(header.meshletTriangleCount) * sizeof(uint8_t);
+
+            const bool valid =
+                header.magic == MESH_CACHE_MAGIC &&
+                header.version == MESH_CACHE_VERSION &&
+                header.sourceHash == sourceHash &&
+                header.vertexStride == sizeof(Vertex) &&
+                header.vertexOffset % MESH_CACHE_ALIGNMENT == 0 &&
+                header.indexOffset % MESH_CACHE_ALIGNMENT == 0 &&
+                header.meshletOffset % MESH_CACHE_ALIGNMENT == 0 &&
+                header.meshletVertexOffset % MESH_CACHE_ALIGNMENT == 0 &&
+                header.vertexOffset + vertexBytes <= fileSize &&
+                header.indexOffset + indexBytes <= fileSize &&
+                header.meshletOffset + meshletBytes <= fileSize &&
+                header.meshletVertexOffset + meshletVertexBytes <= fileSize &&
+                header.meshletTriangleOffset + meshletTriangleBytes <= fileSize;
+
+            if (!valid) {
+#ifdef DEBUG_
+                printf("[mesh cache] stale or invalid cache: %s\n", cachePath.c_str());
+#endif // DEBUG_
+                this->close();
+                return false;
+            }
+
+            this->vertices = reinterpret_cast<const Vertex*>(data + header.vertexOffset);
+            this->indices = reinterpret_cast<const uint32_t*>(data + header.indexOffset);
+            this->vertexCount = header.vertexCount;
+            this->indexCount = header.indexCount;
+            this->meshlets = reinterpret_cast<const VKMeshlet*>(data + header.meshletOffset);
+            this->meshletVertices = reinterpret_cast<const uint32_t*>(data + header.meshletVertexOffset);
+            this->meshletTriangles = data + header.meshletTriangleOffset;
+            this->meshletCount = header.meshletCount;
+            this->meshletVertexCount = header.meshletVertexCount;
+            this->meshletTriangleCount = header.meshletTriangleCount;
+            this->boundsMin = glm::vec3(header.boundsMin[0], header.boundsMin[1], header.boundsMin[2]);
+            this->boundsMax = glm::vec3(header.boundsMax[0], header.boundsMax[1], header.boundsMax[2]);
+
+#ifdef DEBUG_
+            printf("[mesh cache] mapped %s (%u vertices, %u indices, %u meshlets)\n", cachePath.c_str(), this->vertexCount, this->indexCount, this->meshletCount);
+#endif // DEBUG_
+
+            return true;
+        }
+
+        bool VKMeshCache::write(const std::string& cachePath, uint64_t sourceHash, const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices, const VKMeshletData& meshlets)
+        {
+            VKMeshCacheHeader header{};
+            header.magic = MESH_CACHE_MAGIC;
+            header.version = MESH_CACHE_VERSION;
+            header.sourceHash = sourceHash;
+            header.vertexStride = sizeof(Vertex);
+            header.vertexCount = static_cast<uint32_t>(vertices.size());
+            header.indexCount = static_cast<uint32_t>(indices.size());
+            header.meshletCount = static_cast<uint32_t>(meshlets.meshlets.size());
+            header.meshletVertexCount = static_cast<uint32_t>(meshlets.vertices.size());
+            header.meshletTriangleCount = static_cast<uint32_t>(meshlets.triangles.size());
+
+            glm::vec3 boundsMin(0.0f);
+            glm::vec3 boundsMax(0.0f);
+            if (!vertices.empty()) {
+                boundsMin = boundsMax = vertices[0].pos;
+                for (const Vertex& vertex : vertices)
+                {
+                    boundsMin = glm::min(boundsMin, vertex.pos);
+                    boundsMax = glm::max(boundsMax, vertex.pos);
+                }
+            }
+            for (int i = 0; i < 3; i++)
+            {
+                header.boundsMin[i] = boundsMin[i];
+                header.boundsMax[i] = boundsMax[i];
+            }
+
+            const uint64_t vertexBytes = vertices.size() * sizeof(Vertex);
+            const uint64_t indexBytes = indices.size() * sizeof(uint32_t);
+            header.vertexOffset = alignUp(sizeof(VKMeshCacheHeader), MESH_CACHE_ALIGNMENT);
+            const uint64_t meshletBytes = meshlets.meshlets.size() * sizeof(VKMeshlet);
+            const uint64_t meshletVertexBytes = meshlets.vertices.size() * sizeof(uint32_t);
+            const uint64_t meshletTriangleBytes = meshlets.triangles.size() * sizeof(uint8_t);
+            header.indexOffset = alignUp(header.vertexOffset + vertexBytes, MESH_CACHE_ALIGNMENT);
+            header.meshletOffset = alignUp(header.indexOffset + indexBytes, MESH_CACHE_ALIGNMENT);
+            header.meshletVertexOffset = alignUp(header.meshletOffset + meshletBytes, MESH_CACHE_ALIGNMENT);
+            header.meshletTriangleOffset = alignUp(header.meshletVertexOffset + meshletVertexBytes, MESH_CACHE_ALIGNMENT);
+
+            // 쓰는 도중 종료되어도 깨진 캐시가 남지 않도록 임시 파일에 쓴 뒤 교체합니다.
+            const std::string tempPath = cachePath + ".tmp";
+            {
+                std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+                if (!file.is_open()) {
+                    return false;
+                }
+
+                const char padding[MESH_CACHE_ALIGNMENT] = {};
+
+                file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+                file.write(padding, static_cast<std::streamsize>(header.vertexOffset - sizeof(header)));
+                file.write(reinterpret_cast<const char*>(vertices.data()), static_cast<std::streamsize>(vertexBytes));
+                file.write(padding, static_cast<std::streamsize>(header.indexOffset - header.vertexOffset - vertexBytes));
+                file.write(reinterpret_cast<const char*>(indices.data()), static_cast<std::streamsize>(indexBytes));
+                file.write(padding, static_cast<std::streamsize>(header.meshletOffset - header.indexOffset - indexBytes));
+                file.write(reinterpret_cast<const char*>(meshlets.meshlets.data()), static_cast<std::streamsize>(meshletBytes));
+                file.write(padding, static_cast<std::streamsize>(header.meshletVertexOffset - header.meshletOffset - meshletBytes));
+                file.write(reinterpret_cast<const char*>(meshlets.vertices.data()), static_cast<std::streamsize>(meshletVertexBytes));
+                file.write(padding, static_cast<std::streamsize>(header.meshletTriangleOffset - header.meshletVertexOffset - meshletVertexBytes));
+                file.write(reinterpret_cast<const char*>(meshlets.triangles.data()), static_cast<std::streamsize>(meshletTriangleBytes));
+
+                if (!file.good()) {
+                    file.close();
+                    std::remove(tempPath.c_str());
+                    return false;
+                }
+            }
+
+            std::remove(cachePath.c_str());
+            if (std::rename(tempPath.c_str(), cachePath.c_str()) != 0) {
+                std::remove(tempPath.c_str());
+                return false;
+            }
+
+#ifdef DEBUG_
+            printf("[mesh cache] wrote %s (%u vertices, %u indices, %u meshlets)\n", cachePath.c_str(), header.vertexCount, header.indexCount, header.meshletCount);
+#endif // DEBUG_
+
+            return true;
+        }
+
+        void VKMeshCache::assign(std::vector<Vertex>&& vertices, std::vector<uint32_t>&& indices, VKMeshletData&& meshlets)
+        {
+            this->close();
+
+            this->ownedVertices = std::move(vertices);
+            this->ownedIndices = std::move(indices);
+            this->ownedMeshlets = std::move(meshlets);
+
+            if (!this->ownedVertices.empty()) {
+                this->boundsMin = this->boundsMax = this->ownedVertices[0].pos;
+                for (const Vertex& vertex : this->ownedVertices)
+                {
+                    this->boundsMin = glm::min(this->boundsMin, vertex.pos);
+                    this->boundsMax = glm::max(this->boundsMax, vertex.pos);
+                }
+            }
+
+            this->vertices = this->ownedVertices.data();
+            this->indices = this->ownedIndices.data();
+            this->vertexCount = static_cast<uint32_t>(this->ownedVertices.size());
+            this->indexCount = static_cast<uint32_t>(this->ownedIndices.size());
+            this->meshlets = this->ownedMeshlets.meshlets.data();
+            this->meshletVertices = this->ownedMeshlets.vertices.data();
+            this->meshletTriangles = this->ownedMeshlets.triangles.data();
+            this->meshletCount = static_cast<uint32_t>(this->ownedMeshlets.meshlets.size());
+            this->meshletVertexCount = static_cast<uint32_t>(this->ownedMeshlets.vertices.size());
+            this->meshletTriangleCount = static_cast<uint32_t>(this->ownedMeshlets.triangles.size());
+        }
+
+        uint64_t VKMeshCache::hashFile(const std::string& path)
+        {
+            VKMappedFile file;
+            if (!file.open(path)) {
+                throw std::runtime_error("failed to open mesh source file!");
+            }
+
+            return hashBytes(file.getData(), file.getSize());
+        }
+
+        void VKMeshCache::close()
+        {
+            this->mappedFile.close();
+            this->ownedVertices.clear();
+            this->ownedVertices.shrink_to_fit();
+            this->ownedIndices.clear();
+            this->ownedIndices.shrink_to_fit();
+            this->ownedMeshlets = VKMeshletData{};
+
+            this->vertices = nullptr;
+            this->indices = nullptr;
+            this->vertexCount = 0;
+            this->indexCount = 0;
+            this->meshlets = nullptr;
+            this->meshletVertices = nullptr;
+            this->meshletTriangles = nullptr;
+            this->meshletCount = 0;
+            this->meshletVertexCount = 0;
+            this->meshletTriangleCount = 0;
+            this->boundsMin = glm::vec3(0.0f);
+            this->boundsMax = glm::vec3(0.0f);
+        }
+    }
+}
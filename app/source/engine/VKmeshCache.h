@@ -0,0 +1,127 @@
+﻿#ifndef INCLUDE_VULKANMESHCACHE_H_
+#define INCLUDE_VULKANMESHCACHE_H_
+
+#include "../_common.h"
+#include "../struct.h"
+#include "VKmeshlet.h"
+
+namespace vkengine {
+    namespace asset {
+
+        constexpr uint32_t MESH_CACHE_MAGIC = 0x434D4B56;        // "VKMC"
+        constexpr uint32_t MESH_CACHE_VERSION = 3;              // 레이아웃이나 Vertex, 메시 최적화가 바뀌면 올립니다.
+        constexpr uint64_t MESH_CACHE_ALIGNMENT = 16;
+
+        // 캐시 파일 헤더 -> 뒤에 Vertex 배열, uint32_t 인덱스 배열, 메시렛 배열이 이어집니다.
+        struct VKMeshCacheHeader {
+            uint32_t magic;
+            uint32_t version;
+            uint64_t sourceHash;                                // 원본(OBJ) 파일 내용의 해시
+            uint32_t vertexStride;                              // sizeof(Vertex) -> 구조체가 바뀐 캐시를 거릅니다.
+            uint32_t vertexCount;
+            uint32_t indexCount;
+            uint32_t reserved;
+            float boundsMin[3];
+            float boundsMax[3];
+            uint64_t vertexOffset;                              // 파일 시작 기준
+            uint64_t indexOffset;
+            uint32_t meshletCount;
+            uint32_t meshletVertexCount;
+            uint32_t meshletTriangleCount;                      // 로컬 인덱스(uint8) 수 -> 삼각형 수 x 3
+            uint32_t meshletReserved;
+            uint64_t meshletOffset;
+            uint64_t meshletVertexOffset;
+            uint64_t meshletTriangleOffset;
+        };
+
+        // 읽기 전용으로 메모리 매핑한 파일
+        class VKMappedFile {
+        public:
+            VKMappedFile() = default;
+            ~VKMappedFile();
+
+            VKMappedFile(const VKMappedFile&) = delete;
+            VKMappedFile& operator=(const VKMappedFile&) = delete;
+
+            bool open(const std::string& path);
+            void close();
+
+            const uint8_t* getData() const { return this->data; }
+            uint64_t getSize() const { return this->size; }
+
+        private:
+            const uint8_t* data = nullptr;
+            uint64_t size = 0;
+#ifdef _WIN32
+            HANDLE file = INVALID_HANDLE_VALUE;
+            HANDLE mapping = nullptr;
+#else
+            int file = -1;
+#endif
+        };
+
+        // FNV-1a를 8바이트 단위로 적용한 해시 -> 파일 내용이 바뀌었는지만 확인하면 됩니다.
+        uint64_t hashBytes(const uint8_t* data, uint64_t size);
+
+        // 중복 제거된 Vertex/인덱스 배열, 메시렛과 바운딩 박스
+        // 캐시 파일을 매핑한 경우 배열은 매핑된 메모리를 그대로 가리킵니다. (복사 없음)
+        // 캐시를 쓸 수 없을 때는 파싱한 배열을 직접 소유합니다.
+        class VKMeshCache {
+        public:
+            VKMeshCache() = default;
+
+            VKMeshCache(const VKMeshCache&) = delete;
+            VKMeshCache& operator=(const VKMeshCache&) = delete;
+
+            // 캐시 파일을 매핑합니다. 헤더/버전/해시/크기가 맞지 않으면 false
+            bool open(const std::string& cachePath, uint64_t sourceHash);
+
+            // 파싱한 배열을 캐시 파일로 씁니다. (임시 파일에 쓴 뒤 교체)
+            static bool write(const std::string& cachePath, uint64_t sourceHash, const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices, const VKMeshletData& meshlets);
+
+            // 캐시 없이 배열을 직접 사용합니다.
+            void assign(std::vector<Vertex>&& vertices, std::vector<uint32_t>&& indices, VKMeshletData&& meshlets);
+
+            // 파일 내용의 64비트 해시 -> 파일을 열 수 없으면 예외
+            static uint64_t hashFile(const std::string& path);
+
+            const Vertex* getVertices() const { return this->vertices; }
+            const uint32_t* getIndices() const { return this->indices; }
+            uint32_t getVertexCount() const { return this->vertexCount; }
+            uint32_t getIndexCount() const { return this->indexCount; }
+            const VKMeshlet* getMeshlets() const { return this->meshlets; }
+            const uint32_t* getMeshletVertices() const { return this->meshletVertices; }
+            const uint8_t* getMeshletTriangles() const { return this->meshletTriangles; }
+            uint32_t getMeshletCount() const { return this->meshletCount; }
+            uint32_t getMeshletVertexCount() const { return this->meshletVertexCount; }
+            uint32_t getMeshletTriangleCount() const { return this->meshletTriangleCount; }
+            const glm::vec3& getBoundsMin() const { return this->boundsMin; }
+            const glm::vec3& getBoundsMax() const { return this->boundsMax; }
+            bool isMapped() const { return this->mappedFile.getData() != nullptr; }
+
+            // 매핑/배열을 해제하는 함수 -> 업로드가 스테이징 버퍼로 복사된 뒤 호출해도 됩니다.
+            void close();
+
+        private:
+            VKMappedFile mappedFile;
+            std::vector<Vertex> ownedVertices;
+            std::vector<uint32_t> ownedIndices;
+            VKMeshletData ownedMeshlets;
+
+            const Vertex* vertices = nullptr;
+            const uint32_t* indices = nullptr;
+            uint32_t vertexCount = 0;
+            uint32_t indexCount = 0;
+            const VKMeshlet* meshlets = nullptr;
+            const uint32_t* meshletVertices = nullptr;
+            const uint8_t* meshletTriangles = nullptr;
+            uint32_t meshletCount = 0;
+            uint32_t meshletVertexCount = 0;
+            uint32_t meshletTriangleCount = 0;
+            glm::vec3 boundsMin{ 0.0f };
+            glm::vec3 boundsMax{ 0.0f };
+        };
+    }
+}
+
+#endif // INCLUDE_VULKANMESHCACHE_H_
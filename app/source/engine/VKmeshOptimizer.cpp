@@ -0,0 +1,302 @@
+﻿#include "VKmeshOptimizer.h"
+
+namespace vkengine {
+    namespace asset {
+
+        namespace {
+            constexpr uint32_t INVALID_INDEX = UINT32_MAX;
+
+            // 버텍스별로 인접한 삼각형 목록 (CSR 형태)
+            struct VKTriangleAdjacency {
+                std::vector<uint32_t> offsets;                  // vertexCount + 1
+                std::vector<uint32_t> triangles;
+
+                void build(const std::vector<uint32_t>& indices, uint32_t vertexCount)
+                {
+                    this->offsets.assign(vertexCount + 1, 0);
+                    for (uint32_t index : indices)
+                    {
+                        this->offsets[index + 1]++;
+                    }
+                    for (uint32_t v = 0; v < vertexCount; v++)
+                    {
+                        this->offsets[v + 1] += this->offsets[v];
+                    }
+
+                    this->triangles.resize(indices.size());
+                    std::vector<uint32_t> cursor(this->offsets.begin(), this->offsets.end() - 1);
+                    for (uint32_t i = 0; i < static_cast<uint32_t>(indices.size()); i++)
+                    {
+                        this->triangles[cursor[indices[i]]++] = i / 3;
+                    }
+                }
+            };
+        }
+
+        VKVertexCacheStats analyzeVertexCache(const std::vector<uint32_t>& indices, uint32_t vertexCount, uint32_t cacheSize)
+        {
+            VKVertexCacheStats stats{};
+            if (indices.empty() || vertexCount == 0) {
+                return stats;
+            }
+
+            // FIFO 캐시: 버텍스가 들어간 시각을 기록하고, cacheSize번 이상 새로 들어왔으면 밀려난 것으로 봅니다.
+            std::vector<uint32_t> insertTime(vertexCount, 0);
+            uint32_t time = cacheSize + 1;
+            uint32_t misses = 0;
+
+            for (uint32_t index : indices)
+            {
+                if (time - insertTime[index] > cacheSize) {
+                    insertTime[index] = time++;
+                    misses++;
+                }
+            }
+
+            stats.acmr = static_cast<float>(misses) / static_cast<float>(indices.size() / 3);
+            stats.atvr = static_cast<float>(misses) / static_cast<float>(vertexCount);
+            return stats;
+        }
+
+        void optimizeVertexCache(std::vector<uint32_t>& indices, uint32_t vertexCount, std::vector<uint32_t>& clusters, uint32_t cacheSize)
+        {
+            clusters.clear();
+
+            const uint32_t triangleCount = static_cast<uint32_t>(indices.size() / 3);
+            if (triangleCount == 0) {
+                return;
+            }
+
+            VKTriangleAdjacency adjacency;
+            adjacency.build(indices, vertexCount);
+
+            std::vector<uint32_t> liveTriangles(vertexCount);
+            for (uint32_t v = 0; v < vertexCount; v++)
+            {
+                liveTriangles[v] = adjacency.offsets[v + 1] - adjacency.offsets[v];
+            }
+
+            std::vector<uint32_t> cacheTime(vertexCount, 0);
+            std::vector<bool> emitted(triangleCount, false);
+            std::vector<uint32_t> deadEnd;                      // 최근에 참조한 버텍스 스택
+            std::vector<uint32_t> candidates;
+            std::vector<uint32_t> output;
+            output.reserve(indices.size());
+
+            uint32_t time = cacheSize + 1;
+            uint32_t cursor = 0;                                // 남은 삼각형이 있는 버텍스를 순서대로 찾는 위치
+            uint32_t fanning = indices[0];
+
+            clusters.push_back(0);
+
+            while (fanning != INVALID_INDEX)
+            {
+                candidates.clear();
+
+                // 1. fanning 버텍스에 붙은 삼각형을 모두 내보냅니다.
+                for (uint32_t k = adjacency.offsets[fanning]; k < adjacency.offsets[fanning + 1]; k++)
+                {
+                    const uint32_t triangle = adjacency.triangles[k];
+                    if (emitted[triangle]) {
+                        continue;
+                    }
+
+                    for (uint32_t corner = 0; corner < 3; corner++)
+                    {
+                        const uint32_t v = indices[triangle * 3 + corner];
+                        output.push_back(v);
+                        deadEnd.push_back(v);
+                        candidates.push_back(v);
+                        liveTriangles[v]--;
+
+                        if (time - cacheTime[v] > cacheSize) {
+                            cacheTime[v] = time++;
+                        }
+                    }
+                    emitted[triangle] = true;
+                }
+
+                // 2. 캐시에 남아 있을 후보 중 가장 오래된(그러나 아직 밀려나지 않을) 버텍스를 고릅니다.
+                uint32_t next = INVALID_INDEX;
+                int32_t bestPriority = -1;
+                for (uint32_t v : candidates)
+                {
+                    if (liveTriangles[v] == 0) {
+                        continue;
+                    }
+
+                    int32_t priority = 0;
+                    if (time - cacheTime[v] + 2 * liveTriangles[v] <= cacheSize) {
+                        priority = static_cast<int32_t>(time - cacheTime[v]);
+                    }
+                    if (priority > bestPriority) {
+                        bestPriority = priority;
+                        next = v;
+                    }
+                }
+
+                // 3. 후보가 없으면(dead end) 최근 버텍스 스택, 그다음 입력 순서에서 찾습니다. -> 새 클러스터
+                if (next == INVALID_INDEX) {
+                    while (!deadEnd.empty())
+                    {
+                        const uint32_t v = deadEnd.back();
+                        deadEnd.pop_back();
+                        if (liveTriangles[v] > 0) {
+                            next = v;
+                            break;
+                        }
+                    }
+
+                    while (next == INVALID_INDEX && cursor < vertexCount)
+                    {
+                        if (liveTriangles[cursor] > 0) {
+                            next = cursor;
+                        }
+                        cursor++;
+                    }
+
+                    if (next != INVALID_INDEX) {
+                        clusters.push_back(static_cast<uint32_t>(output.size() / 3));
+                    }
+                }
+
+                fanning = next;
+            }
+
+            indices.swap(output);
+        }
+
+        void optimizeOverdraw(std::vector<uint32_t>& indices, const std::vector<Vertex>& vertices, const std::vector<uint32_t>& clusters, float threshold)
+        {
+            const uint32_t triangleCount = static_cast<uint32_t>(indices.size() / 3);
+            const uint32_t clusterCount = static_cast<uint32_t>(clusters.size());
+            if (clusterCount < 2) {
+                return;
+            }
+
+            const VKVertexCacheStats before = analyzeVertexCache(indices, static_cast<uint32_t>(vertices.size()));
+
+            // 메시 중심 (면적 가중)
+            glm::vec3 meshCentroid(0.0f);
+            float meshArea = 0.0f;
+
+            std::vector<glm::vec3> clusterCentroids(clusterCount, glm::vec3(0.0f));
+            std::vector<glm::vec3> clusterNormals(clusterCount, glm::vec3(0.0f));
+            std::vector<float> clusterAreas(clusterCount, 0.0f);
+
+            for (uint32_t c = 0; c < clusterCount; c++)
+            {
+                const uint32_t first = clusters[c];
+                const uint32_t last = (c + 1 < clusterCount) ? clusters[c + 1] : triangleCount;
+
+                for (uint32_t t = first; t < last; t++)
+                {
+                    const glm::vec3& p0 = vertices[indices[t * 3 + 0]].pos;
+                    const glm::vec3& p1 = vertices[indices[t * 3 + 1]].pos;
+                    const glm::vec3& p2 = vertices[indices[t * 3 + 2]].pos;
+
+                    const glm::vec3 normal = glm::cross(p1 - p0, p2 - p0);     // 길이 = 면적 x 2
+                    const float area = glm::length(normal);
+                    const glm::vec3 centroid = (p0 + p1 + p2) / 3.0f;
+
+                    clusterCentroids[c] += centroid * area;
+                    clusterNormals[c] += normal;
+                    clusterAreas[c] += area;
+                }
+
+                meshCentroid += clusterCentroids[c];
+                meshArea += clusterAreas[c];
+            }
+
+            if (meshArea <= 0.0f) {
+                return;
+            }
+            meshCentroid /= meshArea;
+
+            // 바깥쪽을 향하는 클러스터일수록 가리는 쪽이므로 먼저 그립니다.
+            std::vector<float> sortKeys(clusterCount, 0.0f);
+            for (uint32_t c = 0; c < clusterCount; c++)
+            {
+                if (clusterAreas[c] <= 0.0f) {
+                    continue;
+                }
+
+                const glm::vec3 centroid = clusterCentroids[c] / clusterAreas[c];
+                const float normalLength = glm::length(clusterNormals[c]);
+                const glm::vec3 normal = (normalLength > 0.0f) ? clusterNormals[c] / normalLength : glm::vec3(0.0f);
+                sortKeys[c] = glm::dot(centroid - meshCentroid, normal);
+            }
+
+            std::vector<uint32_t> order(clusterCount);
+            for (uint32_t c = 0; c < clusterCount; c++)
+            {
+                order[c] = c;
+            }
+            std::stable_sort(order.begin(), order.end(), [&sortKeys](uint32_t a, uint32_t b) { return sortKeys[a] > sortKeys[b]; });
+
+            std::vector<uint32_t> output;
+            output.reserve(indices.size());
+            for (uint32_t c : order)
+            {
+                const uint32_t first = clusters[c];
+                const uint32_t last = (c + 1 < clusterCount) ? clusters[c + 1] : triangleCount;
+                output.insert(output.end(), indices.begin() + first * 3, indices.begin() + last * 3);
+            }
+
+            // 클러스터 경계는 원래 캐시 재사용이 끊기는 곳이지만, 그래도 ACMR이 많이 나빠지면 정렬을 버립니다.
+            const VKVertexCacheStats after = analyzeVertexCache(output, static_cast<uint32_t>(vertices.size()));
+            if (after.acmr <= before.acmr * threshold) {
+                indices.swap(output);
+            }
+        }
+
+        void optimizeVertexFetch(std::vector<Vertex>& vertices, std::vector<uint32_t>& indices)
+        {
+            const uint32_t vertexCount = static_cast<uint32_t>(vertices.size());
+            std::vector<uint32_t> remap(vertexCount, INVALID_INDEX);
+            std::vector<Vertex> output;
+            output.reserve(vertexCount);
+
+            for (uint32_t& index : indices)
+            {
+                if (remap[index] == INVALID_INDEX) {
+                    remap[index] = static_cast<uint32_t>(output.size());
+                    output.push_back(vertices[index]);
+                }
+                index = remap[index];
+            }
+
+            // 어떤 삼각형도 참조하지 않는 버텍스는 뒤에 그대로 둡니다.
+            for (uint32_t v = 0; v < vertexCount; v++)
+            {
+                if (remap[v] == INVALID_INDEX) {
+                    output.push_back(vertices[v]);
+                }
+            }
+
+            vertices.swap(output);
+        }
+
+        VKMeshOptimizeStats optimizeMesh(std::vector<Vertex>& vertices, std::vector<uint32_t>& indices)
+        {
+            VKMeshOptimizeStats stats{};
+            const uint32_t vertexCount = static_cast<uint32_t>(vertices.size());
+
+            stats.before = analyzeVertexCache(indices, vertexCount);
+
+            std::vector<uint32_t> clusters;
+            optimizeVertexCache(indices, vertexCount, clusters);
+            optimizeOverdraw(indices, vertices, clusters);
+            optimizeVertexFetch(vertices, indices);
+
+            stats.after = analyzeVertexCache(indices, vertexCount);
+
+#ifdef DEBUG_
+            printf("[mesh optimizer] ACMR %.3f -> %.3f, ATVR %.3f -> %.3f (%zu clusters)\n",
+                stats.before.acmr, stats.after.acmr, stats.before.atvr, stats.after.atvr, clusters.size());
+#endif // DEBUG_
+
+            return stats;
+        }
+    }
+}
@@ -0,0 +1,41 @@
+﻿#ifndef INCLUDE_VULKANMESHOPTIMIZER_H_
+#define INCLUDE_VULKANMESHOPTIMIZER_H_
+
+#include "../_common.h"
+#include "../struct.h"
+
+namespace vkengine {
+    namespace asset {
+
+        constexpr uint32_t VERTEX_CACHE_SIZE = 16;              // 최적화/분석에 쓰는 post-transform 캐시 크기
+        constexpr float OVERDRAW_THRESHOLD = 1.05f;             // 오버드로 정렬로 ACMR이 이 비율 이상 나빠지면 정렬을 버립니다.
+
+        // post-transform 버텍스 캐시 통계 (FIFO 캐시 시뮬레이션)
+        struct VKVertexCacheStats {
+            float acmr = 0.0f;                                  // 삼각형당 캐시 미스 수 (0.5 ~ 3.0, 낮을수록 좋음)
+            float atvr = 0.0f;                                  // 버텍스당 캐시 미스 수 (1.0이 최적)
+        };
+
+        struct VKMeshOptimizeStats {
+            VKVertexCacheStats before;
+            VKVertexCacheStats after;
+        };
+
+        VKVertexCacheStats analyzeVertexCache(const std::vector<uint32_t>& indices, uint32_t vertexCount, uint32_t cacheSize = VERTEX_CACHE_SIZE);
+
+        // Tipsify(Sander et al. 2007)로 삼각형 순서를 바꿉니다.
+        // clusters에는 캐시 재사용이 끊기는 지점(클러스터 시작 삼각형 번호)을 돌려줍니다.
+        void optimizeVertexCache(std::vector<uint32_t>& indices, uint32_t vertexCount, std::vector<uint32_t>& clusters, uint32_t cacheSize = VERTEX_CACHE_SIZE);
+
+        // 클러스터를 메시 바깥쪽을 향하는 순서로 정렬해 오버드로를 줄입니다. (클러스터 안의 순서는 유지)
+        void optimizeOverdraw(std::vector<uint32_t>& indices, const std::vector<Vertex>& vertices, const std::vector<uint32_t>& clusters, float threshold = OVERDRAW_THRESHOLD);
+
+        // 인덱스에서 처음 참조되는 순서대로 버텍스 버퍼를 재배치하고 인덱스를 다시 매깁니다.
+        void optimizeVertexFetch(std::vector<Vertex>& vertices, std::vector<uint32_t>& indices);
+
+        // 버텍스 캐시 -> 오버드로 -> 버텍스 fetch 순서로 모두 적용합니다.
+        VKMeshOptimizeStats optimizeMesh(std::vector<Vertex>& vertices, std::vector<uint32_t>& indices);
+    }
+}
+
+#endif // INCLUDE_VULKANMESHOPTIMIZER_H_
@@ -0,0 +1,274 @@
+﻿#include "VKmeshlet.h"
+
+namespace vkengine {
+    namespace asset {
+
+        namespace {
+            constexpr uint8_t UNUSED_LOCAL = 0xFF;
+
+            // 메시렛의 바운딩 구와 법선 원뿔을 계산합니다.
+            void computeMeshletBounds(VKMeshlet& meshlet, const Vertex* vertices, const VKMeshletData& data)
+            {
+                const uint32_t* localVertices = &data.vertices[meshlet.vertexOffset];
+                const uint8_t* localTriangles = &data.triangles[meshlet.triangleOffset];
+
+                // 바운딩 박스 중심 + 가장 먼 버텍스까지의 거리
+                glm::vec3 boundsMin = vertices[localVertices[0]].pos;
+                glm::vec3 boundsMax = boundsMin;
+                for (uint32_t i = 1; i < meshlet.vertexCount; i++)
+                {
+                    boundsMin = glm::min(boundsMin, vertices[localVertices[i]].pos);
+                    boundsMax = glm::max(boundsMax, vertices[localVertices[i]].pos);
+                }
+
+                const glm::vec3 center = (boundsMin + boundsMax) * 0.5f;
+                float radius = 0.0f;
+                for (uint32_t i = 0; i < meshlet.vertexCount; i++)
+                {
+                    radius = std::max(radius, glm::length(vertices[localVertices[i]].pos - center));
+                }
+
+                // 삼각형 법선의 평균 방향과, 그 방향에서 가장 벌어진 법선
+                std::array<glm::vec3, MESHLET_MAX_TRIANGLES> normals;
+                uint32_t normalCount = 0;
+                glm::vec3 axis(0.0f);
+
+                for (uint32_t t = 0; t < meshlet.triangleCount; t++)
+                {
+                    const glm::vec3& p0 = vertices[localVertices[localTriangles[t * 3 + 0]]].pos;
+                    const glm::vec3& p1 = vertices[localVertices[localTriangles[t * 3 + 1]]].pos;
+                    const glm::vec3& p2 = vertices[localVertices[localTriangles[t * 3 + 2]]].pos;
+
+                    const glm::vec3 normal = glm::cross(p1 - p0, p2 - p0);
+                    const float length = glm::length(normal);
+                    if (length > 0.0f) {
+                        normals[normalCount++] = normal / length;
+                        axis += normal / length;
+                    }
+                }
+
+                float coneCutoff = 1.0f;
+                const float axisLength = glm::length(axis);
+                if (normalCount > 0 && axisLength > 0.0f) {
+                    axis /= axisLength;
+
+                    float minDot = 1.0f;
+                    for (uint32_t i = 0; i < normalCount; i++)
+                    {
+                        minDot = std::min(minDot, glm::dot(axis, normals[i]));
+                    }
+
+                    // 원뿔이 반구보다 넓으면 어느 방향에서든 보이는 삼각형이 있습니다.
+                    if (minDot > 0.0f) {
+                        coneCutoff = std::sqrt(1.0f - minDot * minDot);
+                    }
+                }
+                else {
+                    axis = glm::vec3(0.0f, 0.0f, 1.0f);
+                }
+
+                for (int i = 0; i < 3; i++)
+                {
+                    meshlet.center[i] = center[i];
+                    meshlet.coneAxis[i] = axis[i];
+                }
+                meshlet.radius = radius;
+                meshlet.coneCutoff = coneCutoff;
+            }
+        }
+
+        void buildMeshlets(const Vertex* vertices, uint32_t vertexCount, const uint32_t* indices, uint32_t indexCount, VKMeshletData& out)
+        {
+            out.meshlets.clear();
+            out.vertices.clear();
+            out.triangles.clear();
+
+            // 메시 버텍스 -> 현재 메시렛의 로컬 인덱스
+            std::vector<uint8_t> localIndex(vertexCount, UNUSED_LOCAL);
+
+            VKMeshlet current{};
+
+            auto flush = [&]() {
+                if (current.triangleCount == 0) {
+                    return;
+                }
+
+                computeMeshletBounds(current, vertices, out);
+                out.meshlets.push_back(current);
+
+                for (uint32_t i = 0; i < current.vertexCount; i++)
+                {
+                    localIndex[out.vertices[current.vertexOffset + i]] = UNUSED_LOCAL;
+                }
+
+                current = {};
+                current.vertexOffset = static_cast<uint32_t>(out.vertices.size());
+                current.triangleOffset = static_cast<uint32_t>(out.triangles.size());
+                current.indexOffset = current.triangleOffset;   // 삼각형을 순서대로 모으므로 인덱스 위치와 같습니다.
+            };
+
+            for (uint32_t i = 0; i + 2 < indexCount; i += 3)
+            {
+                const uint32_t a = indices[i + 0];
+                const uint32_t b = indices[i + 1];
+                const uint32_t c = indices[i + 2];
+
+                // 이 삼각형이 새로 추가하는 버텍스 수
+                uint32_t newVertices = (localIndex[a] == UNUSED_LOCAL ? 1 : 0);
+                newVertices += (localIndex[b] == UNUSED_LOCAL && b != a) ? 1 : 0;
+                newVertices += (localIndex[c] == UNUSED_LOCAL && c != a && c != b) ? 1 : 0;
+
+                if (current.vertexCount + newVertices > MESHLET_MAX_VERTICES || current.triangleCount + 1 > MESHLET_MAX_TRIANGLES) {
+                    flush();
+                }
+
+                for (uint32_t v : { a, b, c })
+                {
+                    if (localIndex[v] == UNUSED_LOCAL) {
+                        localIndex[v] = static_cast<uint8_t>(current.vertexCount++);
+                        out.vertices.push_back(v);
+                    }
+                    out.triangles.push_back(localIndex[v]);
+                }
+
+                current.triangleCount++;
+            }
+
+            flush();
+
+#ifdef DEBUG_
+            printf("[meshlet] %zu meshlets (%u triangles)\n", out.meshlets.size(), indexCount / 3);
+#endif // DEBUG_
+        }
+
+        bool validateMeshlets(const VKMeshletData& data, const uint32_t* indices, uint32_t indexCount, uint32_t vertexCount)
+        {
+            uint32_t expectedIndexOffset = 0;
+
+            for (const VKMeshlet& meshlet : data.meshlets)
+            {
+                if (meshlet.vertexCount == 0 || meshlet.vertexCount > MESHLET_MAX_VERTICES ||
+                    meshlet.triangleCount == 0 || meshlet.triangleCount > MESHLET_MAX_TRIANGLES) {
+                    return false;
+                }
+
+                if (meshlet.vertexOffset + meshlet.vertexCount > data.vertices.size() ||
+                    meshlet.triangleOffset + meshlet.triangleCount * 3 > data.triangles.size()) {
+                    return false;
+                }
+
+                // 메시렛은 인덱스 버퍼를 빈틈없이 순서대로 나눠야 합니다.
+                if (meshlet.indexOffset != expectedIndexOffset) {
+                    return false;
+                }
+
+                for (uint32_t k = 0; k < meshlet.triangleCount * 3; k++)
+                {
+                    const uint8_t local = data.triangles[meshlet.triangleOffset + k];
+                    if (local >= meshlet.vertexCount) {
+                        return false;
+                    }
+
+                    const uint32_t vertex = data.vertices[meshlet.vertexOffset + local];
+                    if (vertex >= vertexCount || vertex != indices[meshlet.indexOffset + k]) {
+                        return false;
+                    }
+                }
+
+                if (!(meshlet.radius >= 0.0f)) {
+                    return false;
+                }
+
+                expectedIndexOffset += meshlet.triangleCount * 3;
+            }
+
+            return expectedIndexOffset == indexCount - indexCount % 3;
+        }
+
+        uint32_t cullMeshlets(const VKMeshlet* meshlets, uint32_t meshletCount, const glm::mat4& viewProjection, const glm::vec3& cameraPosition, std::vector<uint32_t>& visible)
+        {
+            visible.clear();
+
+            // 행렬의 행에서 절두체 평면을 뽑습니다. (Gribb-Hartmann, 깊이 0..1)
+            auto row = [&viewProjection](int i) {
+                return glm::vec4(viewProjection[0][i], viewProjection[1][i], viewProjection[2][i], viewProjection[3][i]);
+            };
+
+            std::array<glm::vec4, 6> planes = {
+                row(3) + row(0),                                // left
+                row(3) - row(0),                                // right
+                row(3) + row(1),                                // bottom
+                row(3) - row(1),                                // top
+                row(2),                                         // near
+                row(3) - row(2),                                // far
+            };
+
+            for (glm::vec4& plane : planes)
+            {
+                const float length = glm::length(glm::vec3(plane.x, plane.y, plane.z));
+                if (length > 0.0f) {
+                    plane = plane * (1.0f / length);
+                }
+            }
+
+            for (uint32_t i = 0; i < meshletCount; i++)
+            {
+                const VKMeshlet& meshlet = meshlets[i];
+                const glm::vec3 center(meshlet.center[0], meshlet.center[1], meshlet.center[2]);
+
+                bool inside = true;
+                for (const glm::vec4& plane : planes)
+                {
+                    if (glm::dot(glm::vec3(plane.x, plane.y, plane.z), center) + plane.w < -meshlet.radius) {
+                        inside = false;
+                        break;
+                    }
+                }
+                if (!inside) {
+                    continue;
+                }
+
+                // 모든 삼각형이 카메라 반대쪽을 보면 컬링합니다.
+                const glm::vec3 axis(meshlet.coneAxis[0], meshlet.coneAxis[1], meshlet.coneAxis[2]);
+                const glm::vec3 toCenter = center - cameraPosition;
+                if (glm::dot(toCenter, axis) >= meshlet.coneCutoff * glm::length(toCenter) + meshlet.radius) {
+                    continue;
+                }
+
+                visible.push_back(i);
+            }
+
+            return static_cast<uint32_t>(visible.size());
+        }
+
+        uint32_t mergeMeshletDraws(const VKMeshlet* meshlets, uint32_t meshletCount, const std::vector<uint32_t>& visible, uint32_t indexCount, std::vector<VKMeshletDraw>& draws)
+        {
+            draws.clear();
+
+            if (visible.empty()) {
+                return 0;
+            }
+
+            // 몇 개만 빠진 경우는 구간을 나누는 것보다 전부 그리는 편이 쌉니다.
+            if (static_cast<float>(visible.size()) >= static_cast<float>(meshletCount) * MESHLET_FULL_DRAW_FRACTION) {
+                draws.push_back({ 0, indexCount });
+                return 1;
+            }
+
+            for (uint32_t i : visible)
+            {
+                const VKMeshlet& meshlet = meshlets[i];
+                const uint32_t meshletIndexCount = meshlet.triangleCount * 3;
+
+                if (!draws.empty() && draws.back().firstIndex + draws.back().indexCount == meshlet.indexOffset) {
+                    draws.back().indexCount += meshletIndexCount;
+                }
+                else {
+                    draws.push_back({ meshlet.indexOffset, meshletIndexCount });
+                }
+            }
+
+            return static_cast<uint32_t>(draws.size());
+        }
+    }
+}
@@ -0,0 +1,58 @@
+﻿#ifndef INCLUDE_VULKANMESHLET_H_
+#define INCLUDE_VULKANMESHLET_H_
+
+#include "../_common.h"
+#include "../struct.h"
+
+namespace vkengine {
+    namespace asset {
+
+        constexpr uint32_t MESHLET_MAX_VERTICES = 64;
+        constexpr uint32_t MESHLET_MAX_TRIANGLES = 124;
+        constexpr float MESHLET_FULL_DRAW_FRACTION = 0.9f;     // 보이는 메시렛이 이 비율 이상이면 메시 전체를 draw 하나로 그림
+
+        // 메시를 나눈 클러스터 하나
+        // 삼각형은 원래 인덱스 버퍼에서 연속된 구간이므로 [indexOffset, indexOffset + triangleCount * 3)을 그대로 그릴 수 있습니다.
+        // 메시 셰이더용으로 로컬 버텍스 목록(vertexOffset)과 로컬 삼각형(uint8 x 3, triangleOffset)도 가집니다.
+        struct VKMeshlet {
+            uint32_t vertexOffset;                              // VKMeshletData::vertices 시작 위치
+            uint32_t triangleOffset;                            // VKMeshletData::triangles 시작 위치 (바이트)
+            uint32_t vertexCount;
+            uint32_t triangleCount;
+            uint32_t indexOffset;                               // 메시 인덱스 버퍼 시작 위치
+            float center[3];                                    // 바운딩 구
+            float radius;
+            float coneAxis[3];                                  // 법선 원뿔 -> 모든 삼각형이 카메라 반대를 보면 컬링
+            float coneCutoff;                                   // sin(원뿔 반각), 1이면 원뿔 컬링 불가
+        };
+
+        // 인덱스 버퍼의 연속 구간 하나 -> vkCmdDrawIndexed 한 번
+        struct VKMeshletDraw {
+            uint32_t firstIndex;
+            uint32_t indexCount;
+        };
+
+        struct VKMeshletData {
+            std::vector<VKMeshlet> meshlets;
+            std::vector<uint32_t> vertices;                     // 메시 버텍스 인덱스
+            std::vector<uint8_t> triangles;                     // 메시렛 로컬 버텍스 인덱스 (삼각형당 3개)
+        };
+
+        // 인덱스 순서대로 삼각형을 모아 최대 MESHLET_MAX_VERTICES / MESHLET_MAX_TRIANGLES 크기로 나눕니다.
+        // -> 버텍스 캐시 최적화 뒤에 호출하면 인접한 삼각형끼리 묶입니다.
+        void buildMeshlets(const Vertex* vertices, uint32_t vertexCount, const uint32_t* indices, uint32_t indexCount, VKMeshletData& out);
+
+        // 모든 삼각형이 정확히 한 번씩, 원래 인덱스와 같은 버텍스로 덮였는지와 크기 제한을 확인합니다.
+        bool validateMeshlets(const VKMeshletData& data, const uint32_t* indices, uint32_t indexCount, uint32_t vertexCount);
+
+        // CPU 기준 컬러 -> 절두체(바운딩 구)와 법선 원뿔로 보이는 메시렛만 visible에 담습니다.
+        // viewProjection과 cameraPosition은 메시(오브젝트) 공간 기준입니다. (깊이 0..1)
+        uint32_t cullMeshlets(const VKMeshlet* meshlets, uint32_t meshletCount, const glm::mat4& viewProjection, const glm::vec3& cameraPosition, std::vector<uint32_t>& visible);
+
+        // 보이는 메시렛(번호 오름차순) 중 인덱스 버퍼에서 이어지는 것끼리 draw 하나로 합칩니다. -> draw 수
+        // 거의 모두 보이면 (MESHLET_FULL_DRAW_FRACTION) 메시 전체(indexCount)를 draw 하나로 그립니다.
+        uint32_t mergeMeshletDraws(const VKMeshlet* meshlets, uint32_t meshletCount, const std::vector<uint32_t>& visible, uint32_t indexCount, std::vector<VKMeshletDraw>& draws);
+    }
+}
+
+#endif // INCLUDE_VULKANMESHLET_H_
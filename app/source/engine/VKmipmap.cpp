@@ -0,0 +1,404 @@
+﻿#include "VKmipmap.h"
+#include "VKtrace.h"
+
+#include <cmath>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define VK_MIP_AVX2 1
+#define VK_MIP_SSE2 1
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define VK_MIP_SSE2 1
+#elif defined(__ARM_NEON) || defined(_M_ARM64)
+#include <arm_neon.h>
+#define VK_MIP_NEON 1
+#endif
+
+namespace vkengine {
+    namespace asset {
+
+        namespace {
+            constexpr uint32_t SRGB_ENCODE_TABLE_SIZE = 16384;     // 선형 -> sRGB 표 크기 (어두운 쪽에서도 한 단계 오차 안쪽)
+            constexpr uint32_t MIP_ROW_GRAIN_TEXELS = 64 * 1024;    // 작업 하나가 맡는 원본 텍셀 수 (대략)
+
+            float srgbToLinear(float c)
+            {
+                return (c <= 0.04045f) ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f);
+            }
+
+            float linearToSrgb(float c)
+            {
+                return (c <= 0.0031308f) ? c * 12.92f : 1.055f * std::pow(c, 1.0f / 2.4f) - 0.055f;
+            }
+
+            // sRGB 8비트 <-> 선형 변환 표
+            struct SrgbTable {
+                float toLinear[256];
+                float toUnit[256];                                  // 알파 (선형 그대로 / 255)
+                uint8_t toSrgb[SRGB_ENCODE_TABLE_SIZE];
+
+                SrgbTable()
+                {
+                    for (int i = 0; i < 256; i++)
+                    {
+                        this->toLinear[i] = srgbToLinear(static_cast<float>(i) / 255.0f);
+                        this->toUnit[i] = static_cast<float>(i) / 255.0f;
+                    }
+                    for (uint32_t i = 0; i < SRGB_ENCODE_TABLE_SIZE; i++)
+                    {
+                        const float c = static_cast<float>(i) / static_cast<float>(SRGB_ENCODE_TABLE_SIZE - 1);
+                        this->toSrgb[i] = static_cast<uint8_t>(linearToSrgb(c) * 255.0f + 0.5f);
+                    }
+                }
+            };
+
+            const SrgbTable& getSrgbTable()
+            {
+                static const SrgbTable table;
+                return table;
+            }
+
+            // 분리 가능한 필터의 1차원 가중치
+            // 출력 텍셀 x는 원본 텍셀 2x + offset부터 taps개를 읽습니다.
+            struct MipKernel {
+                uint32_t taps = 0;
+                int32_t offset = 0;
+                float weights[MIP_KAISER_TAPS] = {};
+            };
+
+            // 0차 제1종 변형 베셀 함수 (급수 전개)
+            double bessel0(double x)
+            {
+                double sum = 1.0;
+                double term = 1.0;
+                for (int k = 1; k < 32; k++)
+                {
+                    term *= (x * 0.5 / k) * (x * 0.5 / k);
+                    sum += term;
+                }
+                return sum;
+            }
+
+            MipKernel makeKaiserKernel()
+            {
+                const double pi = 3.14159265358979323846;
+
+                MipKernel kernel;
+                kernel.taps = MIP_KAISER_TAPS;
+                kernel.offset = -static_cast<int32_t>(MIP_KAISER_TAPS / 2 - 1);
+
+                double sum = 0.0;
+                double weights[MIP_KAISER_TAPS];
+                for (uint32_t i = 0; i < MIP_KAISER_TAPS; i++)
+                {
+                    // 원본 텍셀 중심과 출력 텍셀 중심의 거리 (출력 텍셀 단위)
+                    const double t = ((static_cast<double>(kernel.offset) + i + 0.5) - 1.0) * 0.5;
+                    const double sinc = (std::fabs(t) < 1e-9) ? 1.0 : std::sin(pi * t) / (pi * t);
+                    const double r = t / MIP_KAISER_RADIUS;
+                    const double window = (std::fabs(r) < 1.0) ? bessel0(MIP_KAISER_ALPHA * std::sqrt(1.0 - r * r)) / bessel0(MIP_KAISER_ALPHA) : 0.0;
+                    weights[i] = sinc * window;
+                    sum += weights[i];
+                }
+
+                for (uint32_t i = 0; i < MIP_KAISER_TAPS; i++)
+                {
+                    kernel.weights[i] = static_cast<float>(weights[i] / sum);
+                }
+                return kernel;
+            }
+
+            const MipKernel& getKernel(VKMipFilter filter)
+            {
+                static const MipKernel box = [] {
+                    MipKernel kernel;
+                    kernel.taps = 2;
+                    kernel.offset = 0;
+                    kernel.weights[0] = 0.5f;
+                    kernel.weights[1] = 0.5f;
+                    return kernel;
+                }();
+                static const MipKernel kaiser = makeKaiserKernel();
+
+                return (filter == VKMipFilter::Kaiser) ? kaiser : box;
+            }
+
+            uint32_t clampIndex(int32_t i, uint32_t size)
+            {
+                return static_cast<uint32_t>(std::min(std::max(i, 0), static_cast<int32_t>(size) - 1));
+            }
+
+            // 텍셀 하나 (선형 RGBA float 4개)를 SIMD 레지스터 하나로 다룹니다.
+#if defined(VK_MIP_SSE2)
+            typedef __m128 Vec4;
+            inline Vec4 load4(const float* p) { return _mm_loadu_ps(p); }
+            inline void store4(float* p, Vec4 v) { _mm_storeu_ps(p, v); }
+            inline Vec4 zero4() { return _mm_setzero_ps(); }
+            inline Vec4 madd4(Vec4 acc, Vec4 v, float w) { return _mm_add_ps(acc, _mm_mul_ps(v, _mm_set1_ps(w))); }
+#elif defined(VK_MIP_NEON)
+            typedef float32x4_t Vec4;
+            inline Vec4 load4(const float* p) { return vld1q_f32(p); }
+            inline void store4(float* p, Vec4 v) { vst1q_f32(p, v); }
+            inline Vec4 zero4() { return vdupq_n_f32(0.0f); }
+            inline Vec4 madd4(Vec4 acc, Vec4 v, float w) { return vmlaq_n_f32(acc, v, w); }
+#else
+            struct Vec4 { float v[4]; };
+            inline Vec4 load4(const float* p) { Vec4 r; memcpy(r.v, p, sizeof(r.v)); return r; }
+            inline void store4(float* p, Vec4 v) { memcpy(p, v.v, sizeof(v.v)); }
+            inline Vec4 zero4() { return Vec4{ { 0.0f, 0.0f, 0.0f, 0.0f } }; }
+            inline Vec4 madd4(Vec4 acc, Vec4 v, float w)
+            {
+                for (int c = 0; c < 4; c++)
+                {
+                    acc.v[c] += v.v[c] * w;
+                }
+                return acc;
+            }
+#endif
+
+            // dst[i] += src[i] * weight (세로 필터, 행 전체를 평평한 float 배열로 처리)
+            void accumulateRow(float* dst, const float* src, float weight, size_t count)
+            {
+                size_t i = 0;
+#if defined(VK_MIP_AVX2)
+                const __m256 weight8 = _mm256_set1_ps(weight);
+                for (; i + 8 <= count; i += 8)
+                {
+                    _mm256_storeu_ps(dst + i, _mm256_add_ps(_mm256_loadu_ps(dst + i), _mm256_mul_ps(_mm256_loadu_ps(src + i), weight8)));
+                }
+#endif
+                for (; i + 4 <= count; i += 4)
+                {
+                    store4(dst + i, madd4(load4(dst + i), load4(src + i), weight));
+                }
+                for (; i < count; i++)
+                {
+                    dst[i] += src[i] * weight;
+                }
+            }
+
+            // 세로로 걸러진 한 행을 가로로 걸러 출력 행을 만듭니다.
+            void filterRow(const float* column, uint32_t srcWidth, float* dst, uint32_t dstWidth, const MipKernel& kernel)
+            {
+                for (uint32_t x = 0; x < dstWidth; x++)
+                {
+                    const int32_t base = static_cast<int32_t>(x * 2) + kernel.offset;
+                    Vec4 acc = zero4();
+
+                    if (base >= 0 && base + static_cast<int32_t>(kernel.taps) <= static_cast<int32_t>(srcWidth)) {
+                        const float* texel = column + static_cast<size_t>(base) * 4;
+                        for (uint32_t t = 0; t < kernel.taps; t++)
+                        {
+                            acc = madd4(acc, load4(texel + t * 4), kernel.weights[t]);
+                        }
+                    }
+                    else {
+                        for (uint32_t t = 0; t < kernel.taps; t++)
+                        {
+                            acc = madd4(acc, load4(column + static_cast<size_t>(clampIndex(base + static_cast<int32_t>(t), srcWidth)) * 4), kernel.weights[t]);
+                        }
+                    }
+
+                    store4(dst + static_cast<size_t>(x) * 4, acc);
+                }
+            }
+
+            // 행 [0, count)를 나눠 실행합니다. (jobSystem이 없으면 호출한 스레드에서)
+            void forEachRow(job::VKJobSystem* jobSystem, uint32_t count, uint32_t width, const std::function<void(uint32_t begin, uint32_t end)>& function)
+            {
+                if (jobSystem != nullptr) {
+                    jobSystem->parallelFor(count, std::max(1u, MIP_ROW_GRAIN_TEXELS / std::max(1u, width)), function);
+                }
+                else {
+                    function(0, count);
+                }
+            }
+
+            void decodeRGBA8(const uint8_t* src, uint32_t width, uint32_t height, float* dst, job::VKJobSystem* jobSystem)
+            {
+                const SrgbTable& table = getSrgbTable();
+
+                forEachRow(jobSystem, height, width, [&](uint32_t begin, uint32_t end) {
+                    const size_t first = static_cast<size_t>(begin) * width;
+                    const size_t last = static_cast<size_t>(end) * width;
+                    for (size_t i = first; i < last; i++)
+                    {
+                        const uint8_t* in = src + i * 4;
+                        float* out = dst + i * 4;
+                        out[0] = table.toLinear[in[0]];
+                        out[1] = table.toLinear[in[1]];
+                        out[2] = table.toLinear[in[2]];
+                        out[3] = table.toUnit[in[3]];
+                    }
+                });
+            }
+
+            void encodeRGBA8(const float* src, uint32_t width, uint32_t height, uint8_t* dst, job::VKJobSystem* jobSystem)
+            {
+                const SrgbTable& table = getSrgbTable();
+                const float colorScale = static_cast<float>(SRGB_ENCODE_TABLE_SIZE - 1);
+
+                forEachRow(jobSystem, height, width, [&](uint32_t begin, uint32_t end) {
+                    const size_t first = static_cast<size_t>(begin) * width;
+                    const size_t last = static_cast<size_t>(end) * width;
+#if defined(VK_MIP_SSE2)
+                    const __m128 scale = _mm_setr_ps(colorScale, colorScale, colorScale, 255.0f);
+                    const __m128 half = _mm_set1_ps(0.5f);
+                    const __m128 zero = _mm_setzero_ps();
+                    const __m128 one = _mm_set1_ps(1.0f);
+#elif defined(VK_MIP_NEON)
+                    const float scaleValues[4] = { colorScale, colorScale, colorScale, 255.0f };
+                    const float32x4_t scale = vld1q_f32(scaleValues);
+                    const float32x4_t half = vdupq_n_f32(0.5f);
+                    const float32x4_t zero = vdupq_n_f32(0.0f);
+                    const float32x4_t one = vdupq_n_f32(1.0f);
+#endif
+                    alignas(16) int32_t index[4];
+                    for (size_t i = first; i < last; i++)
+                    {
+                        // [0, 1]로 자른 뒤 색은 표 인덱스, 알파는 8비트 값으로 반올림
+#if defined(VK_MIP_SSE2)
+                        const __m128 v = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(src + i * 4), zero), one);
+                        _mm_store_si128(reinterpret_cast<__m128i*>(index), _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(v, scale), half)));
+#elif defined(VK_MIP_NEON)
+                        const float32x4_t v = vminq_f32(vmaxq_f32(vld1q_f32(src + i * 4), zero), one);
+                        vst1q_s32(index, vcvtq_s32_f32(vmlaq_f32(half, v, scale)));
+#else
+                        for (int c = 0; c < 4; c++)
+                        {
+                            const float v = std::min(std::max(src[i * 4 + c], 0.0f), 1.0f);
+                            index[c] = static_cast<int32_t>(v * (c < 3 ? colorScale : 255.0f) + 0.5f);
+                        }
+#endif
+                        uint8_t* out = dst + i * 4;
+                        out[0] = table.toSrgb[index[0]];
+                        out[1] = table.toSrgb[index[1]];
+                        out[2] = table.toSrgb[index[2]];
+                        out[3] = static_cast<uint8_t>(index[3]);
+                    }
+                });
+            }
+
+            // 선형 float 이미지의 다음 mip
+            void downsampleLinear(const float* src, uint32_t srcWidth, uint32_t srcHeight, float* dst, VKMipFilter filter, job::VKJobSystem* jobSystem)
+            {
+                const MipKernel& kernel = getKernel(filter);
+                const uint32_t dstWidth = std::max(1u, srcWidth / 2);
+                const uint32_t dstHeight = std::max(1u, srcHeight / 2);
+                const size_t rowFloats = static_cast<size_t>(srcWidth) * 4;
+
+                forEachRow(jobSystem, dstHeight, srcWidth * 2, [&](uint32_t begin, uint32_t end) {
+                    std::vector<float> column(rowFloats);
+                    for (uint32_t y = begin; y < end; y++)
+                    {
+                        std::fill(column.begin(), column.end(), 0.0f);
+                        for (uint32_t t = 0; t < kernel.taps; t++)
+                        {
+                            const uint32_t sy = clampIndex(static_cast<int32_t>(y * 2 + t) + kernel.offset, srcHeight);
+                            accumulateRow(column.data(), src + sy * rowFloats, kernel.weights[t], rowFloats);
+                        }
+                        filterRow(column.data(), srcWidth, dst + static_cast<size_t>(y) * dstWidth * 4, dstWidth, kernel);
+                    }
+                });
+            }
+        }
+
+        const char* getMipSimdName()
+        {
+#if defined(VK_MIP_AVX2)
+            return "avx2";
+#elif defined(VK_MIP_SSE2)
+            return "sse2";
+#elif defined(VK_MIP_NEON)
+            return "neon";
+#else
+            return "scalar";
+#endif
+        }
+
+        void downsampleRGBA8(const uint8_t* src, uint32_t srcWidth, uint32_t srcHeight, uint8_t* dst, VKMipFilter filter, job::VKJobSystem* jobSystem)
+        {
+            const uint32_t dstWidth = std::max(1u, srcWidth / 2);
+            const uint32_t dstHeight = std::max(1u, srcHeight / 2);
+
+            std::vector<float> linear(static_cast<size_t>(srcWidth) * srcHeight * 4);
+            std::vector<float> filtered(static_cast<size_t>(dstWidth) * dstHeight * 4);
+
+            decodeRGBA8(src, srcWidth, srcHeight, linear.data(), jobSystem);
+            downsampleLinear(linear.data(), srcWidth, srcHeight, filtered.data(), filter, jobSystem);
+            encodeRGBA8(filtered.data(), dstWidth, dstHeight, dst, jobSystem);
+        }
+
+        void downsampleRGBA8Reference(const uint8_t* src, uint32_t srcWidth, uint32_t srcHeight, uint8_t* dst, VKMipFilter filter)
+        {
+            const MipKernel& kernel = getKernel(filter);
+            const uint32_t dstWidth = std::max(1u, srcWidth / 2);
+            const uint32_t dstHeight = std::max(1u, srcHeight / 2);
+
+            for (uint32_t y = 0; y < dstHeight; y++)
+            {
+                for (uint32_t x = 0; x < dstWidth; x++)
+                {
+                    float acc[4] = {};
+
+                    // 분리하지 않은 2차원 필터
+                    for (uint32_t ty = 0; ty < kernel.taps; ty++)
+                    {
+                        const uint32_t sy = clampIndex(static_cast<int32_t>(y * 2 + ty) + kernel.offset, srcHeight);
+                        for (uint32_t tx = 0; tx < kernel.taps; tx++)
+                        {
+                            const uint32_t sx = clampIndex(static_cast<int32_t>(x * 2 + tx) + kernel.offset, srcWidth);
+                            const uint8_t* texel = src + (static_cast<size_t>(sy) * srcWidth + sx) * 4;
+                            const float weight = kernel.weights[ty] * kernel.weights[tx];
+
+                            for (int c = 0; c < 3; c++)
+                            {
+                                acc[c] += weight * srgbToLinear(texel[c] / 255.0f);
+                            }
+                            acc[3] += weight * (texel[3] / 255.0f);
+                        }
+                    }
+
+                    uint8_t* out = dst + (static_cast<size_t>(y) * dstWidth + x) * 4;
+                    for (int c = 0; c < 3; c++)
+                    {
+                        out[c] = static_cast<uint8_t>(linearToSrgb(std::min(std::max(acc[c], 0.0f), 1.0f)) * 255.0f + 0.5f);
+                    }
+                    out[3] = static_cast<uint8_t>(std::min(std::max(acc[3], 0.0f), 1.0f) * 255.0f + 0.5f);
+                }
+            }
+        }
+
+        std::vector<VKImageRGBA8> generateMipLevels(const uint8_t* pixels, uint32_t width, uint32_t height, VKMipFilter filter, job::VKJobSystem* jobSystem)
+        {
+            VK_TRACE_SCOPE("generateMipLevels");
+
+            const uint32_t mipLevels = static_cast<uint32_t>(std::floor(std::log2(std::max(width, height)))) + 1;
+
+            std::vector<VKImageRGBA8> levels(mipLevels - 1);
+            std::vector<float> current(static_cast<size_t>(width) * height * 4);
+            std::vector<float> next;
+
+            decodeRGBA8(pixels, width, height, current.data(), jobSystem);
+
+            uint32_t currentWidth = width;
+            uint32_t currentHeight = height;
+            for (VKImageRGBA8& level : levels)
+            {
+                level.width = std::max(1u, currentWidth / 2);
+                level.height = std::max(1u, currentHeight / 2);
+                level.pixels.resize(static_cast<size_t>(level.width) * level.height * 4);
+                next.resize(level.pixels.size());
+
+                downsampleLinear(current.data(), currentWidth, currentHeight, next.data(), filter, jobSystem);
+                encodeRGBA8(next.data(), level.width, level.height, level.pixels.data(), jobSystem);
+
+                current.swap(next);
+                currentWidth = level.width;
+                currentHeight = level.height;
+            }
+
+            return levels;
+        }
+    }
+}
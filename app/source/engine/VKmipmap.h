@@ -0,0 +1,44 @@
+﻿#ifndef INCLUDE_VULKANMIPMAP_H_
+#define INCLUDE_VULKANMIPMAP_H_
+
+#include "../_common.h"
+#include "VKjobSystem.h"
+
+namespace vkengine {
+    namespace asset {
+
+        constexpr float MIP_KAISER_ALPHA = 4.0f;                // 창의 모양 -> 클수록 링잉이 줄고 흐려집니다.
+        constexpr float MIP_KAISER_RADIUS = 1.5f;               // 필터 반경 (다음 mip 텍셀 단위)
+        constexpr uint32_t MIP_KAISER_TAPS = 6;                 // 반경 1.5 -> 원본 텍셀 6개
+
+        // 다음 mip을 만드는 필터
+        enum class VKMipFilter {
+            Box,                                                // 2x2 평균 (vkCmdBlitImage의 선형 필터와 같음)
+            Kaiser,                                             // Kaiser 창을 씌운 sinc (더 선명함, 변환 도구 기본값)
+        };
+
+        // RGBA8 이미지 한 장 (빈틈 없는 행, sRGB)
+        struct VKImageRGBA8 {
+            uint32_t width = 0;
+            uint32_t height = 0;
+            std::vector<uint8_t> pixels;
+        };
+
+        // 컴파일된 SIMD 경로 ("avx2", "sse2", "neon", "scalar")
+        const char* getMipSimdName();
+
+        // src의 다음 mip (max(1, 크기 / 2))을 dst에 만듭니다.
+        // sRGB를 선형 float로 바꿔 분리 가능한 필터(세로 -> 가로)를 SIMD로 적용하고 다시 sRGB로 바꿉니다. 알파는 선형 그대로
+        // 가장자리 밖의 텍셀은 가장자리 텍셀을 반복합니다. jobSystem이 있으면 출력 행을 나눠 병렬로 처리합니다.
+        void downsampleRGBA8(const uint8_t* src, uint32_t srcWidth, uint32_t srcHeight, uint8_t* dst, VKMipFilter filter, job::VKJobSystem* jobSystem = nullptr);
+
+        // downsampleRGBA8과 같은 결과를 내는 스칼라 기준 구현 (벤치마크와 검증용, 텍셀마다 pow 사용)
+        void downsampleRGBA8Reference(const uint8_t* src, uint32_t srcWidth, uint32_t srcHeight, uint8_t* dst, VKMipFilter filter);
+
+        // mip 1부터 1x1까지 만듭니다. (mip 0은 pixels)
+        // 단계 사이에는 선형 float를 그대로 넘기므로 8비트 반올림 오차가 쌓이지 않습니다.
+        std::vector<VKImageRGBA8> generateMipLevels(const uint8_t* pixels, uint32_t width, uint32_t height, VKMipFilter filter, job::VKJobSystem* jobSystem = nullptr);
+    }
+}
+
+#endif // INCLUDE_VULKANMIPMAP_H_
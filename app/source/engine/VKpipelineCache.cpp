@@ -0,0 +1,197 @@
+﻿#include "VKpipelineCache.h"
+
+namespace vkengine {
+
+    void VKPipelineCache::create(VkDevice device, const VkPhysicalDeviceProperties& properties, const std::string& path)
+    {
+        this->VKdevice = device;
+        this->path = path;
+        this->stats = {};
+        this->startupStats = {};
+        this->reported = false;
+        this->storedColdMs = 0.0;
+        this->storedColdPipelineCount = 0;
+
+        std::vector<uint8_t> initialData;
+
+        std::ifstream file(path, std::ios::binary | std::ios::ate);
+        if (file.is_open()) {
+            const uint64_t fileSize = static_cast<uint64_t>(file.tellg());
+            file.seekg(0);
+
+            VKPipelineCacheFileHeader header{};
+            if (fileSize >= sizeof(header) && file.read(reinterpret_cast<char*>(&header), sizeof(header))) {
+                const bool valid =
+                    header.magic == PIPELINE_CACHE_FILE_MAGIC &&
+                    header.version == PIPELINE_CACHE_FILE_VERSION &&
+                    header.dataSize == fileSize - sizeof(header);
+
+                if (valid) {
+                    initialData.resize(static_cast<size_t>(header.dataSize));
+                    if (!file.read(reinterpret_cast<char*>(initialData.data()), static_cast<std::streamsize>(initialData.size())) ||
+                        !validateHeader(initialData.data(), initialData.size(), properties)) {
+                        initialData.clear();
+                    }
+                    else {
+                        this->storedColdMs = header.coldCreationMs;
+                        this->storedColdPipelineCount = header.coldPipelineCount;
+                    }
+                }
+            }
+
+#ifdef DEBUG_
+            if (initialData.empty()) {
+                printf("[pipeline cache] stale or invalid cache: %s\n", path.c_str());
+            }
+#endif // DEBUG_
+        }
+
+        VkPipelineCacheCreateInfo pipelineCacheCreateInfo{};
+        pipelineCacheCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+        pipelineCacheCreateInfo.initialDataSize = initialData.size();
+        pipelineCacheCreateInfo.pInitialData = initialData.empty() ? nullptr : initialData.data();
+
+        VkResult result = vkCreatePipelineCache(this->VKdevice, &pipelineCacheCreateInfo, nullptr, &this->VKpipelineCache);
+
+        // 드라이버가 데이터를 거부하면 빈 캐시로 다시 만듭니다.
+        if (result != VK_SUCCESS && !initialData.empty()) {
+            initialData.clear();
+            pipelineCacheCreateInfo.initialDataSize = 0;
+            pipelineCacheCreateInfo.pInitialData = nullptr;
+            result = vkCreatePipelineCache(this->VKdevice, &pipelineCacheCreateInfo, nullptr, &this->VKpipelineCache);
+        }
+        VK_CHECK_RESULT(result);
+
+        this->stats.warm = !initialData.empty();
+        this->stats.loadedBytes = initialData.size();
+    }
+
+    VkResult VKPipelineCache::createGraphicsPipelines(uint32_t count, const VkGraphicsPipelineCreateInfo* createInfos, VkPipeline* pipelines)
+    {
+        auto start = std::chrono::high_resolution_clock::now();
+        VkResult result = vkCreateGraphicsPipelines(this->VKdevice, this->VKpipelineCache, count, createInfos, nullptr, pipelines);
+        auto end = std::chrono::high_resolution_clock::now();
+
+        std::lock_guard<std::mutex> lock(this->statsMutex);
+        this->stats.creationMs += std::chrono::duration<double, std::milli>(end - start).count();
+        this->stats.pipelineCount += count;
+
+        return result;
+    }
+
+    void VKPipelineCache::report()
+    {
+        std::lock_guard<std::mutex> lock(this->statsMutex);
+        this->startupStats = this->stats;
+        this->reported = true;
+
+        if (this->stats.warm && this->storedColdPipelineCount > 0) {
+            printf("[pipeline cache] warm (%llu bytes): %u pipelines in %.3f ms, cold %u pipelines in %.3f ms (%.1fx)\n",
+                static_cast<unsigned long long>(this->stats.loadedBytes),
+                this->stats.pipelineCount, this->stats.creationMs,
+                this->storedColdPipelineCount, this->storedColdMs,
+                this->storedColdMs / std::max(this->stats.creationMs, 1.0e-3));
+        }
+        else {
+            printf("[pipeline cache] %s: %u pipelines in %.3f ms\n",
+                this->stats.warm ? "warm" : "cold", this->stats.pipelineCount, this->stats.creationMs);
+        }
+    }
+
+    bool VKPipelineCache::save() const
+    {
+        if (this->VKpipelineCache == VK_NULL_HANDLE || this->path.empty()) {
+            return false;
+        }
+
+        size_t dataSize = 0;
+        if (vkGetPipelineCacheData(this->VKdevice, this->VKpipelineCache, &dataSize, nullptr) != VK_SUCCESS || dataSize == 0) {
+            return false;
+        }
+
+        std::vector<uint8_t> data(dataSize);
+        if (vkGetPipelineCacheData(this->VKdevice, this->VKpipelineCache, &dataSize, data.data()) != VK_SUCCESS) {
+            return false;
+        }
+        data.resize(dataSize);
+
+        // 콜드 실행이면 이번 시작 시간을, 웜 실행이면 기록된 콜드 시간을 그대로 남깁니다.
+        std::unique_lock<std::mutex> lock(this->statsMutex);
+        const VKPipelineCacheStats& startup = this->reported ? this->startupStats : this->stats;
+
+        VKPipelineCacheFileHeader header{};
+        header.magic = PIPELINE_CACHE_FILE_MAGIC;
+        header.version = PIPELINE_CACHE_FILE_VERSION;
+        header.dataSize = dataSize;
+        header.coldCreationMs = this->stats.warm ? this->storedColdMs : startup.creationMs;
+        header.coldPipelineCount = this->stats.warm ? this->storedColdPipelineCount : startup.pipelineCount;
+        lock.unlock();
+
+        const std::string tempPath = this->path + ".tmp";
+        {
+            std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+            if (!file.is_open()) {
+                return false;
+            }
+
+            file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+            file.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size()));
+
+            if (!file.good()) {
+                file.close();
+                std::remove(tempPath.c_str());
+                return false;
+            }
+        }
+
+        std::remove(this->path.c_str());
+        if (std::rename(tempPath.c_str(), this->path.c_str()) != 0) {
+            std::remove(tempPath.c_str());
+            return false;
+        }
+
+#ifdef DEBUG_
+        printf("[pipeline cache] wrote %s (%zu bytes)\n", this->path.c_str(), dataSize);
+#endif // DEBUG_
+
+        return true;
+    }
+
+    void VKPipelineCache::cleanup()
+    {
+        if (this->VKpipelineCache == VK_NULL_HANDLE) {
+            return;
+        }
+
+        this->save();
+
+        vkDestroyPipelineCache(this->VKdevice, this->VKpipelineCache, nullptr);
+        this->VKpipelineCache = VK_NULL_HANDLE;
+        this->VKdevice = VK_NULL_HANDLE;
+    }
+
+    bool VKPipelineCache::validateHeader(const uint8_t* data, size_t size, const VkPhysicalDeviceProperties& properties)
+    {
+        // VkPipelineCacheHeaderVersionOne -> 패딩 없는 32바이트 (Vulkan 명세)
+        constexpr size_t HEADER_SIZE = 16 + VK_UUID_SIZE;
+        if (data == nullptr || size < HEADER_SIZE) {
+            return false;
+        }
+
+        uint32_t headerSize = 0;
+        uint32_t headerVersion = 0;
+        uint32_t vendorID = 0;
+        uint32_t deviceID = 0;
+        memcpy(&headerSize, data + 0, sizeof(uint32_t));
+        memcpy(&headerVersion, data + 4, sizeof(uint32_t));
+        memcpy(&vendorID, data + 8, sizeof(uint32_t));
+        memcpy(&deviceID, data + 12, sizeof(uint32_t));
+
+        return headerSize >= HEADER_SIZE &&
+            headerSize <= size &&
+            headerVersion == VK_PIPELINE_CACHE_HEADER_VERSION_ONE &&
+            vendorID == properties.vendorID &&
+            deviceID == properties.deviceID &&
+            memcmp(data + 16, properties.pipelineCacheUUID, VK_UUID_SIZE) == 0;
+    }
+}
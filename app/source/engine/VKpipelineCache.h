@@ -0,0 +1,78 @@
+﻿#ifndef INCLUDE_VULKANPIPELINECACHE_H_
+#define INCLUDE_VULKANPIPELINECACHE_H_
+
+#include "../_common.h"
+
+#include <mutex>
+
+namespace vkengine {
+
+    constexpr const char* PIPELINE_CACHE_FILE = "pipeline.cache";  // 실행 경로(RootPath) 기준
+    constexpr uint32_t PIPELINE_CACHE_FILE_MAGIC = 0x43504B56;      // "VKPC"
+    constexpr uint32_t PIPELINE_CACHE_FILE_VERSION = 1;
+
+    // 캐시 파일 헤더 -> 뒤에 vkGetPipelineCacheData 결과가 그대로 이어집니다.
+    // 드라이버 데이터 앞에 콜드 실행의 파이프라인 생성 시간을 기록해 두고 웜 실행과 비교합니다.
+    struct VKPipelineCacheFileHeader {
+        uint32_t magic;
+        uint32_t version;
+        uint64_t dataSize;
+        double coldCreationMs;                                  // 캐시 없이 시작했을 때 시작 시 파이프라인 생성 시간
+        uint32_t coldPipelineCount;
+        uint32_t reserved;
+    };
+
+    struct VKPipelineCacheStats {
+        bool warm = false;                                      // 저장된 캐시로 시작했는지
+        uint64_t loadedBytes = 0;
+        uint32_t pipelineCount = 0;                             // 캐시를 거쳐 만든 파이프라인 수
+        double creationMs = 0.0;                                // 파이프라인 생성에 걸린 시간 합
+    };
+
+    // 디스크에 저장되는 파이프라인 캐시
+    // 종료할 때 캐시 내용을 파일로 저장하고, 다음 실행에서 같은 장치이면 초기 데이터로 불러옵니다.
+    class VKPipelineCache {
+    public:
+        VKPipelineCache() = default;
+
+        VKPipelineCache(const VKPipelineCache&) = delete;
+        VKPipelineCache& operator=(const VKPipelineCache&) = delete;
+
+        // 캐시 파일을 읽어 파이프라인 캐시를 만듭니다.
+        // 파일이 없거나 헤더(vendorID, deviceID, pipelineCacheUUID)가 장치와 다르면 빈 캐시로 시작합니다.
+        void create(VkDevice device, const VkPhysicalDeviceProperties& properties, const std::string& path);
+
+        // 모든 그래픽스 파이프라인은 이 함수로 만듭니다. -> 캐시를 사용하고 생성 시간을 잽니다.
+        // 파이프라인 관리자의 컴파일 스레드에서 동시에 불러도 됩니다. (VkPipelineCache는 드라이버가 동기화)
+        VkResult createGraphicsPipelines(uint32_t count, const VkGraphicsPipelineCreateInfo* createInfos, VkPipeline* pipelines);
+
+        // 시작 시 파이프라인 생성 시간을 출력합니다. (웜 실행이면 기록된 콜드 실행 시간과 비교)
+        void report();
+
+        // 캐시 내용을 파일로 저장합니다. (임시 파일에 쓴 뒤 교체)
+        bool save() const;
+
+        // 저장한 뒤 파이프라인 캐시를 해제합니다.
+        void cleanup();
+
+        VkPipelineCache getHandle() const { return this->VKpipelineCache; }
+        VKPipelineCacheStats getStats() const { std::lock_guard<std::mutex> lock(this->statsMutex); return this->stats; }
+
+        // vkGetPipelineCacheData 헤더가 이 장치에서 만든 캐시인지 확인합니다.
+        static bool validateHeader(const uint8_t* data, size_t size, const VkPhysicalDeviceProperties& properties);
+
+    private:
+        VkDevice VKdevice = VK_NULL_HANDLE;
+        VkPipelineCache VKpipelineCache = VK_NULL_HANDLE;
+        std::string path;
+
+        mutable std::mutex statsMutex;                          // 컴파일 스레드가 동시에 통계를 갱신
+        VKPipelineCacheStats stats;
+        VKPipelineCacheStats startupStats;                      // report() 시점의 통계 -> 콜드 실행이면 파일에 기록
+        bool reported = false;
+        double storedColdMs = 0.0;                              // 파일에 기록된 콜드 실행 시간
+        uint32_t storedColdPipelineCount = 0;
+    };
+}
+
+#endif // INCLUDE_VULKANPIPELINECACHE_H_
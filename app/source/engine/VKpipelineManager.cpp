@@ -0,0 +1,512 @@
+﻿#include "VKpipelineManager.h"
+#include "VKtrace.h"
+
+namespace vkengine {
+
+    namespace {
+        constexpr uint64_t FNV_OFFSET = 0xcbf29ce484222325ull;
+        constexpr uint64_t FNV_PRIME = 0x100000001b3ull;
+
+        // 필드 하나씩 FNV-1a로 섞습니다. -> 구조체 패딩이 해시에 들어가지 않도록
+        template<typename T>
+        void hashValue(uint64_t& hash, const T& value)
+        {
+            const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&value);
+            for (size_t i = 0; i < sizeof(T); i++) {
+                hash = (hash ^ bytes[i]) * FNV_PRIME;
+            }
+        }
+    }
+
+    uint64_t VKGraphicsPipelineDesc::hash() const
+    {
+        uint64_t hash = FNV_OFFSET;
+
+        hashValue(hash, this->vertexShader);
+        hashValue(hash, this->fragmentShader);
+
+        hashValue(hash, static_cast<uint32_t>(this->vertexBindings.size()));
+        for (const VkVertexInputBindingDescription& binding : this->vertexBindings) {
+            hashValue(hash, binding.binding);
+            hashValue(hash, binding.stride);
+            hashValue(hash, binding.inputRate);
+        }
+
+        hashValue(hash, static_cast<uint32_t>(this->vertexAttributes.size()));
+        for (const VkVertexInputAttributeDescription& attribute : this->vertexAttributes) {
+            hashValue(hash, attribute.location);
+            hashValue(hash, attribute.binding);
+            hashValue(hash, attribute.format);
+            hashValue(hash, attribute.offset);
+        }
+
+        hashValue(hash, this->topology);
+        hashValue(hash, this->polygonMode);
+        hashValue(hash, this->cullMode);
+        hashValue(hash, this->frontFace);
+        hashValue(hash, this->samples);
+        hashValue(hash, this->sampleShadingEnable);
+        hashValue(hash, this->minSampleShading);
+        hashValue(hash, this->depthTestEnable);
+        hashValue(hash, this->depthWriteEnable);
+        hashValue(hash, this->depthCompareOp);
+        hashValue(hash, this->blendEnable);
+        hashValue(hash, this->srcColorBlendFactor);
+        hashValue(hash, this->dstColorBlendFactor);
+        hashValue(hash, this->colorBlendOp);
+        hashValue(hash, this->srcAlphaBlendFactor);
+        hashValue(hash, this->dstAlphaBlendFactor);
+        hashValue(hash, this->alphaBlendOp);
+        hashValue(hash, this->layout);
+        hashValue(hash, this->renderPass);
+        hashValue(hash, this->subpass);
+
+        return hash;
+    }
+
+    bool VKGraphicsPipelineDesc::operator==(const VKGraphicsPipelineDesc& other) const
+    {
+        if (this->vertexBindings.size() != other.vertexBindings.size() ||
+            this->vertexAttributes.size() != other.vertexAttributes.size()) {
+            return false;
+        }
+
+        for (size_t i = 0; i < this->vertexBindings.size(); i++) {
+            const VkVertexInputBindingDescription& a = this->vertexBindings[i];
+            const VkVertexInputBindingDescription& b = other.vertexBindings[i];
+            if (a.binding != b.binding || a.stride != b.stride || a.inputRate != b.inputRate) {
+                return false;
+            }
+        }
+
+        for (size_t i = 0; i < this->vertexAttributes.size(); i++) {
+            const VkVertexInputAttributeDescription& a = this->vertexAttributes[i];
+            const VkVertexInputAttributeDescription& b = other.vertexAttributes[i];
+            if (a.location != b.location || a.binding != b.binding || a.format != b.format || a.offset != b.offset) {
+                return false;
+            }
+        }
+
+        return this->vertexShader == other.vertexShader &&
+            this->fragmentShader == other.fragmentShader &&
+            this->topology == other.topology &&
+            this->polygonMode == other.polygonMode &&
+            this->cullMode == other.cullMode &&
+            this->frontFace == other.frontFace &&
+            this->samples == other.samples &&
+            this->sampleShadingEnable == other.sampleShadingEnable &&
+            this->minSampleShading == other.minSampleShading &&
+            this->depthTestEnable == other.depthTestEnable &&
+            this->depthWriteEnable == other.depthWriteEnable &&
+            this->depthCompareOp == other.depthCompareOp &&
+            this->blendEnable == other.blendEnable &&
+            this->srcColorBlendFactor == other.srcColorBlendFactor &&
+            this->dstColorBlendFactor == other.dstColorBlendFactor &&
+            this->colorBlendOp == other.colorBlendOp &&
+            this->srcAlphaBlendFactor == other.srcAlphaBlendFactor &&
+            this->dstAlphaBlendFactor == other.dstAlphaBlendFactor &&
+            this->alphaBlendOp == other.alphaBlendOp &&
+            this->layout == other.layout &&
+            this->renderPass == other.renderPass &&
+            this->subpass == other.subpass;
+    }
+
+    VKPipelineManager::VKPipelineManager(VkDevice device, VKPipelineCache& pipelineCache, uint32_t compileThreadCount)
+        : shaderLibrary(device)
+    {
+        this->VKdevice = device;
+        this->VKpipelineCache = &pipelineCache;
+
+        if (compileThreadCount == 0) {
+            compileThreadCount = PIPELINE_COMPILE_THREADS;
+        }
+
+        this->workers.reserve(compileThreadCount);
+        for (uint32_t i = 0; i < compileThreadCount; i++) {
+            this->workers.emplace_back(&VKPipelineManager::workerLoop, this);
+        }
+
+#ifdef DEBUG_
+        printf("[pipeline manager] %u compile threads\n", compileThreadCount);
+#endif // DEBUG_
+    }
+
+    VKPipelineManager::~VKPipelineManager()
+    {
+        this->cleanup();
+    }
+
+    VKPipelineHandle VKPipelineManager::request(const VKGraphicsPipelineDesc& desc)
+    {
+        const uint64_t hash = desc.hash();
+
+        std::lock_guard<std::mutex> lock(this->mutex);
+
+        auto range = this->lookup.equal_range(hash);
+        for (auto it = range.first; it != range.second; ++it) {
+            if (it->second->desc == desc) {
+                return VKPipelineHandle(it->second);
+            }
+        }
+
+        auto entry = std::make_unique<VKPipelineEntry>();
+        entry->desc = desc;
+        entry->hash = hash;
+
+        VKPipelineEntry* raw = entry.get();
+        this->entries.push_back(std::move(entry));
+        this->lookup.emplace(hash, raw);
+        this->enqueue(raw);
+
+        return VKPipelineHandle(raw);
+    }
+
+    void VKPipelineManager::enqueue(VKPipelineEntry* entry)
+    {
+        // 이미 큐에 있으면 꺼낼 때 최신 desc로 컴파일하므로 다시 넣지 않습니다.
+        if (entry->queued) {
+            return;
+        }
+
+        entry->queued = true;
+        this->queue.push_back(entry);
+        this->pendingCount++;
+
+        this->queueCondition.notify_one();
+    }
+
+    uint32_t VKPipelineManager::update()
+    {
+        this->frameIndex.fetch_add(1);
+        this->destroyRetired(false);
+
+        std::vector<VKShaderReload> reloads;
+        if (this->shaderLibrary.reloadChanged(reloads) == 0) {
+            return 0;
+        }
+
+        std::lock_guard<std::mutex> lock(this->mutex);
+
+        uint32_t rebuildCount = 0;
+        for (const auto& entry : this->entries) {
+            VKGraphicsPipelineDesc& desc = entry->desc;
+            bool dependent = false;
+
+            for (const VKShaderReload& reload : reloads) {
+                if (desc.vertexShader == reload.oldModule) {
+                    desc.vertexShader = reload.newModule;
+                    dependent = true;
+                }
+                if (desc.fragmentShader == reload.oldModule) {
+                    desc.fragmentShader = reload.newModule;
+                    dependent = true;
+                }
+            }
+
+            if (!dependent) {
+                continue;
+            }
+
+            // 새 모듈로 해시가 바뀌므로 조회 테이블을 고칩니다.
+            auto range = this->lookup.equal_range(entry->hash);
+            for (auto it = range.first; it != range.second; ++it) {
+                if (it->second == entry.get()) {
+                    this->lookup.erase(it);
+                    break;
+                }
+            }
+            entry->hash = desc.hash();
+            entry->generation++;
+            this->lookup.emplace(entry->hash, entry.get());
+
+            this->enqueue(entry.get());
+            rebuildCount++;
+        }
+
+#ifdef DEBUG_
+        printf("[pipeline manager] %zu shaders changed -> rebuilding %u pipelines\n", reloads.size(), rebuildCount);
+#endif // DEBUG_
+
+        return rebuildCount;
+    }
+
+    void VKPipelineManager::destroyRetired(bool all)
+    {
+        std::vector<VkPipeline> expired;
+        {
+            std::lock_guard<std::mutex> lock(this->mutex);
+
+            // 교체된 프레임 이후 MAX_FRAMES_IN_FLIGHT 프레임의 펜스를 기다렸으면 GPU가 더 이상 쓰지 않습니다.
+            const uint64_t currentFrame = this->frameIndex.load();
+            auto it = this->retiredPipelines.begin();
+            while (it != this->retiredPipelines.end()) {
+                if (all || currentFrame >= it->second + MAX_FRAMES_IN_FLIGHT) {
+                    expired.push_back(it->first);
+                    it = this->retiredPipelines.erase(it);
+                }
+                else {
+                    ++it;
+                }
+            }
+        }
+
+        for (VkPipeline pipeline : expired) {
+            vkDestroyPipeline(this->VKdevice, pipeline, nullptr);
+        }
+    }
+
+    VkPipeline VKPipelineManager::wait(const VKPipelineHandle& handle)
+    {
+        if (!handle.isValid()) {
+            throw std::runtime_error("failed to create graphics pipeline!");
+        }
+
+        VKPipelineEntry* entry = handle.entry;
+        if (!entry->done.load(std::memory_order_acquire)) {
+            std::unique_lock<std::mutex> lock(this->mutex);
+            this->doneCondition.wait(lock, [entry] { return entry->done.load(std::memory_order_acquire); });
+        }
+
+        if (entry->result != VK_SUCCESS) {
+            throw std::runtime_error("failed to create graphics pipeline!");
+        }
+
+        return entry->pipeline.load(std::memory_order_acquire);
+    }
+
+    void VKPipelineManager::waitIdle()
+    {
+        std::vector<VKPipelineEntry*> requested;
+        {
+            std::unique_lock<std::mutex> lock(this->mutex);
+            this->doneCondition.wait(lock, [this] { return this->pendingCount == 0; });
+
+            requested.reserve(this->entries.size());
+            for (const auto& entry : this->entries) {
+                requested.push_back(entry.get());
+            }
+        }
+
+        for (VKPipelineEntry* entry : requested) {
+            if (entry->result != VK_SUCCESS) {
+                throw std::runtime_error("failed to create graphics pipeline!");
+            }
+        }
+    }
+
+    uint32_t VKPipelineManager::getPipelineCount() const
+    {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        return static_cast<uint32_t>(this->entries.size());
+    }
+
+    uint32_t VKPipelineManager::getPendingCount() const
+    {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        return this->pendingCount;
+    }
+
+    void VKPipelineManager::cleanup()
+    {
+        {
+            std::lock_guard<std::mutex> lock(this->mutex);
+            this->stopping = true;
+        }
+        this->queueCondition.notify_all();
+
+        for (std::thread& worker : this->workers) {
+            if (worker.joinable()) {
+                worker.join();
+            }
+        }
+        this->workers.clear();
+
+        if (this->VKdevice == VK_NULL_HANDLE) {
+            return;
+        }
+
+        this->destroyRetired(true);
+
+        for (const auto& entry : this->entries) {
+            VkPipeline pipeline = entry->pipeline.exchange(VK_NULL_HANDLE);
+            if (pipeline != VK_NULL_HANDLE) {
+                vkDestroyPipeline(this->VKdevice, pipeline, nullptr);
+            }
+        }
+        this->entries.clear();
+        this->lookup.clear();
+        this->queue.clear();
+        this->pendingCount = 0;
+
+        this->shaderLibrary.cleanup();
+
+        this->VKdevice = VK_NULL_HANDLE;
+    }
+
+    void VKPipelineManager::workerLoop()
+    {
+        VK_TRACE_THREAD_NAME("pipeline compile");
+
+        while (true) {
+            VKPipelineEntry* entry = nullptr;
+            VKGraphicsPipelineDesc desc;
+            uint32_t generation = 0;
+            {
+                std::unique_lock<std::mutex> lock(this->mutex);
+                this->queueCondition.wait(lock, [this] { return this->stopping || !this->queue.empty(); });
+
+                if (this->stopping) {
+                    return;
+                }
+
+                entry = this->queue.front();
+                this->queue.pop_front();
+                entry->queued = false;
+
+                // 컴파일하는 동안 update()가 desc를 바꿀 수 있으므로 복사해 둡니다.
+                desc = entry->desc;
+                generation = entry->generation;
+            }
+
+            VkPipeline pipeline = VK_NULL_HANDLE;
+            const VkResult result = this->compile(desc, pipeline);
+
+            VkPipeline discarded = VK_NULL_HANDLE;
+            {
+                std::lock_guard<std::mutex> lock(this->mutex);
+
+                if (result != VK_SUCCESS) {
+                    // 다시 컴파일하다 실패하면 이전 파이프라인을 계속 씁니다.
+                    if (!entry->done.load()) {
+                        entry->result = result;
+                    }
+#ifdef DEBUG_
+                    printf("[pipeline manager] failed to compile pipeline %016llx (%d)\n",
+                        static_cast<unsigned long long>(entry->hash), static_cast<int>(result));
+#endif // DEBUG_
+                }
+                else if (generation != entry->generation) {
+                    // 컴파일하는 동안 셰이더가 또 바뀌었습니다. -> 큐에 다시 들어가 있으므로 이 결과는 버립니다.
+                    discarded = pipeline;
+                }
+                else {
+                    entry->result = VK_SUCCESS;
+                    VkPipeline previous = entry->pipeline.exchange(pipeline, std::memory_order_acq_rel);
+                    if (previous != VK_NULL_HANDLE) {
+                        this->retiredPipelines.emplace_back(previous, this->frameIndex.load());
+                    }
+                }
+
+                if (discarded == VK_NULL_HANDLE) {
+                    entry->done.store(true, std::memory_order_release);
+                }
+                this->pendingCount--;
+            }
+            this->doneCondition.notify_all();
+
+            if (discarded != VK_NULL_HANDLE) {
+                vkDestroyPipeline(this->VKdevice, discarded, nullptr);
+            }
+        }
+    }
+
+    VkResult VKPipelineManager::compile(const VKGraphicsPipelineDesc& desc, VkPipeline& pipeline)
+    {
+        VK_TRACE_SCOPE("pipeline compile");
+
+        VkPipelineShaderStageCreateInfo shaderStages[2]{};
+        shaderStages[0].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+        shaderStages[0].stage = VK_SHADER_STAGE_VERTEX_BIT;
+        shaderStages[0].module = desc.vertexShader;
+        shaderStages[0].pName = "main";
+
+        shaderStages[1].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+        shaderStages[1].stage = VK_SHADER_STAGE_FRAGMENT_BIT;
+        shaderStages[1].module = desc.fragmentShader;
+        shaderStages[1].pName = "main";
+
+        VkPipelineVertexInputStateCreateInfo vertexInputInfo{};
+        vertexInputInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
+        vertexInputInfo.vertexBindingDescriptionCount = static_cast<uint32_t>(desc.vertexBindings.size());
+        vertexInputInfo.pVertexBindingDescriptions = desc.vertexBindings.data();
+        vertexInputInfo.vertexAttributeDescriptionCount = static_cast<uint32_t>(desc.vertexAttributes.size());
+        vertexInputInfo.pVertexAttributeDescriptions = desc.vertexAttributes.data();
+
+        VkPipelineInputAssemblyStateCreateInfo inputAssembly{};
+        inputAssembly.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
+        inputAssembly.topology = desc.topology;
+        inputAssembly.primitiveRestartEnable = VK_FALSE;
+
+        VkPipelineViewportStateCreateInfo viewportState{};
+        viewportState.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
+        viewportState.viewportCount = 1;
+        viewportState.scissorCount = 1;
+
+        VkPipelineRasterizationStateCreateInfo rasterizer{};
+        rasterizer.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
+        rasterizer.depthClampEnable = VK_FALSE;
+        rasterizer.rasterizerDiscardEnable = VK_FALSE;
+        rasterizer.polygonMode = desc.polygonMode;
+        rasterizer.lineWidth = 1.0f;
+        rasterizer.cullMode = desc.cullMode;
+        rasterizer.frontFace = desc.frontFace;
+        rasterizer.depthBiasEnable = VK_FALSE;
+
+        VkPipelineMultisampleStateCreateInfo multisampling{};
+        multisampling.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
+        multisampling.rasterizationSamples = desc.samples;
+        multisampling.sampleShadingEnable = desc.sampleShadingEnable;
+        multisampling.minSampleShading = desc.minSampleShading;
+
+        VkPipelineDepthStencilStateCreateInfo depthStencil{};
+        depthStencil.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
+        depthStencil.depthTestEnable = desc.depthTestEnable;
+        depthStencil.depthWriteEnable = desc.depthWriteEnable;
+        depthStencil.depthCompareOp = desc.depthCompareOp;
+        depthStencil.depthBoundsTestEnable = VK_FALSE;
+        depthStencil.minDepthBounds = 0.0f;
+        depthStencil.maxDepthBounds = 1.0f;
+        depthStencil.stencilTestEnable = VK_FALSE;
+
+        VkPipelineColorBlendAttachmentState colorBlendAttachment{};
+        colorBlendAttachment.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
+        colorBlendAttachment.blendEnable = desc.blendEnable;
+        colorBlendAttachment.srcColorBlendFactor = desc.srcColorBlendFactor;
+        colorBlendAttachment.dstColorBlendFactor = desc.dstColorBlendFactor;
+        colorBlendAttachment.colorBlendOp = desc.colorBlendOp;
+        colorBlendAttachment.srcAlphaBlendFactor = desc.srcAlphaBlendFactor;
+        colorBlendAttachment.dstAlphaBlendFactor = desc.dstAlphaBlendFactor;
+        colorBlendAttachment.alphaBlendOp = desc.alphaBlendOp;
+
+        VkPipelineColorBlendStateCreateInfo colorBlending{};
+        colorBlending.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
+        colorBlending.logicOpEnable = VK_FALSE;
+        colorBlending.logicOp = VK_LOGIC_OP_COPY;
+        colorBlending.attachmentCount = 1;
+        colorBlending.pAttachments = &colorBlendAttachment;
+
+        VkPipelineDynamicStateCreateInfo dynamicState{};
+        dynamicState.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
+        dynamicState.dynamicStateCount = static_cast<uint32_t>(dynamicStates.size());
+        dynamicState.pDynamicStates = dynamicStates.data();
+
+        VkGraphicsPipelineCreateInfo pipelineInfo{};
+        pipelineInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+        pipelineInfo.stageCount = 2;
+        pipelineInfo.pStages = shaderStages;
+        pipelineInfo.pVertexInputState = &vertexInputInfo;
+        pipelineInfo.pInputAssemblyState = &inputAssembly;
+        pipelineInfo.pViewportState = &viewportState;
+        pipelineInfo.pRasterizationState = &rasterizer;
+        pipelineInfo.pMultisampleState = &multisampling;
+        pipelineInfo.pDepthStencilState = &depthStencil;
+        pipelineInfo.pColorBlendState = &colorBlending;
+        pipelineInfo.pDynamicState = &dynamicState;
+        pipelineInfo.layout = desc.layout;
+        pipelineInfo.renderPass = desc.renderPass;
+        pipelineInfo.subpass = desc.subpass;
+        pipelineInfo.basePipelineHandle = VK_NULL_HANDLE;
+
+        return this->VKpipelineCache->createGraphicsPipelines(1, &pipelineInfo, &pipeline);
+    }
+}
@@ -0,0 +1,157 @@
+﻿#ifndef INCLUDE_VULKANPIPELINEMANAGER_H_
+#define INCLUDE_VULKANPIPELINEMANAGER_H_
+
+#include "../_common.h"
+#include "VKpipelineCache.h"
+#include "VKshaderLibrary.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+namespace vkengine {
+
+    constexpr uint32_t PIPELINE_COMPILE_THREADS = 2;            // 백그라운드 컴파일 스레드 수 (0이면 이 값을 사용)
+
+    // 그래픽스 파이프라인 상태 요약 -> 해시해서 같은 상태의 파이프라인은 한 번만 만듭니다.
+    // 뷰포트/시저는 항상 다이나믹 상태(dynamicStates)이므로 스왑 체인 크기와 무관합니다.
+    struct VKGraphicsPipelineDesc {
+        VkShaderModule vertexShader = VK_NULL_HANDLE;
+        VkShaderModule fragmentShader = VK_NULL_HANDLE;
+
+        std::vector<VkVertexInputBindingDescription> vertexBindings;
+        std::vector<VkVertexInputAttributeDescription> vertexAttributes;
+        VkPrimitiveTopology topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+
+        VkPolygonMode polygonMode = VK_POLYGON_MODE_FILL;
+        VkCullModeFlags cullMode = VK_CULL_MODE_BACK_BIT;
+        VkFrontFace frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE;
+
+        VkSampleCountFlagBits samples = VK_SAMPLE_COUNT_1_BIT;
+        VkBool32 sampleShadingEnable = VK_FALSE;
+        float minSampleShading = 1.0f;
+
+        VkBool32 depthTestEnable = VK_TRUE;
+        VkBool32 depthWriteEnable = VK_TRUE;
+        VkCompareOp depthCompareOp = VK_COMPARE_OP_LESS;
+
+        VkBool32 blendEnable = VK_FALSE;
+        VkBlendFactor srcColorBlendFactor = VK_BLEND_FACTOR_ONE;
+        VkBlendFactor dstColorBlendFactor = VK_BLEND_FACTOR_ZERO;
+        VkBlendOp colorBlendOp = VK_BLEND_OP_ADD;
+        VkBlendFactor srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
+        VkBlendFactor dstAlphaBlendFactor = VK_BLEND_FACTOR_ZERO;
+        VkBlendOp alphaBlendOp = VK_BLEND_OP_ADD;
+
+        VkPipelineLayout layout = VK_NULL_HANDLE;
+        VkRenderPass renderPass = VK_NULL_HANDLE;
+        uint32_t subpass = 0;
+
+        // 버텍스 구조체의 getBindingDescription/getAttributeDescriptions로 입력 상태를 채웁니다.
+        template<typename VertexType>
+        void setVertexInput()
+        {
+            const auto attributes = VertexType::getAttributeDescriptions();
+            this->vertexBindings.assign(1, VertexType::getBindingDescription());
+            this->vertexAttributes.assign(attributes.begin(), attributes.end());
+        }
+
+        uint64_t hash() const;
+        bool operator==(const VKGraphicsPipelineDesc& other) const;
+    };
+
+    // 파이프라인 하나 -> 컴파일 스레드가 끝나면 pipeline을 채웁니다.
+    // 셰이더가 바뀌면 같은 항목을 다시 컴파일하고, 새 파이프라인이 준비될 때까지 이전 파이프라인을 그대로 씁니다.
+    struct VKPipelineEntry {
+        VKGraphicsPipelineDesc desc;                            // 관리자 mutex로 보호
+        uint64_t hash = 0;
+        uint32_t generation = 0;                                // desc가 바뀔 때마다 증가 -> 이전 desc로 컴파일한 결과를 버립니다.
+        bool queued = false;                                    // 컴파일 큐에 들어 있는지
+        std::atomic<VkPipeline> pipeline{ VK_NULL_HANDLE };
+        std::atomic<bool> done{ false };                         // 첫 컴파일이 끝났는지 (실패 포함)
+        VkResult result = VK_SUCCESS;
+    };
+
+    // 파이프라인 핸들 -> 준비되기 전에는 VK_NULL_HANDLE을 돌려주므로 프레임 루프는 기다리지 않고 건너뜁니다.
+    class VKPipelineHandle {
+    public:
+        VKPipelineHandle() = default;
+
+        VkPipeline get() const { return this->entry ? this->entry->pipeline.load(std::memory_order_acquire) : VK_NULL_HANDLE; }
+        bool isReady() const { return this->get() != VK_NULL_HANDLE; }
+        bool isValid() const { return this->entry != nullptr; }
+
+    private:
+        friend class VKPipelineManager;
+        explicit VKPipelineHandle(VKPipelineEntry* entry) : entry(entry) {}
+
+        VKPipelineEntry* entry = nullptr;
+    };
+
+    // 파이프라인 관리자
+    // 상태 요약(VKGraphicsPipelineDesc)으로 중복을 없애고, 없는 파이프라인은 백그라운드 스레드에서 컴파일합니다.
+    // 컴파일은 수십 ms가 걸릴 수 있어 잡 시스템 대신 전용 스레드를 씁니다. (프레임의 wait()가 긴 컴파일을 대신 실행하지 않도록)
+    // 모든 파이프라인은 VKPipelineCache를 거쳐 만들어집니다.
+    class VKPipelineManager {
+    public:
+        VKPipelineManager(VkDevice device, VKPipelineCache& pipelineCache, uint32_t compileThreadCount = 0);
+        ~VKPipelineManager();
+
+        VKPipelineManager(const VKPipelineManager&) = delete;
+        VKPipelineManager& operator=(const VKPipelineManager&) = delete;
+
+        // SPIR-V 파일에서 셰이더 모듈을 만듭니다. -> 셰이더 라이브러리가 경로와 내용 해시로 중복을 없애고 소유합니다.
+        VkShaderModule loadShaderModule(const std::string& path) { return this->shaderLibrary.load(path); }
+
+        // 불러온 셰이더의 디렉터리를 감시합니다. -> 바뀐 .spv는 update()에서 다시 불러옵니다.
+        bool watchShaders() { return this->shaderLibrary.watch(); }
+
+        // 프레임마다 펜스를 기다린 뒤 호출합니다.
+        // 바뀐 셰이더를 쓰는 파이프라인만 다시 컴파일하도록 큐에 넣고, 더 이상 쓰이지 않는 이전 파이프라인을 해제합니다.
+        uint32_t update();
+
+        // 같은 상태의 파이프라인이 있으면 그 핸들을, 없으면 컴파일 큐에 넣고 새 핸들을 돌려줍니다. (기다리지 않음)
+        VKPipelineHandle request(const VKGraphicsPipelineDesc& desc);
+
+        // 핸들이 준비될 때까지 기다립니다. 컴파일에 실패하면 예외
+        VkPipeline wait(const VKPipelineHandle& handle);
+
+        // 요청된 파이프라인이 모두 컴파일될 때까지 기다립니다. (시작 시)
+        void waitIdle();
+
+        uint32_t getPipelineCount() const;
+        uint32_t getPendingCount() const;
+
+        // 컴파일 스레드를 멈추고 파이프라인과 셰이더 모듈을 해제합니다.
+        void cleanup();
+
+    private:
+        void workerLoop();
+        VkResult compile(const VKGraphicsPipelineDesc& desc, VkPipeline& pipeline);
+        void enqueue(VKPipelineEntry* entry);
+        void destroyRetired(bool all);
+
+        VkDevice VKdevice = VK_NULL_HANDLE;
+        VKPipelineCache* VKpipelineCache = nullptr;
+
+        mutable std::mutex mutex;
+        std::condition_variable queueCondition;                 // 컴파일 큐에 항목이 들어옴
+        std::condition_variable doneCondition;                  // 컴파일이 하나 끝남
+        std::vector<std::unique_ptr<VKPipelineEntry>> entries;
+        std::unordered_multimap<uint64_t, VKPipelineEntry*> lookup;
+        std::deque<VKPipelineEntry*> queue;
+        uint32_t pendingCount = 0;
+        bool stopping = false;
+
+        // 다시 컴파일해서 교체된 파이프라인 -> MAX_FRAMES_IN_FLIGHT 프레임 뒤에 해제
+        std::vector<std::pair<VkPipeline, uint64_t>> retiredPipelines;
+        std::atomic<uint64_t> frameIndex{ 0 };
+
+        VKShaderLibrary shaderLibrary;
+        std::vector<std::thread> workers;
+    };
+}
+
+#endif // INCLUDE_VULKANPIPELINEMANAGER_H_
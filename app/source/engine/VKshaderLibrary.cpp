@@ -0,0 +1,334 @@
+﻿#include "VKshaderLibrary.h"
+#include "VKmeshCache.h"
+
+#ifndef _WIN32
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+namespace vkengine {
+
+    namespace {
+        // 경로를 디렉터리(구분자 포함)와 파일 이름으로 나눕니다.
+        void splitPath(const std::string& path, std::string& directory, std::string& fileName)
+        {
+            const size_t separator = path.find_last_of("/\\");
+            directory = (separator == std::string::npos) ? std::string() : path.substr(0, separator + 1);
+            fileName = (separator == std::string::npos) ? path : path.substr(separator + 1);
+        }
+
+        bool isSpirvFile(const std::string& fileName)
+        {
+            return fileName.size() > 4 && fileName.compare(fileName.size() - 4, 4, ".spv") == 0;
+        }
+    }
+
+    VKShaderLibrary::VKShaderLibrary(VkDevice device)
+    {
+        this->VKdevice = device;
+    }
+
+    VKShaderLibrary::~VKShaderLibrary()
+    {
+        this->cleanup();
+    }
+
+    VkShaderModule VKShaderLibrary::load(const std::string& path)
+    {
+        std::lock_guard<std::mutex> lock(this->mutex);
+
+        auto found = this->files.find(path);
+        if (found != this->files.end()) {
+            return found->second.module;
+        }
+
+        VKShaderFile file{};
+        splitPath(path, file.directory, file.fileName);
+
+        if (!this->loadFile(path, file.hash, file.module)) {
+            throw std::runtime_error("failed to load shader module!");
+        }
+
+        this->files.emplace(path, file);
+        return file.module;
+    }
+
+    bool VKShaderLibrary::loadFile(const std::string& path, uint64_t& hash, VkShaderModule& module)
+    {
+        // 매핑한 메모리를 그대로 pCode로 넘깁니다. (페이지 정렬이므로 4바이트 정렬 조건을 만족)
+        asset::VKMappedFile mappedFile;
+        if (!mappedFile.open(path) || mappedFile.getSize() % sizeof(uint32_t) != 0) {
+            return false;
+        }
+
+        hash = asset::hashBytes(mappedFile.getData(), mappedFile.getSize());
+
+        auto found = this->modules.find(hash);
+        if (found != this->modules.end()) {
+            found->second.fileCount++;
+            module = found->second.module;
+            return true;
+        }
+
+        VkShaderModuleCreateInfo createInfo{};
+        createInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+        createInfo.codeSize = static_cast<size_t>(mappedFile.getSize());
+        createInfo.pCode = reinterpret_cast<const uint32_t*>(mappedFile.getData());
+
+        if (vkCreateShaderModule(this->VKdevice, &createInfo, nullptr, &module) != VK_SUCCESS) {
+            return false;
+        }
+
+        VKShaderModuleEntry entry{};
+        entry.module = module;
+        entry.fileCount = 1;
+        this->modules.emplace(hash, entry);
+
+        return true;
+    }
+
+    void VKShaderLibrary::releaseModule(uint64_t hash)
+    {
+        auto found = this->modules.find(hash);
+        if (found == this->modules.end()) {
+            return;
+        }
+
+        if (--found->second.fileCount == 0) {
+            this->retiredModules.push_back(found->second.module);
+            this->modules.erase(found);
+        }
+    }
+
+    bool VKShaderLibrary::watch()
+    {
+        if (this->watching.load()) {
+            return true;
+        }
+
+        std::vector<std::string> directories;
+        {
+            std::lock_guard<std::mutex> lock(this->mutex);
+            for (const auto& file : this->files) {
+                if (std::find(directories.begin(), directories.end(), file.second.directory) == directories.end()) {
+                    directories.push_back(file.second.directory);
+                }
+            }
+        }
+
+        if (directories.empty()) {
+            return false;
+        }
+
+#ifdef _WIN32
+        for (const std::string& directory : directories) {
+            HANDLE handle = FindFirstChangeNotificationA(directory.empty() ? "." : directory.c_str(), FALSE,
+                FILE_NOTIFY_CHANGE_LAST_WRITE | FILE_NOTIFY_CHANGE_FILE_NAME);
+            if (handle == INVALID_HANDLE_VALUE) {
+                continue;
+            }
+            this->watchHandles.push_back(handle);
+            this->watchedDirectories.push_back(directory);
+        }
+
+        if (this->watchHandles.empty()) {
+            return false;
+        }
+#else
+        this->watchFile = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        if (this->watchFile < 0) {
+            return false;
+        }
+
+        for (const std::string& directory : directories) {
+            // 컴파일러가 파일을 다 쓰고 닫거나, 임시 파일을 옮겨 올 때만 알립니다.
+            const int descriptor = inotify_add_watch(this->watchFile, directory.empty() ? "." : directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO);
+            if (descriptor < 0) {
+                continue;
+            }
+            this->watchDescriptors.emplace(descriptor, directory);
+            this->watchedDirectories.push_back(directory);
+        }
+
+        if (this->watchDescriptors.empty()) {
+            ::close(this->watchFile);
+            this->watchFile = -1;
+            return false;
+        }
+#endif
+
+        this->watching.store(true);
+        this->watcher = std::thread(&VKShaderLibrary::watchLoop, this);
+
+#ifdef DEBUG_
+        for (const std::string& directory : this->watchedDirectories) {
+            printf("[shader library] watching %s\n", directory.c_str());
+        }
+#endif // DEBUG_
+
+        return true;
+    }
+
+    void VKShaderLibrary::watchLoop()
+    {
+#ifdef _WIN32
+        while (this->watching.load()) {
+            const DWORD count = static_cast<DWORD>(this->watchHandles.size());
+            const DWORD result = WaitForMultipleObjects(count, this->watchHandles.data(), FALSE, SHADER_WATCH_INTERVAL_MS);
+
+            if (result >= WAIT_OBJECT_0 && result < WAIT_OBJECT_0 + count) {
+                const DWORD index = result - WAIT_OBJECT_0;
+
+                // 변경 알림에는 파일 이름이 없으므로 디렉터리 전체를 확인합니다. -> 내용 해시가 같으면 건너뜁니다.
+                this->notifyChanged(this->watchedDirectories[index], std::string());
+                FindNextChangeNotification(this->watchHandles[index]);
+            }
+        }
+#else
+        alignas(inotify_event) char buffer[4096];
+
+        pollfd pollFile{};
+        pollFile.fd = this->watchFile;
+        pollFile.events = POLLIN;
+
+        while (this->watching.load()) {
+            if (poll(&pollFile, 1, static_cast<int>(SHADER_WATCH_INTERVAL_MS)) <= 0) {
+                continue;
+            }
+
+            ssize_t length = 0;
+            while ((length = read(this->watchFile, buffer, sizeof(buffer))) > 0) {
+                for (char* cursor = buffer; cursor < buffer + length; ) {
+                    const inotify_event* event = reinterpret_cast<const inotify_event*>(cursor);
+                    cursor += sizeof(inotify_event) + event->len;
+
+                    auto directory = this->watchDescriptors.find(event->wd);
+                    if (event->len == 0 || directory == this->watchDescriptors.end() || !isSpirvFile(event->name)) {
+                        continue;
+                    }
+
+                    this->notifyChanged(directory->second, event->name);
+                }
+            }
+        }
+#endif
+    }
+
+    void VKShaderLibrary::notifyChanged(const std::string& directory, const std::string& fileName)
+    {
+        {
+            std::lock_guard<std::mutex> lock(this->changedMutex);
+            this->changedPaths.insert(directory + fileName);
+        }
+        this->changed.store(true, std::memory_order_release);
+    }
+
+    uint32_t VKShaderLibrary::reloadChanged(std::vector<VKShaderReload>& reloads)
+    {
+        if (!this->changed.exchange(false, std::memory_order_acquire)) {
+            return 0;
+        }
+
+        std::set<std::string> changedPaths;
+        {
+            std::lock_guard<std::mutex> lock(this->changedMutex);
+            changedPaths.swap(this->changedPaths);
+        }
+
+        std::lock_guard<std::mutex> lock(this->mutex);
+
+        uint32_t reloadCount = 0;
+        for (auto& it : this->files) {
+            VKShaderFile& file = it.second;
+
+            // 파일 경로 또는 디렉터리 전체가 바뀐 것으로 알려졌는지 확인합니다.
+            if (changedPaths.count(file.directory + file.fileName) == 0 && changedPaths.count(file.directory) == 0) {
+                continue;
+            }
+
+            uint64_t hash = 0;
+            VkShaderModule module = VK_NULL_HANDLE;
+            if (!this->loadFile(it.first, hash, module)) {
+#ifdef DEBUG_
+                printf("[shader library] failed to reload %s\n", it.first.c_str());
+#endif // DEBUG_
+                continue;
+            }
+
+            // 내용이 같으면 (타임스탬프만 바뀐 경우) 아무것도 하지 않습니다.
+            if (hash == file.hash) {
+                this->releaseModule(hash);
+                continue;
+            }
+
+            VKShaderReload reload{};
+            reload.path = it.first;
+            reload.oldModule = file.module;
+            reload.newModule = module;
+            reloads.push_back(reload);
+
+            this->releaseModule(file.hash);
+            file.hash = hash;
+            file.module = module;
+            reloadCount++;
+
+#ifdef DEBUG_
+            printf("[shader library] reloaded %s\n", it.first.c_str());
+#endif // DEBUG_
+        }
+
+        return reloadCount;
+    }
+
+    uint32_t VKShaderLibrary::getModuleCount() const
+    {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        return static_cast<uint32_t>(this->modules.size());
+    }
+
+    void VKShaderLibrary::stopWatching()
+    {
+        this->watching.store(false);
+        if (this->watcher.joinable()) {
+            this->watcher.join();
+        }
+
+#ifdef _WIN32
+        for (HANDLE handle : this->watchHandles) {
+            FindCloseChangeNotification(handle);
+        }
+        this->watchHandles.clear();
+#else
+        if (this->watchFile >= 0) {
+            ::close(this->watchFile);
+            this->watchFile = -1;
+        }
+        this->watchDescriptors.clear();
+#endif
+        this->watchedDirectories.clear();
+    }
+
+    void VKShaderLibrary::cleanup()
+    {
+        this->stopWatching();
+
+        std::lock_guard<std::mutex> lock(this->mutex);
+
+        if (this->VKdevice == VK_NULL_HANDLE) {
+            return;
+        }
+
+        for (auto& module : this->modules) {
+            vkDestroyShaderModule(this->VKdevice, module.second.module, nullptr);
+        }
+        for (VkShaderModule module : this->retiredModules) {
+            vkDestroyShaderModule(this->VKdevice, module, nullptr);
+        }
+
+        this->modules.clear();
+        this->retiredModules.clear();
+        this->files.clear();
+        this->VKdevice = VK_NULL_HANDLE;
+    }
+}
@@ -0,0 +1,91 @@
+﻿#ifndef INCLUDE_VULKANSHADERLIBRARY_H_
+#define INCLUDE_VULKANSHADERLIBRARY_H_
+
+#include "../_common.h"
+
+#include <atomic>
+#include <mutex>
+#include <set>
+#include <thread>
+
+namespace vkengine {
+
+    constexpr uint32_t SHADER_WATCH_INTERVAL_MS = 100;          // 감시 스레드가 종료 요청을 확인하는 간격
+
+    // 핫 리로드로 바뀐 셰이더 모듈 -> 이 모듈을 쓰는 파이프라인을 다시 만들어야 합니다.
+    struct VKShaderReload {
+        std::string path;
+        VkShaderModule oldModule = VK_NULL_HANDLE;
+        VkShaderModule newModule = VK_NULL_HANDLE;
+    };
+
+    // 셰이더 라이브러리
+    // SPIR-V 파일을 메모리 매핑해서 바로 셰이더 모듈을 만들고, 내용 해시가 같은 파일은 모듈 하나를 같이 씁니다.
+    // watch()를 부르면 불러온 셰이더의 디렉터리를 감시해서 (Linux: inotify, Windows: 변경 알림) 바뀐 .spv만 다시 불러옵니다.
+    class VKShaderLibrary {
+    public:
+        explicit VKShaderLibrary(VkDevice device);
+        ~VKShaderLibrary();
+
+        VKShaderLibrary(const VKShaderLibrary&) = delete;
+        VKShaderLibrary& operator=(const VKShaderLibrary&) = delete;
+
+        // 경로의 셰이더 모듈 -> 이미 불러온 경로면 파일을 다시 읽지 않습니다. 실패하면 예외
+        VkShaderModule load(const std::string& path);
+
+        // 지금까지 불러온 셰이더의 디렉터리를 감시합니다. 감시를 시작하지 못하면 false
+        bool watch();
+
+        // 감시 스레드가 알린 파일을 다시 읽고, 내용이 바뀐 셰이더만 reloads에 담습니다. (프레임마다 호출)
+        uint32_t reloadChanged(std::vector<VKShaderReload>& reloads);
+
+        uint32_t getModuleCount() const;
+
+        // 감시를 멈추고 모든 셰이더 모듈을 해제합니다.
+        void cleanup();
+
+    private:
+        struct VKShaderFile {
+            std::string directory;                              // 마지막 구분자까지 포함한 경로
+            std::string fileName;
+            uint64_t hash = 0;                                  // SPIR-V 내용 해시
+            VkShaderModule module = VK_NULL_HANDLE;
+        };
+
+        struct VKShaderModuleEntry {
+            VkShaderModule module = VK_NULL_HANDLE;
+            uint32_t fileCount = 0;                             // 이 모듈을 쓰는 파일 수
+        };
+
+        // 파일을 매핑해서 해시하고, 같은 내용의 모듈이 없으면 새로 만듭니다.
+        bool loadFile(const std::string& path, uint64_t& hash, VkShaderModule& module);
+        void releaseModule(uint64_t hash);
+
+        void stopWatching();
+        void watchLoop();
+        void notifyChanged(const std::string& directory, const std::string& fileName);
+
+        VkDevice VKdevice = VK_NULL_HANDLE;
+
+        mutable std::mutex mutex;
+        std::unordered_map<std::string, VKShaderFile> files;            // 경로 -> 파일
+        std::unordered_map<uint64_t, VKShaderModuleEntry> modules;      // 내용 해시 -> 모듈
+        std::vector<VkShaderModule> retiredModules;     // 핫 리로드로 밀려난 모듈 -> 컴파일 중인 파이프라인이 쓸 수 있으므로 종료할 때 해제
+
+        // 감시 스레드
+        std::thread watcher;
+        std::atomic<bool> watching{ false };
+        std::atomic<bool> changed{ false };
+        std::mutex changedMutex;
+        std::set<std::string> changedPaths;             // 바뀐 파일 (디렉터리만 있으면 그 디렉터리 전체)
+        std::vector<std::string> watchedDirectories;
+#ifdef _WIN32
+        std::vector<HANDLE> watchHandles;
+#else
+        int watchFile = -1;
+        std::unordered_map<int, std::string> watchDescriptors;
+#endif
+    };
+}
+
+#endif // INCLUDE_VULKANSHADERLIBRARY_H_
@@ -0,0 +1,545 @@
+﻿#include "VKstaging.h"
+
+namespace vkengine {
+    namespace memory {
+
+        // copy 명령의 버퍼 오프셋 정렬 -> 텍셀 크기(1/2/4/8/16)와 optimalBufferCopyOffsetAlignment를 모두 만족
+        static const VkDeviceSize STAGING_ALIGNMENT = 16;
+
+        // 업로드된 리소스를 읽을 수 있는 단계와 접근
+        static const VkPipelineStageFlags STAGING_DST_STAGES =
+            VK_PIPELINE_STAGE_VERTEX_INPUT_BIT | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT |
+            VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT;
+        static const VkAccessFlags STAGING_DST_ACCESS =
+            VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT | VK_ACCESS_INDEX_READ_BIT |
+            VK_ACCESS_UNIFORM_READ_BIT | VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_TRANSFER_READ_BIT;
+
+        static VkDeviceSize alignUp(VkDeviceSize value, VkDeviceSize alignment)
+        {
+            return (value + alignment - 1) & ~(alignment - 1);
+        }
+
+        static VkCommandPool createCommandPool(VkDevice device, uint32_t queueFamilyIndex)
+        {
+            VkCommandPoolCreateInfo poolInfo{};
+            poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+            poolInfo.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT | VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+            poolInfo.queueFamilyIndex = queueFamilyIndex;
+
+            VkCommandPool commandPool = VK_NULL_HANDLE;
+            VK_CHECK_RESULT(vkCreateCommandPool(device, &poolInfo, nullptr, &commandPool));
+            return commandPool;
+        }
+
+        static VkCommandBuffer allocateCommandBuffer(VkDevice device, VkCommandPool commandPool)
+        {
+            VkCommandBufferAllocateInfo allocInfo{};
+            allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+            allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+            allocInfo.commandPool = commandPool;
+            allocInfo.commandBufferCount = 1;
+
+            VkCommandBuffer commandBuffer = VK_NULL_HANDLE;
+            VK_CHECK_RESULT(vkAllocateCommandBuffers(device, &allocInfo, &commandBuffer));
+            return commandBuffer;
+        }
+
+        VKStagingRing::VKStagingRing(VkDevice device,
+            VkQueue transferQueue, uint32_t transferQueueFamilyIndex,
+            VkQueue ownerQueue, uint32_t ownerQueueFamilyIndex,
+            VKMemoryAllocator* allocator,
+            VkDeviceSize capacity)
+        {
+            assert(device);
+            assert(transferQueue);
+            assert(ownerQueue);
+            assert(allocator);
+
+            this->VKdevice = device;
+            this->VKqueue = transferQueue;
+            this->VKownerQueue = ownerQueue;
+            this->queueFamilyIndex = transferQueueFamilyIndex;
+            this->ownerQueueFamilyIndex = ownerQueueFamilyIndex;
+            this->ownershipTransfer = transferQueueFamilyIndex != ownerQueueFamilyIndex;
+            this->VKallocator = allocator;
+            this->capacity = alignUp(capacity, STAGING_ALIGNMENT);
+
+            this->VKcommandPool = createCommandPool(this->VKdevice, this->queueFamilyIndex);
+            if (this->ownershipTransfer) {
+                this->VKownerCommandPool = createCommandPool(this->VKdevice, this->ownerQueueFamilyIndex);
+            }
+
+            VkBufferCreateInfo bufferInfo{};
+            bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+            bufferInfo.size = this->capacity;
+            bufferInfo.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+            bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+            VK_CHECK_RESULT(this->VKallocator->createBuffer(bufferInfo,
+                VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                this->VKbuffer, this->VKmemory));
+
+            this->mapped = static_cast<uint8_t*>(this->VKmemory.mapped);
+            if (this->mapped == nullptr) {
+                throw std::runtime_error("failed to map staging ring buffer!");
+            }
+
+            this->stats.capacity = this->capacity;
+        }
+
+        VKStagingRing::~VKStagingRing()
+        {
+            this->cleanup();
+        }
+
+        void VKStagingRing::uploadBuffer(VkBuffer dstBuffer, const void* data, VkDeviceSize size, VkDeviceSize dstOffset)
+        {
+            std::lock_guard<std::mutex> lock(this->stagingMutex);
+
+            // 한 조각이 링의 절반을 넘지 않게 나눕니다. -> 앞 조각이 GPU에 있는 동안 다음 조각을 쓸 수 있음
+            const VkDeviceSize chunkSize = this->capacity / 2;
+            const uint8_t* src = static_cast<const uint8_t*>(data);
+            VkDeviceSize copied = 0;
+
+            while (copied < size)
+            {
+                const VkDeviceSize bytes = std::min(chunkSize, size - copied);
+                const VkDeviceSize offset = this->allocate(bytes, STAGING_ALIGNMENT);
+                memcpy(this->mapped + offset, src + copied, static_cast<size_t>(bytes));
+
+                VkBufferCopy copyRegion{};
+                copyRegion.srcOffset = offset;
+                copyRegion.dstOffset = dstOffset + copied;
+                copyRegion.size = bytes;
+                vkCmdCopyBuffer(this->current.commandBuffer, this->VKbuffer, dstBuffer, 1, &copyRegion);
+
+                this->current.bytes += bytes;
+                copied += bytes;
+            }
+
+            // 같은 배리어를 전송 큐에서는 release, 소유 큐에서는 acquire로 사용합니다.
+            if (this->ownershipTransfer && size > 0) {
+                VkBufferMemoryBarrier barrier{};
+                barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+                barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+                barrier.dstAccessMask = STAGING_DST_ACCESS;
+                barrier.srcQueueFamilyIndex = this->queueFamilyIndex;
+                barrier.dstQueueFamilyIndex = this->ownerQueueFamilyIndex;
+                barrier.buffer = dstBuffer;
+                barrier.offset = dstOffset;
+                barrier.size = size;
+                this->ownershipBuffers.push_back(barrier);
+            }
+
+            this->stats.uploadCount++;
+        }
+
+        void VKStagingRing::uploadImage(VkImage dstImage, const void* data, VkDeviceSize size, uint32_t width, uint32_t height, uint32_t mipLevels, VkImageLayout finalLayout)
+        {
+            std::lock_guard<std::mutex> lock(this->stagingMutex);
+
+            VKImageLevel level{};
+            level.data = data;
+            level.size = size;
+            level.width = width;
+            level.height = height;
+
+            this->recordImageUpload(dstImage, &level, 1, mipLevels, 1, finalLayout);
+        }
+
+        void VKStagingRing::uploadImageLevels(VkImage dstImage, const VKImageLevel* levels, uint32_t levelCount, uint32_t blockHeight, VkImageLayout finalLayout)
+        {
+            std::lock_guard<std::mutex> lock(this->stagingMutex);
+
+            this->recordImageUpload(dstImage, levels, levelCount, levelCount, blockHeight, finalLayout);
+        }
+
+        void VKStagingRing::recordImageUpload(VkImage dstImage, const VKImageLevel* levels, uint32_t levelCount, uint32_t mipLevels, uint32_t blockHeight, VkImageLayout finalLayout)
+        {
+            if (!this->recording) {
+                this->beginBatch();
+            }
+
+            VkImageMemoryBarrier barrier{};
+            barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+            barrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+            barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+            barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+            barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+            barrier.image = dstImage;
+            barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+            barrier.subresourceRange.baseMipLevel = 0;
+            barrier.subresourceRange.levelCount = mipLevels;
+            barrier.subresourceRange.baseArrayLayer = 0;
+            barrier.subresourceRange.layerCount = 1;
+            barrier.srcAccessMask = 0;
+            barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+
+            vkCmdPipelineBarrier(this->current.commandBuffer,
+                VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                0, 0, nullptr, 0, nullptr, 1, &barrier);
+
+            for (uint32_t mip = 0; mip < levelCount; mip++)
+            {
+                const VKImageLevel& level = levels[mip];
+
+                // 링보다 큰 mip은 (블록) 행 단위로 나눠서 복사합니다.
+                const uint32_t blockRows = (level.height + blockHeight - 1) / blockHeight;
+                const VkDeviceSize rowPitch = level.size / blockRows;
+                const uint32_t maxRows = static_cast<uint32_t>(std::max<VkDeviceSize>(1, (this->capacity / 2) / rowPitch));
+                const uint8_t* src = static_cast<const uint8_t*>(level.data);
+
+                for (uint32_t y = 0; y < blockRows; y += maxRows)
+                {
+                    const uint32_t rows = std::min(maxRows, blockRows - y);
+                    const VkDeviceSize bytes = rowPitch * rows;
+                    const VkDeviceSize offset = this->allocate(bytes, STAGING_ALIGNMENT);
+                    memcpy(this->mapped + offset, src + rowPitch * y, static_cast<size_t>(bytes));
+
+                    VkBufferImageCopy region{};
+                    region.bufferOffset = offset;
+                    region.bufferRowLength = 0;
+                    region.bufferImageHeight = 0;
+                    region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+                    region.imageSubresource.mipLevel = mip;
+                    region.imageSubresource.baseArrayLayer = 0;
+                    region.imageSubresource.layerCount = 1;
+                    region.imageOffset = { 0, static_cast<int32_t>(y * blockHeight), 0 };
+                    region.imageExtent = { level.width, std::min(rows * blockHeight, level.height - y * blockHeight), 1 };
+                    vkCmdCopyBufferToImage(this->current.commandBuffer, this->VKbuffer, dstImage, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
+
+                    this->current.bytes += bytes;
+                }
+            }
+
+            barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+            barrier.newLayout = finalLayout;
+            barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+            barrier.dstAccessMask = (finalLayout == VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL)
+                ? (VK_ACCESS_TRANSFER_READ_BIT | VK_ACCESS_TRANSFER_WRITE_BIT)
+                : VK_ACCESS_SHADER_READ_BIT;
+
+            if (this->ownershipTransfer) {
+                // 레이아웃 전환은 소유권 이전 배리어에 같이 넣습니다. (전송 큐는 셰이더 단계를 지원하지 않음)
+                barrier.srcQueueFamilyIndex = this->queueFamilyIndex;
+                barrier.dstQueueFamilyIndex = this->ownerQueueFamilyIndex;
+                this->ownershipImages.push_back(barrier);
+            }
+            else if (finalLayout != VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL) {
+                vkCmdPipelineBarrier(this->current.commandBuffer,
+                    VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+                    0, 0, nullptr, 0, nullptr, 1, &barrier);
+            }
+
+            this->stats.uploadCount++;
+        }
+
+        VkCommandBuffer VKStagingRing::getCommandBuffer()
+        {
+            std::lock_guard<std::mutex> lock(this->stagingMutex);
+
+            if (!this->recording) {
+                this->beginBatch();
+            }
+
+            return this->current.commandBuffer;
+        }
+
+        VkFence VKStagingRing::flush()
+        {
+            std::lock_guard<std::mutex> lock(this->stagingMutex);
+
+            // 끝난 배치를 먼저 회수해서 링 공간을 돌려받습니다.
+            this->retire(false);
+
+            if (!this->recording) {
+                return VK_NULL_HANDLE;
+            }
+
+            return this->submitBatch();
+        }
+
+        void VKStagingRing::waitAll()
+        {
+            std::lock_guard<std::mutex> lock(this->stagingMutex);
+
+            while (!this->inFlight.empty())
+            {
+                this->retire(true);
+            }
+        }
+
+        VKStagingStats VKStagingRing::getStats()
+        {
+            std::lock_guard<std::mutex> lock(this->stagingMutex);
+
+            VKStagingStats result = this->stats;
+            result.inFlightBytes = 0;
+            for (const auto& batch : this->inFlight)
+            {
+                result.inFlightBytes += batch.bytes;
+            }
+
+            return result;
+        }
+
+        void VKStagingRing::cleanup()
+        {
+            std::lock_guard<std::mutex> lock(this->stagingMutex);
+
+            if (this->VKdevice == VK_NULL_HANDLE) {
+                return;
+            }
+
+            // 기록만 하고 제출하지 않은 배치는 버립니다.
+            if (this->recording) {
+                vkEndCommandBuffer(this->current.commandBuffer);
+                this->recording = false;
+                this->freeBatches.push_back(this->current);
+                this->current = VKStagingBatch{};
+                this->ownershipBuffers.clear();
+                this->ownershipImages.clear();
+            }
+
+            while (!this->inFlight.empty())
+            {
+                this->retire(true);
+            }
+
+            for (auto& batch : this->freeBatches)
+            {
+                vkDestroyFence(this->VKdevice, batch.fence, nullptr);
+                if (batch.semaphore != VK_NULL_HANDLE) {
+                    vkDestroySemaphore(this->VKdevice, batch.semaphore, nullptr);
+                }
+            }
+            this->freeBatches.clear();
+
+            // 커맨드 버퍼는 풀과 함께 해제됩니다.
+            if (this->VKcommandPool != VK_NULL_HANDLE) {
+                vkDestroyCommandPool(this->VKdevice, this->VKcommandPool, nullptr);
+                this->VKcommandPool = VK_NULL_HANDLE;
+            }
+
+            if (this->VKownerCommandPool != VK_NULL_HANDLE) {
+                vkDestroyCommandPool(this->VKdevice, this->VKownerCommandPool, nullptr);
+                this->VKownerCommandPool = VK_NULL_HANDLE;
+            }
+
+#ifdef DEBUG_
+            printf("[staging] %u uploads, %u submits, %llu bytes, %u stalls\n",
+                this->stats.uploadCount, this->stats.submitCount,
+                static_cast<unsigned long long>(this->stats.totalBytes), this->stats.stallCount);
+#endif // DEBUG_
+
+            this->VKallocator->destroyBuffer(this->VKbuffer, this->VKmemory);
+            this->mapped = nullptr;
+            this->VKdevice = VK_NULL_HANDLE;
+        }
+
+        // 링에서 size 바이트를 잘라 오프셋을 돌려줍니다.
+        // 공간이 없으면 현재 배치를 제출하고 가장 오래된 배치의 fence를 기다립니다.
+        VkDeviceSize VKStagingRing::allocate(VkDeviceSize size, VkDeviceSize alignment)
+        {
+            assert(size <= this->capacity);
+
+            this->retire(false);
+
+            VkDeviceSize offset = 0;
+            while (!this->tryAllocate(size, alignment, offset))
+            {
+                if (this->recording && this->current.bytes > 0) {
+                    this->submitBatch();
+                }
+
+                this->stats.stallCount++;
+                this->retire(true);
+            }
+
+            if (!this->recording) {
+                this->beginBatch();
+            }
+
+            return offset;
+        }
+
+        bool VKStagingRing::tryAllocate(VkDeviceSize size, VkDeviceSize alignment, VkDeviceSize& outOffset)
+        {
+            // GPU가 읽고 있는 영역도, 기록 중인 영역도 없으면 처음부터 씁니다.
+            const bool empty = this->inFlight.empty() && (!this->recording || this->current.bytes == 0);
+            if (empty) {
+                this->head = 0;
+                this->tail = 0;
+            }
+
+            const VkDeviceSize start = alignUp(this->head, alignment);
+
+            if (empty || this->head > this->tail) {
+                // 빈 공간: [head, capacity) 와 [0, tail)
+                if (start + size <= this->capacity) {
+                    outOffset = start;
+                    this->head = start + size;
+                    return true;
+                }
+
+                // 끝에 자리가 없으면 앞으로 감습니다. -> head == tail은 "비어 있음"이므로 같아지지 않게 합니다.
+                if (size < this->tail) {
+                    outOffset = 0;
+                    this->head = size;
+                    return true;
+                }
+
+                return false;
+            }
+
+            // 빈 공간: [head, tail)
+            if (start + size < this->tail) {
+                outOffset = start;
+                this->head = start + size;
+                return true;
+            }
+
+            return false;
+        }
+
+        void VKStagingRing::beginBatch()
+        {
+            if (!this->freeBatches.empty()) {
+                this->current = this->freeBatches.back();
+                this->freeBatches.pop_back();
+            }
+            else {
+                this->current = VKStagingBatch{};
+                this->current.commandBuffer = allocateCommandBuffer(this->VKdevice, this->VKcommandPool);
+
+                VkFenceCreateInfo fenceInfo{};
+                fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+                VK_CHECK_RESULT(vkCreateFence(this->VKdevice, &fenceInfo, nullptr, &this->current.fence));
+
+                if (this->ownershipTransfer) {
+                    this->current.acquireCommandBuffer = allocateCommandBuffer(this->VKdevice, this->VKownerCommandPool);
+
+                    VkSemaphoreCreateInfo semaphoreInfo{};
+                    semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+                    VK_CHECK_RESULT(vkCreateSemaphore(this->VKdevice, &semaphoreInfo, nullptr, &this->current.semaphore));
+                }
+            }
+
+            this->current.bytes = 0;
+            this->current.endOffset = 0;
+
+            VkCommandBufferBeginInfo beginInfo{};
+            beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+            beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+            VK_CHECK_RESULT(vkBeginCommandBuffer(this->current.commandBuffer, &beginInfo));
+
+            this->recording = true;
+        }
+
+        VkFence VKStagingRing::submitBatch()
+        {
+            if (this->ownershipTransfer) {
+                // release: 전송 큐에서 복사가 끝난 리소스를 소유 큐 패밀리로 넘깁니다.
+                vkCmdPipelineBarrier(this->current.commandBuffer,
+                    VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+                    0, 0, nullptr,
+                    static_cast<uint32_t>(this->ownershipBuffers.size()), this->ownershipBuffers.data(),
+                    static_cast<uint32_t>(this->ownershipImages.size()), this->ownershipImages.data());
+
+                VK_CHECK_RESULT(vkEndCommandBuffer(this->current.commandBuffer));
+
+                VkSubmitInfo submitInfo{};
+                submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+                submitInfo.commandBufferCount = 1;
+                submitInfo.pCommandBuffers = &this->current.commandBuffer;
+                submitInfo.signalSemaphoreCount = 1;
+                submitInfo.pSignalSemaphores = &this->current.semaphore;
+                VK_CHECK_RESULT(vkQueueSubmit(this->VKqueue, 1, &submitInfo, VK_NULL_HANDLE));
+
+                // acquire: 소유 큐에서 같은 배리어로 소유권을 받고 읽기 단계에 보이게 합니다.
+                VkCommandBufferBeginInfo beginInfo{};
+                beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+                beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+                VK_CHECK_RESULT(vkBeginCommandBuffer(this->current.acquireCommandBuffer, &beginInfo));
+
+                vkCmdPipelineBarrier(this->current.acquireCommandBuffer,
+                    VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, STAGING_DST_STAGES,
+                    0, 0, nullptr,
+                    static_cast<uint32_t>(this->ownershipBuffers.size()), this->ownershipBuffers.data(),
+                    static_cast<uint32_t>(this->ownershipImages.size()), this->ownershipImages.data());
+
+                VK_CHECK_RESULT(vkEndCommandBuffer(this->current.acquireCommandBuffer));
+
+                // 소유 큐는 전송 큐의 세마포어를 기다리므로 fence는 두 제출이 모두 끝나야 signal됩니다.
+                const VkPipelineStageFlags waitStage = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+                VkSubmitInfo acquireInfo{};
+                acquireInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+                acquireInfo.waitSemaphoreCount = 1;
+                acquireInfo.pWaitSemaphores = &this->current.semaphore;
+                acquireInfo.pWaitDstStageMask = &waitStage;
+                acquireInfo.commandBufferCount = 1;
+                acquireInfo.pCommandBuffers = &this->current.acquireCommandBuffer;
+                VK_CHECK_RESULT(vkQueueSubmit(this->VKownerQueue, 1, &acquireInfo, this->current.fence));
+
+                this->ownershipBuffers.clear();
+                this->ownershipImages.clear();
+            }
+            else {
+                // 복사 결과를 이후 제출되는 모든 읽기 단계에서 볼 수 있게 합니다.
+                VkMemoryBarrier barrier{};
+                barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+                barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+                barrier.dstAccessMask = STAGING_DST_ACCESS;
+
+                vkCmdPipelineBarrier(this->current.commandBuffer,
+                    VK_PIPELINE_STAGE_TRANSFER_BIT, STAGING_DST_STAGES,
+                    0, 1, &barrier, 0, nullptr, 0, nullptr);
+
+                VK_CHECK_RESULT(vkEndCommandBuffer(this->current.commandBuffer));
+
+                VkSubmitInfo submitInfo{};
+                submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+                submitInfo.commandBufferCount = 1;
+                submitInfo.pCommandBuffers = &this->current.commandBuffer;
+                VK_CHECK_RESULT(vkQueueSubmit(this->VKqueue, 1, &submitInfo, this->current.fence));
+            }
+
+            this->current.endOffset = this->head;
+            this->stats.totalBytes += this->current.bytes;
+            this->stats.submitCount++;
+
+            const VkFence fence = this->current.fence;
+            this->inFlight.push_back(this->current);
+            this->current = VKStagingBatch{};
+            this->recording = false;
+
+            return fence;
+        }
+
+        // 끝난 배치를 제출 순서대로 회수합니다.
+        // waitOldest가 true이면 가장 오래된 배치 하나는 끝날 때까지 기다립니다.
+        void VKStagingRing::retire(bool waitOldest)
+        {
+            if (waitOldest && !this->inFlight.empty()) {
+                VK_CHECK_RESULT(vkWaitForFences(this->VKdevice, 1, &this->inFlight.front().fence, VK_TRUE, UINT64_MAX));
+            }
+
+            while (!this->inFlight.empty())
+            {
+                VKStagingBatch& batch = this->inFlight.front();
+                if (vkGetFenceStatus(this->VKdevice, batch.fence) != VK_SUCCESS) {
+                    break;
+                }
+
+                this->tail = batch.endOffset;
+
+                VK_CHECK_RESULT(vkResetFences(this->VKdevice, 1, &batch.fence));
+                VK_CHECK_RESULT(vkResetCommandBuffer(batch.commandBuffer, 0));
+                if (batch.acquireCommandBuffer != VK_NULL_HANDLE) {
+                    VK_CHECK_RESULT(vkResetCommandBuffer(batch.acquireCommandBuffer, 0));
+                }
+                this->freeBatches.push_back(batch);
+                this->inFlight.pop_front();
+            }
+        }
+    }
+}
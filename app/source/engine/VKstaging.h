@@ -0,0 +1,133 @@
+﻿#ifndef INCLUDE_VULKANSTAGING_H_
+#define INCLUDE_VULKANSTAGING_H_
+
+#include "../_common.h"
+#include "VKallocator.h"
+
+#include <deque>
+#include <mutex>
+
+namespace vkengine {
+    namespace memory {
+
+        // 한 번에 제출되는 업로드 묶음
+        // fence가 signal되면 endOffset까지의 링 영역을 다시 쓸 수 있습니다.
+        struct VKStagingBatch {
+            VkCommandBuffer commandBuffer{ VK_NULL_HANDLE };            // 전송 큐에서 실행되는 복사 명령 (+ 소유권 release)
+            VkCommandBuffer acquireCommandBuffer{ VK_NULL_HANDLE };     // 소유 큐에서 실행되는 소유권 acquire 명령
+            VkSemaphore semaphore{ VK_NULL_HANDLE };                    // 전송 큐 -> 소유 큐 순서를 맞추는 세마포어
+            VkFence fence{ VK_NULL_HANDLE };                            // 배치 전체(복사 + acquire)가 끝나면 signal
+            VkDeviceSize endOffset = 0;                                 // 이 배치가 사용한 링 영역의 끝 위치
+            VkDeviceSize bytes = 0;                                     // 이 배치로 올라간 바이트 수
+        };
+
+        // 업로드 통계
+        struct VKStagingStats {
+            VkDeviceSize capacity = 0;                      // 링 버퍼 크기
+            VkDeviceSize inFlightBytes = 0;                 // GPU가 아직 읽고 있는 바이트
+            VkDeviceSize totalBytes = 0;                    // 지금까지 올라간 바이트
+            uint32_t submitCount = 0;                       // 배치 제출 횟수
+            uint32_t uploadCount = 0;                       // uploadBuffer/uploadImage 호출 횟수
+            uint32_t stallCount = 0;                        // 공간이 없어 fence를 기다린 횟수
+        };
+
+        // 이미지 mip 하나의 데이터 (빈틈 없는 행, 블록 압축 형식이면 빈틈 없는 블록 행)
+        struct VKImageLevel {
+            const void* data = nullptr;
+            VkDeviceSize size = 0;
+            uint32_t width = 0;
+            uint32_t height = 0;
+        };
+
+        // 영구 매핑된 HOST_VISIBLE 버퍼 하나를 링으로 돌려 쓰는 스테이징 버퍼
+        // 업로드마다 스테이징 버퍼를 만들고 vkQueueWaitIdle로 기다리는 대신
+        // 여러 업로드를 하나의 커맨드 버퍼에 모아 flush()에서 한 번에 제출합니다.
+        // 링이 가득 차면 가장 오래된 배치의 fence만 기다립니다.
+        //
+        // 전송 큐 패밀리가 리소스를 사용하는 큐(소유 큐) 패밀리와 다르면
+        // 복사는 전송 큐에서 실행하고, 끝난 리소스는 release/acquire 배리어로 소유 큐에 넘깁니다.
+        // -> 업로드가 렌더링과 겹쳐서 실행됩니다.
+        class VKStagingRing {
+        public:
+            VKStagingRing(VkDevice device,
+                VkQueue transferQueue, uint32_t transferQueueFamilyIndex,
+                VkQueue ownerQueue, uint32_t ownerQueueFamilyIndex,
+                VKMemoryAllocator* allocator,
+                VkDeviceSize capacity = 32ull * 1024 * 1024);
+            ~VKStagingRing();
+
+            VKStagingRing(const VKStagingRing&) = delete;
+            VKStagingRing& operator=(const VKStagingRing&) = delete;
+
+            // data를 dstBuffer의 dstOffset 위치로 복사하는 명령을 현재 배치에 기록합니다.
+            // 링보다 큰 데이터는 나눠서 기록합니다.
+            void uploadBuffer(VkBuffer dstBuffer, const void* data, VkDeviceSize size, VkDeviceSize dstOffset = 0);
+
+            // data(mip 0, 빈틈 없는 행)를 dstImage로 복사하는 명령을 현재 배치에 기록합니다.
+            // 모든 mip을 TRANSFER_DST로 바꾼 뒤 복사하고, finalLayout이 TRANSFER_DST가 아니면 finalLayout으로 전환합니다.
+            void uploadImage(VkImage dstImage, const void* data, VkDeviceSize size, uint32_t width, uint32_t height, uint32_t mipLevels, VkImageLayout finalLayout);
+
+            // 미리 만든 mip 0..levelCount-1을 모두 dstImage로 복사하는 명령을 현재 배치에 기록합니다. (밉맵 생성이 필요 없음)
+            // blockHeight는 블록 압축 형식의 블록 높이 (BC는 4, 압축 없음은 1) -> 링보다 큰 mip은 블록 행 단위로 나눠 복사합니다.
+            void uploadImageLevels(VkImage dstImage, const VKImageLevel* levels, uint32_t levelCount, uint32_t blockHeight, VkImageLayout finalLayout);
+
+            // 현재 배치의 커맨드 버퍼 -> 업로드와 같은 배치에 추가 명령을 기록할 때 사용
+            // 전송 큐에서 실행되므로 전송 명령만 기록해야 합니다.
+            VkCommandBuffer getCommandBuffer();
+
+            // 현재 배치를 제출합니다. 기다리지 않고 바로 반환합니다.
+            // 소유권 이전이 필요하면 소유 큐에 acquire 명령도 함께 제출합니다. (소유 큐의 다음 제출보다 먼저 실행됨)
+            // 기록된 명령이 없으면 아무것도 하지 않고 VK_NULL_HANDLE을 반환합니다.
+            VkFence flush();
+
+            // 전송 큐와 소유 큐가 다른 패밀리인지 -> 업로드가 렌더링과 겹쳐서 실행되는지
+            bool isAsync() const { return this->ownershipTransfer; }
+
+            // 제출된 모든 배치가 끝날 때까지 기다리는 함수
+            void waitAll();
+
+            VKStagingStats getStats();
+
+            // 버퍼와 커맨드 풀을 해제하는 함수 -> 할당기 cleanup 전에 호출
+            void cleanup();
+
+        private:
+            VkDeviceSize allocate(VkDeviceSize size, VkDeviceSize alignment);
+            bool tryAllocate(VkDeviceSize size, VkDeviceSize alignment, VkDeviceSize& outOffset);
+            void beginBatch();
+            VkFence submitBatch();
+            void retire(bool waitOldest);
+            void recordImageUpload(VkImage dstImage, const VKImageLevel* levels, uint32_t levelCount, uint32_t mipLevels, uint32_t blockHeight, VkImageLayout finalLayout);
+
+            VkDevice VKdevice{ VK_NULL_HANDLE };
+            VkQueue VKqueue{ VK_NULL_HANDLE };                          // 전송 큐
+            VkQueue VKownerQueue{ VK_NULL_HANDLE };                     // 리소스를 사용하는 큐
+            uint32_t queueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+            uint32_t ownerQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+            bool ownershipTransfer = false;                             // 두 큐의 패밀리가 다르면 true
+            VKMemoryAllocator* VKallocator = nullptr;
+            VkCommandPool VKcommandPool{ VK_NULL_HANDLE };              // 전송 큐 패밀리용
+            VkCommandPool VKownerCommandPool{ VK_NULL_HANDLE };         // 소유 큐 패밀리용 (acquire 명령)
+
+            VkBuffer VKbuffer{ VK_NULL_HANDLE };
+            VKAllocation VKmemory{};
+            uint8_t* mapped = nullptr;
+            VkDeviceSize capacity = 0;
+
+            VkDeviceSize head = 0;                          // 다음에 쓸 위치
+            VkDeviceSize tail = 0;                          // GPU가 아직 읽고 있는 가장 오래된 위치
+
+            bool recording = false;                         // 현재 배치가 기록 중인지
+            VKStagingBatch current{};
+            std::deque<VKStagingBatch> inFlight;            // 제출 순서대로 쌓인 배치
+            std::vector<VKStagingBatch> freeBatches;        // 재사용할 커맨드 버퍼/fence
+            std::vector<VkBufferMemoryBarrier> ownershipBuffers;   // 현재 배치에서 소유권을 넘길 버퍼
+            std::vector<VkImageMemoryBarrier> ownershipImages;     // 현재 배치에서 소유권을 넘길 이미지
+
+            VKStagingStats stats{};
+            std::mutex stagingMutex;
+        };
+    }
+}
+
+#endif // INCLUDE_VULKANSTAGING_H_
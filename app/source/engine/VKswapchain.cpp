@@ -88,8 +88,56 @@ namespace vkengine
 
     }
 
+    void VKSwapChain::createOffscreen(memory::VKMemoryAllocator* allocator, VkExtent2D extent, VkFormat format, uint32_t imageCount)
+    {
+        this->VKallocator = allocator;
+        this->VKswapChainImages.resize(imageCount);
+        this->VKoffscreenMemory.resize(imageCount);
+        this->nextOffscreenImage = 0;
+
+        VkImageCreateInfo imageInfo{};
+        imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+        imageInfo.imageType = VK_IMAGE_TYPE_2D;
+        imageInfo.extent = { extent.width, extent.height, 1 };
+        imageInfo.mipLevels = 1;
+        imageInfo.arrayLayers = 1;
+        imageInfo.format = format;
+        imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+        imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+        imageInfo.usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT;  //  о   ֵ  ҽε 
+        imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+        imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+        for (uint32_t i = 0; i < imageCount; i++)
+        {
+            if (this->VKallocator->createImage(imageInfo, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, this->VKswapChainImages[i], this->VKoffscreenMemory[i]) != VK_SUCCESS) {
+                throw std::runtime_error("failed to create offscreen image!");
+            }
+        }
+
+        this->VKswapChainImageFormat = format;
+        this->VKswapChainExtent = extent;
+
+#ifdef DEBUG_
+        printf("create offscreen target\n");
+        printf("Offscreen imageCount: %d\n", imageCount);
+        printf("Offscreen imageFormat: %d\n", format);
+        printf("Offscreen imageExtent.width: %d\n", extent.width);
+        printf("Offscreen imageExtent.height: %d\n", extent.height);
+        printf("\n");
+#endif // DEBUG_
+    }
+
     VkResult VKSwapChain::acquireNextImage(VkSemaphore presentCompleteSemaphore, uint32_t& imageIndex)
     {
+        // ũ ̹ Ʈ  Ƿ    ϴ.
+        // ̹  MAX_FRAMES_IN_FLIGHT ,  潺 ٸ ڿ  ̹  GPU ۾  ֽϴ.
+        if (this->isOffscreen()) {
+            imageIndex = this->nextOffscreenImage;
+            this->nextOffscreenImage = (this->nextOffscreenImage + 1) % this->getSwapChainImageCount();
+            return VK_SUCCESS;
+        }
+
         return vkAcquireNextImageKHR(this->VKdevice, this->VKswapChain, UINT64_MAX, presentCompleteSemaphore, (VkFence)nullptr, &imageIndex);
     }
 
@@ -99,6 +147,15 @@ namespace vkengine
             vkDestroyImageView(this->VKdevice, imageView, nullptr);
         }
 
+        if (this->isOffscreen()) {
+            for (size_t i = 0; i < this->VKswapChainImages.size(); i++) {
+                this->VKallocator->destroyImage(this->VKswapChainImages[i], this->VKoffscreenMemory[i]);
+            }
+            this->VKswapChainImages.clear();
+            this->VKoffscreenMemory.clear();
+            return;
+        }
+
         vkDestroySwapchainKHR(this->VKdevice, this->VKswapChain, nullptr);
     }
 
@@ -3,6 +3,7 @@
 
 #include "../_common.h"
 #include "../struct.h"
+#include "VKallocator.h"
 
 namespace vkengine {
 
@@ -15,6 +16,11 @@ namespace vkengine {
         void createImageViews();
         void cleanupSwapChain();
 
+        // 헤드리스 모드 -> 스왑 체인 대신 오프스크린 이미지를 만들고 acquireNextImage에서 돌아가며 사용합니다.
+        // 서피스가 없어도 되므로 창이나 GPU가 없는 환경(lavapipe 등)에서도 렌더링할 수 있습니다.
+        void createOffscreen(memory::VKMemoryAllocator* allocator, VkExtent2D extent, VkFormat format, uint32_t imageCount);
+        bool isOffscreen() const { return this->VKallocator != nullptr; }
+
         const VkExtent2D getSwapChainExtent() { return this->VKswapChainExtent; }
         const VkFormat getSwapChainImageFormat() { return this->VKswapChainImageFormat; }
         const VkSwapchainKHR getSwapChain() { return this->VKswapChain; }
@@ -32,6 +38,11 @@ namespace vkengine {
         std::vector<VkImage> VKswapChainImages{};
         std::vector<VkImageView> VKswapChainImageViews{};
 
+        // 오프스크린 이미지 (헤드리스 모드)
+        memory::VKMemoryAllocator* VKallocator{ nullptr };
+        std::vector<memory::VKAllocation> VKoffscreenMemory{};
+        uint32_t nextOffscreenImage = 0;
+
         VkPhysicalDevice VKphysicalDevice{ VK_NULL_HANDLE };
         VkDevice VKdevice{ VK_NULL_HANDLE };
         VkSurfaceKHR VKsurface{ VK_NULL_HANDLE };
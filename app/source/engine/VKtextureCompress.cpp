@@ -0,0 +1,411 @@
+﻿#include "VKtextureCompress.h"
+#include "VKtrace.h"
+
+#include <cfloat>
+#include <climits>
+#include <cmath>
+
+namespace vkengine {
+    namespace asset {
+
+        namespace {
+            // 블록 텍셀의 주성분 축 (공분산 행렬의 거듭제곱법)
+            template<int N>
+            void principalAxis(const float (&points)[16][N], const float (&mean)[N], float (&axis)[N])
+            {
+                float covariance[N][N] = {};
+                for (int i = 0; i < 16; i++)
+                {
+                    for (int a = 0; a < N; a++)
+                    {
+                        for (int b = 0; b < N; b++)
+                        {
+                            covariance[a][b] += (points[i][a] - mean[a]) * (points[i][b] - mean[b]);
+                        }
+                    }
+                }
+
+                for (int a = 0; a < N; a++)
+                {
+                    axis[a] = 1.0f;
+                }
+
+                for (int iteration = 0; iteration < 8; iteration++)
+                {
+                    float next[N] = {};
+                    float length = 0.0f;
+                    for (int a = 0; a < N; a++)
+                    {
+                        for (int b = 0; b < N; b++)
+                        {
+                            next[a] += covariance[a][b] * axis[b];
+                        }
+                        length = std::max(length, std::fabs(next[a]));
+                    }
+
+                    if (length < 1e-6f) {
+                        break;
+                    }
+                    for (int a = 0; a < N; a++)
+                    {
+                        axis[a] = next[a] / length;
+                    }
+                }
+            }
+
+            // 주성분 축에 투영했을 때 양 끝 값 -> 두 끝점
+            template<int N>
+            void fitEndpoints(const float (&points)[16][N], float (&endpoint0)[N], float (&endpoint1)[N])
+            {
+                float mean[N] = {};
+                for (int i = 0; i < 16; i++)
+                {
+                    for (int a = 0; a < N; a++)
+                    {
+                        mean[a] += points[i][a] / 16.0f;
+                    }
+                }
+
+                float axis[N];
+                principalAxis(points, mean, axis);
+
+                float minT = FLT_MAX;
+                float maxT = -FLT_MAX;
+                for (int i = 0; i < 16; i++)
+                {
+                    float t = 0.0f;
+                    for (int a = 0; a < N; a++)
+                    {
+                        t += (points[i][a] - mean[a]) * axis[a];
+                    }
+                    minT = std::min(minT, t);
+                    maxT = std::max(maxT, t);
+                }
+
+                float axisLength = 0.0f;
+                for (int a = 0; a < N; a++)
+                {
+                    axisLength += axis[a] * axis[a];
+                }
+                axisLength = std::max(axisLength, 1e-12f);
+
+                for (int a = 0; a < N; a++)
+                {
+                    endpoint0[a] = std::min(std::max(mean[a] + axis[a] * minT / axisLength, 0.0f), 255.0f);
+                    endpoint1[a] = std::min(std::max(mean[a] + axis[a] * maxT / axisLength, 0.0f), 255.0f);
+                }
+            }
+
+            uint16_t packRGB565(const float (&color)[3])
+            {
+                const uint32_t r = static_cast<uint32_t>(color[0] * 31.0f / 255.0f + 0.5f);
+                const uint32_t g = static_cast<uint32_t>(color[1] * 63.0f / 255.0f + 0.5f);
+                const uint32_t b = static_cast<uint32_t>(color[2] * 31.0f / 255.0f + 0.5f);
+                return static_cast<uint16_t>((r << 11) | (g << 5) | b);
+            }
+
+            void unpackRGB565(uint16_t color, int (&rgb)[3])
+            {
+                const int r = (color >> 11) & 31;
+                const int g = (color >> 5) & 63;
+                const int b = color & 31;
+                rgb[0] = (r << 3) | (r >> 2);
+                rgb[1] = (g << 2) | (g >> 4);
+                rgb[2] = (b << 3) | (b >> 2);
+            }
+
+            // BC7 4비트 인덱스의 보간 가중치 (/64)
+            const int BC7_WEIGHTS[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+            struct BC7Endpoints {
+                int quantized[2][4];                            // 7비트
+                int pbit[2];
+            };
+
+            // 끝점마다 p비트 0/1 중 오차가 작은 쪽으로 7비트 양자화합니다.
+            void quantizeBC7(const float (&endpoint0)[4], const float (&endpoint1)[4], BC7Endpoints& endpoints)
+            {
+                const float* source[2] = { endpoint0, endpoint1 };
+
+                for (int e = 0; e < 2; e++)
+                {
+                    float bestError = FLT_MAX;
+                    for (int p = 0; p < 2; p++)
+                    {
+                        int quantized[4];
+                        float error = 0.0f;
+                        for (int c = 0; c < 4; c++)
+                        {
+                            quantized[c] = std::min(std::max(static_cast<int>(std::floor((source[e][c] - p) / 2.0f + 0.5f)), 0), 127);
+                            const float diff = static_cast<float>((quantized[c] << 1) | p) - source[e][c];
+                            error += diff * diff;
+                        }
+
+                        if (error < bestError) {
+                            bestError = error;
+                            endpoints.pbit[e] = p;
+                            memcpy(endpoints.quantized[e], quantized, sizeof(quantized));
+                        }
+                    }
+                }
+            }
+
+            // 팔레트 16개 중 가장 가까운 인덱스를 고르고 전체 오차를 돌려줍니다.
+            int selectBC7Indices(const uint8_t texels[64], const BC7Endpoints& endpoints, uint8_t (&indices)[16])
+            {
+                int palette[16][4];
+                for (int c = 0; c < 4; c++)
+                {
+                    const int e0 = (endpoints.quantized[0][c] << 1) | endpoints.pbit[0];
+                    const int e1 = (endpoints.quantized[1][c] << 1) | endpoints.pbit[1];
+                    for (int i = 0; i < 16; i++)
+                    {
+                        palette[i][c] = ((64 - BC7_WEIGHTS[i]) * e0 + BC7_WEIGHTS[i] * e1 + 32) >> 6;
+                    }
+                }
+
+                int totalError = 0;
+                for (int t = 0; t < 16; t++)
+                {
+                    int bestError = INT_MAX;
+                    for (int i = 0; i < 16; i++)
+                    {
+                        int error = 0;
+                        for (int c = 0; c < 4; c++)
+                        {
+                            const int diff = palette[i][c] - texels[t * 4 + c];
+                            error += diff * diff;
+                        }
+                        if (error < bestError) {
+                            bestError = error;
+                            indices[t] = static_cast<uint8_t>(i);
+                        }
+                    }
+                    totalError += bestError;
+                }
+
+                return totalError;
+            }
+
+            // 비트를 낮은 쪽부터 채웁니다.
+            void writeBits(uint8_t* block, uint32_t& position, uint32_t value, uint32_t count)
+            {
+                for (uint32_t i = 0; i < count; i++, position++)
+                {
+                    if ((value >> i) & 1) {
+                        block[position >> 3] |= static_cast<uint8_t>(1u << (position & 7));
+                    }
+                }
+            }
+        }
+
+        void encodeBC1Block(const uint8_t texels[64], uint8_t block[8])
+        {
+            float points[16][3];
+            bool transparent = false;
+            for (int i = 0; i < 16; i++)
+            {
+                for (int c = 0; c < 3; c++)
+                {
+                    points[i][c] = texels[i * 4 + c];
+                }
+                transparent |= texels[i * 4 + 3] < 128;
+            }
+
+            float endpoint0[3], endpoint1[3];
+            fitEndpoints(points, endpoint0, endpoint1);
+
+            uint16_t color0 = packRGB565(endpoint1);
+            uint16_t color1 = packRGB565(endpoint0);
+
+            // color0 > color1이면 4색, color0 <= color1이면 3색 + 투명
+            if ((color0 < color1) != transparent) {
+                std::swap(color0, color1);
+            }
+
+            int palette[4][3];
+            unpackRGB565(color0, palette[0]);
+            unpackRGB565(color1, palette[1]);
+            const bool fourColor = color0 > color1;
+            for (int c = 0; c < 3; c++)
+            {
+                if (fourColor) {
+                    palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+                    palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+                }
+                else {
+                    palette[2][c] = (palette[0][c] + palette[1][c]) / 2;
+                    palette[3][c] = 0;
+                }
+            }
+
+            uint32_t indices = 0;
+            for (int i = 0; i < 16; i++)
+            {
+                uint32_t best = 0;
+                if (!fourColor && texels[i * 4 + 3] < 128) {
+                    best = 3;
+                }
+                else {
+                    int bestError = INT_MAX;
+                    const uint32_t candidates = fourColor ? 4 : 3;
+                    for (uint32_t p = 0; p < candidates; p++)
+                    {
+                        int error = 0;
+                        for (int c = 0; c < 3; c++)
+                        {
+                            const int diff = palette[p][c] - texels[i * 4 + c];
+                            error += diff * diff;
+                        }
+                        if (error < bestError) {
+                            bestError = error;
+                            best = p;
+                        }
+                    }
+                }
+                indices |= best << (i * 2);
+            }
+
+            block[0] = static_cast<uint8_t>(color0 & 0xFF);
+            block[1] = static_cast<uint8_t>(color0 >> 8);
+            block[2] = static_cast<uint8_t>(color1 & 0xFF);
+            block[3] = static_cast<uint8_t>(color1 >> 8);
+            memcpy(block + 4, &indices, sizeof(indices));
+        }
+
+        void encodeBC7Block(const uint8_t texels[64], uint8_t block[16])
+        {
+            float points[16][4];
+            for (int i = 0; i < 16; i++)
+            {
+                for (int c = 0; c < 4; c++)
+                {
+                    points[i][c] = texels[i * 4 + c];
+                }
+            }
+
+            float endpoint0[4], endpoint1[4];
+            fitEndpoints(points, endpoint0, endpoint1);
+
+            BC7Endpoints endpoints;
+            uint8_t indices[16];
+            quantizeBC7(endpoint0, endpoint1, endpoints);
+            int error = selectBC7Indices(texels, endpoints, indices);
+
+            // 고른 인덱스의 가중치로 끝점을 최소 제곱 보정합니다. -> 오차가 줄어들 때만 사용
+            float a = 0.0f, b = 0.0f, c = 0.0f;
+            float rhs0[4] = {}, rhs1[4] = {};
+            for (int i = 0; i < 16; i++)
+            {
+                const float w = static_cast<float>(BC7_WEIGHTS[indices[i]]) / 64.0f;
+                a += (1.0f - w) * (1.0f - w);
+                b += (1.0f - w) * w;
+                c += w * w;
+                for (int ch = 0; ch < 4; ch++)
+                {
+                    rhs0[ch] += (1.0f - w) * points[i][ch];
+                    rhs1[ch] += w * points[i][ch];
+                }
+            }
+
+            const float determinant = a * c - b * b;
+            if (std::fabs(determinant) > 1e-6f) {
+                for (int ch = 0; ch < 4; ch++)
+                {
+                    endpoint0[ch] = std::min(std::max((c * rhs0[ch] - b * rhs1[ch]) / determinant, 0.0f), 255.0f);
+                    endpoint1[ch] = std::min(std::max((a * rhs1[ch] - b * rhs0[ch]) / determinant, 0.0f), 255.0f);
+                }
+
+                BC7Endpoints refined;
+                uint8_t refinedIndices[16];
+                quantizeBC7(endpoint0, endpoint1, refined);
+                const int refinedError = selectBC7Indices(texels, refined, refinedIndices);
+
+                if (refinedError < error) {
+                    error = refinedError;
+                    endpoints = refined;
+                    memcpy(indices, refinedIndices, sizeof(indices));
+                }
+            }
+
+            // 첫 텍셀(앵커)의 인덱스는 최상위 비트가 0이어야 합니다. -> 끝점을 바꾸고 인덱스를 뒤집습니다.
+            if (indices[0] >= 8) {
+                std::swap(endpoints.quantized[0], endpoints.quantized[1]);
+                std::swap(endpoints.pbit[0], endpoints.pbit[1]);
+                for (uint8_t& index : indices)
+                {
+                    index = static_cast<uint8_t>(15 - index);
+                }
+            }
+
+            memset(block, 0, 16);
+            uint32_t position = 0;
+
+            writeBits(block, position, 1u << 6, 7);                     // 모드 6
+            for (int ch = 0; ch < 4; ch++)
+            {
+                writeBits(block, position, static_cast<uint32_t>(endpoints.quantized[0][ch]), 7);
+                writeBits(block, position, static_cast<uint32_t>(endpoints.quantized[1][ch]), 7);
+            }
+            writeBits(block, position, static_cast<uint32_t>(endpoints.pbit[0]), 1);
+            writeBits(block, position, static_cast<uint32_t>(endpoints.pbit[1]), 1);
+
+            writeBits(block, position, indices[0], 3);
+            for (int i = 1; i < 16; i++)
+            {
+                writeBits(block, position, indices[i], 4);
+            }
+        }
+
+        std::vector<uint8_t> compressImage(const uint8_t* pixels, uint32_t width, uint32_t height, VKTextureFormat format, job::VKJobSystem* jobSystem)
+        {
+            VK_TRACE_SCOPE("compressImage");
+
+            if (format == VKTextureFormat::RGBA8) {
+                return std::vector<uint8_t>(pixels, pixels + static_cast<size_t>(width) * height * 4);
+            }
+
+            const uint32_t blocksX = (width + 3) / 4;
+            const uint32_t blocksY = (height + 3) / 4;
+            const uint32_t blockBytes = (format == VKTextureFormat::BC1) ? 8 : 16;
+
+            std::vector<uint8_t> output(static_cast<size_t>(getLevelSize(format, width, height)));
+
+            auto compressRows = [&](uint32_t begin, uint32_t end) {
+                uint8_t texels[64];
+                for (uint32_t by = begin; by < end; by++)
+                {
+                    for (uint32_t bx = 0; bx < blocksX; bx++)
+                    {
+                        for (uint32_t y = 0; y < 4; y++)
+                        {
+                            const uint32_t sy = std::min(by * 4 + y, height - 1);
+                            for (uint32_t x = 0; x < 4; x++)
+                            {
+                                const uint32_t sx = std::min(bx * 4 + x, width - 1);
+                                memcpy(texels + (y * 4 + x) * 4, pixels + (static_cast<size_t>(sy) * width + sx) * 4, 4);
+                            }
+                        }
+
+                        uint8_t* block = output.data() + (static_cast<size_t>(by) * blocksX + bx) * blockBytes;
+                        if (format == VKTextureFormat::BC1) {
+                            encodeBC1Block(texels, block);
+                        }
+                        else {
+                            encodeBC7Block(texels, block);
+                        }
+                    }
+                }
+            };
+
+            if (jobSystem != nullptr) {
+                jobSystem->parallelFor(blocksY, 4, compressRows);
+            }
+            else {
+                compressRows(0, blocksY);
+            }
+
+            return output;
+        }
+    }
+}
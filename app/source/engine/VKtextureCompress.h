@@ -0,0 +1,25 @@
+﻿#ifndef INCLUDE_VULKANTEXTURECOMPRESS_H_
+#define INCLUDE_VULKANTEXTURECOMPRESS_H_
+
+#include "../_common.h"
+#include "VKtextureFile.h"
+#include "VKmipmap.h"
+#include "VKjobSystem.h"
+
+namespace vkengine {
+    namespace asset {
+
+        // 4x4 블록(행 순서 RGBA8 16개)을 압축합니다.
+        // BC1: 주성분 축의 양 끝을 끝점으로 씁니다. 알파가 128 미만인 텍셀이 있으면 3색 + 투명 모드
+        // BC7: 모드 6만 씁니다. (서브셋 1개, RGBA 7비트 + p비트 끝점, 4비트 인덱스) -> 주성분 축 + 최소 제곱 보정 1회
+        void encodeBC1Block(const uint8_t texels[64], uint8_t block[8]);
+        void encodeBC7Block(const uint8_t texels[64], uint8_t block[16]);
+
+        // mip 하나를 format으로 압축합니다. (RGBA8이면 복사) -> 크기는 getLevelSize(format, width, height)
+        // 크기가 4의 배수가 아니면 가장자리 텍셀을 반복해서 블록을 채웁니다.
+        // jobSystem이 있으면 블록 행을 나눠 병렬로 압축합니다.
+        std::vector<uint8_t> compressImage(const uint8_t* pixels, uint32_t width, uint32_t height, VKTextureFormat format, job::VKJobSystem* jobSystem = nullptr);
+    }
+}
+
+#endif // INCLUDE_VULKANTEXTURECOMPRESS_H_
@@ -0,0 +1,192 @@
+﻿#include "VKtextureFile.h"
+
+namespace vkengine {
+    namespace asset {
+
+        namespace {
+            uint64_t alignUp(uint64_t value, uint64_t alignment)
+            {
+                return (value + alignment - 1) & ~(alignment - 1);
+            }
+        }
+
+        VkFormat getVkFormat(VKTextureFormat format)
+        {
+            switch (format)
+            {
+            case VKTextureFormat::RGBA8: return VK_FORMAT_R8G8B8A8_SRGB;
+            case VKTextureFormat::BC1: return VK_FORMAT_BC1_RGBA_SRGB_BLOCK;
+            case VKTextureFormat::BC7: return VK_FORMAT_BC7_SRGB_BLOCK;
+            default: return VK_FORMAT_UNDEFINED;
+            }
+        }
+
+        const char* getFormatName(VKTextureFormat format)
+        {
+            switch (format)
+            {
+            case VKTextureFormat::RGBA8: return "rgba8";
+            case VKTextureFormat::BC1: return "bc1";
+            case VKTextureFormat::BC7: return "bc7";
+            default: return "unknown";
+            }
+        }
+
+        uint32_t getBlockDimension(VKTextureFormat format)
+        {
+            return (format == VKTextureFormat::RGBA8) ? 1 : 4;
+        }
+
+        uint64_t getLevelSize(VKTextureFormat format, uint32_t width, uint32_t height)
+        {
+            const uint64_t blocksX = (width + 3) / 4;
+            const uint64_t blocksY = (height + 3) / 4;
+
+            switch (format)
+            {
+            case VKTextureFormat::RGBA8: return static_cast<uint64_t>(width) * height * 4;
+            case VKTextureFormat::BC1: return blocksX * blocksY * 8;
+            case VKTextureFormat::BC7: return blocksX * blocksY * 16;
+            default: return 0;
+            }
+        }
+
+        bool VKTextureFile::open(const std::string& path)
+        {
+            this->close();
+
+            if (!this->mappedFile.open(path)) {
+                return false;
+            }
+
+            const uint64_t fileSize = this->mappedFile.getSize();
+            if (fileSize < sizeof(VKTextureFileHeader)) {
+                this->close();
+                return false;
+            }
+
+            memcpy(&this->header, this->mappedFile.getData(), sizeof(this->header));
+
+            bool valid =
+                this->header.magic == TEXTURE_FILE_MAGIC &&
+                this->header.version == TEXTURE_FILE_VERSION &&
+                this->header.format < static_cast<uint32_t>(VKTextureFormat::Count) &&
+                this->header.width > 0 && this->header.height > 0 &&
+                this->header.levelCount > 0 && this->header.levelCount <= TEXTURE_FILE_MAX_LEVELS;
+
+            // mip 크기는 헤더에 적힌 값을 믿지 않고 형식과 크기로 다시 계산해서 확인합니다.
+            for (uint32_t i = 0; valid && i < this->header.levelCount; i++)
+            {
+                const VKTextureLevel& level = this->header.levels[i];
+                valid =
+                    level.width == std::max(1u, this->header.width >> i) &&
+                    level.height == std::max(1u, this->header.height >> i) &&
+                    level.size == getLevelSize(this->getFormat(), level.width, level.height) &&
+                    level.offset % TEXTURE_FILE_ALIGNMENT == 0 &&
+                    level.offset + level.size <= fileSize;
+            }
+
+            if (!valid) {
+#ifdef DEBUG_
+                printf("[texture file] invalid texture file: %s\n", path.c_str());
+#endif // DEBUG_
+                this->close();
+                return false;
+            }
+
+            return true;
+        }
+
+        bool VKTextureFile::write(const std::string& path, uint64_t sourceHash, VKTextureFormat format, const std::vector<std::vector<uint8_t>>& levels, uint32_t width, uint32_t height)
+        {
+            if (levels.empty() || levels.size() > TEXTURE_FILE_MAX_LEVELS) {
+                return false;
+            }
+
+            VKTextureFileHeader header{};
+            header.magic = TEXTURE_FILE_MAGIC;
+            header.version = TEXTURE_FILE_VERSION;
+            header.sourceHash = sourceHash;
+            header.format = static_cast<uint32_t>(format);
+            header.width = width;
+            header.height = height;
+            header.levelCount = static_cast<uint32_t>(levels.size());
+
+            uint64_t offset = alignUp(sizeof(VKTextureFileHeader), TEXTURE_FILE_ALIGNMENT);
+            for (uint32_t i = 0; i < header.levelCount; i++)
+            {
+                VKTextureLevel& level = header.levels[i];
+                level.width = std::max(1u, width >> i);
+                level.height = std::max(1u, height >> i);
+                level.size = getLevelSize(format, level.width, level.height);
+                level.offset = offset;
+
+                if (levels[i].size() != level.size) {
+                    return false;
+                }
+                offset = alignUp(offset + level.size, TEXTURE_FILE_ALIGNMENT);
+            }
+
+            // 쓰는 도중 종료되어도 깨진 파일이 남지 않도록 임시 파일에 쓴 뒤 교체합니다.
+            const std::string tempPath = path + ".tmp";
+            {
+                std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+                if (!file.is_open()) {
+                    return false;
+                }
+
+                const char padding[TEXTURE_FILE_ALIGNMENT] = {};
+                uint64_t written = sizeof(header);
+
+                file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+                for (uint32_t i = 0; i < header.levelCount; i++)
+                {
+                    file.write(padding, static_cast<std::streamsize>(header.levels[i].offset - written));
+                    file.write(reinterpret_cast<const char*>(levels[i].data()), static_cast<std::streamsize>(levels[i].size()));
+                    written = header.levels[i].offset + header.levels[i].size;
+                }
+
+                if (!file.good()) {
+                    file.close();
+                    std::remove(tempPath.c_str());
+                    return false;
+                }
+            }
+
+            std::remove(path.c_str());
+            if (std::rename(tempPath.c_str(), path.c_str()) != 0) {
+                std::remove(tempPath.c_str());
+                return false;
+            }
+
+            return true;
+        }
+
+        bool VKTextureFile::readHeader(const std::string& path, VKTextureFileHeader& header)
+        {
+            std::ifstream file(path, std::ios::binary);
+            if (!file.is_open()) {
+                return false;
+            }
+
+            file.read(reinterpret_cast<char*>(&header), sizeof(header));
+            return file.good() && header.magic == TEXTURE_FILE_MAGIC && header.version == TEXTURE_FILE_VERSION;
+        }
+
+        uint64_t VKTextureFile::getDataSize() const
+        {
+            uint64_t size = 0;
+            for (uint32_t i = 0; i < this->header.levelCount; i++)
+            {
+                size += this->header.levels[i].size;
+            }
+            return size;
+        }
+
+        void VKTextureFile::close()
+        {
+            this->mappedFile.close();
+            this->header = VKTextureFileHeader{};
+        }
+    }
+}
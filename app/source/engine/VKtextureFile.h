@@ -0,0 +1,87 @@
+﻿#ifndef INCLUDE_VULKANTEXTUREFILE_H_
+#define INCLUDE_VULKANTEXTUREFILE_H_
+
+#include "../_common.h"
+#include "VKmeshCache.h"
+
+namespace vkengine {
+    namespace asset {
+
+        constexpr uint32_t TEXTURE_FILE_MAGIC = 0x58544B56;      // "VKTX"
+        constexpr uint32_t TEXTURE_FILE_VERSION = 1;            // 레이아웃이나 인코더 출력이 바뀌면 올립니다.
+        constexpr uint64_t TEXTURE_FILE_ALIGNMENT = 16;         // mip 데이터 정렬 -> 블록 크기(8/16)와 스테이징 오프셋 정렬
+        constexpr uint32_t TEXTURE_FILE_MAX_LEVELS = 16;        // 32768 x 32768까지
+        constexpr const char* TEXTURE_FILE_EXTENSION = ".vktex"; // 원본 경로 뒤에 붙입니다. (viking_room.png.vktex)
+
+        // 저장된 픽셀 형식 -> 모두 sRGB
+        enum class VKTextureFormat : uint32_t {
+            RGBA8 = 0,                                          // 압축 없음, 텍셀당 4바이트
+            BC1 = 1,                                            // 4x4 블록당 8바이트 (RGB + 1비트 알파), RGBA8의 1/8
+            BC7 = 2,                                            // 4x4 블록당 16바이트 (RGBA), RGBA8의 1/4
+            Count,
+        };
+
+        struct VKTextureLevel {
+            uint64_t offset;                                    // 파일 시작 기준
+            uint64_t size;
+            uint32_t width;
+            uint32_t height;
+        };
+
+        // 텍스처 파일 헤더 (KTX2처럼 mip 목록이 앞에 있고 mip 데이터가 이어집니다.)
+        // mip 데이터는 빈틈 없는 (블록) 행이라 그대로 스테이징 링에 복사할 수 있습니다.
+        struct VKTextureFileHeader {
+            uint32_t magic;
+            uint32_t version;
+            uint64_t sourceHash;                                // 원본 이미지 파일 내용의 해시 -> 변환 도구가 바뀌지 않은 파일을 건너뜁니다.
+            uint32_t format;                                    // VKTextureFormat
+            uint32_t width;
+            uint32_t height;
+            uint32_t levelCount;
+            VKTextureLevel levels[TEXTURE_FILE_MAX_LEVELS];
+        };
+
+        VkFormat getVkFormat(VKTextureFormat format);
+        const char* getFormatName(VKTextureFormat format);
+
+        // 압축 형식의 블록 크기 (압축 없음은 1)
+        uint32_t getBlockDimension(VKTextureFormat format);
+
+        // width x height mip 하나의 바이트 수
+        uint64_t getLevelSize(VKTextureFormat format, uint32_t width, uint32_t height);
+
+        // 변환 도구(textureCompiler)가 만든 텍스처 파일을 읽기 전용으로 매핑합니다.
+        // 디코딩이 없으므로 mip 데이터를 그대로 스테이징 링에 복사하면 됩니다.
+        class VKTextureFile {
+        public:
+            VKTextureFile() = default;
+
+            VKTextureFile(const VKTextureFile&) = delete;
+            VKTextureFile& operator=(const VKTextureFile&) = delete;
+
+            // 파일을 매핑합니다. 헤더/버전/mip 크기가 맞지 않으면 false
+            bool open(const std::string& path);
+
+            // mip 배열을 텍스처 파일로 씁니다. (임시 파일에 쓴 뒤 교체)
+            static bool write(const std::string& path, uint64_t sourceHash, VKTextureFormat format, const std::vector<std::vector<uint8_t>>& levels, uint32_t width, uint32_t height);
+
+            // 헤더만 읽습니다. -> 변환 도구가 원본이 바뀌었는지 확인할 때 사용
+            static bool readHeader(const std::string& path, VKTextureFileHeader& header);
+
+            const VKTextureFileHeader& getHeader() const { return this->header; }
+            VKTextureFormat getFormat() const { return static_cast<VKTextureFormat>(this->header.format); }
+            const uint8_t* getLevelData(uint32_t level) const { return this->mappedFile.getData() + this->header.levels[level].offset; }
+
+            // 모든 mip의 바이트 수
+            uint64_t getDataSize() const;
+
+            void close();
+
+        private:
+            VKMappedFile mappedFile;
+            VKTextureFileHeader header{};
+        };
+    }
+}
+
+#endif // INCLUDE_VULKANTEXTUREFILE_H_
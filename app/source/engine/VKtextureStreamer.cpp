@@ -0,0 +1,377 @@
+﻿#include "VKtextureStreamer.h"
+#include "VKtrace.h"
+
+#include "../../include/common/stb_image.h"
+
+#include <cmath>
+
+using namespace vkutil;
+
+namespace vkengine {
+    namespace asset {
+
+        VKTextureStreamer::VKTextureStreamer(VkPhysicalDevice physicalDevice, VkDevice device, memory::VKMemoryAllocator* allocator, memory::VKStagingRing* stagingRing,
+            bool textureCompressionBC, uint32_t decodeThreadCount)
+        {
+            this->VKdevice = device;
+            this->VKallocator = allocator;
+            this->VKstagingRing = stagingRing;
+
+            // 밉맵은 blit(선형 필터)으로 만듭니다. -> 지원하지 않으면 디코딩 스레드에서 CPU로 만들어 모든 mip을 올립니다.
+            VkFormatProperties formatProperties;
+            vkGetPhysicalDeviceFormatProperties(physicalDevice, VK_FORMAT_R8G8B8A8_SRGB, &formatProperties);
+            this->linearBlit = (formatProperties.optimalTilingFeatures & VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT) != 0;
+
+            // 블록 압축 형식은 textureCompressionBC 기능이 켜져 있고 형식이 샘플링을 지원할 때만 텍스처 파일을 씁니다.
+            // -> 기능 없이 BC 이미지를 만들면 안 되므로 이때는 원본을 디코딩해서 RGBA8로 올립니다.
+            for (uint32_t i = 0; i < static_cast<uint32_t>(VKTextureFormat::Count); i++)
+            {
+                const VKTextureFormat format = static_cast<VKTextureFormat>(i);
+                if (getBlockDimension(format) > 1 && !textureCompressionBC) {
+                    this->supportedFormats[i] = false;
+                    continue;
+                }
+
+                vkGetPhysicalDeviceFormatProperties(physicalDevice, getVkFormat(format), &formatProperties);
+                this->supportedFormats[i] = (formatProperties.optimalTilingFeatures & VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT) != 0;
+            }
+
+            this->createPlaceholder();
+
+            if (decodeThreadCount == 0) {
+                decodeThreadCount = TEXTURE_DECODE_THREADS;
+            }
+
+            this->workers.reserve(decodeThreadCount);
+            for (uint32_t i = 0; i < decodeThreadCount; i++) {
+                this->workers.emplace_back(&VKTextureStreamer::decodeLoop, this);
+            }
+        }
+
+        VKTextureStreamer::~VKTextureStreamer()
+        {
+            this->cleanup();
+        }
+
+        VKTextureHandle VKTextureStreamer::request(const std::string& path)
+        {
+            const VKTextureHandle handle = static_cast<VKTextureHandle>(this->textures.size());
+
+            VKStreamedTexture texture{};
+            texture.path = path;
+            this->textures.push_back(texture);
+
+            {
+                std::lock_guard<std::mutex> lock(this->mutex);
+                this->requests.emplace_back(handle, path);
+            }
+            this->requestCondition.notify_one();
+
+            return handle;
+        }
+
+        uint32_t VKTextureStreamer::update(VkCommandBuffer commandBuffer, uint32_t frameIndex)
+        {
+            VK_TRACE_SCOPE("texture upload");
+
+            // 이 슬롯의 펜스를 기다렸으므로 지난번 이 슬롯에서 기록한 업로드와 밉맵은 끝났습니다.
+            uint32_t residentCount = 0;
+            for (VKStreamedTexture& texture : this->textures)
+            {
+                if (texture.state == VKTextureState::Uploading && texture.frameIndex == frameIndex) {
+                    texture.state = VKTextureState::Resident;
+                    residentCount++;
+                }
+            }
+
+            // 예산만큼 디코딩 결과를 꺼냅니다. (큰 이미지 하나는 예산을 넘어도 올림)
+            std::vector<VKDecodedImage> ready;
+            {
+                std::lock_guard<std::mutex> lock(this->mutex);
+
+                VkDeviceSize bytes = 0;
+                while (!this->decoded.empty() && bytes < TEXTURE_UPLOAD_BUDGET) {
+                    bytes += this->decoded.front().getUploadSize();
+                    ready.push_back(std::move(this->decoded.front()));
+                    this->decoded.pop_front();
+                }
+            }
+
+            if (ready.empty()) {
+                return residentCount;
+            }
+            this->spaceCondition.notify_all();
+
+            for (const VKDecodedImage& image : ready)
+            {
+                VKStreamedTexture& texture = this->textures[image.handle];
+
+                if (image.pixels == nullptr && image.file == nullptr) {
+                    texture.state = VKTextureState::Failed;
+#ifdef DEBUG_
+                    printf("[texture streamer] failed to load %s\n", texture.path.c_str());
+#endif // DEBUG_
+                    continue;
+                }
+
+                texture.width = image.width;
+                texture.height = image.height;
+
+                if (image.file != nullptr) {
+                    this->uploadFile(texture, *image.file);
+                }
+                else {
+                    this->uploadPixels(texture, commandBuffer, image);
+                    stbi_image_free(image.pixels);
+                }
+
+                texture.state = VKTextureState::Uploading;
+                texture.frameIndex = frameIndex;
+
+#ifdef DEBUG_
+                printf("[texture streamer] %s (%ux%u, %u mips, %s) uploading\n", texture.path.c_str(), texture.width, texture.height, texture.mipLevels,
+                    (image.file != nullptr) ? getFormatName(image.file->getFormat()) : "decoded");
+#endif // DEBUG_
+            }
+
+            return residentCount;
+        }
+
+        VkImageView VKTextureStreamer::getImageView(VKTextureHandle handle) const
+        {
+            const VKStreamedTexture& texture = this->textures[handle];
+            return (texture.state == VKTextureState::Resident) ? texture.view : this->placeholder.view;
+        }
+
+        uint32_t VKTextureStreamer::getPendingCount() const
+        {
+            uint32_t count = 0;
+            for (const VKStreamedTexture& texture : this->textures)
+            {
+                if (texture.state == VKTextureState::Queued || texture.state == VKTextureState::Uploading) {
+                    count++;
+                }
+            }
+            return count;
+        }
+
+        void VKTextureStreamer::decodeLoop()
+        {
+            VK_TRACE_THREAD_NAME("texture decode");
+
+            while (true) {
+                std::pair<VKTextureHandle, std::string> request;
+                {
+                    std::unique_lock<std::mutex> lock(this->mutex);
+                    this->requestCondition.wait(lock, [this] { return this->stopping || !this->requests.empty(); });
+
+                    if (this->stopping) {
+                        return;
+                    }
+
+                    request = this->requests.front();
+                    this->requests.pop_front();
+                }
+
+                VKDecodedImage image{};
+                image.handle = request.first;
+
+                // 변환된 텍스처 파일이 있으면 매핑만 합니다.
+                std::unique_ptr<VKTextureFile> file = std::make_unique<VKTextureFile>();
+                if (file->open(request.second + TEXTURE_FILE_EXTENSION) && this->supportedFormats[file->getHeader().format]) {
+                    image.width = file->getHeader().width;
+                    image.height = file->getHeader().height;
+                    image.file = std::move(file);
+                }
+                else {
+                    VK_TRACE_SCOPE("stbi_load");
+
+                    int width = 0, height = 0, channels = 0;
+                    image.pixels = stbi_load(request.second.c_str(), &width, &height, &channels, STBI_rgb_alpha);
+                    image.width = static_cast<uint32_t>(width);
+                    image.height = static_cast<uint32_t>(height);
+
+                    // 디코딩 스레드는 작업 시스템 밖이므로 한 스레드로 만듭니다. (텍스처끼리는 디코딩 스레드 수만큼 병렬)
+                    if (!this->linearBlit && image.pixels != nullptr) {
+                        image.mips = generateMipLevels(image.pixels, image.width, image.height, VKMipFilter::Box);
+                    }
+                }
+
+                // 업로드가 밀려 있으면 풀린 이미지가 메모리에 쌓이지 않도록 기다립니다.
+                std::unique_lock<std::mutex> lock(this->mutex);
+                this->spaceCondition.wait(lock, [this] { return this->stopping || this->decoded.size() < TEXTURE_STREAM_QUEUE_DEPTH; });
+
+                if (this->stopping) {
+                    stbi_image_free(image.pixels);
+                    return;
+                }
+
+                this->decoded.push_back(std::move(image));
+            }
+        }
+
+        VkDeviceSize VKTextureStreamer::VKDecodedImage::getUploadSize() const
+        {
+            if (this->file != nullptr) {
+                return this->file->getDataSize();
+            }
+
+            VkDeviceSize size = static_cast<VkDeviceSize>(this->width) * this->height * 4;
+            for (const VKImageRGBA8& mip : this->mips)
+            {
+                size += mip.pixels.size();
+            }
+            return size;
+        }
+
+        void VKTextureStreamer::createPlaceholder()
+        {
+            const uint8_t pixel[4] = { 128, 128, 128, 255 };
+
+            this->placeholder.path = "placeholder";
+            this->placeholder.width = 1;
+            this->placeholder.height = 1;
+            this->placeholder.mipLevels = 1;
+
+            this->createImage(this->placeholder, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT);
+            this->VKstagingRing->uploadImage(this->placeholder.image, pixel, sizeof(pixel), 1, 1, 1, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+            this->placeholder.state = VKTextureState::Resident;
+        }
+
+        void VKTextureStreamer::createImage(VKStreamedTexture& texture, VkFormat format, VkImageUsageFlags usage)
+        {
+            helper_::createImage(
+                this->VKallocator,
+                texture.width,
+                texture.height,
+                texture.mipLevels,
+                VK_SAMPLE_COUNT_1_BIT,
+                format,
+                VK_IMAGE_TILING_OPTIMAL,
+                usage,
+                VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+                texture.image,
+                texture.memory);
+
+            texture.view = helper_::createImageView(
+                this->VKdevice,
+                texture.image,
+                format,
+                VK_IMAGE_ASPECT_COLOR_BIT,
+                texture.mipLevels);
+        }
+
+        void VKTextureStreamer::uploadPixels(VKStreamedTexture& texture, VkCommandBuffer commandBuffer, const VKDecodedImage& image)
+        {
+            // CPU에서 만든 mip이 있으면 모두 복사만 합니다.
+            if (!image.mips.empty()) {
+                texture.mipLevels = static_cast<uint32_t>(image.mips.size()) + 1;
+
+                this->createImage(texture, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT);
+
+                std::vector<memory::VKImageLevel> levels(texture.mipLevels);
+                levels[0].data = image.pixels;
+                levels[0].size = static_cast<VkDeviceSize>(image.width) * image.height * 4;
+                levels[0].width = image.width;
+                levels[0].height = image.height;
+                for (uint32_t i = 1; i < texture.mipLevels; i++)
+                {
+                    const VKImageRGBA8& mip = image.mips[i - 1];
+                    levels[i].data = mip.pixels.data();
+                    levels[i].size = mip.pixels.size();
+                    levels[i].width = mip.width;
+                    levels[i].height = mip.height;
+                }
+
+                this->VKstagingRing->uploadImageLevels(texture.image, levels.data(), texture.mipLevels, 1, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+                return;
+            }
+
+            texture.mipLevels = this->linearBlit
+                ? static_cast<uint32_t>(std::floor(std::log2(std::max(image.width, image.height)))) + 1
+                : 1;
+
+            this->createImage(texture, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT);
+
+            // 밉맵을 만들 이미지는 TRANSFER_DST로 두고, mip이 1개면 바로 셰이더에서 읽을 수 있게 전환합니다.
+            this->VKstagingRing->uploadImage(
+                texture.image,
+                image.pixels,
+                image.getUploadSize(),
+                texture.width,
+                texture.height,
+                texture.mipLevels,
+                (texture.mipLevels > 1) ? VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL : VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+
+            // 업로드는 같은 큐(또는 소유권을 넘겨받는 큐)에 이 프레임보다 먼저 제출되므로 바로 밉맵을 기록합니다.
+            if (texture.mipLevels > 1) {
+                helper_::recordMipmaps(commandBuffer, texture.image,
+                    static_cast<int32_t>(texture.width), static_cast<int32_t>(texture.height), texture.mipLevels);
+            }
+        }
+
+        void VKTextureStreamer::uploadFile(VKStreamedTexture& texture, const VKTextureFile& file)
+        {
+            const VKTextureFileHeader& header = file.getHeader();
+            texture.mipLevels = header.levelCount;
+
+            this->createImage(texture, getVkFormat(file.getFormat()), VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT);
+
+            // 모든 mip이 파일에 있으므로 복사만 하고 바로 셰이더에서 읽을 수 있게 전환합니다.
+            memory::VKImageLevel levels[TEXTURE_FILE_MAX_LEVELS];
+            for (uint32_t i = 0; i < header.levelCount; i++)
+            {
+                levels[i].data = file.getLevelData(i);
+                levels[i].size = header.levels[i].size;
+                levels[i].width = header.levels[i].width;
+                levels[i].height = header.levels[i].height;
+            }
+
+            this->VKstagingRing->uploadImageLevels(texture.image, levels, header.levelCount, getBlockDimension(file.getFormat()), VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+        }
+
+        void VKTextureStreamer::destroyTexture(VKStreamedTexture& texture)
+        {
+            if (texture.view != VK_NULL_HANDLE) {
+                vkDestroyImageView(this->VKdevice, texture.view, nullptr);
+                texture.view = VK_NULL_HANDLE;
+            }
+            if (texture.image != VK_NULL_HANDLE) {
+                this->VKallocator->destroyImage(texture.image, texture.memory);
+            }
+        }
+
+        void VKTextureStreamer::cleanup()
+        {
+            if (this->VKdevice == VK_NULL_HANDLE) {
+                return;
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(this->mutex);
+                this->stopping = true;
+            }
+            this->requestCondition.notify_all();
+            this->spaceCondition.notify_all();
+
+            for (std::thread& worker : this->workers) {
+                worker.join();
+            }
+            this->workers.clear();
+
+            for (VKDecodedImage& image : this->decoded) {
+                stbi_image_free(image.pixels);
+            }
+            this->decoded.clear();
+            this->requests.clear();
+
+            for (VKStreamedTexture& texture : this->textures) {
+                this->destroyTexture(texture);
+            }
+            this->textures.clear();
+            this->destroyTexture(this->placeholder);
+
+            this->VKdevice = VK_NULL_HANDLE;
+        }
+    }
+}
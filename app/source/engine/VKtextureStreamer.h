@@ -0,0 +1,119 @@
+﻿#ifndef INCLUDE_VULKANTEXTURESTREAMER_H_
+#define INCLUDE_VULKANTEXTURESTREAMER_H_
+
+#include "../_common.h"
+#include "VKallocator.h"
+#include "VKstaging.h"
+#include "VKtextureFile.h"
+#include "VKmipmap.h"
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+namespace vkengine {
+    namespace asset {
+
+        constexpr uint32_t TEXTURE_DECODE_THREADS = 2;                      // 이미지 디코딩 스레드 수
+        constexpr uint32_t TEXTURE_STREAM_QUEUE_DEPTH = 4;                  // 업로드를 기다리는 디코딩 결과 최대 수 -> 가득 차면 디코딩 스레드가 기다림
+        constexpr VkDeviceSize TEXTURE_UPLOAD_BUDGET = 16ull * 1024 * 1024; // 프레임마다 스테이징 링에 올릴 최대 바이트 (최소 1장)
+
+        using VKTextureHandle = uint32_t;
+
+        enum class VKTextureState {
+            Queued,                                                 // 디코딩 대기 또는 디코딩 중
+            Uploading,                                              // 업로드와 밉맵 생성을 기록함 -> 그 프레임 슬롯의 펜스를 기다리면 Resident
+            Resident,
+            Failed,                                                 // 읽지 못함 -> 계속 자리 표시 텍스처를 씁니다.
+        };
+
+        // 비동기 텍스처 스트리밍
+        // request()는 바로 반환하고, 디코딩 스레드가 stb_image로 파일을 풉니다.
+        // 풀린 이미지는 크기가 정해진 큐를 거쳐 update()에서 프레임 예산만큼 스테이징 링에 올라가고,
+        // 밉맵은 그 프레임의 커맨드 버퍼에 기록됩니다. 올라오기 전까지 getImageView()는 자리 표시 텍스처를 돌려줍니다.
+        // 원본 옆에 변환 도구가 만든 <경로>.vktex가 있고 디바이스가 그 형식을 지원하면 디코딩 대신 파일을 매핑해서
+        // 미리 만든 mip(블록 압축)을 그대로 복사합니다.
+        // BC 형식은 디바이스를 만들 때 textureCompressionBC 기능을 켰을 때만 쓰고, 아니면 원본을 풀어서 RGBA8로 올립니다.
+        // request/update/getImageView는 렌더링 스레드에서만 부릅니다.
+        class VKTextureStreamer {
+        public:
+            // textureCompressionBC: 디바이스 생성 때 켠 VkPhysicalDeviceFeatures::textureCompressionBC
+            VKTextureStreamer(VkPhysicalDevice physicalDevice, VkDevice device, memory::VKMemoryAllocator* allocator, memory::VKStagingRing* stagingRing,
+                bool textureCompressionBC, uint32_t decodeThreadCount = TEXTURE_DECODE_THREADS);
+            ~VKTextureStreamer();
+
+            VKTextureStreamer(const VKTextureStreamer&) = delete;
+            VKTextureStreamer& operator=(const VKTextureStreamer&) = delete;
+
+            // 디코딩을 예약하고 핸들을 돌려줍니다. (sRGB RGBA8 또는 <path>.vktex의 형식)
+            VKTextureHandle request(const std::string& path);
+
+            // frameIndex 슬롯의 펜스를 기다린 뒤, 커맨드 버퍼를 시작하고 렌더 패스 전에 호출합니다.
+            // 이 슬롯에서 지난번 밉맵을 기록한 텍스처를 Resident로 바꾸고, 디코딩이 끝난 이미지를 올립니다.
+            // 이번에 Resident가 된 텍스처 수를 돌려줍니다.
+            uint32_t update(VkCommandBuffer commandBuffer, uint32_t frameIndex);
+
+            // Resident가 아니면 자리 표시 텍스처의 뷰
+            VkImageView getImageView(VKTextureHandle handle) const;
+            VKTextureState getState(VKTextureHandle handle) const { return this->textures[handle].state; }
+            bool isResident(VKTextureHandle handle) const { return this->textures[handle].state == VKTextureState::Resident; }
+
+            // 아직 Resident가 아닌 텍스처 수
+            uint32_t getPendingCount() const;
+
+            // 디코딩 스레드를 멈추고 모든 이미지를 해제합니다. -> GPU가 쓰지 않을 때 (vkDeviceWaitIdle 뒤) 호출
+            void cleanup();
+
+        private:
+            struct VKStreamedTexture {
+                std::string path;
+                VKTextureState state = VKTextureState::Queued;
+                VkImage image = VK_NULL_HANDLE;
+                memory::VKAllocation memory{};
+                VkImageView view = VK_NULL_HANDLE;
+                uint32_t width = 0;
+                uint32_t height = 0;
+                uint32_t mipLevels = 1;
+                uint32_t frameIndex = 0;                            // 밉맵을 기록한 프레임 슬롯
+            };
+
+            struct VKDecodedImage {
+                VKTextureHandle handle = 0;
+                uint8_t* pixels = nullptr;                          // stbi_load 결과 (RGBA8), 실패하면 nullptr
+                std::unique_ptr<VKTextureFile> file;                // 매핑한 텍스처 파일 -> 있으면 pixels 대신 사용
+                std::vector<VKImageRGBA8> mips;                     // blit을 못 쓸 때 CPU에서 만든 mip 1..n
+                uint32_t width = 0;
+                uint32_t height = 0;
+
+                VkDeviceSize getUploadSize() const;
+            };
+
+            void decodeLoop();
+            void createPlaceholder();
+            void createImage(VKStreamedTexture& texture, VkFormat format, VkImageUsageFlags usage);
+            void uploadPixels(VKStreamedTexture& texture, VkCommandBuffer commandBuffer, const VKDecodedImage& image);
+            void uploadFile(VKStreamedTexture& texture, const VKTextureFile& file);
+            void destroyTexture(VKStreamedTexture& texture);
+
+            VkDevice VKdevice = VK_NULL_HANDLE;
+            memory::VKMemoryAllocator* VKallocator = nullptr;
+            memory::VKStagingRing* VKstagingRing = nullptr;
+            bool linearBlit = false;                                // 밉맵 blit을 지원하는지 -> 아니면 디코딩 스레드에서 CPU로 만듭니다.
+            bool supportedFormats[static_cast<uint32_t>(VKTextureFormat::Count)] = {}; // 텍스처 파일 형식별 샘플링 지원 여부
+
+            VKStreamedTexture placeholder;                          // 1x1 회색
+            std::vector<VKStreamedTexture> textures;                // 핸들 = 인덱스 (렌더링 스레드만 접근)
+
+            std::vector<std::thread> workers;
+            std::mutex mutex;
+            std::condition_variable requestCondition;               // 요청이 들어옴
+            std::condition_variable spaceCondition;                 // 디코딩 결과 큐에 자리가 남
+            std::deque<std::pair<VKTextureHandle, std::string>> requests;
+            std::deque<VKDecodedImage> decoded;                     // 최대 TEXTURE_STREAM_QUEUE_DEPTH개
+            bool stopping = false;
+        };
+    }
+}
+
+#endif // INCLUDE_VULKANTEXTURESTREAMER_H_
@@ -0,0 +1,108 @@
+﻿#include "VKtrace.h"
+
+#if CPU_TRACE
+
+#include <cstdio>
+#include <memory>
+#include <mutex>
+
+namespace vkengine {
+    namespace trace {
+
+        namespace {
+            const std::chrono::steady_clock::time_point traceEpoch = std::chrono::steady_clock::now();
+
+            // 등록된 모든 스레드 버퍼 -> 잠금은 등록과 내보내기에만 씁니다.
+            std::mutex& getRegistryMutex()
+            {
+                static std::mutex mutex;
+                return mutex;
+            }
+
+            std::vector<std::unique_ptr<VKTraceBuffer>>& getRegistry()
+            {
+                static std::vector<std::unique_ptr<VKTraceBuffer>> buffers;
+                return buffers;
+            }
+
+            thread_local VKTraceBuffer* threadBuffer = nullptr;
+        }
+
+        int64_t now()
+        {
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - traceEpoch).count();
+        }
+
+        VKTraceBuffer& getThreadBuffer()
+        {
+            if (threadBuffer == nullptr) {
+                std::unique_ptr<VKTraceBuffer> buffer = std::make_unique<VKTraceBuffer>();
+
+                std::lock_guard<std::mutex> lock(getRegistryMutex());
+                std::vector<std::unique_ptr<VKTraceBuffer>>& buffers = getRegistry();
+
+                buffer->threadId = static_cast<uint32_t>(buffers.size()) + 1;
+                snprintf(buffer->threadName, CPU_TRACE_THREAD_NAME_LENGTH, "thread %u", buffer->threadId);
+
+                threadBuffer = buffer.get();
+                buffers.push_back(std::move(buffer));
+            }
+            return *threadBuffer;
+        }
+
+        void setThreadName(const char* name)
+        {
+            VKTraceBuffer& buffer = getThreadBuffer();
+
+            std::lock_guard<std::mutex> lock(getRegistryMutex());
+            snprintf(buffer.threadName, CPU_TRACE_THREAD_NAME_LENGTH, "%s", name);
+        }
+
+        bool writeChromeTrace(const std::string& path)
+        {
+            FILE* file = fopen(path.c_str(), "w");
+            if (file == nullptr) {
+#ifdef DEBUG_
+                printf("[trace] failed to open %s\n", path.c_str());
+#endif // DEBUG_
+                return false;
+            }
+
+            std::lock_guard<std::mutex> lock(getRegistryMutex());
+
+            // 완료 이벤트("X")만 씁니다. -> ts, dur 단위는 us
+            fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+            fprintf(file, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"CPU\"}}");
+
+            size_t eventCount = 0;
+            for (const std::unique_ptr<VKTraceBuffer>& buffer : getRegistry())
+            {
+                fprintf(file, ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"%s\"}}",
+                    buffer->threadId, buffer->threadName);
+
+                // 링 버퍼가 한 바퀴 넘게 돌았으면 가장 최근 CPU_TRACE_BUFFER_EVENTS개만 남아 있습니다.
+                const uint64_t writeCount = buffer->writeCount.load(std::memory_order_acquire);
+                const uint64_t first = (writeCount > CPU_TRACE_BUFFER_EVENTS) ? writeCount - CPU_TRACE_BUFFER_EVENTS : 0;
+
+                for (uint64_t i = first; i < writeCount; i++)
+                {
+                    const VKTraceEvent& event = buffer->events[i & (CPU_TRACE_BUFFER_EVENTS - 1)];
+                    fprintf(file, ",\n{\"name\":\"%s\",\"cat\":\"cpu\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}",
+                        event.name, buffer->threadId, static_cast<double>(event.startNs) / 1000.0, static_cast<double>(event.durationNs) / 1000.0);
+                }
+                eventCount += static_cast<size_t>(writeCount - first);
+            }
+
+            fprintf(file, "\n]}\n");
+            fclose(file);
+
+#ifdef DEBUG_
+            printf("[trace] %zu events written to %s\n", eventCount, path.c_str());
+#endif // DEBUG_
+
+            return true;
+        }
+    }
+}
+
+#endif // CPU_TRACE
@@ -0,0 +1,103 @@
+﻿#ifndef INCLUDE_VULKANTRACE_H_
+#define INCLUDE_VULKANTRACE_H_
+
+#include "../_common.h"
+
+// CPU 트레이스 구간
+// VK_TRACE_SCOPE("이름")으로 블록의 시작과 끝 시간을 스레드별 링 버퍼에 남기고, VK_TRACE_WRITE(경로)로 Chrome 트레이스(JSON)를 씁니다.
+// CPU_TRACE가 0이면 (릴리스 빌드 기본값) 매크로가 모두 비어서 코드와 버퍼가 남지 않습니다.
+#if CPU_TRACE
+
+#include <atomic>
+
+namespace vkengine {
+    namespace trace {
+
+        constexpr uint32_t CPU_TRACE_BUFFER_EVENTS = 1u << 14;         // 스레드마다 남길 최근 구간 수 (2의 거듭제곱)
+        constexpr uint32_t CPU_TRACE_THREAD_NAME_LENGTH = 32;
+
+        struct VKTraceEvent {
+            const char* name;                                   // 문자열 리터럴 또는 __FUNCTION__ (복사하지 않음)
+            int64_t startNs;                                    // 프로세스 시작 기준
+            int64_t durationNs;
+        };
+
+        // 스레드 하나의 링 버퍼 -> 쓰기는 그 스레드만 하므로 잠금이 없습니다.
+        // 버퍼는 스레드가 끝나도 해제하지 않아서 워커 스레드를 멈춘 뒤에도 내보낼 수 있습니다.
+        struct VKTraceBuffer {
+            uint32_t threadId = 0;
+            char threadName[CPU_TRACE_THREAD_NAME_LENGTH] = {};
+            std::atomic<uint64_t> writeCount{ 0 };              // 지금까지 쓴 구간 수 -> 위치는 writeCount % CPU_TRACE_BUFFER_EVENTS
+            VKTraceEvent events[CPU_TRACE_BUFFER_EVENTS];
+        };
+
+        // 프로세스 시작 기준 ns
+        int64_t now();
+
+        // 호출한 스레드의 버퍼 -> 처음 부르면 만들어서 등록합니다.
+        VKTraceBuffer& getThreadBuffer();
+
+        // 호출한 스레드의 이름 (트레이스의 thread_name)
+        void setThreadName(const char* name);
+
+        // 모든 스레드 버퍼의 구간을 Chrome 트레이스 형식으로 저장합니다. (chrome://tracing, Perfetto UI)
+        // 기록 중인 스레드가 있으면 가장 오래된 구간 몇 개가 덮어써질 수 있습니다.
+        bool writeChromeTrace(const std::string& path);
+
+        // 블록 범위 구간 -> 소멸자에서 한 번에 완료 이벤트를 씁니다.
+        class VKTraceScope {
+        public:
+            explicit VKTraceScope(const char* name) : name(name), startNs(now()) {}
+            ~VKTraceScope()
+            {
+                VKTraceBuffer& buffer = getThreadBuffer();
+                const uint64_t index = buffer.writeCount.load(std::memory_order_relaxed);
+
+                VKTraceEvent& event = buffer.events[index & (CPU_TRACE_BUFFER_EVENTS - 1)];
+                event.name = this->name;
+                event.startNs = this->startNs;
+                event.durationNs = now() - this->startNs;
+
+                buffer.writeCount.store(index + 1, std::memory_order_release);
+            }
+
+            VKTraceScope(const VKTraceScope&) = delete;
+            VKTraceScope& operator=(const VKTraceScope&) = delete;
+
+        private:
+            const char* name;
+            int64_t startNs;
+        };
+    }
+}
+
+#define VK_TRACE_CONCAT_(a, b) a##b
+#define VK_TRACE_CONCAT(a, b) VK_TRACE_CONCAT_(a, b)
+#define VK_TRACE_SCOPE(name) ::vkengine::trace::VKTraceScope VK_TRACE_CONCAT(traceScope_, __LINE__)(name)
+#define VK_TRACE_FUNCTION() VK_TRACE_SCOPE(__FUNCTION__)
+#define VK_TRACE_THREAD_NAME(name) ::vkengine::trace::setThreadName(name)
+#define VK_TRACE_WRITE(path) ::vkengine::trace::writeChromeTrace(path)
+
+#else
+
+#define VK_TRACE_SCOPE(name) ((void)0)
+#define VK_TRACE_FUNCTION() ((void)0)
+#define VK_TRACE_THREAD_NAME(name) ((void)0)
+#define VK_TRACE_WRITE(path) ::vkengine::trace::writeChromeTrace(path)
+
+namespace vkengine {
+    namespace trace {
+        // 남긴 구간이 없으므로 파일을 쓰지 않습니다. -> 호출하는 쪽은 문장이나 조건식 어디서든 그대로 씁니다.
+        inline bool writeChromeTrace(const std::string&) { return false; }
+    }
+}
+
+#endif // CPU_TRACE
+
+namespace vkengine {
+    namespace trace {
+        constexpr const char* CPU_TRACE_FILE = "cpu_trace.json";  // 실행 경로(RootPath) 기준
+    }
+}
+
+#endif // INCLUDE_VULKANTRACE_H_
@@ -0,0 +1,359 @@
+﻿#include "VKtransform.h"
+#include "VKtrace.h"
+
+#include <cstring>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define VK_TRANSFORM_AVX2 1
+#define VK_TRANSFORM_SSE2 1
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define VK_TRANSFORM_SSE2 1
+#elif defined(__ARM_NEON) || defined(_M_ARM64)
+#include <arm_neon.h>
+#define VK_TRANSFORM_NEON 1
+#endif
+
+namespace vkengine {
+
+    const char* getTransformSimdName()
+    {
+#if defined(VK_TRANSFORM_AVX2)
+        return "avx2";
+#elif defined(VK_TRANSFORM_SSE2)
+        return "sse2";
+#elif defined(VK_TRANSFORM_NEON)
+        return "neon";
+#else
+        return "scalar";
+#endif
+    }
+
+    // 결과 열 c = a의 열 4개를 b[c]의 성분으로 곱해 더한 것 -> 모든 경로가 같은 순서로 더하므로 결과가 비트 단위로 같습니다.
+    void multiplyTransform(const glm::mat4& a, const glm::mat4& b, glm::mat4& out)
+    {
+        const float* pa = &a[0][0];
+        const float* pb = &b[0][0];
+        float* po = &out[0][0];
+
+#if defined(VK_TRANSFORM_AVX2)
+        // 레지스터 하나에 b의 열 2개 -> 128비트 레인 안에서 성분을 퍼뜨립니다.
+        const __m256 a0 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(pa));
+        const __m256 a1 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(pa + 4));
+        const __m256 a2 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(pa + 8));
+        const __m256 a3 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(pa + 12));
+
+        auto columns = [&](__m256 bb) {
+            return _mm256_add_ps(
+                _mm256_add_ps(_mm256_mul_ps(a0, _mm256_permute_ps(bb, 0x00)), _mm256_mul_ps(a1, _mm256_permute_ps(bb, 0x55))),
+                _mm256_add_ps(_mm256_mul_ps(a2, _mm256_permute_ps(bb, 0xAA)), _mm256_mul_ps(a3, _mm256_permute_ps(bb, 0xFF))));
+        };
+
+        const __m256 r01 = columns(_mm256_loadu_ps(pb));
+        const __m256 r23 = columns(_mm256_loadu_ps(pb + 8));
+        _mm256_storeu_ps(po, r01);
+        _mm256_storeu_ps(po + 8, r23);
+#elif defined(VK_TRANSFORM_SSE2)
+        const __m128 a0 = _mm_loadu_ps(pa);
+        const __m128 a1 = _mm_loadu_ps(pa + 4);
+        const __m128 a2 = _mm_loadu_ps(pa + 8);
+        const __m128 a3 = _mm_loadu_ps(pa + 12);
+
+        __m128 result[4];
+        for (int c = 0; c < 4; c++)
+        {
+            const float* column = pb + c * 4;
+            result[c] = _mm_add_ps(
+                _mm_add_ps(_mm_mul_ps(a0, _mm_set1_ps(column[0])), _mm_mul_ps(a1, _mm_set1_ps(column[1]))),
+                _mm_add_ps(_mm_mul_ps(a2, _mm_set1_ps(column[2])), _mm_mul_ps(a3, _mm_set1_ps(column[3]))));
+        }
+
+        for (int c = 0; c < 4; c++)
+        {
+            _mm_storeu_ps(po + c * 4, result[c]);
+        }
+#elif defined(VK_TRANSFORM_NEON)
+        const float32x4_t a0 = vld1q_f32(pa);
+        const float32x4_t a1 = vld1q_f32(pa + 4);
+        const float32x4_t a2 = vld1q_f32(pa + 8);
+        const float32x4_t a3 = vld1q_f32(pa + 12);
+
+        float32x4_t result[4];
+        for (int c = 0; c < 4; c++)
+        {
+            const float* column = pb + c * 4;
+            result[c] = vaddq_f32(
+                vaddq_f32(vmulq_n_f32(a0, column[0]), vmulq_n_f32(a1, column[1])),
+                vaddq_f32(vmulq_n_f32(a2, column[2]), vmulq_n_f32(a3, column[3])));
+        }
+
+        for (int c = 0; c < 4; c++)
+        {
+            vst1q_f32(po + c * 4, result[c]);
+        }
+#else
+        float result[16];
+        for (int c = 0; c < 4; c++)
+        {
+            const float* column = pb + c * 4;
+            for (int r = 0; r < 4; r++)
+            {
+                result[c * 4 + r] = (pa[r] * column[0] + pa[4 + r] * column[1]) + (pa[8 + r] * column[2] + pa[12 + r] * column[3]);
+            }
+        }
+        memcpy(po, result, sizeof(result));
+#endif
+    }
+
+    uint32_t VKTransformHierarchy::createNode(uint32_t parent, const glm::mat4& local)
+    {
+        if (parent != TRANSFORM_NONE && parent >= this->getCount()) {
+            throw std::runtime_error("transform parent does not exist!");
+        }
+
+        const uint32_t node = this->getCount();
+        const uint32_t slot = static_cast<uint32_t>(this->slotNodes.size());
+        const uint32_t parentSlot = (parent != TRANSFORM_NONE) ? this->nodeSlots[parent] : TRANSFORM_NONE;
+
+        this->localMatrices.push_back(local);
+        this->worldMatrices.push_back(local);
+        this->parentSlots.push_back(parentSlot);
+        this->depths.push_back((parentSlot != TRANSFORM_NONE) ? this->depths[parentSlot] + 1 : 0);
+        this->dirtyFlags.push_back(0);
+        this->slotNodes.push_back(node);
+        this->nodeSlots.push_back(slot);
+
+        // 끝에 붙였으므로 깊이 순서와 levelStarts는 update에서 다시 맞춥니다.
+        this->orderDirty = true;
+        this->markDirty(slot);
+        return node;
+    }
+
+    void VKTransformHierarchy::setParent(uint32_t node, uint32_t parent)
+    {
+        const uint32_t slot = this->nodeSlots[node];
+        const uint32_t parentSlot = (parent != TRANSFORM_NONE) ? this->nodeSlots[parent] : TRANSFORM_NONE;
+
+        // 자기 하위 트리 아래로 옮기면 순환이 생깁니다.
+        for (uint32_t ancestor = parentSlot; ancestor != TRANSFORM_NONE; ancestor = this->parentSlots[ancestor])
+        {
+            if (ancestor == slot) {
+                throw std::runtime_error("transform parent would create a cycle!");
+            }
+        }
+
+        this->parentSlots[slot] = parentSlot;
+        this->orderDirty = true;
+        this->markDirty(slot);
+    }
+
+    void VKTransformHierarchy::setLocal(uint32_t node, const glm::mat4& local)
+    {
+        const uint32_t slot = this->nodeSlots[node];
+        this->localMatrices[slot] = local;
+        this->markDirty(slot);
+    }
+
+    uint32_t VKTransformHierarchy::getParent(uint32_t node) const
+    {
+        const uint32_t parentSlot = this->parentSlots[this->nodeSlots[node]];
+        return (parentSlot != TRANSFORM_NONE) ? this->slotNodes[parentSlot] : TRANSFORM_NONE;
+    }
+
+    void VKTransformHierarchy::clear()
+    {
+        this->localMatrices.clear();
+        this->worldMatrices.clear();
+        this->parentSlots.clear();
+        this->depths.clear();
+        this->dirtyFlags.clear();
+        this->slotNodes.clear();
+        this->nodeSlots.clear();
+        this->levelStarts.clear();
+        this->changed.clear();
+        this->firstDirty = TRANSFORM_NONE;
+        this->orderDirty = false;
+    }
+
+    void VKTransformHierarchy::reserve(uint32_t count)
+    {
+        this->localMatrices.reserve(count);
+        this->worldMatrices.reserve(count);
+        this->parentSlots.reserve(count);
+        this->depths.reserve(count);
+        this->dirtyFlags.reserve(count);
+        this->slotNodes.reserve(count);
+        this->nodeSlots.reserve(count);
+    }
+
+    uint32_t VKTransformHierarchy::update(job::VKJobSystem* jobSystem)
+    {
+        this->changed.clear();
+
+        if (this->orderDirty) {
+            this->rebuildOrder();
+        }
+
+        // 바뀐 것이 없으면 아무것도 하지 않습니다.
+        if (this->firstDirty == TRANSFORM_NONE) {
+            return 0;
+        }
+
+        VK_TRACE_SCOPE("VKTransformHierarchy::update");
+
+        const uint32_t count = static_cast<uint32_t>(this->slotNodes.size());
+
+        if (jobSystem == nullptr) {
+            this->updateRange(this->firstDirty, count);
+        }
+        else {
+            // 깊이 하나씩 -> 같은 깊이의 노드는 이전 깊이만 읽으므로 나눠서 계산해도 됩니다.
+            for (uint32_t depth = this->depths[this->firstDirty]; depth + 1 < this->levelStarts.size(); depth++)
+            {
+                const uint32_t begin = std::max(this->levelStarts[depth], this->firstDirty);
+                const uint32_t end = this->levelStarts[depth + 1];
+
+                if (end - begin > TRANSFORM_GRAIN) {
+                    jobSystem->parallelFor(end - begin, TRANSFORM_GRAIN, [this, begin](uint32_t rangeBegin, uint32_t rangeEnd) {
+                        this->updateRange(begin + rangeBegin, begin + rangeEnd);
+                    });
+                }
+                else {
+                    this->updateRange(begin, end);
+                }
+            }
+        }
+
+        // 바뀐 노드를 모으고 플래그를 지웁니다.
+        for (uint32_t slot = this->firstDirty; slot < count; slot++)
+        {
+            if (this->dirtyFlags[slot] != 0) {
+                this->changed.push_back(this->slotNodes[slot]);
+                this->dirtyFlags[slot] = 0;
+            }
+        }
+
+        this->firstDirty = TRANSFORM_NONE;
+        return static_cast<uint32_t>(this->changed.size());
+    }
+
+    void VKTransformHierarchy::markDirty(uint32_t slot)
+    {
+        this->dirtyFlags[slot] = 1;
+        this->firstDirty = (this->firstDirty == TRANSFORM_NONE) ? slot : std::min(this->firstDirty, slot);
+    }
+
+    void VKTransformHierarchy::rebuildOrder()
+    {
+        VK_TRACE_SCOPE("VKTransformHierarchy::rebuildOrder");
+
+        const uint32_t count = static_cast<uint32_t>(this->slotNodes.size());
+
+        // 부모를 바꿨으면 부모가 뒤에 있을 수 있으므로 조상을 따라 올라가며 깊이를 다시 계산합니다.
+        std::vector<uint32_t> newDepths(count, TRANSFORM_NONE);
+        std::vector<uint32_t> chain;
+        for (uint32_t slot = 0; slot < count; slot++)
+        {
+            uint32_t current = slot;
+            while (current != TRANSFORM_NONE && newDepths[current] == TRANSFORM_NONE)
+            {
+                chain.push_back(current);
+                current = this->parentSlots[current];
+            }
+
+            uint32_t depth = (current != TRANSFORM_NONE) ? newDepths[current] + 1 : 0;
+            while (!chain.empty())
+            {
+                newDepths[chain.back()] = depth++;
+                chain.pop_back();
+            }
+        }
+        this->depths.swap(newDepths);
+
+        // 깊이별 개수 -> levelStarts
+        uint32_t maxDepth = 0;
+        for (uint32_t depth : this->depths)
+        {
+            maxDepth = std::max(maxDepth, depth);
+        }
+
+        this->levelStarts.assign(static_cast<size_t>(maxDepth) + 2, 0);
+        for (uint32_t depth : this->depths)
+        {
+            this->levelStarts[depth + 1]++;
+        }
+        for (size_t depth = 1; depth < this->levelStarts.size(); depth++)
+        {
+            this->levelStarts[depth] += this->levelStarts[depth - 1];
+        }
+
+        this->orderDirty = false;
+        if (std::is_sorted(this->depths.begin(), this->depths.end())) {
+            return;
+        }
+
+        // 깊이 순서로 안정 정렬 (계수 정렬) -> 같은 깊이 안에서는 기존 순서를 유지합니다.
+        std::vector<uint32_t> newSlots(count);
+        std::vector<uint32_t> next(this->levelStarts.begin(), this->levelStarts.end() - 1);
+        for (uint32_t slot = 0; slot < count; slot++)
+        {
+            newSlots[slot] = next[this->depths[slot]]++;
+        }
+
+        auto permute = [&](auto& values) {
+            typename std::remove_reference<decltype(values)>::type sorted(values.size());
+            for (uint32_t slot = 0; slot < count; slot++)
+            {
+                sorted[newSlots[slot]] = values[slot];
+            }
+            values.swap(sorted);
+        };
+
+        for (uint32_t& parentSlot : this->parentSlots)
+        {
+            if (parentSlot != TRANSFORM_NONE) {
+                parentSlot = newSlots[parentSlot];
+            }
+        }
+
+        permute(this->localMatrices);
+        permute(this->worldMatrices);
+        permute(this->parentSlots);
+        permute(this->depths);
+        permute(this->dirtyFlags);
+        permute(this->slotNodes);
+
+        this->firstDirty = TRANSFORM_NONE;
+        for (uint32_t slot = 0; slot < count; slot++)
+        {
+            this->nodeSlots[this->slotNodes[slot]] = slot;
+            if (this->dirtyFlags[slot] != 0 && this->firstDirty == TRANSFORM_NONE) {
+                this->firstDirty = slot;
+            }
+        }
+    }
+
+    void VKTransformHierarchy::updateRange(uint32_t begin, uint32_t end)
+    {
+        for (uint32_t slot = begin; slot < end; slot++)
+        {
+            const uint32_t parentSlot = this->parentSlots[slot];
+
+            // 부모가 바뀌었으면 자식도 바뀝니다. (부모는 앞에 있으므로 이미 이번 update의 플래그를 가짐)
+            if (parentSlot != TRANSFORM_NONE && this->dirtyFlags[parentSlot] != 0) {
+                this->dirtyFlags[slot] = 1;
+            }
+            if (this->dirtyFlags[slot] == 0) {
+                continue;
+            }
+
+            if (parentSlot != TRANSFORM_NONE) {
+                multiplyTransform(this->worldMatrices[parentSlot], this->localMatrices[slot], this->worldMatrices[slot]);
+            }
+            else {
+                this->worldMatrices[slot] = this->localMatrices[slot];
+            }
+        }
+    }
+}
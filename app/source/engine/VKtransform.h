@@ -0,0 +1,77 @@
+﻿#ifndef INCLUDE_VULKANTRANSFORM_H_
+#define INCLUDE_VULKANTRANSFORM_H_
+
+#include "../_common.h"
+#include "../struct.h"
+#include "VKjobSystem.h"
+
+namespace vkengine {
+
+    constexpr uint32_t TRANSFORM_NONE = UINT32_MAX;                 // 부모가 없는 노드 (루트)
+    constexpr uint32_t TRANSFORM_GRAIN = 16 * 1024;                 // 깊이 하나의 노드가 이보다 많으면 잡으로 나눠 계산
+
+    // 컴파일된 SIMD 경로 ("avx2", "sse2", "neon", "scalar")
+    const char* getTransformSimdName();
+
+    // out = a * b (열 우선 4x4) -> out이 a나 b와 같아도 됩니다.
+    void multiplyTransform(const glm::mat4& a, const glm::mat4& b, glm::mat4& out);
+
+    // 부모-자식 변환 계층
+    // 노드 데이터는 필드별 배열(로컬 행렬, 월드 행렬, 부모, dirty 플래그)로 두고, 깊이 순서로 정렬해서 부모가 항상 자식보다 앞에 옵니다.
+    // -> update는 앞에서부터 한 번만 지나가며 world = parentWorld * local을 계산하고, 같은 깊이의 노드는 서로 독립이라 잡으로 나눕니다.
+    // setLocal이 dirty 표시를 하고 update가 표시된 노드의 하위 트리만 다시 계산합니다. -> 움직이지 않는 장면은 update 비용이 거의 없습니다.
+    // 노드 번호(createNode 반환값)는 정렬과 상관없이 그대로 유지됩니다.
+    class VKTransformHierarchy {
+    public:
+        // parent 아래에 노드를 만듭니다. -> 노드 번호 (0부터 순서대로)
+        uint32_t createNode(uint32_t parent = TRANSFORM_NONE, const glm::mat4& local = glm::mat4(1.0f));
+
+        // 부모를 바꿉니다. (TRANSFORM_NONE이면 루트) -> 다음 update에서 깊이 순서를 다시 맞춥니다.
+        void setParent(uint32_t node, uint32_t parent);
+
+        // 로컬 변환을 바꾸고 노드를 dirty로 표시합니다.
+        void setLocal(uint32_t node, const glm::mat4& local);
+
+        const glm::mat4& getLocal(uint32_t node) const { return this->localMatrices[this->nodeSlots[node]]; }
+
+        // 마지막 update 기준의 월드 변환
+        const glm::mat4& getWorld(uint32_t node) const { return this->worldMatrices[this->nodeSlots[node]]; }
+
+        uint32_t getParent(uint32_t node) const;
+        uint32_t getCount() const { return static_cast<uint32_t>(this->nodeSlots.size()); }
+        bool isDirty() const { return this->firstDirty != TRANSFORM_NONE || this->orderDirty; }
+
+        // 모든 노드를 지웁니다.
+        void clear();
+
+        // 노드를 많이 만들기 전에 배열을 미리 늘립니다.
+        void reserve(uint32_t count);
+
+        // dirty 노드와 그 하위 트리의 월드 변환을 다시 계산합니다. -> 월드 변환이 바뀐 노드 수
+        uint32_t update(job::VKJobSystem* jobSystem = nullptr);
+
+        // 마지막 update에서 월드 변환이 바뀐 노드 번호 (깊이 순서) -> 이 노드들만 GPU로 올리면 됩니다.
+        const std::vector<uint32_t>& getChanged() const { return this->changed; }
+
+    private:
+        void markDirty(uint32_t slot);
+        void rebuildOrder();
+        void updateRange(uint32_t begin, uint32_t end);
+
+        // 슬롯(깊이 순서)별 배열
+        std::vector<glm::mat4> localMatrices;
+        std::vector<glm::mat4> worldMatrices;
+        std::vector<uint32_t> parentSlots;                          // 슬롯 -> 부모 슬롯 (루트는 TRANSFORM_NONE)
+        std::vector<uint32_t> depths;
+        std::vector<uint8_t> dirtyFlags;
+        std::vector<uint32_t> slotNodes;                            // 슬롯 -> 노드 번호
+
+        std::vector<uint32_t> nodeSlots;                            // 노드 번호 -> 슬롯
+        std::vector<uint32_t> levelStarts;                          // 깊이 d의 첫 슬롯 (마지막 원소는 노드 수)
+        std::vector<uint32_t> changed;
+        uint32_t firstDirty = TRANSFORM_NONE;                       // 가장 앞의 dirty 슬롯 -> update는 여기서부터 시작
+        bool orderDirty = false;                                    // 깊이 순서나 levelStarts를 다시 만들어야 함
+    };
+}
+
+#endif // INCLUDE_VULKANTRANSFORM_H_
@@ -0,0 +1,246 @@
+﻿#include "VKvertexDedup.h"
+
+namespace vkengine {
+    namespace asset {
+
+        namespace {
+            constexpr uint32_t SHARD_BITS = 6;
+            constexpr uint32_t SHARD_COUNT = 1u << SHARD_BITS;      // 해시 상위 비트로 나누는 샤드 수
+            constexpr uint32_t CHUNK_SIZE = 1u << 16;               // 병렬 처리 단위 (모서리 수)
+            constexpr uint32_t EMPTY_SLOT = UINT32_MAX;
+
+            inline uint32_t rotl(uint32_t value, uint32_t shift)
+            {
+                return (value << shift) | (value >> (32 - shift));
+            }
+
+            inline uint32_t shardOf(uint32_t hash)
+            {
+                return hash >> (32 - SHARD_BITS);
+            }
+
+            inline uint32_t nextPowerOfTwo(uint32_t value)
+            {
+                uint32_t result = 1;
+                while (result < value)
+                {
+                    result <<= 1;
+                }
+                return result;
+            }
+        }
+
+        uint32_t hashVertex(const Vertex& vertex)
+        {
+            const float values[8] = {
+                vertex.pos.x, vertex.pos.y, vertex.pos.z,
+                vertex.color.x, vertex.color.y, vertex.color.z,
+                vertex.texCoord.x, vertex.texCoord.y
+            };
+
+            // MurmurHash3 (x86_32)의 블록 처리와 마무리 단계
+            uint32_t hash = 0x9747b28c;
+            for (float value : values)
+            {
+                uint32_t bits = 0;
+                if (value != 0.0f) {
+                    memcpy(&bits, &value, sizeof(bits));
+                }
+
+                bits *= 0xcc9e2d51;
+                bits = rotl(bits, 15);
+                bits *= 0x1b873593;
+
+                hash ^= bits;
+                hash = rotl(hash, 13);
+                hash = hash * 5 + 0xe6546b64;
+            }
+
+            hash ^= sizeof(values);
+            hash ^= hash >> 16;
+            hash *= 0x85ebca6b;
+            hash ^= hash >> 13;
+            hash *= 0xc2b2ae35;
+            hash ^= hash >> 16;
+            return hash;
+        }
+
+        VKVertexDeduplicator::VKVertexDeduplicator(job::VKJobSystem* jobSystem)
+        {
+            this->VKjobSystem = jobSystem;
+        }
+
+        void VKVertexDeduplicator::deduplicate(const Vertex* corners, uint32_t cornerCount, std::vector<Vertex>& outVertices, std::vector<uint32_t>& outIndices)
+        {
+            outVertices.clear();
+            outIndices.clear();
+
+            if (cornerCount == 0) {
+                return;
+            }
+
+            const uint32_t chunkCount = (cornerCount + CHUNK_SIZE - 1) / CHUNK_SIZE;
+
+            this->hashes.resize(cornerCount);
+            this->shardOrder.resize(cornerCount);
+            this->representatives.resize(cornerCount);
+            this->chunkCounts.assign(static_cast<size_t>(chunkCount) * SHARD_COUNT, 0);
+            this->shardOffsets.resize(SHARD_COUNT + 1);
+            this->tableOffsets.resize(SHARD_COUNT + 1);
+
+            // 1. 모서리를 해시하고 청크별로 샤드 히스토그램을 만듭니다.
+            this->parallelFor(chunkCount, 1, [&](uint32_t begin, uint32_t end) {
+                for (uint32_t chunk = begin; chunk < end; chunk++)
+                {
+                    uint32_t* histogram = &this->chunkCounts[static_cast<size_t>(chunk) * SHARD_COUNT];
+                    const uint32_t last = std::min(cornerCount, (chunk + 1) * CHUNK_SIZE);
+                    for (uint32_t i = chunk * CHUNK_SIZE; i < last; i++)
+                    {
+                        const uint32_t hash = hashVertex(corners[i]);
+                        this->hashes[i] = hash;
+                        histogram[shardOf(hash)]++;
+                    }
+                }
+            });
+
+            // 2. 히스토그램을 (샤드, 청크) 순서의 쓰기 위치로 바꿉니다. -> 샤드 안에서는 모서리 순서가 유지됩니다.
+            uint32_t offset = 0;
+            uint32_t tableSize = 0;
+            for (uint32_t shard = 0; shard < SHARD_COUNT; shard++)
+            {
+                this->shardOffsets[shard] = offset;
+                for (uint32_t chunk = 0; chunk < chunkCount; chunk++)
+                {
+                    uint32_t& count = this->chunkCounts[static_cast<size_t>(chunk) * SHARD_COUNT + shard];
+                    const uint32_t start = offset;
+                    offset += count;
+                    count = start;
+                }
+
+                // 부하율 0.5 이하의 테이블
+                this->tableOffsets[shard] = tableSize;
+                tableSize += nextPowerOfTwo(std::max(16u, (offset - this->shardOffsets[shard]) * 2));
+            }
+            this->shardOffsets[SHARD_COUNT] = offset;
+            this->tableOffsets[SHARD_COUNT] = tableSize;
+
+            if (this->tables.size() < tableSize) {
+                this->tables.resize(tableSize);
+            }
+
+            // 3. 모서리 인덱스를 샤드별로 흩뿌립니다.
+            this->parallelFor(chunkCount, 1, [&](uint32_t begin, uint32_t end) {
+                for (uint32_t chunk = begin; chunk < end; chunk++)
+                {
+                    uint32_t* cursor = &this->chunkCounts[static_cast<size_t>(chunk) * SHARD_COUNT];
+                    const uint32_t last = std::min(cornerCount, (chunk + 1) * CHUNK_SIZE);
+                    for (uint32_t i = chunk * CHUNK_SIZE; i < last; i++)
+                    {
+                        this->shardOrder[cursor[shardOf(this->hashes[i])]++] = i;
+                    }
+                }
+            });
+
+            // 4. 샤드마다 자기 테이블에서 중복을 찾습니다. 같은 Vertex는 항상 같은 샤드에 들어갑니다.
+            this->parallelFor(SHARD_COUNT, 1, [&](uint32_t begin, uint32_t end) {
+                for (uint32_t shard = begin; shard < end; shard++)
+                {
+                    VKDedupSlot* table = &this->tables[this->tableOffsets[shard]];
+                    const uint32_t mask = this->tableOffsets[shard + 1] - this->tableOffsets[shard] - 1;
+
+                    for (uint32_t slot = 0; slot <= mask; slot++)
+                    {
+                        table[slot] = { 0, EMPTY_SLOT };
+                    }
+
+                    for (uint32_t k = this->shardOffsets[shard]; k < this->shardOffsets[shard + 1]; k++)
+                    {
+                        const uint32_t i = this->shardOrder[k];
+                        const uint32_t hash = this->hashes[i];
+
+                        // 상위 비트는 샤드 선택에 썼으므로 하위 비트로 선형 탐사합니다.
+                        uint32_t slot = hash & mask;
+                        for (;;)
+                        {
+                            VKDedupSlot& entry = table[slot];
+                            if (entry.index == EMPTY_SLOT) {
+                                entry = { hash, i };
+                                this->representatives[i] = i;
+                                break;
+                            }
+                            if (entry.hash == hash && corners[entry.index] == corners[i]) {
+                                this->representatives[i] = entry.index;
+                                break;
+                            }
+                            slot = (slot + 1) & mask;
+                        }
+                    }
+                }
+            });
+
+            // 5. 청크별 고유 Vertex 수를 세서 출력 위치를 정합니다.
+            this->chunkCounts.assign(chunkCount + 1, 0);
+            this->parallelFor(chunkCount, 1, [&](uint32_t begin, uint32_t end) {
+                for (uint32_t chunk = begin; chunk < end; chunk++)
+                {
+                    uint32_t count = 0;
+                    const uint32_t last = std::min(cornerCount, (chunk + 1) * CHUNK_SIZE);
+                    for (uint32_t i = chunk * CHUNK_SIZE; i < last; i++)
+                    {
+                        count += (this->representatives[i] == i) ? 1 : 0;
+                    }
+                    this->chunkCounts[chunk] = count;
+                }
+            });
+
+            uint32_t uniqueCount = 0;
+            for (uint32_t chunk = 0; chunk < chunkCount; chunk++)
+            {
+                const uint32_t count = this->chunkCounts[chunk];
+                this->chunkCounts[chunk] = uniqueCount;
+                uniqueCount += count;
+            }
+
+            outVertices.resize(uniqueCount);
+            outIndices.resize(cornerCount);
+
+            // 6. 처음 등장한 모서리에 새 인덱스를 매기고 Vertex를 씁니다. (해시 배열을 새 인덱스로 재사용)
+            this->parallelFor(chunkCount, 1, [&](uint32_t begin, uint32_t end) {
+                for (uint32_t chunk = begin; chunk < end; chunk++)
+                {
+                    uint32_t next = this->chunkCounts[chunk];
+                    const uint32_t last = std::min(cornerCount, (chunk + 1) * CHUNK_SIZE);
+                    for (uint32_t i = chunk * CHUNK_SIZE; i < last; i++)
+                    {
+                        if (this->representatives[i] == i) {
+                            this->hashes[i] = next;
+                            outVertices[next++] = corners[i];
+                        }
+                    }
+                }
+            });
+
+            // 7. 모든 모서리의 인덱스를 대표 모서리의 새 인덱스로 바꿉니다.
+            this->parallelFor(chunkCount, 1, [&](uint32_t begin, uint32_t end) {
+                for (uint32_t chunk = begin; chunk < end; chunk++)
+                {
+                    const uint32_t last = std::min(cornerCount, (chunk + 1) * CHUNK_SIZE);
+                    for (uint32_t i = chunk * CHUNK_SIZE; i < last; i++)
+                    {
+                        outIndices[i] = this->hashes[this->representatives[i]];
+                    }
+                }
+            });
+        }
+
+        void VKVertexDeduplicator::parallelFor(uint32_t count, uint32_t grainSize, const std::function<void(uint32_t begin, uint32_t end)>& function)
+        {
+            if (this->VKjobSystem) {
+                this->VKjobSystem->parallelFor(count, grainSize, function);
+            }
+            else {
+                function(0, count);
+            }
+        }
+    }
+}
@@ -0,0 +1,48 @@
+﻿#ifndef INCLUDE_VULKANVERTEXDEDUP_H_
+#define INCLUDE_VULKANVERTEXDEDUP_H_
+
+#include "../_common.h"
+#include "../struct.h"
+#include "VKjobSystem.h"
+
+namespace vkengine {
+    namespace asset {
+
+        // Vertex의 원시 비트에 대한 32비트 해시 (-0.0은 0.0과 같게 취급 -> Vertex::operator==와 일치)
+        uint32_t hashVertex(const Vertex& vertex);
+
+        // 면의 모서리(corner) 목록에서 같은 Vertex를 합쳐 버텍스/인덱스 배열을 만드는 클래스
+        // std::unordered_map 대신 해시 상위 비트로 나눈 샤드마다 개방 주소법 테이블을 사용하고,
+        // 해싱/샤드 분류/중복 제거/인덱스 재배치를 잡 시스템으로 병렬 실행합니다.
+        // 결과는 std::unordered_map으로 처음 등장한 순서대로 번호를 매긴 것과 같습니다.
+        // 작업 버퍼는 다음 호출에서 재사용하므로 같은 객체로 여러 메시를 처리하면 할당이 없습니다.
+        class VKVertexDeduplicator {
+        public:
+            // jobSystem이 nullptr이면 호출 스레드에서 실행합니다.
+            explicit VKVertexDeduplicator(job::VKJobSystem* jobSystem = nullptr);
+
+            void deduplicate(const Vertex* corners, uint32_t cornerCount, std::vector<Vertex>& outVertices, std::vector<uint32_t>& outIndices);
+
+        private:
+            // 개방 주소법 테이블 항목 -> index가 UINT32_MAX이면 비어 있음
+            struct VKDedupSlot {
+                uint32_t hash;
+                uint32_t index;
+            };
+
+            void parallelFor(uint32_t count, uint32_t grainSize, const std::function<void(uint32_t begin, uint32_t end)>& function);
+
+            job::VKJobSystem* VKjobSystem = nullptr;
+
+            std::vector<uint32_t> hashes;                   // 모서리별 해시 -> 재배치 단계에서 새 인덱스로 재사용
+            std::vector<uint32_t> shardOrder;               // 샤드별로 정렬한 모서리 인덱스
+            std::vector<uint32_t> representatives;          // 같은 Vertex 중 처음 등장한 모서리 인덱스
+            std::vector<uint32_t> chunkCounts;              // 청크 x 샤드 히스토그램 / 청크별 고유 Vertex 수
+            std::vector<uint32_t> shardOffsets;
+            std::vector<uint32_t> tableOffsets;
+            std::vector<VKDedupSlot> tables;
+        };
+    }
+}
+
+#endif // INCLUDE_VULKANVERTEXDEDUP_H_
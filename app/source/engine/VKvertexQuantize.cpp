@@ -0,0 +1,184 @@
+﻿#include "VKvertexQuantize.h"
+
+namespace vkengine {
+    namespace asset {
+
+        namespace {
+            uint16_t quantizeUnorm16(float value)
+            {
+                return static_cast<uint16_t>(std::lround(std::min(std::max(value, 0.0f), 1.0f) * 65535.0f));
+            }
+
+            uint8_t quantizeUnorm8(float value)
+            {
+                return static_cast<uint8_t>(std::lround(std::min(std::max(value, 0.0f), 1.0f) * 255.0f));
+            }
+        }
+
+        uint16_t floatToHalf(float value)
+        {
+            uint32_t bits;
+            memcpy(&bits, &value, sizeof(bits));
+
+            const uint32_t sign = (bits >> 16) & 0x8000u;
+            const uint32_t exponent = (bits >> 23) & 0xFFu;
+            uint32_t mantissa = bits & 0x7FFFFFu;
+
+            // NaN / Inf
+            if (exponent == 0xFFu) {
+                return static_cast<uint16_t>(sign | 0x7C00u | (mantissa ? 0x200u : 0u));
+            }
+
+            const int32_t halfExponent = static_cast<int32_t>(exponent) - 127 + 15;
+
+            // 표현 범위를 넘으면 Inf
+            if (halfExponent >= 31) {
+                return static_cast<uint16_t>(sign | 0x7C00u);
+            }
+
+            // 비정규 수 또는 0
+            if (halfExponent <= 0) {
+                if (halfExponent < -10) {
+                    return static_cast<uint16_t>(sign);
+                }
+
+                mantissa |= 0x800000u;
+                const uint32_t shift = static_cast<uint32_t>(14 - halfExponent);
+                uint32_t half = mantissa >> shift;
+
+                // 가장 가까운 짝수로 반올림
+                const uint32_t remainder = mantissa & ((1u << shift) - 1u);
+                const uint32_t halfway = 1u << (shift - 1);
+                if (remainder > halfway || (remainder == halfway && (half & 1u))) {
+                    half++;
+                }
+                return static_cast<uint16_t>(sign | half);
+            }
+
+            uint32_t half = (static_cast<uint32_t>(halfExponent) << 10) | (mantissa >> 13);
+
+            // 가장 가까운 짝수로 반올림 -> 가수가 넘치면 지수로 올라갑니다.
+            const uint32_t remainder = mantissa & 0x1FFFu;
+            if (remainder > 0x1000u || (remainder == 0x1000u && (half & 1u))) {
+                half++;
+            }
+            return static_cast<uint16_t>(sign | half);
+        }
+
+        float halfToFloat(uint16_t value)
+        {
+            const uint32_t sign = static_cast<uint32_t>(value & 0x8000u) << 16;
+            uint32_t exponent = (value >> 10) & 0x1Fu;
+            uint32_t mantissa = value & 0x3FFu;
+            uint32_t bits;
+
+            if (exponent == 0x1Fu) {
+                bits = sign | 0x7F800000u | (mantissa << 13);
+            }
+            else if (exponent != 0) {
+                bits = sign | ((exponent + 127 - 15) << 23) | (mantissa << 13);
+            }
+            else if (mantissa == 0) {
+                bits = sign;
+            }
+            else {
+                // 비정규 수 -> 정규화
+                exponent = 127 - 15 + 1;
+                while ((mantissa & 0x400u) == 0)
+                {
+                    mantissa <<= 1;
+                    exponent--;
+                }
+                bits = sign | (exponent << 23) | ((mantissa & 0x3FFu) << 13);
+            }
+
+            float result;
+            memcpy(&result, &bits, sizeof(result));
+            return result;
+        }
+
+        bool canPackVertices(const Vertex* vertices, uint32_t vertexCount)
+        {
+            for (uint32_t i = 0; i < vertexCount; i++)
+            {
+                const Vertex& vertex = vertices[i];
+
+                for (int c = 0; c < 3; c++)
+                {
+                    if (!(vertex.color[c] >= 0.0f && vertex.color[c] <= 1.0f)) {
+                        return false;
+                    }
+                }
+
+                for (int c = 0; c < 2; c++)
+                {
+                    if (!(std::abs(vertex.texCoord[c]) <= PACKED_TEXCOORD_LIMIT)) {
+                        return false;
+                    }
+                }
+            }
+
+            return true;
+        }
+
+        VKVertexFormat selectVertexFormat(const Vertex* vertices, uint32_t vertexCount, bool preferPacked)
+        {
+            if (preferPacked && vertexCount > 0 && canPackVertices(vertices, vertexCount)) {
+                return VKVertexFormat::Packed;
+            }
+
+            return VKVertexFormat::Float;
+        }
+
+        VKVertexQuantization packVertices(const Vertex* vertices, uint32_t vertexCount, const glm::vec3& boundsMin, const glm::vec3& boundsMax, std::vector<VertexPacked>& out)
+        {
+            const glm::vec3 extent = boundsMax - boundsMin;
+
+            // 크기가 0인 축은 모두 0으로 저장하고 offset만으로 복원합니다.
+            glm::vec3 inverseExtent(0.0f);
+            for (int c = 0; c < 3; c++)
+            {
+                if (extent[c] > 0.0f) {
+                    inverseExtent[c] = 1.0f / extent[c];
+                }
+            }
+
+            out.resize(vertexCount);
+            for (uint32_t i = 0; i < vertexCount; i++)
+            {
+                const Vertex& vertex = vertices[i];
+                VertexPacked& packed = out[i];
+
+                for (int c = 0; c < 3; c++)
+                {
+                    packed.pos[c] = quantizeUnorm16((vertex.pos[c] - boundsMin[c]) * inverseExtent[c]);
+                    packed.color[c] = quantizeUnorm8(vertex.color[c]);
+                }
+                packed.pos[3] = 0;
+                packed.color[3] = 255;
+
+                packed.texCoord[0] = floatToHalf(vertex.texCoord.x);
+                packed.texCoord[1] = floatToHalf(vertex.texCoord.y);
+            }
+
+            VKVertexQuantization quantization{};
+            quantization.positionOffset = glm::vec4(boundsMin, 0.0f);
+            quantization.positionScale = glm::vec4(extent, 0.0f);
+            return quantization;
+        }
+
+        Vertex unpackVertex(const VertexPacked& vertex, const VKVertexQuantization& quantization)
+        {
+            Vertex result{};
+
+            for (int c = 0; c < 3; c++)
+            {
+                result.pos[c] = quantization.positionOffset[c] + (vertex.pos[c] / 65535.0f) * quantization.positionScale[c];
+                result.color[c] = vertex.color[c] / 255.0f;
+            }
+            result.texCoord = glm::vec2(halfToFloat(vertex.texCoord[0]), halfToFloat(vertex.texCoord[1]));
+
+            return result;
+        }
+    }
+}
@@ -0,0 +1,42 @@
+﻿#ifndef INCLUDE_VULKANVERTEXQUANTIZE_H_
+#define INCLUDE_VULKANVERTEXQUANTIZE_H_
+
+#include "../_common.h"
+#include "../struct.h"
+
+namespace vkengine {
+    namespace asset {
+
+        // half float의 UV 정밀도가 1/1024 이상인 범위 -> 벗어나면 압축하지 않습니다.
+        constexpr float PACKED_TEXCOORD_LIMIT = 2.0f;
+
+        enum class VKVertexFormat : uint32_t {
+            Float = 0,                                          // Vertex (32바이트)
+            Packed = 1,                                         // VertexPacked (16바이트)
+        };
+
+        // 셰이더에서 위치를 복원하는 푸시 상수 -> position = offset + inPosition * scale
+        // Float 형식은 offset 0, scale 1로 그대로 통과합니다.
+        struct VKVertexQuantization {
+            glm::vec4 positionOffset{ 0.0f };
+            glm::vec4 positionScale{ 1.0f, 1.0f, 1.0f, 0.0f };
+        };
+
+        uint16_t floatToHalf(float value);
+        float halfToFloat(uint16_t value);
+
+        // 색상이 [0, 1], UV가 PACKED_TEXCOORD_LIMIT 안에 있으면 압축할 수 있습니다.
+        bool canPackVertices(const Vertex* vertices, uint32_t vertexCount);
+
+        // 메시마다 불러올 때 형식을 고릅니다. -> preferPacked이고 압축할 수 있을 때만 Packed
+        VKVertexFormat selectVertexFormat(const Vertex* vertices, uint32_t vertexCount, bool preferPacked);
+
+        // AABB 기준으로 위치를 16비트 정규화하고, 복원용 푸시 상수를 돌려줍니다.
+        VKVertexQuantization packVertices(const Vertex* vertices, uint32_t vertexCount, const glm::vec3& boundsMin, const glm::vec3& boundsMax, std::vector<VertexPacked>& out);
+
+        // 셰이더와 같은 방식으로 복원합니다. (검증/디버그용)
+        Vertex unpackVertex(const VertexPacked& vertex, const VKVertexQuantization& quantization);
+    }
+}
+
+#endif // INCLUDE_VULKANVERTEXQUANTIZE_H_
@@ -26,10 +26,13 @@ namespace vkengine {
             QueueFamilyIndices indices_ = findQueueFamilies(device, VKsurface);
             *indices = indices_;
 
-            bool extensionsSupported = checkDeviceExtensionSupport(device);
-            bool swapChainAdequate = false;
+            // 帮  ǽ Ƿ  ü Ȯ ʽϴ.
+            const bool headless = (VKsurface == VK_NULL_HANDLE);
 
-            if (extensionsSupported) {
+            bool extensionsSupported = checkDeviceExtensionSupport(device, headless ? headlessDeviceExtensions : deviceExtensions);
+            bool swapChainAdequate = headless;
+
+            if (extensionsSupported && !headless) {
                 SwapChainSupportDetails swapChainSupport = querySwapChainSupport(device, VKsurface);
                 swapChainAdequate = !swapChainSupport.formats.empty() && !swapChainSupport.presentModes.empty();
             }
@@ -83,7 +86,13 @@ namespace vkengine {
                 }
                 
                 VkBool32 presentSupport = false;
-                vkGetPhysicalDeviceSurfaceSupportKHR(device, i, VKsurface, &presentSupport);
+                if (VKsurface != VK_NULL_HANDLE) {
+                    vkGetPhysicalDeviceSurfaceSupportKHR(device, i, VKsurface, &presentSupport);
+                }
+                else {
+                    // 帮  Ʈ ʽϴ. -> ׷Ƚ ť йи Ʈ ť йи Ӵϴ.
+                    presentSupport = indices.graphicsAndComputeFamilyHasValue && indices.graphicsAndComputeFamily == static_cast<uint32_t>(i);
+                }
 
                 if (presentSupport)
                 {
@@ -113,6 +122,11 @@ namespace vkengine {
                 i++;
             }
 
+            // ε忡   ť йи ãϴ. ( ׷Ƚ ť йи  )
+            if (selected) {
+                target.setTransferFamily(vkutil::helper_::findTransferQueueFamily(device, target.graphicsAndComputeFamily));
+            }
+
             return target;
         }
 
@@ -127,7 +141,7 @@ namespace vkengine {
             endSingleTimeCommands(VKdevice, VKcommandPool, graphicsVKQueue, commandBuffer);
         }
 
-        void createBuffer(VkDevice device, VkPhysicalDevice physicalDevice, VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, VkBuffer& buffer, VkDeviceMemory& bufferMemory)
+        void createBuffer(memory::VKMemoryAllocator* allocator, VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, VkBuffer& buffer, memory::VKAllocation& bufferMemory)
         {
             //     ü ʱȭѴ.
             VkBufferCreateInfo bufferInfo{};
@@ -137,26 +151,13 @@ namespace vkengine {
             bufferInfo.usage = usage;                                       //    Ѵ (: vertex, index ).
             bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;             //   带  Ѵ.
 
-            //    ۸ ϰ,  θ ˻Ѵ.
-            VK_CHECK_RESULT(vkCreateBuffer(device, &bufferInfo, nullptr, &buffer));
-
-            //  ۿ ʿ ޸ 䱸  ´.
-            VkMemoryRequirements memRequirements;
-            vkGetBufferMemoryRequirements(device, buffer, &memRequirements);
-
-            // ޸ Ҵ   ü ʱȭѴ.
-            VkMemoryAllocateInfo allocInfo{};
-            
-            allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;                                                   // ü Ÿ Ѵ.    
-            allocInfo.allocationSize = memRequirements.size;                                                            // ۸  ޸ ũ⸦ Ѵ.
-            allocInfo.memoryTypeIndex = findMemoryType(physicalDevice, memRequirements.memoryTypeBits, properties);     // 䱸׿ ´ ޸ Ÿ ε ãƼ Ѵ.
-            
-            VK_CHECK_RESULT(vkAllocateMemory(device, &allocInfo, nullptr, &bufferMemory));  //    ޸𸮸 Ҵϰ  θ ˻Ѵ.
-            VK_CHECK_RESULT(vkBindBufferMemory(device, buffer, bufferMemory, 0));           // Ҵ ޸𸮸 ۿ εϿ GPU   ְ Ѵ.
+            // ۸ ϰ, Ҵ Ͽ ߶ (memory + offset) εѴ.
+            // -> ۸ vkAllocateMemory ȣ ʴ´.
+            VK_CHECK_RESULT(allocator->createBuffer(bufferInfo, properties, buffer, bufferMemory));
         }
 
 
-        bool checkDeviceExtensionSupport(VkPhysicalDevice device)
+        bool checkDeviceExtensionSupport(VkPhysicalDevice device, const std::vector<const char*>& extensions)
         {
             uint32_t extensionCount;
             vkEnumerateDeviceExtensionProperties(device, nullptr, &extensionCount, nullptr);
@@ -164,7 +165,7 @@ namespace vkengine {
             std::vector<VkExtensionProperties> availableExtensions(extensionCount);
             vkEnumerateDeviceExtensionProperties(device, nullptr, &extensionCount, availableExtensions.data());
 
-            std::set<std::string> requiredExtensions(deviceExtensions.begin(), deviceExtensions.end());
+            std::set<std::string> requiredExtensions(extensions.begin(), extensions.end());
 
             for (const auto& extension : availableExtensions) {
 
@@ -366,50 +367,19 @@ namespace vkengine {
 
         VkCommandBuffer beginSingleTimeCommands(VkDevice& device, VkCommandPool& commandPool)
         {
-            VkCommandBufferAllocateInfo allocInfo{};                          // Ŀǵ  Ҵ  ü ʱȭմϴ.
-            allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO; // ü Ÿ մϴ.
-            
-            // Ŀǵ   մϴ.
-            // VK_COMMAND_BUFFER_LEVEL_PRIMARY: ⺻ Ŀǵ 
-            // VK_COMMAND_BUFFER_LEVEL_SECONDARY:  Ŀǵ 
-            allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
-            allocInfo.commandPool = commandPool;                              // Ŀǵ Ǯ մϴ.
-            allocInfo.commandBufferCount = 1;                                 // Ŀǵ   մϴ.
-
-            VkCommandBuffer commandBuffer;
-            vkAllocateCommandBuffers(device, &allocInfo, &commandBuffer);     // Ŀǵ ۸ Ҵմϴ.
-
-            VkCommandBufferBeginInfo beginInfo{};
-            // VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO :     մϴ.
-            beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
-            
-            // VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT : Ŀǵ ۸   Ϸ  մϴ.
-            beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
-
-            // Ŀǵ ۸ մϴ.
-            vkBeginCommandBuffer(commandBuffer, &beginInfo);
-
-            return commandBuffer;
-
+            // Ŀǵ Ǯ ϴ ɹ۸   մϴ. (vkutil::helper_  ĳø ϴ)
+            return vkutil::helper_::beginSingleTimeCommands(device, commandPool);
         }
+
         void endSingleTimeCommands(VkDevice& device, VkCommandPool& commandPool, VkQueue& graphicsQueue, VkCommandBuffer& commandBuffer)
         {   
-            // Ŀǵ ۸ մϴ.
-            vkEndCommandBuffer(commandBuffer);
-            
-            VkSubmitInfo submitInfo{};
-            submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-            submitInfo.commandBufferCount = 1; // Ŀǵ   մϴ.
-            submitInfo.pCommandBuffers = &commandBuffer; // Ŀǵ ۸ մϴ.
-            
-            // ť Ŀǵ ۸ մϴ.
-            vkQueueSubmit(graphicsQueue, 1, &submitInfo, VK_NULL_HANDLE);
-            
-            // ť  ۾ Ϸ  մϴ.
-            vkQueueWaitIdle(graphicsQueue);
-            
-            // Ŀǵ ۸ մϴ.
-            vkFreeCommandBuffers(device, commandPool, 1, &commandBuffer);
+            // ϰ  ɹ fence ٸ , ɹۿ fence ؼ Ǯ  Ӵϴ.
+            vkutil::helper_::endSingleTimeCommands(device, commandPool, graphicsQueue, commandBuffer);
+        }
+
+        void releaseSingleTimeCommands(VkDevice device, VkCommandPool commandPool)
+        {
+            vkutil::helper_::releaseSingleTimeCommands(device, commandPool);
         }
 
         void transitionImageLayout(VkDevice device, VkCommandPool commandPool, VkQueue graphicsQueue, VkImage image, VkFormat format, VkImageLayout oldLayout, VkImageLayout newLayout, uint32_t mipLevels)
@@ -11,11 +11,13 @@ namespace vkengine {
         std::vector<char> readFile(const std::string& filename);
 
         //  ̽ 䱸  ϴ Ȯϴ Լ
+        // ǽ VK_NULL_HANDLE̸ 帮  -> Ʈ   ü Ȯ 䱸 
         bool isDeviceSuitable(VkPhysicalDevice device, VkSurfaceKHR VKsurface, QueueFamilyIndices* indices);
 
         // ־  ġ ť йи Ӽ ã Լ
         // PROB : ť йи  쿡 ʿ ó ִ йи  ã ,  йи ε ȯ
         // TODO ; ť йи  쿡  ó ʿ
+        // ǽ VK_NULL_HANDLE̸ Ʈ ť йи ׷Ƚ ť йи  
         const QueueFamilyIndices findQueueFamilies(VkPhysicalDevice device, VkSurfaceKHR VKsurface);
 
         // ۸ ϴ Լ
@@ -28,19 +30,19 @@ namespace vkengine {
             VkDeviceSize size);
 
         // buffer ϴ Լ
+        // ޸𸮴 Ҵ Ͽ  Ҵ˴ϴ.
         void createBuffer(
-            VkDevice device,
-            VkPhysicalDevice physicalDevice,
+            memory::VKMemoryAllocator* allocator,
             VkDeviceSize size,
             VkBufferUsageFlags usage,
             VkMemoryPropertyFlags properties,
             VkBuffer& buffer,
-            VkDeviceMemory& bufferMemory);
+            memory::VKAllocation& bufferMemory);
 
         //  ̽ Ȯ  ϴ Ȯϴ Լ
         //  ̾  θ Ȯϴ Լ
         // Ȯ  ϰ ʿ  Ȯ  ԵǾ ִ Ȯ
-        bool checkDeviceExtensionSupport(VkPhysicalDevice device);
+        bool checkDeviceExtensionSupport(VkPhysicalDevice device, const std::vector<const char*>& extensions = deviceExtensions);
 
         //  ̽  Ȯ  Լ
         void getDeviceExtensionSupport(VkPhysicalDevice device, std::set<std::string>* temp);
@@ -120,6 +122,9 @@ namespace vkengine {
         // ɹ۸ ϴ Լ
         void endSingleTimeCommands(VkDevice& device, VkCommandPool& commandPool, VkQueue& graphicsQueue, VkCommandBuffer& commandBuffer);
 
+        // Ϸ   ܹ߼ ɹۿ fence ϴ Լ -> vkDestroyCommandPool  ȣ
+        void releaseSingleTimeCommands(VkDevice device, VkCommandPool commandPool);
+
         // ̹ ̾ƿ ȯϴ Լ
         void transitionImageLayout(
             VkDevice device,
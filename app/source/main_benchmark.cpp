@@ -0,0 +1,53 @@
+﻿#include "benchmark/Benchmark.h"
+
+// CPU 벤치마크와 헤드리스 프레임 벤치마크 (frame은 Vulkan 디바이스가 필요 -> lavapipe 같은 소프트웨어 ICD로도 실행)
+// 사용법: benchmark.exe [이름] [인자...]  -> 이름을 생략하면 전부 실행합니다.
+struct BenchmarkEntry {
+    const char* name;
+    int (*run)(const std::vector<std::string>& args);
+};
+
+static const BenchmarkEntry benchmarks[] = {
+    { "job", vkengine::benchmark::runJobBenchmark },
+    { "dedup", vkengine::benchmark::runDedupBenchmark },
+    { "meshlet", vkengine::benchmark::runMeshletBenchmark },
+    { "frame", vkengine::benchmark::runFrameBenchmark },
+    { "mipmap", vkengine::benchmark::runMipmapBenchmark },
+    { "instancing", vkengine::benchmark::runInstancingBenchmark },
+    { "gpucull", vkengine::benchmark::runGpuCullBenchmark },
+    { "frustum", vkengine::benchmark::runFrustumCullBenchmark },
+    { "bvh", vkengine::benchmark::runBvhBenchmark },
+    { "transform", vkengine::benchmark::runTransformBenchmark },
+};
+
+int main(int argc, char* argv[]) {
+
+    const char* selected = (argc > 1) ? argv[1] : nullptr;
+    const std::vector<std::string> args(argv + std::min(argc, 2), argv + argc);
+    bool found = false;
+
+    for (const BenchmarkEntry& entry : benchmarks)
+    {
+        if (selected && strcmp(selected, entry.name) != 0) {
+            continue;
+        }
+
+        found = true;
+        printf("==== %s ====\n", entry.name);
+
+        if (entry.run(args) != EXIT_SUCCESS) {
+            return EXIT_FAILURE;
+        }
+    }
+
+    if (!found) {
+        std::cerr << "알 수 없는 벤치마크입니다: " << selected << std::endl;
+        for (const BenchmarkEntry& entry : benchmarks)
+        {
+            std::cerr << "  " << entry.name << std::endl;
+        }
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
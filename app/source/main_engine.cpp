@@ -6,15 +6,33 @@
 
 int main(int argc, char* argv[]) {
 
-    char path[MAX_PATH];
     std::string root_path = "";
 
+#ifdef _WIN32
+    char path[MAX_PATH];
+
     if (GetModuleFileNameA(NULL, path, MAX_PATH)) {
         root_path = path;
     }
     else {
         std::cerr << "θ   ߽ϴ." << std::endl;
     }
+#else
+    root_path = argv[0];
+#endif
+
+    // --headless [frames] -> â  ũ frames  ϰ մϴ. (CI ġũ)
+    bool headless = false;
+    uint32_t headlessFrameCount = HEADLESS_FRAME_COUNT;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--headless") == 0) {
+            headless = true;
+            if (i + 1 < argc && argv[i + 1][0] != '-') {
+                headlessFrameCount = static_cast<uint32_t>(strtoul(argv[++i], nullptr, 10));
+            }
+        }
+    }
 
     std::unique_ptr<vkengine::VulkanEngine> engine;
 
@@ -33,6 +51,8 @@ int main(int argc, char* argv[]) {
 #if SELECTED_ENGINE  < 0
 
 #else
+    engine->setHeadless(headless, headlessFrameCount);
+
     engine->init();
 
     engine->prepare();
@@ -0,0 +1,154 @@
+﻿#include "engine/VKtextureCompress.h"
+#include "engine/VKtextureFile.h"
+#include "engine/VKjobSystem.h"
+
+#ifndef STB_IMAGE_IMPLEMENTATION
+#define STB_IMAGE_IMPLEMENTATION
+#include "../../include/common/stb_image.h"
+#endif
+
+// 오프라인 텍스처 변환 도구
+// PNG/JPG를 읽어 모든 mip을 미리 만들고 블록 압축해서 원본 옆에 <원본 경로>.vktex로 저장합니다.
+// 실행 중에는 텍스처 스트리머가 이 파일을 매핑해서 그대로 복사합니다. (디코딩과 밉맵 blit 없음)
+// 사용법: textureCompiler.exe [-f bc7|bc1|rgba8] [--filter kaiser|box] [--force] 이미지...
+//   -f       : 압축 형식 (기본 bc7, 알파가 없는 텍스처는 bc1로 절반 크기)
+//   --filter : mip 필터 (기본 kaiser, box는 실행 중 blit과 같은 결과)
+//   --force  : 원본이 바뀌지 않았어도 다시 변환합니다.
+namespace {
+
+    bool parseFormat(const std::string& name, vkengine::asset::VKTextureFormat& format)
+    {
+        for (uint32_t i = 0; i < static_cast<uint32_t>(vkengine::asset::VKTextureFormat::Count); i++)
+        {
+            const vkengine::asset::VKTextureFormat candidate = static_cast<vkengine::asset::VKTextureFormat>(i);
+            if (name == vkengine::asset::getFormatName(candidate)) {
+                format = candidate;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool compileTexture(const std::string& input, vkengine::asset::VKTextureFormat format, vkengine::asset::VKMipFilter filter, bool force, vkengine::job::VKJobSystem& jobSystem)
+    {
+        using namespace vkengine::asset;
+
+        const std::string output = input + TEXTURE_FILE_EXTENSION;
+
+        VKMappedFile source;
+        if (!source.open(input)) {
+            std::cerr << "원본 이미지를 열 수 없습니다: " << input << std::endl;
+            return false;
+        }
+
+        // 원본 내용과 형식이 같으면 건너뜁니다.
+        const uint64_t sourceHash = hashBytes(source.getData(), source.getSize());
+        VKTextureFileHeader existing{};
+        if (!force && VKTextureFile::readHeader(output, existing) &&
+            existing.sourceHash == sourceHash && existing.format == static_cast<uint32_t>(format)) {
+            printf("%s: up to date\n", output.c_str());
+            return true;
+        }
+
+        const auto start = std::chrono::steady_clock::now();
+
+        int width = 0, height = 0, channels = 0;
+        stbi_uc* pixels = stbi_load_from_memory(source.getData(), static_cast<int>(source.getSize()), &width, &height, &channels, STBI_rgb_alpha);
+        if (pixels == nullptr) {
+            std::cerr << "이미지를 디코딩할 수 없습니다: " << input << " (" << stbi_failure_reason() << ")" << std::endl;
+            return false;
+        }
+
+        const std::vector<VKImageRGBA8> mips = generateMipLevels(pixels, static_cast<uint32_t>(width), static_cast<uint32_t>(height), filter, &jobSystem);
+
+        if (mips.size() + 1 > TEXTURE_FILE_MAX_LEVELS) {
+            stbi_image_free(pixels);
+            std::cerr << "이미지가 너무 큽니다: " << input << std::endl;
+            return false;
+        }
+
+        std::vector<std::vector<uint8_t>> levels;
+        levels.reserve(mips.size() + 1);
+        uint64_t uncompressedBytes = static_cast<uint64_t>(width) * height * 4;
+
+        levels.push_back(compressImage(pixels, static_cast<uint32_t>(width), static_cast<uint32_t>(height), format, &jobSystem));
+        uint64_t compressedBytes = levels.back().size();
+        stbi_image_free(pixels);
+
+        for (const VKImageRGBA8& mip : mips)
+        {
+            levels.push_back(compressImage(mip.pixels.data(), mip.width, mip.height, format, &jobSystem));
+            uncompressedBytes += mip.pixels.size();
+            compressedBytes += levels.back().size();
+        }
+
+        if (!VKTextureFile::write(output, sourceHash, format, levels, static_cast<uint32_t>(width), static_cast<uint32_t>(height))) {
+            std::cerr << "텍스처 파일을 쓸 수 없습니다: " << output << std::endl;
+            return false;
+        }
+
+        const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        printf("%s: %dx%d, %zu mips, %s, %.1f KB (rgba8 %.1f KB, %.1fx smaller), %.1f ms\n",
+            output.c_str(), width, height, levels.size(), getFormatName(format),
+            compressedBytes / 1024.0, uncompressedBytes / 1024.0,
+            static_cast<double>(uncompressedBytes) / static_cast<double>(compressedBytes), ms);
+
+        return true;
+    }
+}
+
+int main(int argc, char* argv[]) {
+
+    vkengine::asset::VKTextureFormat format = vkengine::asset::VKTextureFormat::BC7;
+    vkengine::asset::VKMipFilter filter = vkengine::asset::VKMipFilter::Kaiser;
+    bool force = false;
+    std::vector<std::string> inputs;
+
+    for (int i = 1; i < argc; i++)
+    {
+        const std::string arg = argv[i];
+
+        if (arg == "-f" && i + 1 < argc) {
+            if (!parseFormat(argv[++i], format)) {
+                std::cerr << "알 수 없는 형식입니다: " << argv[i] << " (bc7, bc1, rgba8)" << std::endl;
+                return EXIT_FAILURE;
+            }
+        }
+        else if (arg == "--filter" && i + 1 < argc) {
+            const std::string name = argv[++i];
+            if (name == "kaiser") {
+                filter = vkengine::asset::VKMipFilter::Kaiser;
+            }
+            else if (name == "box") {
+                filter = vkengine::asset::VKMipFilter::Box;
+            }
+            else {
+                std::cerr << "알 수 없는 필터입니다: " << name << " (kaiser, box)" << std::endl;
+                return EXIT_FAILURE;
+            }
+        }
+        else if (arg == "--force") {
+            force = true;
+        }
+        else {
+            inputs.push_back(arg);
+        }
+    }
+
+    if (inputs.empty()) {
+        std::cerr << "사용법: textureCompiler [-f bc7|bc1|rgba8] [--filter kaiser|box] [--force] 이미지..." << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    vkengine::job::VKJobSystem jobSystem;
+    bool succeeded = true;
+
+    for (const std::string& input : inputs)
+    {
+        succeeded &= compileTexture(input, format, filter, force, jobSystem);
+    }
+
+    jobSystem.cleanup();
+
+    return succeeded ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -3,6 +3,7 @@
 
 #include "./_common.h"
 #include "./math.h"
+#include "./engine/VKallocator.h"
 
 #define GLM_FORCE_RADIANS
 #define GLM_ENABLE_EXPERIMENTAL
@@ -15,10 +16,12 @@
 struct QueueFamilyIndices {
     uint32_t graphicsAndComputeFamily = 0;  // ׷Ƚ/ǻ ť йи ε (׷Ƚ/ǻ  óϴ ť)
     uint32_t presentFamily = 0;             // Ʈ ť йи ε ( ý۰ Vulkan ϴ ̽)
+    uint32_t transferFamily = 0;            //  ť йи ε (ε ,  ׷Ƚ ť йи )
     VkQueueFamilyProperties queueFamilyProperties = {};
 
     bool graphicsAndComputeFamilyHasValue = false;
     bool presentFamilyHasValue = false;
+    bool transferFamilyHasValue = false;
 
     void setgraphicsAndComputeFamily(uint32_t index) {
         graphicsAndComputeFamily = index;
@@ -28,6 +31,10 @@ struct QueueFamilyIndices {
         presentFamily = index;
         presentFamilyHasValue = true;
     }
+    void setTransferFamily(uint32_t index) {
+        transferFamily = index;
+        transferFamilyHasValue = true;
+    }
     const uint32_t getGraphicsQueueFamilyIndex() {
         uint32_t target = -1;
 
@@ -62,6 +69,8 @@ struct QueueFamilyIndices {
         this->presentFamily = 0;
         this->graphicsAndComputeFamilyHasValue = false;
         this->presentFamilyHasValue = false;
+        this->transferFamily = 0;
+        this->transferFamilyHasValue = false;
         this->queueFamilyProperties = {};
     }
 };
@@ -118,6 +127,47 @@ struct Vertex {
 
 };
 
+//  ؽ (16Ʈ)
+// ġ: ޽ AABB  16Ʈ ȭ (w е), : RGBA8, UV: half float
+// -> ġ  ʿ AABB ̴ Ǫ  ѱϴ. (VKVertexQuantization)
+struct VertexPacked {
+    uint16_t pos[4];
+    uint8_t color[4];
+    uint16_t texCoord[2];
+
+    static VkVertexInputBindingDescription getBindingDescription() {
+        VkVertexInputBindingDescription bindingDescription{};
+
+        bindingDescription.binding = 0;
+        bindingDescription.stride = sizeof(VertexPacked);
+        bindingDescription.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+
+        return bindingDescription;
+    }
+
+    // Vertex  location Ƿ ̴ Է(vec3, vec3, vec2) ״Դϴ.
+    static std::array<VkVertexInputAttributeDescription, 3> getAttributeDescriptions() {
+        std::array<VkVertexInputAttributeDescription, 3> attributeDescriptions{};
+
+        attributeDescriptions[0].binding = 0;
+        attributeDescriptions[0].location = 0;
+        attributeDescriptions[0].format = VK_FORMAT_R16G16B16A16_UNORM;
+        attributeDescriptions[0].offset = offsetof(VertexPacked, pos);
+
+        attributeDescriptions[1].binding = 0;
+        attributeDescriptions[1].location = 1;
+        attributeDescriptions[1].format = VK_FORMAT_R8G8B8A8_UNORM;
+        attributeDescriptions[1].offset = offsetof(VertexPacked, color);
+
+        attributeDescriptions[2].binding = 0;
+        attributeDescriptions[2].location = 2;
+        attributeDescriptions[2].format = VK_FORMAT_R16G16_SFLOAT;
+        attributeDescriptions[2].offset = offsetof(VertexPacked, texCoord);
+
+        return attributeDescriptions;
+    }
+};
+
 struct VertexPosColor {
     glm::vec3 pos;
     glm::vec3 color;
@@ -160,26 +210,24 @@ struct VertexPosColor {
 
 struct VertexBuffer {
     VkBuffer vertexBuffer;
-    VkDeviceMemory vertexMemory;
+    vkengine::memory::VKAllocation vertexMemory;
     VkBuffer indexBuffer;
-    VkDeviceMemory indexmemory;
+    vkengine::memory::VKAllocation indexmemory;
 
-    void cleanup(VkDevice device) {
-        vkDestroyBuffer(device, vertexBuffer, nullptr);
-        vkFreeMemory(device, vertexMemory, nullptr);
-        vkDestroyBuffer(device, indexBuffer, nullptr);
-        vkFreeMemory(device, indexmemory, nullptr);
+    void cleanup(vkengine::memory::VKMemoryAllocator* allocator) {
+        allocator->destroyBuffer(vertexBuffer, vertexMemory);
+        allocator->destroyBuffer(indexBuffer, indexmemory);
     }
 };
 
 struct UniformBuffer {
     VkBuffer buffer;
-    VkDeviceMemory memory;
-    void* Mapped;
+    vkengine::memory::VKAllocation memory;
+    void* Mapped;       // memory.mapped ->     ε ּ
 
-    void cleanup(VkDevice device) {
-        vkDestroyBuffer(device, buffer, nullptr);
-        vkFreeMemory(device, memory, nullptr);
+    void cleanup(vkengine::memory::VKMemoryAllocator* allocator) {
+        allocator->destroyBuffer(buffer, memory);
+        Mapped = nullptr;
     }
 };
 
@@ -221,13 +269,12 @@ struct UniformBufferTime {
 struct depthStencill {
     VkFormat depthFormat{};
     VkImage depthImage{};
-    VkDeviceMemory depthImageMemory{};
+    vkengine::memory::VKAllocation depthImageMemory{};
     VkImageView depthImageView{};
 
-    void cleanup(VkDevice device) {
+    void cleanup(VkDevice device, vkengine::memory::VKMemoryAllocator* allocator) {
         vkDestroyImageView(device, depthImageView, nullptr);
-        vkDestroyImage(device, depthImage, nullptr);
-        vkFreeMemory(device, depthImageMemory, nullptr);
+        allocator->destroyImage(depthImage, depthImageMemory);
     }
 };
 
@@ -247,12 +294,29 @@ struct FrameData {
     VkCommandBufferBeginInfo commandBufferBeginInfo(VkCommandBufferUsageFlags flags = 0);
 };
 
+//   ܰ躰 CPU ð(ms) GPU ð -> drawFrame ä ġũ нϴ.
+struct FrameTimings {
+    double wait = 0.0;          //  潺  (GPU з  )
+    double acquire = 0.0;       //  ü ̹ ȹ
+    double uniform = 0.0;       // uniform   ( )
+    double record = 0.0;        // Ŀǵ  
+    double submit = 0.0;        // ε flush + ť 
+    double present = 0.0;       // Ʈ
+    double gpu = -1.0;          //     Ŀǵ  GPU  ð (Ÿӽ,  ϸ )
+};
+
 struct UniformBufferObject {
     glm::mat4 model;
     glm::mat4 view;
     glm::mat4 proj;
 };
 
+// νϽ ϳ  -> 丮 ۿ std430 ̰ ؽ ̴ gl_InstanceIndex нϴ.
+struct InstanceData {
+    glm::mat4 model;
+    glm::vec4 color;            // ؽ  մϴ.
+};
+
 const std::vector<Vertex> testVectex = {
     {{-0.5f, -0.5f, 0.0f}, {1.0f, 0.0f, 0.0f}, {0.0f, 0.0f}},
     {{0.5f, -0.5f, 0.0f}, {0.0f, 1.0f, 0.0f}, {1.0f, 0.0f}},
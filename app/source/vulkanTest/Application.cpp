@@ -3,6 +3,7 @@
 #include "Camera.h"
 
 #include "../struct.h"
+#include "../engine/VKtrace.h"
 
 #ifndef STB_IMAGE_IMPLEMENTATION
 #define STB_IMAGE_IMPLEMENTATION
@@ -31,6 +32,8 @@ namespace vkutil {
     }
 
     Application::Application(std::string root_path) {
+        VK_TRACE_THREAD_NAME("main");
+
         this->VKwindow = nullptr;
         this->VKinstance = {};
         this->VKdebugUtilsMessenger = VK_NULL_HANDLE;
@@ -47,15 +50,15 @@ namespace vkutil {
         this->VKswapChainExtent = { 0, 0 };
         this->VKpipelineLayout = VK_NULL_HANDLE;
         this->VKrenderPass = VK_NULL_HANDLE;
-        this->VKgraphicsPipeline = VK_NULL_HANDLE;
+        this->VKgraphicsPipeline = {};
         this->VKswapChainFramebuffers.clear();
         this->VKcommandPool = VK_NULL_HANDLE;
         this->VKcommandBuffers.clear();
         this->VkimageavailableSemaphore.clear();
         this->VkrenderFinishedSemaphore.clear();
         this->VKvertexBuffer = VK_NULL_HANDLE;
-        this->VKvertexBufferMemory = VK_NULL_HANDLE;
-        this->VKindexBufferMemory = VK_NULL_HANDLE;
+        this->VKvertexBufferMemory = {};
+        this->VKindexBufferMemory = {};
         this->VkinFlightFences.clear();
         this->VKuniformBuffers.clear();
         this->VKuniformBuffersMemory.clear();
@@ -68,8 +71,10 @@ namespace vkutil {
         this->currentFrame = 0;
         this->state = true;
         this->framebufferResized = false;
-        this->VKtextureImage = VK_NULL_HANDLE;
-        this->VKtextureImageMemory = VK_NULL_HANDLE;
+        this->VKtexture = 0;
+        for (VkImageView& view : this->VKboundTextureViews) {
+            view = VK_NULL_HANDLE;
+        }
         
         this->camera = std::make_shared<vkutil::object::Camera>();
         this->camera->setProjection(45.0f, (float)WIDTH / (float)HEIGHT, 0.1f, 100.0f);
@@ -84,6 +89,14 @@ namespace vkutil {
         initWindow(); //    GLFW  
         initVulkan();
         initUI();
+
+        // ĳ       ð
+        this->VKpipelineManager->waitIdle();
+        this->VKpipelineCache.report();
+
+#if SHADER_HOT_RELOAD
+        this->VKpipelineManager->watchShaders();
+#endif
     }
 
     void Application::update() {
@@ -106,30 +119,26 @@ namespace vkutil {
         this->cleanupSwapChain();
 
         vkDestroySampler(this->VKdevice, this->VKtextureSampler, nullptr);
-        vkDestroyImageView(this->VKdevice, this->VKtextureImageView, nullptr);
 
-        vkDestroyImage(this->VKdevice, this->VKtextureImage, nullptr);
-        vkFreeMemory(this->VKdevice, this->VKtextureImageMemory, nullptr);
+        // ڵ 带 ߰ ؽó մϴ. -> Ҵ⺸ 
+        this->VKtextureStreamer->cleanup();
+        this->VKtextureStreamer.reset();
 
-        vkDestroyPipeline(this->VKdevice, this->VKgraphicsPipeline, nullptr);
         vkDestroyPipelineLayout(this->VKdevice, this->VKpipelineLayout, nullptr);
         
         vkDestroyRenderPass(this->VKdevice, this->VKrenderPass, nullptr);
 
         for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++)
         {
-            vkDestroyBuffer(this->VKdevice, this->VKuniformBuffers[i], nullptr);
-            vkFreeMemory(this->VKdevice, this->VKuniformBuffersMemory[i], nullptr);
+            this->VKallocator->destroyBuffer(this->VKuniformBuffers[i], this->VKuniformBuffersMemory[i]);
         }
 
         vkDestroyDescriptorPool(this->VKdevice, this->VKdescriptorPool, nullptr);
         vkDestroyDescriptorSetLayout(this->VKdevice, this->VKdescriptorSetLayout, nullptr);
 
-        vkDestroyBuffer(this->VKdevice, this->VKvertexBuffer, nullptr);
-        vkFreeMemory(this->VKdevice, this->VKvertexBufferMemory, nullptr);
-
-        vkDestroyBuffer(this->VKdevice, this->VKindexBuffer, nullptr);
-        vkFreeMemory(this->VKdevice, this->VKindexBufferMemory, nullptr);
+        this->VKallocator->destroyBuffer(this->VKvertexBuffer, this->VKvertexBufferMemory);
+        this->VKallocator->destroyBuffer(this->VKindexBuffer, this->VKindexBufferMemory);
+        this->VKmesh.close();
 
         for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++)
         {
@@ -138,8 +147,31 @@ namespace vkutil {
             vkDestroyFence(this->VKdevice, this->VkinFlightFences[i], nullptr);
         }
 
+        helper_::releaseSingleTimeCommands(this->VKdevice, this->VKcommandPool);
         vkDestroyCommandPool(this->VKdevice, this->VKcommandPool, nullptr);
 
+        // 庰 Ŀǵ Ǯ ϰ  ý Ŀ 带 ϴ.
+        this->VKcommandRecorder->cleanup();
+        this->VKcommandRecorder.reset();
+        this->VKjobSystem->cleanup();
+        this->VKjobSystem.reset();
+
+        // ¡  Ҵ ۸ Ƿ Ҵ⺸  մϴ.
+        this->VKstagingRing->cleanup();
+        this->VKstagingRing.reset();
+
+        //  带 ߰   ,  ĳø Ϸ ϰ մϴ.
+        this->VKpipelineManager->cleanup();
+        this->VKpipelineManager.reset();
+        this->VKpipelineCache.cleanup();
+
+        // Ҵ  ̽  Ǿ մϴ.
+#ifdef DEBUG_
+        this->VKallocator->printStats();
+#endif // DEBUG_
+        this->VKallocator->cleanup();
+        this->VKallocator.reset();
+
         vkDestroyDevice(this->VKdevice, nullptr);
 
 
@@ -187,6 +219,9 @@ namespace vkutil {
         this->createImageViews();
         this->createRenderPass();
         
+        // ޽ø ؽ  Ƿ κ  ҷɴϴ.
+        this->loadModel();
+
         // shader 
         this->createDescriptorSetLayout();
         this->createGraphicsPipeline();
@@ -201,9 +236,7 @@ namespace vkutil {
         this->createFramebuffers();
 
         this->createTextureImage();
-        this->createTextureImageView();
         this->createTextureSampler();
-        this->loadModel();
 
         this->createVertexBuffer();
         this->createIndexBuffer();
@@ -217,9 +250,17 @@ namespace vkutil {
 
     void Application::drawFrame()
     {
+        VK_TRACE_SCOPE("drawFrame");
+
         //  ϱ    غ Ǿ Ȯմϴ.
         vkWaitForFences(this->VKdevice, 1, &this->VkinFlightFences[currentFrame], VK_TRUE, UINT64_MAX);
 
+        //   GPU ۾ Ƿ 庰 Ŀǵ Ǯ մϴ.
+        this->VKcommandRecorder->resetFrame(static_cast<uint32_t>(this->currentFrame));
+
+        // ٲ ̴   ٽ ϰ, ü  մϴ.
+        this->VKpipelineManager->update();
+
         uint32_t imageIndex;
 
         // ̹    üο ̹ ε ɴϴ.
@@ -266,6 +307,9 @@ namespace vkutil {
 
         vkResetFences(this->VKdevice, 1, &this->VkinFlightFences[currentFrame]); // ÷׸ 缳մϴ. ->   ÷׸ 缳մϴ.
 
+        // ̹ ӿ  ε带    ť մϴ. (ϵ   ƹ͵  )
+        this->VKstagingRing->flush();
+
         //  մϴ.
         if (vkQueueSubmit(this->graphicsVKQueue, 1, &submitInfo, this->VkinFlightFences[currentFrame]) != VK_SUCCESS) {
             throw std::runtime_error("failed to submit draw command buffer!");
@@ -315,7 +359,7 @@ namespace vkutil {
         init_info.ImageCount = MAX_FRAMES_IN_FLIGHT;
         init_info.MinImageCount = MAX_FRAMES_IN_FLIGHT;
         init_info.Queue = this->graphicsVKQueue;
-        init_info.PipelineCache = VK_NULL_HANDLE;
+        init_info.PipelineCache = this->VKpipelineCache.getHandle();
         init_info.DescriptorPool = this->VKdescriptorPool;
         init_info.Allocator = VK_NULL_HANDLE;
         init_info.RenderPass = this->VKrenderPass;
@@ -478,7 +522,8 @@ namespace vkutil {
         
         std::set<uint32_t> uniqueQueueFamilies = {
             this->VKqueueFamilyIndices.graphicsAndComputeFamily,
-            this->VKqueueFamilyIndices.presentFamily
+            this->VKqueueFamilyIndices.presentFamily,
+            this->VKqueueFamilyIndices.transferFamily
         };
 
         float queuePriority = 1.0f;                                                                      // ť 켱 մϴ.
@@ -492,9 +537,14 @@ namespace vkutil {
         }
 
         //  ġ  ü ʱȭմϴ.
+        VkPhysicalDeviceFeatures supportedFeatures{};
+        vkGetPhysicalDeviceFeatures(this->VKphysicalDevice, &supportedFeatures);
+
         VkPhysicalDeviceFeatures deviceFeatures{};
         deviceFeatures.samplerAnisotropy = VK_TRUE; // ÷ Ͽ ؽó մϴ.
         deviceFeatures.sampleRateShading = VK_TRUE; //  Ʈ ̵ Ͽ ȼ ׸ϴ.
+        deviceFeatures.textureCompressionBC = supportedFeatures.textureCompressionBC; // ϸ BC ؽó (.vktex) ״ øϴ.
+        this->VKtextureCompressionBC = supportedFeatures.textureCompressionBC == VK_TRUE;
 
 
         //  ġ   ü ʱȭմϴ.
@@ -523,6 +573,31 @@ namespace vkutil {
         vkGetDeviceQueue(this->VKdevice, this->VKqueueFamilyIndices.graphicsAndComputeFamily, 0, &this->graphicsVKQueue);
         //  ̽ ̼ ť ڵ ɴϴ.
         vkGetDeviceQueue(this->VKdevice, this->VKqueueFamilyIndices.presentFamily, 0, &this->presentVKQueue);
+        //  ̽  ť ڵ ɴϴ.
+        vkGetDeviceQueue(this->VKdevice, this->VKqueueFamilyIndices.transferFamily, 0, &this->transferVKQueue);
+
+        //  ̽ ޸ Ҵ⸦ մϴ.
+        this->VKallocator = std::make_unique<vkengine::memory::VKMemoryAllocator>(this->VKphysicalDevice, this->VKdevice);
+
+        //  ť ϴ ¡  ۸ մϴ.
+        //  ť йи   ε尡  ҽ  ׷Ƚ ť ѱϴ.
+        this->VKstagingRing = std::make_unique<vkengine::memory::VKStagingRing>(
+            this->VKdevice,
+            this->transferVKQueue, this->VKqueueFamilyIndices.transferFamily,
+            this->graphicsVKQueue, this->VKqueueFamilyIndices.graphicsAndComputeFamily,
+            this->VKallocator.get());
+
+        //  ܰ踦  ϴ  ý۰,  ý 庰 Ŀǵ Ǯ secondary Ŀǵ ۸ ϴ ڴ մϴ.
+        this->VKjobSystem = std::make_unique<vkengine::job::VKJobSystem>();
+        this->VKcommandRecorder = std::make_unique<vkengine::VKCommandRecorder>(this->VKdevice, this->VKqueueFamilyIndices.graphicsAndComputeFamily, *this->VKjobSystem);
+
+        //   ĳð  ġ  ̸ ҷɴϴ.
+        VkPhysicalDeviceProperties deviceProperties{};
+        vkGetPhysicalDeviceProperties(this->VKphysicalDevice, &deviceProperties);
+        this->VKpipelineCache.create(this->VKdevice, deviceProperties, this->RootPath + vkengine::PIPELINE_CACHE_FILE);
+
+        //  ׷Ƚ  ڸ   ĳ÷ ϴ.
+        this->VKpipelineManager = std::make_unique<vkengine::VKPipelineManager>(this->VKdevice, this->VKpipelineCache);
     }
 
     void Application::createSurface()
@@ -724,183 +799,48 @@ namespace vkutil {
 
     void Application::createGraphicsPipeline()
     {
-        auto vertShaderCode = helper_::readFile(this->RootPath + "../../../../../../shader/vert.spv");
-        auto fragShaderCode = helper_::readFile(this->RootPath + "../../../../../../shader/frag.spv");
-
-        VkShaderModule baseVertshaderModule = createShaderModule(vertShaderCode);
-        VkShaderModule baseFragShaderModule = createShaderModule(fragShaderCode);
-
-        VkPipelineShaderStageCreateInfo vertShaderStageInfo{};
-        vertShaderStageInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
-        vertShaderStageInfo.stage = VK_SHADER_STAGE_VERTEX_BIT;
-        vertShaderStageInfo.module = baseVertshaderModule;
-        vertShaderStageInfo.pName = "main";
-
-        VkPipelineShaderStageCreateInfo fragShaderStageInfo{};
-        fragShaderStageInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
-        fragShaderStageInfo.stage = VK_SHADER_STAGE_FRAGMENT_BIT;
-        fragShaderStageInfo.module = baseFragShaderModule;
-        fragShaderStageInfo.pName = "main";
-
-        VkPipelineShaderStageCreateInfo shaderStages[] = { vertShaderStageInfo, fragShaderStageInfo };
-
-        // vertex input
-        auto bindingDescription = Vertex::getBindingDescription();
-        auto attributeDescriptions = Vertex::getAttributeDescriptions();
-
         // ׷  ̾ƿ մϴ.
-        VkPipelineVertexInputStateCreateInfo vertexInputInfo{};
-        vertexInputInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
-        vertexInputInfo.vertexBindingDescriptionCount = 1;
-        vertexInputInfo.vertexAttributeDescriptionCount = static_cast<uint32_t>(attributeDescriptions.size());
-        vertexInputInfo.pVertexBindingDescriptions = &bindingDescription;
-        vertexInputInfo.pVertexAttributeDescriptions = attributeDescriptions.data();
-
-        // Է ͸  ·   մϴ.
-        VkPipelineInputAssemblyStateCreateInfo inputAssembly{};
-        inputAssembly.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
-        inputAssembly.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST; // ﰢ Ʈ 
-        inputAssembly.primitiveRestartEnable = VK_FALSE; // Ƽ  Ȱȭ
-
-        VkViewport viewpport{};
-        viewpport.x = 0.0f;
-        viewpport.y = 0.0f;
-        viewpport.width = (float)this->VKswapChainExtent.width;
-        viewpport.height = (float)this->VKswapChainExtent.height;
-        viewpport.minDepth = 0.0f;
-        viewpport.maxDepth = 1.0f;
-
-        VkRect2D scissor{};
-        scissor.offset = { 0, 0 };
-        scissor.extent = this->VKswapChainExtent;
-
-        // Ʈ 
-        VkPipelineViewportStateCreateInfo viewportState{};
-        viewportState.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
-        viewportState.viewportCount = 1;
-        viewportState.pViewports = &viewpport;
-        viewportState.scissorCount = 1;
-        viewportState.pScissors = &scissor;
-
-        // ȭ 
-        VkPipelineRasterizationStateCreateInfo rasterizer{};
-        rasterizer.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
-        rasterizer.depthClampEnable = VK_FALSE;                 //  Ŭ Ȱȭ
-        rasterizer.rasterizerDiscardEnable = VK_FALSE;          // ȭ  Ȱȭ
-        rasterizer.polygonMode = VK_POLYGON_MODE_FILL;          // ٰ 带 ä 
-        rasterizer.lineWidth = 1.0f;                            //  ʺ 1.0f 
-        rasterizer.cullMode = VK_CULL_MODE_BACK_BIT;            // ĸ  
-        rasterizer.frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE; //   ݽð  
-        rasterizer.depthBiasEnable = VK_FALSE;                  //  ̾ Ȱȭ
-        //rasterizer.depthBiasConstantFactor = 0.0f;              //  ̾  Ҹ 0.0f 
-        //rasterizer.depthBiasClamp = 0.0f;                       //  ̾ Ŭ 0.0f 
-        //rasterizer.depthBiasSlopeFactor = 0.0f;                 //  ̾  Ҹ 0.0f 
-
-        //  ø 
-        VkPipelineMultisampleStateCreateInfo multisampling{};
-        multisampling.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO; //
-        multisampling.sampleShadingEnable = VK_TRUE;               // ø ̵ Ȱȭ
-        multisampling.rasterizationSamples = this->VKmsaaSamples; // ȭ   1Ʈ 
-        multisampling.minSampleShading = 0.2f;                      // ּ ø 0.2f 
-        multisampling.pSampleMask = nullptr;                        //  ũ nullptr  -> option
-        multisampling.alphaToCoverageEnable = VK_FALSE;             //  Ŀ Ȱȭ -> option
-        multisampling.alphaToOneEnable = VK_FALSE;                  //   Ȱȭ -> option
-
-        //  ٽ ׽Ʈ 
-        VkPipelineDepthStencilStateCreateInfo depthStencil{};
-        depthStencil.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
-        depthStencil.depthTestEnable = VK_TRUE;
-        depthStencil.depthWriteEnable = VK_TRUE;
-        depthStencil.depthCompareOp = VK_COMPARE_OP_LESS;
-        depthStencil.depthBoundsTestEnable = VK_FALSE;
-        depthStencil.stencilTestEnable = VK_FALSE;
-        depthStencil.minDepthBounds = 0.0f; // Optional
-        depthStencil.maxDepthBounds = 1.0f; // Optional
-        depthStencil.stencilTestEnable = VK_FALSE;
-        depthStencil.front = {}; // Optional
-        depthStencil.back = {}; // Optional
-
-        // ÷  
-        VkPipelineColorBlendAttachmentState colorBlendAttachment{};
-        colorBlendAttachment.colorWriteMask = VK_COLOR_COMPONENT_R_BIT |
-            VK_COLOR_COMPONENT_G_BIT |
-            VK_COLOR_COMPONENT_B_BIT |
-            VK_COLOR_COMPONENT_A_BIT;     // ÷  ũ 
-        colorBlendAttachment.blendEnable = VK_FALSE;                        //  Ȱȭ
-        colorBlendAttachment.srcColorBlendFactor = VK_BLEND_FACTOR_ONE;     // ҽ ÷  ͸ 
-        colorBlendAttachment.dstColorBlendFactor = VK_BLEND_FACTOR_ZERO;    //  ÷  ͸ 
-        colorBlendAttachment.colorBlendOp = VK_BLEND_OP_ADD;                // ÷   
-        colorBlendAttachment.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE;     // ҽ   ͸ 
-        colorBlendAttachment.dstAlphaBlendFactor = VK_BLEND_FACTOR_ZERO;    //    ͸ 
-        colorBlendAttachment.alphaBlendOp = VK_BLEND_OP_ADD;                //    
-        /*
-        if (blendEnable) {
-            finalColor.rgb = (srcColorBlendFactor * newColor.rgb) <colorBlendOp> (dstColorBlendFactor * oldColor.rgb);
-            finalColor.a = (srcAlphaBlendFactor * newColor.a) <alphaBlendOp> (dstAlphaBlendFactor * oldColor.a);
-        } else {
-            finalColor = newColor;
-        }
-
-        finalColor = finalColor & colorWriteMask;
-        */
-
-        // ÷     ü ʱȭմϴ.
-        VkPipelineColorBlendStateCreateInfo colorBlending{};
-        colorBlending.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO; // ü Ÿ 
-        colorBlending.logicOpEnable = VK_FALSE;                                       //   Ȱȭ
-        colorBlending.logicOp = VK_LOGIC_OP_COPY;                                     //   
-        colorBlending.attachmentCount = 1;                                            // ÷  ÷  
-        colorBlending.pAttachments = &colorBlendAttachment;                           // ÷  ÷ ͸ 
-        colorBlending.blendConstants[0] = 0.0f;                                       //   
-        colorBlending.blendConstants[1] = 0.0f;                                       //   
-        colorBlending.blendConstants[2] = 0.0f;                                       //   
-        colorBlending.blendConstants[3] = 0.0f;                                       //   
-
-        //   ¸ մϴ.
-        VkPipelineDynamicStateCreateInfo dynamicState{};
-        dynamicState.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
-        dynamicState.dynamicStateCount = static_cast<uint32_t>(dynamicStates.size());
-        dynamicState.pDynamicStates = dynamicStates.data();
+        //  ؽ ġ   (VKVertexQuantization)
+        VkPushConstantRange pushConstantRange{};
+        pushConstantRange.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+        pushConstantRange.offset = 0;
+        pushConstantRange.size = sizeof(vkengine::asset::VKVertexQuantization);
 
-        // ׷  ̾ƿ մϴ.
         VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
         pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO; // ü Ÿ 
         pipelineLayoutInfo.setLayoutCount = 1;                                    // ̾ƿ  
         pipelineLayoutInfo.pSetLayouts = &this->VKdescriptorSetLayout;            // ̾ƿ ͸ 
-        pipelineLayoutInfo.pushConstantRangeCount = 0;                            // Ǫ    
-        pipelineLayoutInfo.pPushConstantRanges = nullptr;                         // Ǫ   ͸ 
+        pipelineLayoutInfo.pushConstantRangeCount = 1;                            // Ǫ    
+        pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;              // Ǫ   ͸ 
 
         if (vkCreatePipelineLayout(this->VKdevice, &pipelineLayoutInfo, nullptr, &this->VKpipelineLayout) != VK_SUCCESS) {
             throw std::runtime_error("failed to create pipeline layout!");
         }
 
+        //  ¸ ؼ ڿ ûմϴ. ->  ׶ 忡 ˴ϴ.
+        vkengine::VKGraphicsPipelineDesc desc{};
+        desc.vertexShader = this->VKpipelineManager->loadShaderModule(this->RootPath + "../../../../../../shader/vert.spv");
+        desc.fragmentShader = this->VKpipelineManager->loadShaderModule(this->RootPath + "../../../../../../shader/frag.spv");
 
-        // ׷    ü ʱȭմϴ.
-        VkGraphicsPipelineCreateInfo pipelineInfo{};
-        pipelineInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
-        pipelineInfo.stageCount = 2;
-        pipelineInfo.pStages = shaderStages;
-        pipelineInfo.pVertexInputState = &vertexInputInfo;
-        pipelineInfo.pInputAssemblyState = &inputAssembly;
-        pipelineInfo.pViewportState = &viewportState;
-        pipelineInfo.pRasterizationState = &rasterizer;
-        pipelineInfo.pMultisampleState = &multisampling;
-        pipelineInfo.pDepthStencilState = &depthStencil; // Optional
-        pipelineInfo.pColorBlendState = &colorBlending;
-        pipelineInfo.pDynamicState = &dynamicState; // Optional
-        pipelineInfo.layout = this->VKpipelineLayout;
-        pipelineInfo.renderPass = this->VKrenderPass;
-        pipelineInfo.subpass = 0;
-        pipelineInfo.basePipelineHandle = VK_NULL_HANDLE; // Optional
-        pipelineInfo.basePipelineIndex = -1; // Optional
-
-        if (vkCreateGraphicsPipelines(this->VKdevice, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &this->VKgraphicsPipeline) != VK_SUCCESS) {
-            throw std::runtime_error("failed to create graphics pipeline!");
+        // vertex input -> ޽ø ҷ    ϴ.
+        if (this->VKvertexFormat == vkengine::asset::VKVertexFormat::Packed) {
+            desc.setVertexInput<VertexPacked>();
+        }
+        else {
+            desc.setVertexInput<Vertex>();
         }
 
-        vkDestroyShaderModule(this->VKdevice, baseVertshaderModule, nullptr);
-        vkDestroyShaderModule(this->VKdevice, baseFragShaderModule, nullptr);
+        desc.cullMode = VK_CULL_MODE_BACK_BIT;                  // ĸ  
+        desc.frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE;       //   ݽð  
+        desc.samples = this->VKmsaaSamples;
+        desc.sampleShadingEnable = VK_TRUE;
+        desc.minSampleShading = 0.2f;                           // ּ ø 0.2f 
+        desc.depthCompareOp = VK_COMPARE_OP_LESS;
+        desc.layout = this->VKpipelineLayout;
+        desc.renderPass = this->VKrenderPass;
+        desc.subpass = 0;
 
+        this->VKgraphicsPipeline = this->VKpipelineManager->request(desc);
     }
 
     void Application::createFramebuffers()
@@ -990,12 +930,10 @@ namespace vkutil {
     void Application::cleanupSwapChain()
     {
         vkDestroyImageView(this->VKdevice, this->VKcolorImageView, nullptr); // ÷ ̹ 並 մϴ.
-        vkDestroyImage(this->VKdevice, this->VKcolorImage, nullptr); // ÷ ̹ մϴ.
-        vkFreeMemory(this->VKdevice, this->VKcolorImageMemory, nullptr); // ÷ ̹ ޸𸮸 մϴ.
+        this->VKallocator->destroyImage(this->VKcolorImage, this->VKcolorImageMemory); // ÷ ̹ ޸𸮸 մϴ.
 
         vkDestroyImageView(this->VKdevice, this->VKdepthImageView, nullptr); //  ̹ 並 մϴ.
-        vkDestroyImage(this->VKdevice, this->VKdepthImage, nullptr); //  ̹ մϴ.
-        vkFreeMemory(this->VKdevice, this->VKdepthImageMemory, nullptr); //  ̹ ޸𸮸 մϴ.
+        this->VKallocator->destroyImage(this->VKdepthImage, this->VKdepthImageMemory); //  ̹ ޸𸮸 մϴ.
 
         for (auto framebuffer : VKswapChainFramebuffers)
         {
@@ -1034,91 +972,53 @@ namespace vkutil {
 
     void Application::createVertexBuffer()
     {
-        VkDeviceSize bufferSize = sizeof(this->VKvertices[0]) * this->VKvertices.size();
-        
-        VkBuffer stagingBuffer;
-        VkDeviceMemory stagingBufferMemory;
+        //  ̸ AABB  ȭ 迭 øϴ. -> ؽ  ũⰡ 
+        std::vector<VertexPacked> packedVertices;
+        const void* vertexData = this->VKmesh.getVertices();
+        VkDeviceSize bufferSize = sizeof(Vertex) * this->VKmesh.getVertexCount();
 
-        helper_::createBuffer(
-            this->VKdevice,
-            this->VKphysicalDevice,
-            bufferSize,
-            VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
-            VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-            stagingBuffer,
-            stagingBufferMemory);
+        this->VKvertexQuantization = vkengine::asset::VKVertexQuantization{};
+        if (this->VKvertexFormat == vkengine::asset::VKVertexFormat::Packed) {
+            this->VKvertexQuantization = vkengine::asset::packVertices(
+                this->VKmesh.getVertices(), this->VKmesh.getVertexCount(), this->VKmesh.getBoundsMin(), this->VKmesh.getBoundsMax(), packedVertices);
 
-        void* data;
-        vkMapMemory(this->VKdevice, stagingBufferMemory, 0, bufferSize, 0, &data);
-            memcpy(data, this->VKvertices.data(), (size_t)bufferSize);
-        vkUnmapMemory(this->VKdevice, stagingBufferMemory);
+            vertexData = packedVertices.data();
+            bufferSize = sizeof(VertexPacked) * packedVertices.size();
+        }
+
+#ifdef DEBUG_
+        printf("[vertex buffer] %s, %u vertices, %llu bytes\n",
+            this->VKvertexFormat == vkengine::asset::VKVertexFormat::Packed ? "packed" : "float",
+            this->VKmesh.getVertexCount(), static_cast<unsigned long long>(bufferSize));
+#endif // DEBUG_
 
         helper_::createBuffer(
-            this->VKdevice,
-            this->VKphysicalDevice,
+            this->VKallocator.get(),
             bufferSize,
             VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
             VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
             this->VKvertexBuffer,
             this->VKvertexBufferMemory);
 
-        helper_::copyBuffer(
-            this->VKdevice, 
-            this->VKcommandPool, 
-            this->graphicsVKQueue, 
-            stagingBuffer, 
-            this->VKvertexBuffer, 
-            bufferSize);
-
-        // ¡ ۿ ̽ ۷ ͸  Ŀ ̸ ؾ մϴ:
-        vkDestroyBuffer(this->VKdevice, stagingBuffer, nullptr);
-        vkFreeMemory(this->VKdevice, stagingBufferMemory, nullptr);
+        // ¡   ɸ մϴ. ->  flush()   ̷ϴ.
+        // ĳø   ε ޸𸮿 ¡ ۷ ٷ մϴ.
+        this->VKstagingRing->uploadBuffer(this->VKvertexBuffer, vertexData, bufferSize);
     }
 
     void Application::createIndexBuffer()
     {
-        VkDeviceSize bufferSize = sizeof(this->VKindices[0]) * this->VKindices.size();
-
-        VkBuffer stagingBuffer;
-        VkDeviceMemory stagingBufferMemory;
+        VkDeviceSize bufferSize = sizeof(uint32_t) * this->VKmesh.getIndexCount();
 
         helper_::createBuffer(
-            this->VKdevice,
-            this->VKphysicalDevice,
-            bufferSize,
-            VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
-            VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-            stagingBuffer,
-            stagingBufferMemory);
-
-        
-        void* data;
-        vkMapMemory(this->VKdevice, stagingBufferMemory, 0, bufferSize, 0, &data);
-            memcpy(data, this->VKindices.data(), (size_t)bufferSize);
-        vkUnmapMemory(this->VKdevice, stagingBufferMemory);
-        
-        helper_::createBuffer(
-            this->VKdevice,
-            this->VKphysicalDevice,
+            this->VKallocator.get(),
             bufferSize,
             VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT,
             VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
             this->VKindexBuffer,
             this->VKindexBufferMemory);
 
-        helper_::copyBuffer(
-            this->VKdevice,
-            this->VKcommandPool,
-            this->graphicsVKQueue,
-            stagingBuffer,
-            this->VKindexBuffer,
-            bufferSize);
-
-        vkDestroyBuffer(this->VKdevice, stagingBuffer, nullptr);
-        vkFreeMemory(this->VKdevice, stagingBufferMemory, nullptr);
-
+        // ¡   ɸ մϴ. ->  flush()   ̷ϴ.
+        this->VKstagingRing->uploadBuffer(this->VKindexBuffer, this->VKmesh.getIndices(), bufferSize);
     }
 
     void Application::createDescriptorSetLayout()
@@ -1169,8 +1069,7 @@ namespace vkutil {
 
         for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
             helper_::createBuffer(
-                this->VKdevice,
-                this->VKphysicalDevice,
+                this->VKallocator.get(),
                 bufferSize,
                 VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
                 VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
@@ -1178,7 +1077,7 @@ namespace vkutil {
                 this->VKuniformBuffers[i],
                 this->VKuniformBuffersMemory[i]);
 
-            vkMapMemory(this->VKdevice, this->VKuniformBuffersMemory[i], 0, bufferSize, 0, &this->VKuniformBuffersMapped[i]);
+            this->VKuniformBuffersMapped[i] = this->VKuniformBuffersMemory[i].mapped;
         }
     }
 
@@ -1239,8 +1138,9 @@ namespace vkutil {
             // ũ ̹  մϴ.
             VkDescriptorImageInfo imageInfo{};
             imageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-            imageInfo.imageView = this->VKtextureImageView;
+            imageInfo.imageView = this->VKtextureStreamer->getImageView(this->VKtexture);
             imageInfo.sampler = this->VKtextureSampler;
+            this->VKboundTextureViews[i] = imageInfo.imageView;
 
             std::array<VkWriteDescriptorSet, 2> descriptorWrites{};
 
@@ -1266,98 +1166,18 @@ namespace vkutil {
 
     void Application::createTextureImage()
     {
-        int texWidth, texHeight, texChannels;
-        //stbi_uc* pixels = stbi_load((this->RootPath + "/../../../../source/image.jpg").c_str(), &texWidth, &texHeight, &texChannels, STBI_rgb_alpha);
-        std::string objtex = this->RootPath + TEXTURE_PATH;
+        VK_TRACE_SCOPE("createTextureImage");
 
-        stbi_uc* pixels = stbi_load(objtex.c_str(), &texWidth, &texHeight, &texChannels, STBI_rgb_alpha);
-        VkDeviceSize imageSize = texWidth * texHeight * 4;
-
-        if (!pixels) {
-            throw std::runtime_error("failed to load texture image!");
-        }
-
-        this->VKmipLevels = static_cast<uint32_t>(std::floor(std::log2(std::max(texWidth, texHeight)))) + 1;
-
-        VkBuffer stagingBuffer;
-        VkDeviceMemory stagingBufferMemory;
-
-        helper_::createBuffer(
-            this->VKdevice,
+        //  ڵ 忡 а, ö  ڸ ǥ ؽó εմϴ.
+        // ->  ð ؽó ũ⿡  ʽϴ.
+        this->VKtextureStreamer = std::make_unique<vkengine::asset::VKTextureStreamer>(
             this->VKphysicalDevice,
-            imageSize,
-            VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
-            VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-            stagingBuffer,
-            stagingBufferMemory);
-        
-        void* data;
-        vkMapMemory(this->VKdevice, stagingBufferMemory, 0, imageSize, 0, &data);
-            memcpy(data, pixels, static_cast<size_t>(imageSize));
-        vkUnmapMemory(this->VKdevice, stagingBufferMemory);
-
-        stbi_image_free(pixels);
-
-        helper_::createImage(
-            this->VKdevice,
-            this->VKphysicalDevice,
-            texWidth,
-            texHeight,
-            this->VKmipLevels,
-            VK_SAMPLE_COUNT_1_BIT,
-            VK_FORMAT_R8G8B8A8_SRGB,
-            VK_IMAGE_TILING_OPTIMAL,
-            VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
-            VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
-            this->VKtextureImage,
-            this->VKtextureImageMemory);
-        helper_::transitionImageLayout(
             this->VKdevice,
-            this->VKcommandPool,
-            this->graphicsVKQueue,
-            this->VKtextureImage,
-            VK_FORMAT_R8G8B8A8_SRGB,
-            VK_IMAGE_LAYOUT_UNDEFINED,
-            VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-            this->VKmipLevels);
-        helper_::copyBufferToImage(
-            this->VKdevice,
-            this->VKcommandPool,
-            this->graphicsVKQueue,
-            stagingBuffer,
-            this->VKtextureImage,
-            static_cast<uint32_t>(texWidth),
-            static_cast<uint32_t>(texHeight));
-        // Ӹ ϴ  VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL ȯǾϴ.
-        // VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL ȯǸ ̹ ̴   ֽϴ.
-        // ׷ Ʒ ڵ 
-
-        vkDestroyBuffer(this->VKdevice, stagingBuffer, nullptr);
-        vkFreeMemory(this->VKdevice, stagingBufferMemory, nullptr);
-
-        helper_::generateMipmaps(
-            this->VKphysicalDevice,
-            this->VKdevice,
-            this->VKcommandPool,
-            this->graphicsVKQueue,
-            this->VKtextureImage,
-            VK_FORMAT_R8G8B8A8_SRGB,
-            texWidth,
-            texHeight,
-            this->VKmipLevels);
-    }
+            this->VKallocator.get(),
+            this->VKstagingRing.get(),
+            this->VKtextureCompressionBC);
 
-    void Application::createTextureImageView()
-    {
-        // ̹    ü ʱȭմϴ.
-        this->VKtextureImageView = 
-            helper_::createImageView(
-            this->VKdevice,
-            this->VKtextureImage,
-            VK_FORMAT_R8G8B8A8_SRGB,
-            VK_IMAGE_ASPECT_COLOR_BIT,
-            this->VKmipLevels);
+        this->VKtexture = this->VKtextureStreamer->request(this->RootPath + TEXTURE_PATH);
     }
 
     void Application::createTextureSampler()
@@ -1380,7 +1200,7 @@ namespace vkutil {
         samplerInfo.compareOp = VK_COMPARE_OP_ALWAYS;
         samplerInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_LINEAR;
         samplerInfo.minLod = 0.0f; // Optional
-        samplerInfo.maxLod = static_cast<float>(this->VKmipLevels);
+        samplerInfo.maxLod = VK_LOD_CLAMP_NONE;             //   ؽó ö ڿ ϴ.
         samplerInfo.mipLodBias = 0.0f; // Optional
 
         if (vkCreateSampler(this->VKdevice, &samplerInfo, nullptr, &this->VKtextureSampler) != VK_SUCCESS)
@@ -1398,8 +1218,7 @@ namespace vkutil {
 
         // ̹   ü ʱȭմϴ.
         helper_::createImage(
-            this->VKdevice,
-            this->VKphysicalDevice,
+            this->VKallocator.get(),
             this->VKswapChainExtent.width,
             this->VKswapChainExtent.height,
             1,
@@ -1432,20 +1251,41 @@ namespace vkutil {
     }
 
     void Application::loadModel()
+    {
+        VK_TRACE_SCOPE("loadModel");
+
+        std::string obj = this->RootPath + MODEL_PATH;
+        std::string cache = obj + ".meshcache";
+
+        //  OBJ ؽð ĳÿ  Ľ  ĳø մϴ.
+        const uint64_t sourceHash = vkengine::asset::VKMeshCache::hashFile(obj);
+        if (!this->VKmesh.open(cache, sourceHash)) {
+            this->parseModel(obj, cache, sourceHash);
+        }
+
+        // ޽ø ؽ  ϴ. ->  ؽ Է° ؽ ۰   ϴ.
+        this->VKvertexFormat = vkengine::asset::selectVertexFormat(this->VKmesh.getVertices(), this->VKmesh.getVertexCount(), PACKED_VERTEXTYPE != 0);
+    }
+
+    void Application::parseModel(const std::string& obj, const std::string& cache, uint64_t sourceHash)
     {
         tinyobj::attrib_t attrib;
         std::vector<tinyobj::shape_t> shapes;
         std::vector<tinyobj::material_t> materials;
         std::string warn, err;
 
-        std::string obj = this->RootPath + MODEL_PATH;
-
         if (!tinyobj::LoadObj(&attrib, &shapes, &materials, &warn, &err, obj.c_str())) {
             throw std::runtime_error(warn + err);
         }
 
-        std::unordered_map<Vertex, uint32_t> uniqueVertices{};
+        //  𼭸  Vertex Ĩϴ.
+        size_t cornerCount = 0;
+        for (const auto& shape : shapes) {
+            cornerCount += shape.mesh.indices.size();
+        }
 
+        std::vector<Vertex> corners;
+        corners.reserve(cornerCount);
         for (const auto& shape : shapes) {
             for (const auto& index : shape.mesh.indices) {
                 Vertex vertex{};
@@ -1462,20 +1302,41 @@ namespace vkutil {
                 };
 
                 vertex.color = { 1.0f, 1.0f, 1.0f };
-#if UNIQUE_VERTEXTYPE
+                corners.push_back(vertex);
+            }
+        }
 
-                if (uniqueVertices.count(vertex) == 0) {
-                    uniqueVertices[vertex] = static_cast<uint32_t>(this->VKvertices.size());
-                    this->VKvertices.push_back(vertex);
-                }
-                this->VKindices.push_back(uniqueVertices[vertex]);
+        std::vector<Vertex> vertices;
+        std::vector<uint32_t> indices;
+#if UNIQUE_VERTEXTYPE
+        //  Vertex Ĩϴ. -> 庰  ּҹ ̺  ý  ó
+        vkengine::asset::VKVertexDeduplicator deduplicator(this->VKjobSystem.get());
+        deduplicator.deduplicate(corners.data(), static_cast<uint32_t>(corners.size()), vertices, indices);
 #else
-                
-                this->VKvertices.push_back(vertex);
-                this->VKindices.push_back(this->VKindices.size());
+        vertices = std::move(corners);
+        indices.resize(vertices.size());
+        for (uint32_t i = 0; i < static_cast<uint32_t>(indices.size()); i++)
+        {
+            indices[i] = i;
+        }
 #endif
-            }
+
+        // ؽ ĳ//ؽ fetch  ġմϴ. ->  ĳÿ ǹǷ ó   
+        vkengine::asset::optimizeMesh(vertices, indices);
+
+        // ȭ  ޽÷ ϴ. -> ޽÷  øؼ ׸ϴ.
+        vkengine::asset::VKMeshletData meshlets;
+        vkengine::asset::buildMeshlets(vertices.data(), static_cast<uint32_t>(vertices.size()), indices.data(), static_cast<uint32_t>(indices.size()), meshlets);
+        if (!vkengine::asset::validateMeshlets(meshlets, indices.data(), static_cast<uint32_t>(indices.size()), static_cast<uint32_t>(vertices.size()))) {
+            throw std::runtime_error("failed to build meshlets!");
+        }
+
+        //  ʹ ĳø մϴ. ĳø    Ľ 迭 ״ մϴ.
+        if (vkengine::asset::VKMeshCache::write(cache, sourceHash, vertices, indices, meshlets) && this->VKmesh.open(cache, sourceHash)) {
+            return;
         }
+
+        this->VKmesh.assign(std::move(vertices), std::move(indices), std::move(meshlets));
     }
 
     // ÷ ҽ Ƽø ó  ߰  ̹ ϸ,
@@ -1485,8 +1346,7 @@ namespace vkutil {
         VkFormat colorFormat = this->VKswapChainImageFormat;
 
         helper_::createImage(
-            this->VKdevice,
-            this->VKphysicalDevice,
+            this->VKallocator.get(),
             this->VKswapChainExtent.width,
             this->VKswapChainExtent.height,
             1,
@@ -1551,6 +1411,9 @@ namespace vkutil {
                 indices.queueFamilyProperties = queueFamily;
                 printf("Queuefamily index: %d\n", i);
                 printf("\n");
+
+                // ε忡   ť йи ãϴ. ( ׷Ƚ ť йи  )
+                indices.setTransferFamily(helper_::findTransferQueueFamily(device, indices.graphicsAndComputeFamily));
                 break;
             }
 
@@ -1676,23 +1539,10 @@ namespace vkutil {
 
     }
 
-    const VkShaderModule Application::createShaderModule(const std::vector<char>& code)
-    {
-        VkShaderModuleCreateInfo createInfo{};
-        createInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
-        createInfo.codeSize = code.size();
-        createInfo.pCode = reinterpret_cast<const uint32_t*>(code.data());
-
-        VkShaderModule shaderModule;
-        if (vkCreateShaderModule(this->VKdevice, &createInfo, nullptr, &shaderModule) != VK_SUCCESS) {
-            throw std::runtime_error("failed to create shader module!");
-        }
-
-        return shaderModule;
-    }
-
     void Application::recordCommandBuffer(VkCommandBuffer commandBuffer, uint32_t imageIndex)
     {
+        VK_TRACE_SCOPE("recordCommandBuffer");
+
         // Ŀǵ   մϴ.
         VkCommandBufferBeginInfo beginInfo{};
         beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
@@ -1703,6 +1553,30 @@ namespace vkutil {
             throw std::runtime_error("failed to begin recording command buffer!");
         }
 
+        // ڵ  ؽó ø Ӹ մϴ. ( н )
+        //   潺 ٷǷ   ũ Ʈ ٷ    ֽϴ.
+        this->VKtextureStreamer->update(commandBuffer, static_cast<uint32_t>(this->currentFrame));
+
+        const VkImageView textureView = this->VKtextureStreamer->getImageView(this->VKtexture);
+        if (textureView != this->VKboundTextureViews[this->currentFrame]) {
+            VkDescriptorImageInfo imageInfo{};
+            imageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+            imageInfo.imageView = textureView;
+            imageInfo.sampler = this->VKtextureSampler;
+
+            VkWriteDescriptorSet descriptorWrite{};
+            descriptorWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+            descriptorWrite.dstSet = this->VKdescriptorSets[this->currentFrame];
+            descriptorWrite.dstBinding = 1;
+            descriptorWrite.dstArrayElement = 0;
+            descriptorWrite.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+            descriptorWrite.descriptorCount = 1;
+            descriptorWrite.pImageInfo = &imageInfo;
+
+            vkUpdateDescriptorSets(this->VKdevice, 1, &descriptorWrite, 0, nullptr);
+            this->VKboundTextureViews[this->currentFrame] = textureView;
+        }
+
         //  н   ü ʱȭմϴ.
         VkRenderPassBeginInfo renderPassInfo{};
         renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
@@ -1720,47 +1594,80 @@ namespace vkutil {
         renderPassInfo.clearValueCount = static_cast<uint32_t>(clearValues.size());;
         renderPassInfo.pClearValues = clearValues.data();
 
-        //  н մϴ.
-        vkCmdBeginRenderPass(commandBuffer, &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
+        //  н մϴ. ->  secondary Ŀǵ ۷ մϴ.
+        vkCmdBeginRenderPass(commandBuffer, &renderPassInfo, VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS);
         {
-            // ׷  εմϴ.
-            vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, this->VKgraphicsPipeline);
-
-            VkViewport viewport{};
-            viewport.x = 0.0f;
-            viewport.y = 0.0f;
-            viewport.width = static_cast<float>(this->VKswapChainExtent.width);
-            viewport.height = static_cast<float>(this->VKswapChainExtent.height);
-            viewport.minDepth = 0.0f;
-            viewport.maxDepth = 1.0f;
-            vkCmdSetViewport(commandBuffer, 0, 1, &viewport);
-
-            VkRect2D scissor{};
-            scissor.offset = { 0, 0 };
-            scissor.extent = this->VKswapChainExtent;
-            vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
-
-            // ؽ ۸ εմϴ.
-            VkBuffer vertexBuffers[] = { this->VKvertexBuffer };
-            VkDeviceSize offsets[] = { 0 };
-            vkCmdBindVertexBuffers(commandBuffer, 0, 1, vertexBuffers, offsets);
-            
-            // ε ۸ εմϴ.
-            vkCmdBindIndexBuffer(commandBuffer, this->VKindexBuffer, 0, VK_INDEX_TYPE_UINT32);
-
-            // ũ Ʈ εմϴ.
-            vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, this->VKpipelineLayout, 0, 1, &this->VKdescriptorSets[currentFrame], 0, nullptr);
-            //  н մϴ.
-            vkCmdDrawIndexed(commandBuffer, static_cast<uint32_t>(this->VKindices.size()), 1, 0, 0, 0);
-
-            ImGui_ImplVulkan_NewFrame();
-            ImGui_ImplGlfw_NewFrame();
-            ImGui::NewFrame();
-            
-            ImGui::ShowDemoWindow();
-            
-            ImGui::Render();
-            ImGui_ImplVulkan_RenderDrawData(ImGui::GetDrawData(), commandBuffer);
+            VkCommandBufferInheritanceInfo inheritanceInfo{};
+            inheritanceInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
+            inheritanceInfo.renderPass = this->VKrenderPass;
+            inheritanceInfo.subpass = 0;
+            inheritanceInfo.framebuffer = this->VKswapChainFramebuffers[imageIndex];
+
+            // ̴ ޽÷ ׸ϴ. (ü +  )
+            // ε ۿ ̾ ޽÷ draw ϳ ġ,   ̸ ޽ ü   ׸ϴ.
+            vkengine::asset::cullMeshlets(this->VKmesh.getMeshlets(), this->VKmesh.getMeshletCount(), this->VKmeshletViewProjection, this->VKmeshletCameraPosition, this->VKvisibleMeshlets);
+            vkengine::asset::mergeMeshletDraws(this->VKmesh.getMeshlets(), this->VKmesh.getMeshletCount(), this->VKvisibleMeshlets, this->VKmesh.getIndexCount(), this->VKmeshletDraws);
+
+            // draw  庰  ϰ, ImGui  忡  մϴ.
+            this->VKcommandRecorder->record(
+                commandBuffer,
+                static_cast<uint32_t>(this->currentFrame),
+                inheritanceInfo,
+                static_cast<uint32_t>(this->VKmeshletDraws.size()),
+                [this](VkCommandBuffer secondary, uint32_t first, uint32_t count) {
+                    //    ̸   ׸ ʽϴ.
+                    const VkPipeline pipeline = this->VKgraphicsPipeline.get();
+                    if (pipeline == VK_NULL_HANDLE) {
+                        return;
+                    }
+
+                    // ׷  εմϴ.
+                    vkCmdBindPipeline(secondary, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline);
+
+                    VkViewport viewport{};
+                    viewport.x = 0.0f;
+                    viewport.y = 0.0f;
+                    viewport.width = static_cast<float>(this->VKswapChainExtent.width);
+                    viewport.height = static_cast<float>(this->VKswapChainExtent.height);
+                    viewport.minDepth = 0.0f;
+                    viewport.maxDepth = 1.0f;
+                    vkCmdSetViewport(secondary, 0, 1, &viewport);
+
+                    VkRect2D scissor{};
+                    scissor.offset = { 0, 0 };
+                    scissor.extent = this->VKswapChainExtent;
+                    vkCmdSetScissor(secondary, 0, 1, &scissor);
+
+                    // ؽ ۸ εմϴ.
+                    VkBuffer vertexBuffers[] = { this->VKvertexBuffer };
+                    VkDeviceSize offsets[] = { 0 };
+                    vkCmdBindVertexBuffers(secondary, 0, 1, vertexBuffers, offsets);
+
+                    // ε ۸ εմϴ.
+                    vkCmdBindIndexBuffer(secondary, this->VKindexBuffer, 0, VK_INDEX_TYPE_UINT32);
+
+                    // ũ Ʈ εմϴ.
+                    vkCmdBindDescriptorSets(secondary, VK_PIPELINE_BIND_POINT_GRAPHICS, this->VKpipelineLayout, 0, 1, &this->VKdescriptorSets[currentFrame], 0, nullptr);
+
+                    //  ؽ ġ   ѱϴ. (Float  ׵ ȯ)
+                    vkCmdPushConstants(secondary, this->VKpipelineLayout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(this->VKvertexQuantization), &this->VKvertexQuantization);
+
+                    for (uint32_t i = first; i < first + count; i++)
+                    {
+                        const vkengine::asset::VKMeshletDraw& draw = this->VKmeshletDraws[i];
+                        vkCmdDrawIndexed(secondary, draw.indexCount, 1, draw.firstIndex, 0, 0);
+                    }
+                },
+                [](VkCommandBuffer secondary) {
+                    ImGui_ImplVulkan_NewFrame();
+                    ImGui_ImplGlfw_NewFrame();
+                    ImGui::NewFrame();
+
+                    ImGui::ShowDemoWindow();
+
+                    ImGui::Render();
+                    ImGui_ImplVulkan_RenderDrawData(ImGui::GetDrawData(), secondary);
+                });
         }
 
         vkCmdEndRenderPass(commandBuffer);
@@ -1773,6 +1680,8 @@ namespace vkutil {
 
     void Application::updateUniformBuffer(uint32_t currentImage)
     {
+        VK_TRACE_SCOPE("updateUniformBuffer");
+
         static auto startTime = std::chrono::high_resolution_clock::now();
         auto currentTime = std::chrono::high_resolution_clock::now();
         float time = std::chrono::duration<float, std::chrono::seconds::period>(currentTime - startTime).count();
@@ -1786,6 +1695,10 @@ namespace vkutil {
         ubo.proj[1][1] *= -1;
         //ubo.proj = this->camera->getProjectionMatrix();
 
+        // ޽÷ ø ޽(Ʈ)  մϴ.
+        this->VKmeshletViewProjection = ubo.proj * ubo.view * ubo.model;
+        this->VKmeshletCameraPosition = glm::vec3(glm::inverse(ubo.view * ubo.model)[3]);
+
         memcpy(this->VKuniformBuffersMapped[currentImage], &ubo, sizeof(ubo));
     }
 
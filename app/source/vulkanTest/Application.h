@@ -3,6 +3,18 @@
 
 #include "../_common.h"
 #include "../struct.h"
+#include "../engine/VKallocator.h"
+#include "../engine/VKstaging.h"
+#include "../engine/VKjobSystem.h"
+#include "../engine/VKcommandRecorder.h"
+#include "../engine/VKpipelineCache.h"
+#include "../engine/VKpipelineManager.h"
+#include "../engine/VKmeshCache.h"
+#include "../engine/VKvertexDedup.h"
+#include "../engine/VKmeshOptimizer.h"
+#include "../engine/VKmeshlet.h"
+#include "../engine/VKvertexQuantize.h"
+#include "../engine/VKtextureStreamer.h"
 
 #include "imgui.h" 
 #include "imconfig.h"
@@ -65,11 +77,11 @@ namespace vkutil {
         void createDescriptorPool();
         void createDescriptorSets();
         void createTextureImage();
-        void createTextureImageView();
         void createTextureSampler();
         void createDepthResources();
         
         void loadModel();
+        void parseModel(const std::string& obj, const std::string& cache, uint64_t sourceHash);   // OBJ를 파싱해 캐시를 만듭니다.
         void createColorResources();
 
         // 도구
@@ -107,9 +119,7 @@ namespace vkutil {
         // 현재 해상도가 유효하면 반환하고, 그렇지 않으면 GLFW 크기를 기준으로 해상도를 설정합니다.
         // 해상도는 최소 및 최대 이미지 해상도 사이에서 클램프됩니다.
         VkExtent2D chooseSwapExtent(const VkSurfaceCapabilitiesKHR& capabilities);
-        
-        // 코드를 읽어서 셰이더 모듈을 생성하는 함수
-        const VkShaderModule createShaderModule(const std::vector<char>& code);
+
 
         // 커맨드 버퍼를 기록하는 함수
         // 실행하고자 하는 명령을 명령 버퍼에 기록
@@ -128,9 +138,16 @@ namespace vkutil {
         VkPhysicalDevice VKphysicalDevice;                  // 물리 디바이스 -> GPU Physical Handle
         QueueFamilyIndices VKqueueFamilyIndices;            // 큐 패밀리 인덱스 -> VKphysicalDevice에서 선택한 queue family index
         VkDevice VKdevice;                                  // 논리 디바이스 -> GPU Logical Handle
+        std::unique_ptr<vkengine::memory::VKMemoryAllocator> VKallocator; // 디바이스 메모리 할당기 -> 버퍼/이미지 메모리를 블록 단위로 관리
+        std::unique_ptr<vkengine::memory::VKStagingRing> VKstagingRing; // 스테이징 링 버퍼 -> 업로드를 모아 한 번에 제출
+        std::unique_ptr<vkengine::job::VKJobSystem> VKjobSystem; // 잡 시스템 -> 작업 훔치기 스케줄러로 프레임 단계를 병렬 실행
+        std::unique_ptr<vkengine::VKCommandRecorder> VKcommandRecorder; // 멀티스레드 커맨드 레코더 -> 스레드별 커맨드 풀로 secondary 커맨드 버퍼 기록
+        vkengine::VKPipelineCache VKpipelineCache;          // 파이프라인 캐시 -> 종료할 때 파일로 저장하고 다음 실행에서 불러옴
+        std::unique_ptr<vkengine::VKPipelineManager> VKpipelineManager; // 파이프라인 관리자 -> 상태 해시로 중복 제거, 백그라운드 스레드에서 컴파일
         
         VkQueue graphicsVKQueue;                            // 그래픽스 큐 -> 그래픽스 명령을 처리하는 큐
         VkQueue presentVKQueue;                             // 프레젠트 큐 -> 윈도우 시스템과 Vulkan을 연결하는 인터페이스
+        VkQueue transferVKQueue;                            // 전송 큐 -> 업로드(복사) 명령을 처리하는 큐
         
         VkSurfaceKHR VKsurface;                             // 서피스 -> 윈도우 시스템과 Vulkan을 연결하는 인터페이스
         VkSwapchainKHR VKswapChain;                         // 스왑 체인 -> 이미지를 프레임 버퍼로 전송하는 데 사용
@@ -140,7 +157,7 @@ namespace vkutil {
         VkExtent2D VKswapChainExtent;                       // 스왑 체인 이미지 해상도 -> 스왑 체인 이미지의 너비와 높이
         VkPipelineLayout VKpipelineLayout;                  // 파이프라인 레이아웃 -> 파이프라인에 사용되는 레이아웃
         VkRenderPass VKrenderPass;                          // 렌더 패스 -> 렌더링 작업을 정의하는 데 사용
-        VkPipeline VKgraphicsPipeline;                      // 그래픽스 파이프라인 -> 그래픽스 파이프라인을 생성
+        vkengine::VKPipelineHandle VKgraphicsPipeline;      // 그래픽스 파이프라인 -> 파이프라인 관리자가 컴파일하고 소유
         std::vector<VkFramebuffer> VKswapChainFramebuffers; // 스왑 체인 프레임 버퍼 -> 스왑 체인 이미지를 렌더링할 때 사용 (프레임 버퍼는 이미지를 렌더링하는 데 사용)
         VkCommandPool VKcommandPool;                        // 커맨드 풀 -> 커맨드 버퍼를 생성하는 데 사용 (커맨드 풀은 커맨드 버퍼를 생성하는 데 사용)
         std::vector<VkCommandBuffer> VKcommandBuffers;      // 커맨드 버퍼 -> 렌더링 명령을 저장하는 데 사용
@@ -148,37 +165,41 @@ namespace vkutil {
         std::vector<VkSemaphore> VkrenderFinishedSemaphore; // 렌더링 완료 세마포어 -> 렌더링이 완료되었음을 알리는 데 사용
         std::vector<VkFence> VkinFlightFences;              // 플라이트 펜스 -> 프레임이 완료되었음을 알리는 데 사용
 
-        std::vector<Vertex> VKvertices;                     // 버텍스 -> 버텍스 데이터를 저장하는 데 사용
-        std::vector<uint32_t> VKindices;                    // 인덱스 -> 인덱스 데이터를 저장하는 데 사용
+        vkengine::asset::VKMeshCache VKmesh;                // 메시 -> 바이너리 캐시를 매핑한 버텍스/인덱스/메시렛 데이터
+        std::vector<uint32_t> VKvisibleMeshlets;            // 이번 프레임에 컬링을 통과한 메시렛 번호
+        std::vector<vkengine::asset::VKMeshletDraw> VKmeshletDraws; // 이어지는 보이는 메시렛을 합친 draw 목록
+        glm::mat4 VKmeshletViewProjection{ 1.0f };          // 메시렛 컬링용 MVP (오브젝트 공간 -> 클립 공간)
+        glm::vec3 VKmeshletCameraPosition{ 0.0f };          // 메시렛 컬링용 카메라 위치 (오브젝트 공간)
+        vkengine::asset::VKVertexFormat VKvertexFormat = vkengine::asset::VKVertexFormat::Float;    // 메시 버텍스 형식 -> loadModel에서 고릅니다.
+        vkengine::asset::VKVertexQuantization VKvertexQuantization{};                               // 압축 버텍스 위치 복원 푸시 상수
 
         VkBuffer VKvertexBuffer;                            // 버텍스 버퍼 -> 버텍스 데이터를 저장하는 데 사용
-        VkDeviceMemory VKvertexBufferMemory;                // 버텍스 버퍼 메모리 -> 버텍스 데이터를 저장하는 데 사용
+        vkengine::memory::VKAllocation VKvertexBufferMemory; // 버텍스 버퍼 메모리 -> 버텍스 데이터를 저장하는 데 사용
         
         VkBuffer VKindexBuffer;                             // 인덱스 버퍼 -> 인덱스 데이터를 저장하는 데 사용
-        VkDeviceMemory VKindexBufferMemory;                 // 인덱스 버퍼 메모리 -> 인덱스 데이터를 저장하는 데 사용
+        vkengine::memory::VKAllocation VKindexBufferMemory; // 인덱스 버퍼 메모리 -> 인덱스 데이터를 저장하는 데 사용
 
         std::vector<VkBuffer> VKuniformBuffers;             // 유니폼 버퍼 -> 유니폼 데이터를 저장하는 데 사용
-        std::vector<VkDeviceMemory> VKuniformBuffersMemory; // 유니폼 버퍼 메모리 -> 유니폼 데이터를 저장하는 데 사용
+        std::vector<vkengine::memory::VKAllocation> VKuniformBuffersMemory; // 유니폼 버퍼 메모리 -> 유니폼 데이터를 저장하는 데 사용
         std::vector<void*> VKuniformBuffersMapped;          // 유니폼 버퍼 매핑 -> 유니폼 데이터를 매핑하는 데 사용
 
         VkDescriptorPool VKdescriptorPool;                  // 디스크립터 풀 -> 디스크립터를 생성하는 데 사용
         VkDescriptorSetLayout VKdescriptorSetLayout;        // 디스크립터 세트 레이아웃 -> 디스크립터 세트를 생성하는 데 사용
         std::vector<VkDescriptorSet> VKdescriptorSets;      // 디스크립터 세트 -> 디스크립터를 생성하는 데 사용
 
-        uint32_t VKmipLevels;                               // 밉 레벨 -> 이미지의 미입 레벨
-
-        VkImage VKtextureImage;                            // 텍스처 이미지 -> 텍스처 이미지를 저장하는 데 사용
-        VkDeviceMemory VKtextureImageMemory;               // 텍스처 이미지 메모리 -> 텍스처 이미지를 저장하는 데 사용
+        std::unique_ptr<vkengine::asset::VKTextureStreamer> VKtextureStreamer; // 텍스처 스트리밍 -> 디코딩 스레드에서 읽고 프레임마다 올립니다.
+        bool VKtextureCompressionBC = false;                // 디바이스를 만들 때 textureCompressionBC를 켰는지 -> 꺼져 있으면 BC 텍스처 파일 대신 원본을 올립니다.
+        vkengine::asset::VKTextureHandle VKtexture;         // 모델 텍스처 핸들
+        VkImageView VKboundTextureViews[MAX_FRAMES_IN_FLIGHT]; // 프레임 슬롯의 디스크립터 세트에 써 둔 뷰 -> 자리 표시 텍스처에서 바뀌면 다시 씁니다.
 
-        VkImageView VKtextureImageView;                    // 텍스처 이미지 뷰 -> 텍스처 이미지를 뷰로 변환 (이미지 뷰는 이미지를 읽고 쓰는 데 사용)
         VkSampler VKtextureSampler;                        // 텍스처 샘플러 -> 텍스처 이미지를 샘플링하는 데 사용
 
         VkImage VKdepthImage;                              // 깊이 이미지 -> 깊이 이미지를 저장하는 데 사용
-        VkDeviceMemory VKdepthImageMemory;                 // 깊이 이미지 메모리 -> 깊이 이미지를 저장하는 데 사용
+        vkengine::memory::VKAllocation VKdepthImageMemory; // 깊이 이미지 메모리 -> 깊이 이미지를 저장하는 데 사용
         VkImageView VKdepthImageView;                      // 깊이 이미지 뷰 -> 깊이 이미지를 뷰로 변환 (이미지 뷰는 이미지를 읽고 쓰는 데 사용)
 
         VkImage VKcolorImage;                              // 컬러 이미지 -> 컬러 이미지를 저장하는 데 사용
-        VkDeviceMemory VKcolorImageMemory;                 // 컬러 이미지 메모리 -> 컬러 이미지를 저장하는 데 사용
+        vkengine::memory::VKAllocation VKcolorImageMemory; // 컬러 이미지 메모리 -> 컬러 이미지를 저장하는 데 사용
         VkImageView VKcolorImageView;                      // 컬러 이미지 뷰 -> 컬러 이미지를 뷰로 변환 (이미지 뷰는 이미지를 읽고 쓰는 데 사용)
 
         VkSampleCountFlagBits VKmsaaSamples = VK_SAMPLE_COUNT_1_BIT; // MSAA 샘플 -> MSAA 샘플 수
@@ -1,6 +1,7 @@
 
 #include "DebugFunction.h"
 #include "Application.h"
+#include "../engine/VKtrace.h"
 
 using namespace vkutil;
 using vkutil::Application;
@@ -19,6 +20,11 @@ namespace vkutil {
         if (key == GLFW_KEY_ESCAPE && action == GLFW_PRESS) {
             glfwSetWindowShouldClose(window, GLFW_TRUE);
         }
+
+        // F12 -> ֱ CPU  Ʈ̽ Ϸ  (۾ ͸ )
+        if (key == GLFW_KEY_F12 && action == GLFW_PRESS) {
+            VK_TRACE_WRITE(vkengine::trace::CPU_TRACE_FILE);
+        }
     }
 
     void populateDebugMessengerCreateInfo(VkDebugUtilsMessengerCreateInfoEXT& createInfo) {
@@ -1,3 +1,5 @@
 C:/VulkanSDK/1.4.304.0/Bin/glslc.exe shader.vert -o vert.spv
 C:/VulkanSDK/1.4.304.0/Bin/glslc.exe shader.frag -o frag.spv
+C:/VulkanSDK/1.4.304.0/Bin/glslc.exe instanced.vert -o vertInstanced.spv
+C:/VulkanSDK/1.4.304.0/Bin/glslc.exe cull.comp -o compCull.spv
 pause
\ No newline at end of file
@@ -2,4 +2,6 @@ C:/VulkanSDK/1.4.304.0/Bin/glslangValidator.exe -e main -gVS -V -o vert.spv shad
 C:/VulkanSDK/1.4.304.0/Bin/glslangValidator.exe -e main -gVS -V -o frag.spv shader.frag
 C:/VulkanSDK/1.4.304.0/Bin/glslangValidator.exe -e main -gVS -V -o vertTrinagle00.spv trinagle00.vert
 C:/VulkanSDK/1.4.304.0/Bin/glslangValidator.exe -e main -gVS -V -o fragTrinagle00.spv trinagle00.frag
+C:/VulkanSDK/1.4.304.0/Bin/glslangValidator.exe -e main -gVS -V -o vertInstanced.spv instanced.vert
+C:/VulkanSDK/1.4.304.0/Bin/glslangValidator.exe -e main -gVS -V -o compCull.spv cull.comp
 pause
\ No newline at end of file